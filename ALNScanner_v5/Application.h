@@ -30,10 +30,12 @@
 
 #include "config.h"
 #include "hal/RFIDReader.h"
+#include "hal/RFIDScanTask.h"
 #include "hal/DisplayDriver.h"
 #include "hal/AudioDriver.h"
 #include "hal/TouchDriver.h"
 #include "hal/SDCard.h"
+#include "hal/AssetPack.h"
 #include "services/ConfigService.h"
 #include "services/TokenService.h"
 #include "services/AssetService.h"
@@ -87,7 +89,6 @@ public:
     Application()
         : _debugMode(false)
         , _rfidInitialized(false)
-        , _lastRFIDScan(0)
         , _bootOverrideReceived(false)
         , _ui(nullptr)
     {
@@ -134,7 +135,7 @@ public:
      * 2. Update audio playback state
      * 3. Update UI state machine (timeouts, screen updates)
      * 4. Handle touch events
-     * 5. Process RFID scans (if not blocked by UI)
+     * 5. Consume RFID scan events (posted by the RFID scan task)
      * 6. Process serial commands again (responsiveness)
      *
      * SOURCE: ALNScanner1021_Orchestrator.ino lines 3563-3840
@@ -164,13 +165,6 @@ private:
      */
     bool _rfidInitialized;
 
-    /**
-     * Last RFID scan timestamp (for 500ms rate limiting)
-     * Prevents excessive scanning and reduces GPIO 27 beeping
-     * SOURCE: v4.1 line 106
-     */
-    uint32_t _lastRFIDScan;
-
     /**
      * Boot override flag (30-second window)
      * If any character received during boot, force DEBUG_MODE=true
@@ -262,13 +256,16 @@ private:
     void registerSerialCommands();
 
     /**
-     * @brief Start FreeRTOS background task on Core 0
+     * @brief Start FreeRTOS background tasks on Core 0
      *
      * Starts the background synchronization task that:
      * - Checks orchestrator health every 10 seconds
      * - Uploads queued scans when connection available
      * - Updates connection state
      *
+     * and, when RFID is initialized, the RFID scan task (hal/RFIDScanTask.h)
+     * that detects cards and posts scan events to processRFIDScan().
+     *
      * SOURCE: v4.1 lines 2679-2683, 2893-2900
      */
     void startBackgroundTasks();
@@ -297,28 +294,65 @@ private:
     // PPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPP
 
     /**
-     * @brief Process RFID card scan events
+     * @brief Consume RFID scan events from the RFID scan task
      *
      * EXECUTION FLOW:
-     * 1. Check preconditions (initialized, UI not blocked, rate limit)
-     * 2. Scan for RFID card (500ms interval to reduce beeping); distinguish
-     *    NoCard vs CommFailed via DetectResult enum
-     * 3. Extract token ID from NDEF. On failure, show non-blocking
-     *    SCAN_FAILED screen and do NOT send to orchestrator.
-     * 4. Look up token metadata in local DB BEFORE sending to orchestrator.
-     *    Unknown tokens show SCAN_FAILED and are not uploaded — the
-     *    orchestrator only ever sees real game tokenIds.
-     * 5. Send known tokens to orchestrator or queue offline.
-     * 6. Display appropriate screen (video modal or regular token).
+     * 1. Apply UI blocking policy to the scan task (pause while a token,
+     *    status or video modal is on screen)
+     * 2. Poll one RFIDScanEvent from the lock-free queue
+     * 3. Discard it if the UI became blocking after it was posted,
+     *    otherwise hand it to handleScanEvent()
+     * 4. Rearm the task so it may detect the next card
      *
-     * RATE LIMITING:
-     * - 500ms minimum between scans (reduces GPIO 27 beeping)
-     * - Blocked when UI not in READY state
+     * Detection and NDEF extraction run on the scan task (Core 0), so
+     * they proceed while this loop is drawing.
+     * The 500ms scan cadence (GPIO 27 beeping mitigation) lives in
+     * the task.
      *
      * SOURCE: v4.1 lines 3678-3839
      */
     void processRFIDScan();
 
+    /**
+     * @brief Route a single scan event to the orchestrator and UI
+     *
+     * 1. CommFailed / ReadFailed -> non-blocking SCAN_FAILED screen, no send.
+     * 2. Look up token metadata in local DB BEFORE sending to orchestrator.
+     *    Unknown tokens show SCAN_FAILED and are not uploaded — the
+     *    orchestrator only ever sees real game tokenIds.
+     * 3. Submit known tokens to the scan submit task or queue offline.
+     * 4. Display appropriate screen (video modal or regular token) at once;
+     *    the outcome is reconciled later by processScanResults().
+     */
+    void handleScanEvent(const hal::RFIDScanEvent& event);
+
+    /**
+     * @brief Reconcile outcomes of submitted scans with the screen
+     *
+     * The token was drawn optimistically (as if ACCEPTED). A late outcome
+     * queues RETRY_QUEUE scans, relabels a still-visible processing modal
+     * "VIDEO UNAVAILABLE", or reverts to NO SESSION when the scan was not
+     * recorded (services::lateOutcomeAction()).
+     */
+    void processScanResults();
+
+    /**
+     * @brief Swap in a token database re-synced on Core 0
+     *
+     * Only while the UI is idle; until then the new file waits on SD
+     * (see TokenService::reloadIfNewer()).
+     */
+    void processRemoteRefresh();
+
+    /**
+     * @brief Token/asset re-syncs pushed by the orchestrator
+     *
+     * OrchestratorService::RemoteRefreshJob, run on the OrchestratorSync
+     * task (Core 0): downloads only, the token reload is left to
+     * processRemoteRefresh().
+     */
+    static void syncRemoteChanges(uint8_t what, const models::DeviceConfig& config);
+
     /**
      * @brief Process touch events via UI state machine
      *
@@ -347,7 +381,7 @@ private:
     /**
      * @brief Apply the shared outcome logic for a classified scan response.
      *
-     * Both processRFIDScan() and the SIMULATE_SCAN serial command send a scan
+     * Both processScanResults() and the SIMULATE_SCAN serial command send a scan
      * to the orchestrator and receive a ScanOutcome.  The queueing decision
      * and UI transition for the REJECTED_NO_SESSION case are identical in
      * both paths — this helper owns that shared logic so the two call sites
@@ -397,12 +431,14 @@ private:
  * 2. Update audio playback
  * 3. Update UI (timeouts, screen transitions)
  * 4. Process touch events (delegated to UIStateMachine)
- * 5. Process RFID scanning (guarded by state checks)
+ * 5. Consume RFID scan events (detection runs on the RFID scan task)
+ * 6. Reconcile scan outcomes (submission runs on the scan submit task)
  *
  * Design notes:
  * - Serial commands are processed multiple times per loop for responsiveness
  * - All touch logic is in UIStateMachine (no duplication here)
- * - RFID scanning is guarded by _rfidInitialized and UI state
+ * - RFID events are gated by _rfidInitialized and UI state; the card
+ *   itself is polled on Core 0 so this loop never waits on the reader
  */
 inline void Application::loop() {
     // Get singleton references (efficient - static local in getInstance())
@@ -426,9 +462,15 @@ inline void Application::loop() {
     // Touch handling (delegated to UIStateMachine)
     processTouch();
 
-    // RFID scanning (guarded by state checks)
+    // RFID scan events (guarded by state checks)
     processRFIDScan();
 
+    // Outcomes of scans submitted on earlier iterations
+    processScanResults();
+
+    // Token/asset changes announced on the push channel
+    processRemoteRefresh();
+
     // Process serial commands one more time
     serial.processCommands();
 }
@@ -459,27 +501,19 @@ inline void Application::processTouch() {
 // ═══════════════════════════════════════════════════════════════════════
 
 /**
- * processRFIDScan() - RFID scanning and token processing
- *
- * Flow:
- * 1. Guard conditions (RFID init, UI blocking, rate limiting).
- * 2. Detect card via DetectResult enum (NoCard/Detected/CommFailed).
- * 3. Extract tokenId from NDEF. On failure -> showScanFailed(), no
- *    orchestrator send, no UID fallback.
- * 4. Look up token in local DB before sending to orchestrator. Unknown
- *    tokens are reported to the user but NOT uploaded — the old UID-hex
- *    fallback is removed so that the orchestrator only ever sees real
- *    game tokenIds.
- * 5. Display token (video modal or regular) only for known, valid tokens.
+ * processRFIDScan() - Consume events from the RFID scan task
  *
- * Failure routing (all via _ui->showScanFailed, which is non-blocking):
- *   CommFailed  -> "COMM FAILED"    (detect retries exhausted)
- *   NDEF empty  -> "READ FAILED"    (NDEF extraction retries exhausted)
- *   Unknown ID  -> "UNKNOWN TOKEN"  (NDEF OK, but tokenId not in DB)
- *
- * The SCAN_FAILED UI state does NOT block RFID scanning, so the player
- * can immediately re-tap a token after a transient failure without
- * waiting for the screen to dismiss.
+ * The scan task (hal/RFIDScanTask.h) does card detection and NDEF
+ * extraction on Core 0 and posts at most one event at a time. This side
+ * owns the UI policy:
+ * - The task is paused while the UI blocks RFID (token display, status,
+ *   video modal). SCAN_FAILED does not block, so a player can re-tap
+ *   immediately after a transient failure.
+ * - An event that raced a transition into a blocking state is dropped,
+ *   matching the old inline behaviour where no scan happened at all.
+ * - rearm() is only called after the event has been fully handled, so a
+ *   token resting on the reader during a long draw produces no duplicate
+ *   events.
  */
 inline void Application::processRFIDScan() {
     // ═══ GUARD CONDITIONS ═══════════════════════════════════════════
@@ -487,49 +521,66 @@ inline void Application::processRFIDScan() {
         return;
     }
 
-    if (_ui && _ui->isBlockingRFID()) {
-        return;
-    }
+    auto& scanTask = hal::RFIDScanTask::getInstance();
+    scanTask.setPaused(!_ui || _ui->isBlockingRFID());
 
-    if (millis() - _lastRFIDScan < timing::RFID_SCAN_INTERVAL_MS) {
+    hal::RFIDScanEvent event;
+    if (!scanTask.poll(event)) {
         return;
     }
-    _lastRFIDScan = millis();
 
-    // ═══ RFID DETECTION ═════════════════════════════════════════════
-    auto& rfid = hal::RFIDReader::getInstance();
-
-    MFRC522::Uid uid;
-    hal::DetectResult det = rfid.detectCard(uid);
+    LOG_DEBUG("[SCAN] Event result=%d detect=%lums read=%lums queued=%lums\n",
+              static_cast<int>(event.result),
+              (unsigned long)(event.detectedAtMs - event.startedAtMs),
+              (unsigned long)(event.completedAtMs - event.detectedAtMs),
+              (unsigned long)(millis() - event.completedAtMs));
 
-    if (det == hal::DetectResult::NoCard) {
-        return;  // Normal idle — no card in field
+    if (!_ui || _ui->isBlockingRFID()) {
+        LOG_DEBUG("[SCAN] UI blocking, event discarded\n");
+    } else {
+        handleScanEvent(event);
     }
 
-    if (det == hal::DetectResult::CommFailed) {
+    // Re-evaluate the policy before rearming so a scan that just put a
+    // token on screen doesn't let the task start another RF cycle.
+    scanTask.setPaused(!_ui || _ui->isBlockingRFID());
+    scanTask.rearm();
+}
+
+/**
+ * handleScanEvent() - Token processing for one scan event
+ *
+ * Flow:
+ * 1. Failure results -> showScanFailed(), no orchestrator send, no UID
+ *    fallback.
+ * 2. Look up token in local DB before sending to orchestrator. Unknown
+ *    tokens are reported to the user but NOT uploaded — the old UID-hex
+ *    fallback is removed so that the orchestrator only ever sees real
+ *    game tokenIds.
+ * 3. Display token (video modal or regular) only for known, valid tokens.
+ *
+ * Failure routing (all via _ui->showScanFailed, which is non-blocking):
+ *   CommFailed  -> "COMM FAILED"    (detect retries exhausted)
+ *   ReadFailed  -> "READ FAILED"    (NDEF extraction retries exhausted)
+ *   Unknown ID  -> "UNKNOWN TOKEN"  (NDEF OK, but tokenId not in DB)
+ */
+inline void Application::handleScanEvent(const hal::RFIDScanEvent& event) {
+    // ═══ DETECT / READ RESULT ═══════════════════════════════════════
+    if (event.result == hal::ScanEventResult::CommFailed) {
         LOG_INFO("[SCAN-FAIL] Card detect comm failure\n");
-        if (_ui) {
-            _ui->showScanFailed("COMM FAILED");
-        }
+        _ui->showScanFailed("COMM FAILED");
         return;
     }
 
-    // det == Detected
-    LOG_INFO("[SCAN] Card detected (UID size: %d)\n", uid.size);
+    LOG_INFO("[SCAN] Card detected (UID size: %d)\n", event.uid.size);
 
-    // ═══ NDEF EXTRACTION ════════════════════════════════════════════
-    // extractNDEFText() handles its own retries and reSelect recovery,
-    // and internally disables the RF field on return (success or failure).
-    String tokenId = rfid.extractNDEFText();
-
-    if (tokenId.length() == 0) {
+    if (event.result == hal::ScanEventResult::ReadFailed) {
         LOG_INFO("[SCAN-FAIL] NDEF extraction failed after retries\n");
-        if (_ui) {
-            _ui->showScanFailed("READ FAILED");
-        }
+        _ui->showScanFailed("READ FAILED");
         return;
     }
 
+    const String& tokenId = event.tokenId;
     LOG_INFO("[SCAN] NDEF tokenId: %s\n", tokenId.c_str());
 
     // ═══ TOKEN DB VALIDATION (gate orchestrator send) ═══════════════
@@ -547,11 +598,11 @@ inline void Application::processRFIDScan() {
         return;
     }
 
-    // ═══ ORCHESTRATOR SEND/QUEUE ════════════════════════════════════
-    // SCAN-PATH CONTRACT (F-PARITY-06): at most ONE bounded send attempt
-    // here; on failure the scan is queued immediately. Retries/backoff
-    // belong exclusively to the Core-0 background task. Token display
-    // never waits beyond that single attempt.
+    // ═══ ORCHESTRATOR SUBMIT/QUEUE ══════════════════════════════════
+    // SCAN-PATH CONTRACT (F-PARITY-06): at most ONE bounded send attempt,
+    // made by the Core-0 scan submit task; on failure the scan is queued
+    // when the outcome comes back. Retries/backoff belong exclusively to
+    // the Core-0 background task. Token display never waits on the network.
     auto& config = services::ConfigService::getInstance();
     auto& orchestrator = services::OrchestratorService::getInstance();
 
@@ -567,17 +618,13 @@ inline void Application::processRFIDScan() {
     // will never trigger playback later (decision A4).
     bool videoUnavailable = false;
 
-    if (orchestrator.getState() == models::ORCH_CONNECTED) {
-        LOG_INFO("[SCAN] Attempting to send to orchestrator (single attempt)...\n");
-        services::ScanOutcome outcome = orchestrator.sendScan(scan, config.getConfig());
-        LOG_INFO("[SCAN] Outcome: %d\n", static_cast<int>(outcome));
-        // applyScanOutcome() owns queueing and the REJECTED_NO_SESSION UI
-        // transition — single definition shared with SIMULATE_SCAN.
-        if (!applyScanOutcome(outcome, scan, orchestrator, videoUnavailable)) {
-            return;  // REJECTED_NO_SESSION: scan not recorded, stop processing
-        }
+    if (orchestrator.getState() == models::ORCH_CONNECTED &&
+        orchestrator.submitScan(scan)) {
+        // Optimistic: displayed as accepted, processScanResults() corrects it
+        LOG_INFO("[SCAN] Submitted to orchestrator (%u in flight)\n",
+                 (unsigned)orchestrator.scansInFlight());
     } else {
-        LOG_INFO("[SCAN] Offline, queueing immediately\n");
+        LOG_INFO("[SCAN] Offline or submit queue full, queueing immediately\n");
         orchestrator.queueScan(scan);
         videoUnavailable = true;  // queued scans never trigger video (A4)
     }
@@ -597,6 +644,84 @@ inline void Application::processRFIDScan() {
     }
 }
 
+/**
+ * processScanResults() - Late outcomes of submitted scans
+ *
+ * applyScanOutcome() still owns queueing (RETRY_QUEUE) and the NO SESSION
+ * failure screen; this adds the one correction only an async outcome
+ * needs: a processing modal drawn as "Sending..." becomes "VIDEO
+ * UNAVAILABLE" when the video will not play. A regular token's display is
+ * left alone, and nothing is redrawn once the player has moved on.
+ */
+inline void Application::processScanResults() {
+    auto& orchestrator = services::OrchestratorService::getInstance();
+
+    services::ScanResult result;
+    while (orchestrator.pollScanResult(result)) {
+        const String& tokenId = result.scan.tokenId;
+        LOG_INFO("[SCAN] Outcome %d for %s after %lu ms\n",
+                 static_cast<int>(result.outcome), tokenId.c_str(),
+                 (unsigned long)(result.completedAtMs - result.submittedAtMs));
+
+        services::LateOutcomeAction action = services::lateOutcomeAction(
+            result.outcome, _ui && _ui->isShowingToken(tokenId), _ui && _ui->isIdle());
+
+        bool videoUnavailable = false;
+        if (!applyScanOutcome(result.outcome, result.scan, orchestrator, videoUnavailable)) {
+            continue;  // REJECTED_NO_SESSION: not recorded, failure shown if appropriate
+        }
+        if (action == services::LateOutcomeAction::VideoUnavailable) {
+            _ui->relabelProcessing(tokenId, "VIDEO UNAVAILABLE", "Rescan later");
+        }
+    }
+}
+
+/**
+ * processRemoteRefresh() - Load the token database a pushed re-sync saved
+ *
+ * The download itself ran on Core 0 (syncRemoteChanges()); only the parse
+ * into the main task's token list happens here, and only on an idle
+ * screen so a player never has a token display stall under it. Scans
+ * tapped meanwhile wait in the RFID event queue.
+ */
+inline void Application::processRemoteRefresh() {
+    if (!_ui || !_ui->isIdle()) return;
+
+    auto& tokens = services::TokenService::getInstance();
+    if (tokens.reloadIfNewer()) {
+        LOG_INFO("[REFRESH] ✓ %d tokens\n", tokens.getCount());
+    }
+}
+
+/**
+ * syncRemoteChanges() - Re-sync what the orchestrator says changed
+ *
+ * Runs on the OrchestratorSync task, which has already closed the push
+ * channel and idle keep-alive connection for an asset sync. Both syncs
+ * are incremental (the asset sync only fetches files whose SHA-1
+ * changed) and lock the SD card per chunk, so the UI keeps drawing.
+ */
+inline void Application::syncRemoteChanges(uint8_t what, const models::DeviceConfig& config) {
+    auto& orchestrator = services::OrchestratorService::getInstance();
+
+    if ((what & services::OrchestratorService::REFRESH_TOKENS) && config.syncTokens) {
+        LOG_INFO("[REFRESH] Re-syncing tokens\n");
+        if (!services::TokenService::getInstance().syncFromOrchestrator(
+                config.orchestratorURL, orchestrator)) {
+            LOG_ERROR("REFRESH", "Token sync failed - keeping loaded database");
+        }
+    }
+
+    if ((what & services::OrchestratorService::REFRESH_ASSETS) && config.syncAssets) {
+        auto& assets = services::AssetService::getInstance();
+        LOG_INFO("[REFRESH] Re-syncing assets\n");
+        assets.setUsePack(config.assetPack);
+        assets.setFetchMode(config.assetFetch);
+        bool ok = assets.syncFromOrchestrator(config.orchestratorURL, orchestrator);
+        LOG_INFO("[REFRESH] Asset sync %s\n", ok ? "complete" : "partial/failed");
+    }
+}
+
 // ═══════════════════════════════════════════════════════════════════════
 // TIMESTAMP GENERATION - ISO 8601 Format
 // ═══════════════════════════════════════════════════════════════════════
@@ -679,7 +804,7 @@ inline String Application::generateTimestamp() {
  * applyScanOutcome() - Shared outcome handler for scan response classification.
  *
  * Owns the queueing decision and the REJECTED_NO_SESSION UI transition so
- * that processRFIDScan() and the SIMULATE_SCAN serial command cannot drift.
+ * that processScanResults() and the SIMULATE_SCAN serial command cannot drift.
  * The caller is responsible for its own logging and for the final token
  * display step.
  *
@@ -699,9 +824,13 @@ inline bool Application::applyScanOutcome(services::ScanOutcome outcome,
         case services::ScanOutcome::REJECTED_NO_SESSION:
             // 409 SESSION_NOT_FOUND: scan was NOT persisted. Final per A5 —
             // do NOT queue (retrying without a session would hit the same 409).
-            // Show the failure screen so the player knows to wait for a session.
+            // Show the failure screen so the player knows to wait for a session
+            // — replacing the optimistic token display, but never a token
+            // scanned since (async outcomes can arrive late).
             LOG_INFO("[SCAN-OUTCOME] REJECTED_NO_SESSION — scan not recorded, not queued\n");
-            if (_ui) {
+            if (_ui && services::lateOutcomeAction(outcome, _ui->isShowingToken(scan.tokenId),
+                                                   _ui->isIdle()) ==
+                           services::LateOutcomeAction::RevertNoSession) {
                 _ui->showScanFailed("NO SESSION");
             }
             return false;  // Tell the caller to stop processing
@@ -1017,6 +1146,8 @@ inline bool Application::initializeServices() {
         int lastFileIdx = -1;
         int lastPct = -1;
         auto& assets = services::AssetService::getInstance();
+        assets.setUsePack(config.getConfig().assetPack);
+        assets.setFetchMode(config.getConfig().assetFetch);
         assets.setProgressCallback(
             [&tft, progressRow, &lastFileIdx, &lastPct](const services::AssetService::ProgressInfo& p) {
                 int pct = p.bytesTotal > 0
@@ -1090,9 +1221,16 @@ inline void Application::registerSerialCommands() {
                 break;
         }
 
+        Serial.printf("Push channel: %s, session %s\n",
+                      orch.getPushStats().up ? "UP" : "DOWN",
+                      services::sessionStateName(orch.getSessionState()));
         Serial.printf("Queue size: %d entries\n", orch.getQueueSize());
         Serial.printf("Token database: %d tokens loaded\n", tokens.getCount());
         Serial.printf("Free heap: %d bytes\n", ESP.getFreeHeap());
+        hal::SDProbeResult sdClock = hal::SDCard::getInstance().getProbeResult();
+        Serial.printf("SD clock: %lu kHz (write %lu KB/s, read %lu KB/s)\n",
+                      (unsigned long)hal::SDCard::getInstance().getClockKHz(),
+                      (unsigned long)sdClock.writeKBps, (unsigned long)sdClock.readKBps);
         Serial.println("===========================\n");
     }, "Show orchestrator connection and queue status");
 
@@ -1182,15 +1320,74 @@ inline void Application::registerSerialCommands() {
         Serial.flush();
         delay(100);
 
-        if (rfid.begin()) {  // RFIDReader uses begin() not initialize()
-            _rfidInitialized = true;
-            Serial.println("✓ RFID initialized successfully");
-            Serial.println("⚡ Serial RX now disabled (GPIO 3 conflict)");
-        } else {
+        if (!rfid.begin()) {  // RFIDReader uses begin() not initialize()
             Serial.println("✗ RFID initialization failed");
+            return;
         }
+        // Same check as the boot path: without the task nothing scans
+        if (!hal::RFIDScanTask::getInstance().start()) {
+            Serial.println("✗ RFID scan task failed to start");
+            return;
+        }
+        _rfidInitialized = true;
+        Serial.println("✓ RFID initialized successfully");
+        Serial.println("⚡ Serial RX now disabled (GPIO 3 conflict)");
     }, "Initialize RFID (DEBUG_MODE only, kills serial RX)");
 
+    // RFID_STATS - Scan counters, attempt histograms, per-phase latency
+    serial.registerCommand("RFID_STATS", [&rfid](const String& args) {
+        if (args == "RESET") {
+            rfid.resetStats();
+            Serial.println("✓ RFID statistics reset\n");
+            return;
+        }
+        rfid.getStats().print();
+    }, "Show RFID phase latency histograms (RFID_STATS:RESET to clear)");
+
+    // SD_STATS - SD mutex contention by caller (who holds the bus, how long)
+    serial.registerCommand("SD_STATS", [](const String& args) {
+        auto& sd = hal::SDCard::getInstance();
+        if (args == "RESET") {
+            sd.resetLockStats();
+            Serial.println("✓ SD lock statistics reset\n");
+            return;
+        }
+        hal::SDLockStats stats = sd.getLockStats();
+        stats.print();
+        stats.printCallers();
+        Serial.println();
+    }, "Show SD mutex wait/hold per caller (SD_STATS:RESET to clear)");
+
+    // HTTP_STATS - Keep-alive reuse vs handshakes, cold/warm request latency
+    serial.registerCommand("HTTP_STATS", [&orch](const String& args) {
+        if (args == "RESET") {
+            orch.resetHttpStats();
+            Serial.println("✓ HTTP statistics reset\n");
+            return;
+        }
+        orch.getHttpStats().print();
+        Serial.println();
+    }, "Show HTTP handshakes, reuse and latency (HTTP_STATS:RESET to clear)");
+
+    // PUSH_STATS - Event stream link state, reconnects and polls while down
+    serial.registerCommand("PUSH_STATS", [&orch](const String& args) {
+        (void)args;
+        orch.getPushStats().print();
+        Serial.printf("Session: %s\n\n", services::sessionStateName(orch.getSessionState()));
+    }, "Show push channel state, drops and /health polls while down");
+
+    // ASSET_STATS - Totals of the last asset sync (size the boot sync window)
+    serial.registerCommand("ASSET_STATS", [](const String& args) {
+        (void)args;
+        const services::AssetSyncStats& stats = services::AssetService::getInstance().lastStats();
+        if (stats.mode[0] == '\0') {
+            Serial.println("No asset sync since boot\n");
+            return;
+        }
+        stats.print();
+        Serial.println();
+    }, "Show files/s, MB/s and handshakes of the last asset sync");
+
     // SIMULATE_SCAN - Simulate token processing without hardware
     serial.registerCommand("SIMULATE_SCAN", [this, &tokens, &orch, &config](const String& args) {
         if (args.length() == 0) {
@@ -1370,85 +1567,9 @@ inline void Application::registerSerialCommands() {
     serial.registerCommand("QUEUE_STATUS", [&orch](const String& args) {
         Serial.println("\n=== Queue Status (Detailed) ===");
 
-        // Cached size (from RAM)
-        int cachedSize = orch.getQueueSize();
-        Serial.printf("Cached size: %d entries (from RAM)\n", cachedSize);
-
-        // File-based information (requires SD access)
-        hal::SDCard::Lock lock("queueStatus", freertos_config::SD_MUTEX_TIMEOUT_MS);
-        if (!lock.acquired()) {
-            Serial.println("✗ Could not acquire SD mutex");
-            Serial.println("=================================\n");
-            return;
-        }
-
-        if (!SD.exists(queue_config::QUEUE_FILE)) {
-            Serial.println("File status: NOT FOUND (empty queue)");
-            Serial.println("=================================\n");
-            return;
-        }
-
-        File file = SD.open(queue_config::QUEUE_FILE, FILE_READ);
-        if (!file) {
-            Serial.println("✗ Could not open queue file");
-            Serial.println("=================================\n");
-            return;
-        }
-
-        // File size
-        unsigned long fileSize = file.size();
-        Serial.printf("File size: %lu bytes", fileSize);
-        if (fileSize > queue_config::MAX_QUEUE_FILE_SIZE) {
-            Serial.print(" ⚠️  CORRUPT (exceeds threshold)");
-        }
-        Serial.println();
-
-        // Count actual lines
-        int actualLines = 0;
-        while (file.available()) {
-            file.readStringUntil('\n');
-            actualLines++;
-        }
-
-        Serial.printf("Actual lines: %d entries (from file)\n", actualLines);
-
-        // Cache vs file divergence check
-        if (cachedSize != actualLines) {
-            Serial.printf("⚠️  WARNING: Cache divergence detected!\n");
-            Serial.printf("   Cached: %d, Actual: %d (difference: %d)\n",
-                         cachedSize, actualLines, actualLines - cachedSize);
-        } else {
-            Serial.println("✓ Cache matches file");
-        }
-
-        // Reopen to show first/last entries
-        file.close();
-        file = SD.open(queue_config::QUEUE_FILE, FILE_READ);
-
-        if (file.available()) {
-            String firstLine = file.readStringUntil('\n');
-            firstLine.trim();
-            Serial.printf("\nFirst entry: %s\n",
-                         firstLine.length() > 80 ? (firstLine.substring(0, 77) + "...").c_str() : firstLine.c_str());
-
-            // Find last line (simple approach - read all)
-            String lastLine = "";
-            while (file.available()) {
-                String line = file.readStringUntil('\n');
-                line.trim();
-                if (line.length() > 0) {
-                    lastLine = line;
-                }
-            }
-            if (lastLine.length() > 0) {
-                Serial.printf("Last entry: %s\n",
-                             lastLine.length() > 80 ? (lastLine.substring(0, 77) + "...").c_str() : lastLine.c_str());
-            }
-        }
-
-        file.close();
+        orch.printQueueStatus();
         Serial.println("=================================\n");
-    }, "Show detailed queue diagnostics (file size, line count, cache status)");
+    }, "Show detailed queue diagnostics (ring usage, header, cache status)");
 
     // FORCE_OVERFLOW - Test FIFO overflow protection
     serial.registerCommand("FORCE_OVERFLOW", [&orch, &config](const String& args) {
@@ -1495,6 +1616,8 @@ inline void Application::registerSerialCommands() {
         }
 
         auto& assets = services::AssetService::getInstance();
+        assets.setUsePack(config.getConfig().assetPack);
+        assets.setFetchMode(config.getConfig().assetFetch);
         bool ok = assets.syncFromOrchestrator(config.getConfig().orchestratorURL, orch);
         Serial.printf("[CMD] SYNC_ASSETS_NOW: %s\n", ok ? "ok" : "partial/failed");
         Serial.println("====================\n");
@@ -1509,10 +1632,23 @@ inline void Application::startBackgroundTasks() {
     auto& config = services::ConfigService::getInstance();
 
     // Start FreeRTOS background sync task on Core 0
-    // (main loop runs on Core 1)
+    // (main loop runs on Core 1); pushed re-syncs run there too
+    orch.setRemoteRefreshJob(syncRemoteChanges);
     orch.startBackgroundTask(config.getConfig());
 
     LOG_INFO("[INIT] ✓ Background queue sync task started on Core 0\n");
+
+    // RFID scan task (detect + NDEF read off the UI core). In DEBUG_MODE
+    // the reader isn't up yet — START_SCANNER starts the task instead.
+    if (_rfidInitialized) {
+        if (hal::RFIDScanTask::getInstance().start()) {
+            LOG_INFO("[INIT] ✓ RFID scan task started on Core %d\n",
+                     freertos_config::RFID_TASK_CORE);
+        } else {
+            LOG_ERROR("INIT", "RFID scan task failed to start");
+            _rfidInitialized = false;
+        }
+    }
 }
 
 // NOTE: processRFIDScan(), processTouch(), and loop() are already implemented above
@@ -1592,6 +1728,16 @@ inline void Application::setup() {
         _debugMode = config.getConfig().debugMode;
     }
 
+    // 3b. Raise the SD clock now that SD_CLOCK_KHZ is known (probe if unset)
+    hal::SDCard::getInstance().tuneClock(config.getConfig().sdClockKHz);
+
+    // 3c. Load the asset pack index if the card has one (drivers read packed
+    // assets whether or not ASSET_PACK is still enabled for new downloads)
+    {
+        hal::SDCard::Lock lock("AssetPack::load");
+        if (lock.acquired()) hal::AssetPack::getInstance().load();
+    }
+
     // 4. Boot override handling (30-second window, can force DEBUG_MODE=true)
     handleBootOverride();
 
@@ -1634,6 +1780,20 @@ inline void Application::setup() {
         status.maxQueueSize = queue_config::MAX_QUEUE_SIZE;
         status.teamID = config.getConfig().teamID;
         status.deviceID = config.getConfig().deviceID;
+
+        // Copy taken under the stats spinlock; the scan task keeps writing
+        const hal::RFIDStats rfidStats = hal::RFIDReader::getInstance().getStats();
+        status.rfidCardsSeen = rfidStats.cardsSeen();
+        status.rfidTokensRead = rfidStats.tokensRead();
+        status.rfidRetries = rfidStats.retryCount;
+        status.rfidScanP90Ms = rfidStats.phase(hal::RFIDPhase::Scan).percentileUs(90) / 1000;
+
+        // Serial RX is gone once START_SCANNER hands GPIO 3 to RFID, so
+        // RFID_STATS can't be typed any more; TX still works. Debug builds
+        // only: the ~30-line dump blocks every status render.
+        if (_debugMode && _rfidInitialized) {
+            rfidStats.print();
+        }
         return status;
     });
 
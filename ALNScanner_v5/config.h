@@ -52,6 +52,14 @@ namespace rfid_config {
     constexpr uint8_t RETRY_DELAY_MS = 100;      // Community-standard for NTAG state recovery
     constexpr uint8_t ANTENNA_SETTLE_MS = 5;     // Settling time after RF field enable
 
+    // Incremental NDEF read (see RFIDReader::readNDEFPages()). The first
+    // FAST_READ covers the CC, TLV header and a typical short Text record
+    // (e.g. "kaa001" + "en" ends at byte 19); longer layouts trigger
+    // follow-up reads for exactly the missing pages.
+    constexpr uint8_t NDEF_FIRST_READ_PAGES = 5;   // pages 3..7
+    constexpr uint8_t FAST_READ_MAX_PAGES = 15;    // 60 data + 2 CRC <= 64-byte FIFO
+    constexpr uint16_t NDEF_MAX_READ_BYTES = 256;  // cap on bytes buffered from page 3
+
     // Low-level SPI/operation timing (unchanged)
     constexpr uint8_t OPERATION_DELAY_US = 10;
     constexpr uint8_t TIMEOUT_MS = 100;
@@ -62,10 +70,47 @@ namespace rfid_config {
 
 namespace queue_config {
     constexpr int MAX_QUEUE_SIZE = 100;
-    constexpr int BATCH_UPLOAD_SIZE = 10;
-    constexpr unsigned long MAX_QUEUE_FILE_SIZE = 102400;  // 100KB - corruption detection threshold
-    constexpr const char* QUEUE_FILE = "/queue.jsonl";
-    constexpr const char* QUEUE_TEMP_FILE = "/queue.tmp";
+    // Offline queue drain (services/BatchDrain.h): batches follow the
+    // measured round trip; the body streams from the ring, so its size
+    // does not depend on free heap
+    constexpr uint16_t BATCH_START_SIZE = 10;
+    constexpr uint16_t BATCH_MIN_SIZE = 1;
+    constexpr uint16_t BATCH_MAX_SIZE = MAX_QUEUE_SIZE;  // Whole queue: the body is streamed
+    constexpr uint32_t BATCH_TARGET_RTT_MS = 2000;   // Grow below half, shrink above
+    constexpr uint16_t BATCH_SCAN_BYTES_GUESS = 160; // JSON per scan until measured
+    constexpr uint32_t BATCH_HEAP_RESERVE = 32768;   // 32KB kept for TLS and the rest
+    constexpr uint8_t BATCH_SLICE_RECORDS = 8;       // Ring records per SD read while streaming
+    constexpr unsigned long MAX_QUEUE_FILE_SIZE = 102400;  // 100KB - legacy JSONL corruption threshold
+    constexpr const char* QUEUE_FILE = "/queue.ring";           // O(1) ring log (services/QueueRing.h)
+    constexpr uint32_t QUEUE_RING_CAPACITY = 32768;             // Data bytes (~900 binary records)
+    constexpr const char* QUEUE_UPGRADE_FILE = "/queue.ring.new";  // v1->v2 ring rebuild, renamed into place
+    constexpr const char* QUEUE_DICT_FILE = "/queue.dict";      // Interned deviceIds (services/ScanRecord.h)
+    constexpr const char* QUEUE_DICT_TEMP_FILE = "/queue.dict.new";
+    constexpr const char* LEGACY_QUEUE_FILE = "/queue.jsonl";   // Pre-ring format, imported at boot
+    constexpr const char* QUEUE_TEMP_FILE = "/queue.tmp";       // Legacy rebuild leftover, removed at boot
+    // RAM write-behind in front of the ring (services/ScanJournal.h)
+    constexpr size_t SCAN_JOURNAL_DEPTH = 16;                   // power of two
+    constexpr uint32_t SCAN_JOURNAL_FLUSH_MS = 250;             // Max time a scan sits in RAM only
+    constexpr size_t SCAN_JOURNAL_BATCH = 8;                    // Flush early at this many pending
+    constexpr uint32_t SCAN_JOURNAL_LOW_HEAP_BYTES = 32768;     // Flush at once below this free heap
+    // Online scans awaiting their POST /api/scan outcome (services/ScanSubmitQueue.h);
+    // a tap beyond this many in flight is queued offline instead
+    constexpr size_t SCAN_SUBMIT_DEPTH = 4;                     // power of two
+}
+
+// PPP SD CARD CONFIGURATION PPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPP
+
+// SPI clock (hal/SDCard.h tuneClock(), hal/SDClockProbe.h)
+namespace sd_config {
+    // Mount clock before tuning; also the fallback if every probe fails
+    constexpr uint32_t DEFAULT_CLOCK_KHZ = 4000;
+    // Probed in ascending order, stopping at the first failure. ESP32 SPI
+    // clocks divide the 80 MHz APB clock, so these are exact dividers.
+    constexpr uint32_t PROBE_CLOCKS_KHZ[] = { 8000, 10000, 16000, 20000, 26667, 40000 };
+    constexpr uint32_t MIN_CLOCK_KHZ = 400;     // SD_CLOCK_KHZ override range
+    constexpr uint32_t MAX_CLOCK_KHZ = 40000;
+    constexpr const char* PROBE_FILE = "/.sdprobe";
+    constexpr size_t PROBE_BYTES = 16384;       // Written, read back and CRC-checked per clock
 }
 
 // PPP FILE PATHS PPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPP
@@ -73,6 +118,9 @@ namespace queue_config {
 namespace paths {
     constexpr const char* CONFIG_FILE = "/config.txt";
     constexpr const char* TOKEN_DB_FILE = "/tokens.json";
+    // ETag/Last-Modified of the response each file was built from; sent as
+    // If-None-Match/If-Modified-Since by the next sync (services/SyncValidators.h)
+    constexpr const char* TOKEN_DB_VALIDATOR_FILE = "/tokens.etag";
     constexpr const char* DEVICE_ID_FILE = "/device_id.txt";
     constexpr const char* IMAGES_DIR = "/assets/images/";
     constexpr const char* AUDIO_DIR = "/assets/audio/";
@@ -80,43 +128,98 @@ namespace paths {
     // after each successful download (stream to .part, rename on success).
     constexpr const char* MANIFEST_FILE = "/assets/manifest.json";
     constexpr const char* MANIFEST_TEMP_FILE = "/assets/manifest.tmp";
+    constexpr const char* MANIFEST_VALIDATOR_FILE = "/assets/manifest.etag";
     constexpr const char* PART_SUFFIX = ".part";
+    // Optional packed container (ASSET_PACK=true, hal/AssetPack.h). Root
+    // level so opening it never walks the /assets/ directories.
+    constexpr const char* ASSET_PACK_FILE = "/assets.pack";
 }
 
 // PPP SIZE LIMITS PPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPP
 
 namespace limits {
     constexpr int MAX_TOKENS = 50;
-    constexpr int MAX_TOKEN_DB_SIZE = 50000; // 50KB
-    // Wire-format ceiling for the manifest payload. Device refuses anything
-    // larger to avoid pathological-input OOM. Tied to the parent CLAUDE.md
-    // "ESP32 Asset Sync Issues" debug step #5.
-    constexpr int MAX_MANIFEST_SIZE = 131072; // 128KB
-
-    // Nominal manifest doc capacity passed to DynamicJsonDocument. NOTE:
-    // ArduinoJson 7 is elastic — this capacity arg is IGNORED and heap tracks
-    // the actual parsed size — so it no longer bounds live heap. The
-    // AssetService pre-flight heap check is therefore sized to the actual
-    // manifest body length, not to "2 * MANIFEST_DOC_SIZE".
-    constexpr int MANIFEST_DOC_SIZE = 65536; // 64KB (nominal; v7 ignores it)
+    // Free heap needed before a streamed download offers Accept-Encoding:
+    // gzip - the inflater's tables and 32 KB window (~43 KB) on top of the
+    // ASSET_MIN_FREE_HEAP streaming floor. The token database streams to SD
+    // either way, so it has no size cap.
+    constexpr int GZIP_MIN_FREE_HEAP = 86016; // 84KB
+    // Entry ceiling for a parsed asset manifest (remote and local alike).
+    // The manifest is stream-parsed into ~40 bytes an entry, so this bounds
+    // each table at ~80 KB rather than the JSON text. Device refuses a
+    // larger manifest to avoid pathological-input OOM.
+    constexpr int MANIFEST_MAX_ENTRIES = 2048;
     // Streaming download buffer sized to balance TCP window utilization
     // against heap pressure (TLS session ~22 KB, file I/O overhead, SHA
     // context). 4 KB chunks are the standard Espressif streaming example.
     constexpr int ASSET_DOWNLOAD_CHUNK_SIZE = 4096;
-    // Per-file asset download timeout passed to httpGETStreamToSD. The
-    // SD_MUTEX_LONG_TIMEOUT_MS static_assert below ensures the mutex wait
-    // timeout outlasts this so mid-session re-sync (Task 14) doesn't
-    // spuriously fail on lock acquisition.
+    // Per-file asset download timeout passed to httpGETStreamToSD. The SD
+    // mutex is only held per chunk write, so this no longer bounds how long
+    // other SD users can be blocked.
     constexpr int ASSET_DOWNLOAD_TIMEOUT_MS = 60000;
     // Per-file streaming abort threshold used by httpGETStreamToSD;
     // separate from the manifest-parse pre-flight in AssetService.
     constexpr int ASSET_MIN_FREE_HEAP = 40960; // 40KB
+    // Pipelined asset sync (ASSET_FETCH=pipeline|bundle): GETs in flight on
+    // the sync connection, so the next response is already on its way while
+    // the current body is written and verified
+    constexpr int ASSET_PIPELINE_DEPTH = 2;
+    // Socket read slice for the bundle stream (tar parsing copies out of it)
+    constexpr int ASSET_READ_SLICE = 1024;
+    // Longest response head accepted on the sync connection
+    constexpr int ASSET_MAX_HEAD_BYTES = 4096;
+    // Asset pack index slots (56 B each on SD; RAM holds only used ones).
+    // Changing it makes an existing pack unreadable -> rebuilt on next sync.
+    constexpr uint16_t ASSET_PACK_MAX_ENTRIES = 256;
+    // Data region = remote manifest total + headroom, so a re-sync can
+    // write new versions beside the old ones before freeing them
+    constexpr uint32_t ASSET_PACK_HEADROOM_PCT = 50;
+    constexpr uint32_t ASSET_PACK_MIN_BYTES = 4UL * 1024 * 1024;
     constexpr int MAX_DEVICE_ID_LENGTH = 100;
     constexpr int TEAM_ID_LENGTH = 3;
     constexpr int MAX_SSID_LENGTH = 32;
     constexpr int MAX_PASSWORD_LENGTH = 63;
 }
 
+// PPP HTTP CONFIGURATION PPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPP
+
+namespace http_config {
+    // Keep-alive connection to the orchestrator (OrchestratorService::HTTPHelper).
+    // Idle limit stays under Node's default 5 s server keepAliveTimeout so a
+    // reused socket is never one the server is about to close.
+    constexpr uint32_t KEEPALIVE_IDLE_MS = 4000;
+    // How long a request waits for the shared connection before falling back
+    // to a one-shot connection of its own
+    constexpr uint32_t SHARED_WAIT_MS = 50;
+    // Leak guard: free heap sampled with the connection idle may sit this far
+    // below its post-handshake baseline; LEAK_STRIKES samples in a row past
+    // it disable keep-alive until reboot
+    constexpr uint32_t LEAK_TOLERANCE_BYTES = 2048;
+    constexpr uint8_t LEAK_STRIKES = 3;
+
+    // Push channel (server-sent events, services/PushChannel.h). While it is
+    // up the orchestrator tells the scanner about health, timezone, session
+    // and token/asset changes, and /health polling stops.
+    constexpr const char* PUSH_EVENTS_PATH = "/api/scanner/events";
+    // The server comments at least every 5 s; silence past this is a dead
+    // link (an orchestrator that vanished without closing the socket)
+    constexpr uint32_t PUSH_STALL_TIMEOUT_MS = 12000;
+    constexpr uint32_t PUSH_CONNECT_TIMEOUT_MS = 3000;
+    // Reconnect backoff; a 404 (orchestrator without the route) waits longest
+    constexpr uint32_t PUSH_RETRY_MIN_MS = 2000;
+    constexpr uint32_t PUSH_RETRY_MAX_MS = 60000;
+    constexpr uint32_t PUSH_UNSUPPORTED_RETRY_MS = 300000;
+    // A link must stay up this long before the backoff starts over
+    constexpr uint32_t PUSH_STABLE_MS = 30000;
+    // Longest event (name + data) kept; larger ones are dropped whole
+    constexpr size_t PUSH_MAX_EVENT_BYTES = 512;
+    // Second TLS session held open for the life of the channel
+    constexpr uint32_t PUSH_MIN_FREE_HEAP = 61440; // 60KB
+    // Token/asset change events are synced once they have been quiet this
+    // long, so a burst of edits on the orchestrator costs one re-sync
+    constexpr uint32_t PUSH_REFRESH_SETTLE_MS = 3000;
+}
+
 // PPP FREERTOS CONFIGURATION PPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPP
 
 namespace freertos_config {
@@ -124,22 +227,29 @@ namespace freertos_config {
     constexpr uint8_t BACKGROUND_TASK_PRIORITY = 1;
     constexpr uint8_t BACKGROUND_TASK_CORE = 0;
     constexpr uint32_t BACKGROUND_TASK_DELAY_MS = 100;
+    // RFID scan task (detect + NDEF read, see hal/RFIDScanTask.h). Runs off
+    // the UI core; priority above OrchestratorSync so scans aren't starved
+    // by a long batch upload sharing Core 0.
+    constexpr uint32_t RFID_TASK_STACK_SIZE = 4096;
+    constexpr uint8_t RFID_TASK_PRIORITY = 2;
+    constexpr uint8_t RFID_TASK_CORE = 0;
+    constexpr size_t RFID_EVENT_QUEUE_DEPTH = 4;   // power of two
+    // Scan submit task (POST /api/scan off the UI core). 8 KB is what the
+    // Core-1 loopTask had when it ran sendScan() inline, TLS handshake included.
+    constexpr uint32_t SCAN_SUBMIT_TASK_STACK_SIZE = 8192;
+    constexpr uint8_t SCAN_SUBMIT_TASK_PRIORITY = 1;
+    constexpr uint8_t SCAN_SUBMIT_TASK_CORE = 0;
     constexpr uint32_t SD_MUTEX_TIMEOUT_MS = 500;
-    // Long-form mutex acquire used by operations that hold the SD card for
-    // extended periods (asset streaming downloads up to 60 s per file).
-    // Must outlast the longest holder — see static_assert below.
+    // Long-form mutex acquire used by callers that must not give up while
+    // another task does a large SD operation (full-screen BMP draw, config
+    // save). Asset downloads no longer count: they lock per chunk.
     constexpr uint32_t SD_MUTEX_LONG_TIMEOUT_MS = 60000;
+    // Holds longer than this are logged and counted (hal/SDLockStats.h)
+    constexpr uint32_t SD_LOCK_HOLD_WARN_MS = 40;
+    // Rows in the per-caller SD lock table (SD_STATS); last row is overflow
+    constexpr uint8_t SD_LOCK_STATS_CALLERS = 24;
 }
 
-// AssetService::httpGETStreamToSD holds the SD mutex for an entire
-// download (up to 60s per file in the default config). The long-timeout
-// mutex must outlast that, otherwise every download aborts on lock
-// acquisition. Encoded as a compile-time constraint so a future tweak
-// to either constant can't silently break asset sync.
-static_assert(freertos_config::SD_MUTEX_LONG_TIMEOUT_MS >= limits::ASSET_DOWNLOAD_TIMEOUT_MS,
-              "SD_MUTEX_LONG_TIMEOUT_MS must outlast ASSET_DOWNLOAD_TIMEOUT_MS "
-              "so mid-session asset sync doesn't fail on mutex acquisition");
-
 // PPP DEBUG CONFIGURATION PPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPPP
 
 // Compile-time debug flags (reduces flash in production)
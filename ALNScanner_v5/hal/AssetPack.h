@@ -0,0 +1,485 @@
+#pragma once
+
+/**
+ * @file AssetPack.h
+ * @brief Optional single-file container for token images and audio.
+ *
+ * Loose assets cost a FAT directory walk on every SD.open() (linear in the
+ * number of files under /assets/images/), and each re-sync churns .part
+ * create/rename/remove through the FAT, fragmenting it further. The pack is
+ * one preallocated file with a sorted index loaded into RAM at boot, so
+ * opening an asset is a binary search plus one open of a root-level file,
+ * whatever the asset count, and re-syncs only ever rewrite bytes inside
+ * clusters the pack already owns.
+ *
+ * File layout (preallocated once by create()):
+ *
+ *   [0 .. slot)        index slot A - commits alternate between the slots;
+ *   [slot .. 2*slot)   index slot B   the valid one with the higher seq wins
+ *   [dataStart ..]     data region, extents aligned to SECTOR bytes
+ *
+ *   slot   = 32-byte header + capacity * ENTRY_BYTES
+ *   header = u32 magic | u16 version | u16 capacity | u32 count | u32 seq |
+ *            u32 dataSize | u32 reserved | u32 CRC32(entries) |
+ *            u32 CRC32(header[0..28))
+ *   entry  = char tokenId[24] | u8 type | char ext[3] | u32 offset |
+ *            u32 length | u8 sha1[20]          (all integers LE)
+ *
+ * Entries are kept sorted by (type, tokenId). An update writes the new
+ * bytes into a free extent first and only then commits an index that
+ * points at them, so power loss at any point leaves the previous index and
+ * the data it references intact. Freed extents are reused first-fit.
+ *
+ * Not thread-safe: callers hold hal::SDCard::Lock around every call that
+ * touches the file or the index (find()/resolve() included, since a sync
+ * may commit concurrently).
+ */
+
+#include <Arduino.h>
+#include <SD.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+#include "../config.h"
+#include "../services/Crc32.h"
+
+namespace hal {
+
+class AssetPack {
+public:
+    static constexpr uint32_t MAGIC = 0x504E4C41;  // "ALNP"
+    static constexpr uint16_t VERSION = 1;
+    static constexpr uint32_t HEADER_BYTES = 32;
+    static constexpr uint32_t ENTRY_BYTES = 56;
+    static constexpr uint32_t SECTOR = 512;
+    static constexpr size_t TOKEN_ID_MAX = 24;     // incl. padding, no NUL needed
+
+    enum Type : uint8_t { IMAGE = 0, AUDIO = 1 };
+
+    struct Entry {
+        char tokenId[TOKEN_ID_MAX + 1] = {};
+        uint8_t type = IMAGE;
+        char ext[4] = {};
+        uint32_t offset = 0;
+        uint32_t length = 0;
+        uint8_t sha1[20] = {};
+    };
+
+    struct Extent {
+        uint32_t offset = 0;
+        uint32_t length = 0;
+    };
+
+    /**
+     * @brief Shared pack at paths::ASSET_PACK_FILE (drivers + AssetService)
+     */
+    static AssetPack& getInstance() {
+        static AssetPack instance(paths::ASSET_PACK_FILE, limits::ASSET_PACK_MAX_ENTRIES);
+        return instance;
+    }
+
+    AssetPack(const char* path, uint16_t capacity) : _path(path), _capacity(capacity) {}
+
+    AssetPack(const AssetPack&) = delete;
+    AssetPack& operator=(const AssetPack&) = delete;
+
+    const char* path() const { return _path; }
+    bool isLoaded() const { return _loaded; }
+    size_t size() const { return _index.size(); }
+    uint16_t capacity() const { return _capacity; }
+    uint32_t dataSize() const { return _dataSize; }
+    const std::vector<Entry>& entries() const { return _index; }
+
+    /**
+     * @brief Read the newest valid index slot into RAM
+     * @return false if there is no pack or neither slot is valid
+     */
+    bool load() {
+        _loaded = false;
+        _index.clear();
+        File f = SD.open(_path, FILE_READ);
+        if (!f) return false;
+
+        // Capacity is fixed by config; a pack built for another capacity
+        // reads as absent and is recreated by the next sync
+        uint8_t a[HEADER_BYTES], b[HEADER_BYTES];
+        bool okA = readHeader(f, 0, a);
+        bool okB = readHeader(f, slotBytes(_capacity), b);
+
+        // Prefer the newer slot whose entries also check out
+        const uint8_t* order[2] = { nullptr, nullptr };
+        if (okA && okB) {
+            bool aNewer = static_cast<int32_t>(get32(a + 12) - get32(b + 12)) > 0;
+            order[0] = aNewer ? a : b;
+            order[1] = aNewer ? b : a;
+        } else {
+            order[0] = okA ? a : (okB ? b : nullptr);
+        }
+
+        for (const uint8_t* h : order) {
+            if (!h) continue;
+            uint32_t slotOffset = (h == a) ? 0 : slotBytes(_capacity);
+            if (readEntries(f, h, slotOffset) &&
+                f.size() >= dataStart(_capacity) + get32(h + 16)) {
+                _seq = get32(h + 12);
+                _dataSize = get32(h + 16);
+                _activeSlot = (h == a) ? 0 : 1;
+                _loaded = true;
+                break;
+            }
+            _index.clear();
+        }
+        f.close();
+        if (_loaded) {
+            LOG_INFO("[ASSET-PACK] Loaded %s: %u entries, %lu KB data\n", _path,
+                     (unsigned)_index.size(), (unsigned long)(_dataSize / 1024));
+        }
+        return _loaded;
+    }
+
+    /**
+     * @brief (Re)create an empty pack, preallocating index and data region
+     *
+     * The index slots are zeroed; the data region is claimed with one seek
+     * past the end (FATFS allocates the cluster chain without writing it),
+     * so creation is fast even for tens of MB. Data bytes start undefined;
+     * nothing references them yet.
+     */
+    bool create(uint32_t dataSize) {
+        _loaded = false;
+        _index.clear();
+        File f = SD.open(_path, FILE_WRITE);
+        if (!f) {
+            LOG_ERROR("ASSET-PACK", "Could not create asset pack file");
+            return false;
+        }
+        // Zero both index slots (stale clusters could hold an old header),
+        // then extend over the data region without writing it
+        uint8_t zeros[128] = {};
+        bool ok = true;
+        for (uint32_t done = 0; ok && done < dataStart(_capacity); done += sizeof(zeros)) {
+            ok = f.write(zeros, sizeof(zeros)) == sizeof(zeros);
+        }
+        uint32_t total = dataStart(_capacity) + dataSize;
+        ok = ok && f.seek(total - 1) && f.write(static_cast<uint8_t>(0)) == 1;
+        _dataSize = dataSize;
+        _seq = 0;
+        _activeSlot = 1;  // First commit lands in slot A
+        ok = ok && commit(f);
+        f.close();
+        if (!ok) {
+            SD.remove(_path);
+            LOG_ERROR("ASSET-PACK", "Asset pack preallocation failed");
+            return false;
+        }
+        _loaded = true;
+        LOG_INFO("[ASSET-PACK] Created %s: %u entries, %lu KB data\n", _path,
+                 (unsigned)_capacity, (unsigned long)(dataSize / 1024));
+        return true;
+    }
+
+    /**
+     * @brief Index lookup, O(log n)
+     */
+    const Entry* find(uint8_t type, const char* tokenId) const {
+        size_t lo = 0, hi = _index.size();
+        while (lo < hi) {
+            size_t mid = (lo + hi) / 2;
+            int c = compare(_index[mid], type, tokenId);
+            if (c == 0) return &_index[mid];
+            if (c < 0) lo = mid + 1; else hi = mid;
+        }
+        return nullptr;
+    }
+
+    /**
+     * @brief Map an asset path (paths::IMAGES_DIR / AUDIO_DIR) to its extent
+     * @return false if the pack is not loaded or does not hold that asset
+     */
+    bool resolve(const String& path, Extent& out) const {
+        if (!_loaded) return false;
+        uint8_t type;
+        String tokenId, ext;
+        if (!parsePath(path, type, tokenId, ext)) return false;
+        const Entry* e = find(type, tokenId.c_str());
+        if (!e || (type == AUDIO && strcmp(ext.c_str(), e->ext) != 0)) return false;
+        out.offset = e->offset;
+        out.length = e->length;
+        return true;
+    }
+
+    /**
+     * @brief First free extent that fits length bytes (sector aligned)
+     *
+     * Extents of current entries are never returned, including the one an
+     * update will replace, so the old copy stays readable until commit.
+     */
+    bool reserve(uint32_t length, uint32_t& offset) const {
+        if (!_loaded || length == 0) return false;
+        std::vector<Extent> used;
+        used.reserve(_index.size());
+        for (const Entry& e : _index) used.push_back({e.offset, e.length});
+        std::sort(used.begin(), used.end(),
+                  [](const Extent& x, const Extent& y) { return x.offset < y.offset; });
+
+        uint32_t cursor = dataStart(_capacity);
+        const uint32_t end = cursor + _dataSize;
+        for (const Extent& u : used) {
+            if (u.offset >= cursor && u.offset - cursor >= length) break;
+            uint32_t next = alignUp(u.offset + u.length);
+            if (next > cursor) cursor = next;
+        }
+        if (cursor > end || end - cursor < length) return false;
+        offset = cursor;
+        return true;
+    }
+
+    /**
+     * @brief Insert or replace an entry and commit the index
+     *
+     * The entry's bytes must already be written and flushed. On a failed
+     * commit the in-RAM index is rolled back.
+     */
+    bool put(const Entry& entry) {
+        if (!_loaded) return false;
+        auto it = lowerBound(entry.type, entry.tokenId);
+        bool replace = it != _index.end() && compare(*it, entry.type, entry.tokenId) == 0;
+        if (!replace && _index.size() >= _capacity) {
+            LOG_INFO("[ASSET-PACK] Index full (%u entries)\n", (unsigned)_capacity);
+            return false;
+        }
+        Entry previous;
+        if (replace) {
+            previous = *it;
+            *it = entry;
+        } else {
+            it = _index.insert(it, entry);
+        }
+        if (commitToFile()) return true;
+        if (replace) {
+            *it = previous;
+        } else {
+            _index.erase(it);
+        }
+        return false;
+    }
+
+    /**
+     * @brief Drop an entry (its extent becomes free) and commit
+     */
+    bool remove(uint8_t type, const char* tokenId) {
+        if (!_loaded) return false;
+        auto it = lowerBound(type, tokenId);
+        if (it == _index.end() || compare(*it, type, tokenId) != 0) return false;
+        Entry previous = *it;
+        size_t pos = it - _index.begin();
+        _index.erase(it);
+        if (commitToFile()) return true;
+        _index.insert(_index.begin() + pos, previous);
+        return false;
+    }
+
+    // Bytes not covered by any entry (fragmented free space included)
+    uint32_t freeBytes() const {
+        uint32_t used = 0;
+        for (const Entry& e : _index) used += alignUp(e.length);
+        return used >= _dataSize ? 0 : _dataSize - used;
+    }
+
+    /**
+     * @brief Split an asset path into (type, tokenId, ext)
+     *
+     * "/assets/images/kaa001.bmp" -> IMAGE, "kaa001", "bmp"
+     * "/assets/audio/kaa001.wav"  -> AUDIO, "kaa001", "wav"
+     */
+    static bool parsePath(const String& path, uint8_t& type, String& tokenId, String& ext) {
+        String rest;
+        if (path.startsWith(paths::IMAGES_DIR)) {
+            type = IMAGE;
+            rest = path.substring(strlen(paths::IMAGES_DIR));
+        } else if (path.startsWith(paths::AUDIO_DIR)) {
+            type = AUDIO;
+            rest = path.substring(strlen(paths::AUDIO_DIR));
+        } else {
+            return false;
+        }
+        int dot = rest.lastIndexOf('.');
+        if (dot <= 0 || rest.indexOf('/') >= 0) return false;
+        tokenId = rest.substring(0, dot);
+        ext = rest.substring(dot + 1);
+        return tokenId.length() <= TOKEN_ID_MAX && ext.length() <= 3;
+    }
+
+    /**
+     * @brief Fill an Entry for (type, tokenId, ext) from a manifest sha1
+     * @return false if the id/ext do not fit or sha1Hex is not 40 hex chars
+     */
+    static bool makeEntry(uint8_t type, const String& tokenId, const String& ext,
+                          const String& sha1Hex, uint32_t offset, uint32_t length,
+                          Entry& out) {
+        if (tokenId.length() == 0 || tokenId.length() > TOKEN_ID_MAX ||
+            ext.length() > 3 || sha1Hex.length() != 40) {
+            return false;
+        }
+        out = Entry();
+        memcpy(out.tokenId, tokenId.c_str(), tokenId.length());
+        out.type = type;
+        memcpy(out.ext, ext.c_str(), ext.length());
+        out.offset = offset;
+        out.length = length;
+        for (int i = 0; i < 20; i++) {
+            int hi = hexNibble(sha1Hex[i * 2]);
+            int lo = hexNibble(sha1Hex[i * 2 + 1]);
+            if (hi < 0 || lo < 0) return false;
+            out.sha1[i] = static_cast<uint8_t>(hi << 4 | lo);
+        }
+        return true;
+    }
+
+    static uint32_t slotBytes(uint32_t capacity) {
+        return HEADER_BYTES + capacity * ENTRY_BYTES;
+    }
+
+    static uint32_t dataStart(uint32_t capacity) {
+        return alignUp(2 * slotBytes(capacity));
+    }
+
+private:
+    const char* _path;
+    std::vector<Entry> _index;
+    const uint16_t _capacity;
+    uint32_t _dataSize = 0;
+    uint32_t _seq = 0;
+    uint8_t _activeSlot = 0;
+    bool _loaded = false;
+
+    static uint32_t alignUp(uint32_t v) {
+        return (v + SECTOR - 1) & ~(SECTOR - 1);
+    }
+
+    static int hexNibble(char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+
+    static int compare(const Entry& e, uint8_t type, const char* tokenId) {
+        if (e.type != type) return e.type < type ? -1 : 1;
+        return strncmp(e.tokenId, tokenId, TOKEN_ID_MAX);
+    }
+
+    std::vector<Entry>::iterator lowerBound(uint8_t type, const char* tokenId) {
+        auto it = _index.begin();
+        while (it != _index.end() && compare(*it, type, tokenId) < 0) ++it;
+        return it;
+    }
+
+    static void put16(uint8_t* p, uint16_t v) {
+        p[0] = v & 0xFF;
+        p[1] = v >> 8;
+    }
+
+    static uint16_t get16(const uint8_t* p) {
+        return static_cast<uint16_t>(p[0] | p[1] << 8);
+    }
+
+    static void put32(uint8_t* p, uint32_t v) {
+        for (int i = 0; i < 4; i++) p[i] = static_cast<uint8_t>(v >> (8 * i));
+    }
+
+    static uint32_t get32(const uint8_t* p) {
+        return static_cast<uint32_t>(p[0]) | static_cast<uint32_t>(p[1]) << 8 |
+               static_cast<uint32_t>(p[2]) << 16 | static_cast<uint32_t>(p[3]) << 24;
+    }
+
+    static void encodeEntry(const Entry& e, uint8_t* p) {
+        memset(p, 0, ENTRY_BYTES);
+        memcpy(p, e.tokenId, strnlen(e.tokenId, TOKEN_ID_MAX));
+        p[24] = e.type;
+        memcpy(p + 25, e.ext, strnlen(e.ext, 3));
+        put32(p + 28, e.offset);
+        put32(p + 32, e.length);
+        memcpy(p + 36, e.sha1, 20);
+    }
+
+    static void decodeEntry(const uint8_t* p, Entry& e) {
+        e = Entry();
+        memcpy(e.tokenId, p, TOKEN_ID_MAX);
+        e.type = p[24];
+        memcpy(e.ext, p + 25, 3);
+        e.offset = get32(p + 28);
+        e.length = get32(p + 32);
+        memcpy(e.sha1, p + 36, 20);
+    }
+
+    bool readHeader(File& f, uint32_t at, uint8_t* h) const {
+        if (!f.seek(at) || f.read(h, HEADER_BYTES) != HEADER_BYTES) return false;
+        uint16_t cap = get16(h + 6);
+        return get32(h) == MAGIC && get16(h + 4) == VERSION && cap == _capacity &&
+               get32(h + 8) <= cap && get32(h + 28) == services::crc32(h, 28);
+    }
+
+    // Entries of a valid header: CRC, sort order and bounds all checked
+    bool readEntries(File& f, const uint8_t* h, uint32_t slotOffset) {
+        uint32_t count = get32(h + 8);
+        uint32_t start = dataStart(_capacity);
+        uint32_t end = start + get32(h + 16);
+        if (!f.seek(slotOffset + HEADER_BYTES)) return false;
+
+        _index.clear();
+        _index.reserve(count);
+        uint32_t crc = 0;
+        uint8_t raw[ENTRY_BYTES];
+        for (uint32_t i = 0; i < count; i++) {
+            if (f.read(raw, ENTRY_BYTES) != ENTRY_BYTES) return false;
+            crc = services::crc32(raw, ENTRY_BYTES, crc);
+            Entry e;
+            decodeEntry(raw, e);
+            if (e.offset < start || e.offset > end || end - e.offset < e.length) return false;
+            if (!_index.empty() && compare(_index.back(), e.type, e.tokenId) >= 0) return false;
+            _index.push_back(e);
+        }
+        return crc == get32(h + 24);
+    }
+
+    bool commitToFile() {
+        File f = SD.open(_path, "r+");
+        if (!f) return false;
+        bool ok = commit(f);
+        f.close();
+        return ok;
+    }
+
+    // Write the index to the inactive slot, entries before header
+    bool commit(File& f) {
+        uint8_t slot = _activeSlot ^ 1;
+        uint32_t at = slot ? slotBytes(_capacity) : 0;
+        uint32_t crc = 0;
+        uint8_t raw[ENTRY_BYTES];
+        if (!f.seek(at + HEADER_BYTES)) return false;
+        for (const Entry& e : _index) {
+            encodeEntry(e, raw);
+            crc = services::crc32(raw, ENTRY_BYTES, crc);
+            if (f.write(raw, ENTRY_BYTES) != ENTRY_BYTES) return false;
+        }
+        f.flush();  // Entries durable before the header that covers them
+
+        uint8_t h[HEADER_BYTES] = {};
+        put32(h, MAGIC);
+        put16(h + 4, VERSION);
+        put16(h + 6, _capacity);
+        put32(h + 8, _index.size());
+        put32(h + 12, _seq + 1);
+        put32(h + 16, _dataSize);
+        put32(h + 24, crc);
+        put32(h + 28, services::crc32(h, 28));
+        if (!f.seek(at) || f.write(h, HEADER_BYTES) != HEADER_BYTES) return false;
+        f.flush();
+        _seq++;
+        _activeSlot = slot;
+        return true;
+    }
+};
+
+} // namespace hal
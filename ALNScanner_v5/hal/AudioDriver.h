@@ -4,6 +4,8 @@
 #include <AudioGeneratorWAV.h>
 #include <AudioOutputI2S.h>
 #include "../config.h"
+#include "AudioFileSourcePack.h"
+#include "SDCard.h"
 
 namespace hal {
 
@@ -36,6 +38,9 @@ namespace hal {
  *       audio.loop();
  *   }
  *
+ * Files held by the asset pack (AssetPack) are streamed from their extent
+ * via AudioFileSourcePack; anything else opens as a loose SD file.
+ *
  * Dependencies:
  * - SDCard.h must be initialized before use
  * - ESP8266Audio library (AudioGeneratorWAV, AudioOutputI2S)
@@ -125,8 +130,19 @@ public:
 
         LOG_INFO("[AUDIO-HAL] Playing: %s\n", path.c_str());
 
-        // Open WAV file from SD card
-        _source = new AudioFileSourceSD(path.c_str());
+        // Open WAV: pack extent if packed, else the loose file. The index
+        // lookup needs the SD lock (a sync may be committing to it).
+        AssetPack::Extent extent;
+        bool packed;
+        {
+            SDCard::Lock lock("audio:open");
+            packed = lock.acquired() && AssetPack::getInstance().resolve(path, extent);
+        }
+        if (packed) {
+            _source = new AudioFileSourcePack(AssetPack::getInstance().path(), extent);
+        } else {
+            _source = new AudioFileSourceSD(path.c_str());
+        }
         if (!_source || !_source->isOpen()) {
             LOG_ERROR("AUDIO-HAL", "Failed to open audio file");
             delete _source;
@@ -228,14 +244,14 @@ private:
     // Audio subsystem state
     static AudioOutputI2S* _output;
     static AudioGeneratorWAV* _generator;
-    static AudioFileSourceSD* _source;
+    static AudioFileSource* _source;
     static bool _initialized;
 };
 
 // Static member initialization
 AudioOutputI2S* AudioDriver::_output = nullptr;
 AudioGeneratorWAV* AudioDriver::_generator = nullptr;
-AudioFileSourceSD* AudioDriver::_source = nullptr;
+AudioFileSource* AudioDriver::_source = nullptr;
 bool AudioDriver::_initialized = false;
 
 } // namespace hal
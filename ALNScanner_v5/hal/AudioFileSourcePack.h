@@ -0,0 +1,66 @@
+#pragma once
+
+/**
+ * @file AudioFileSourcePack.h
+ * @brief ESP8266Audio source reading one extent of the asset pack.
+ *
+ * Same contract as AudioFileSourceSD, but positions are relative to the
+ * extent and reads stop at its end, so AudioGeneratorWAV sees the packed
+ * WAV as if it were a standalone file. Like AudioFileSourceSD, reads are
+ * issued from AudioDriver::loop() without the SD mutex.
+ */
+
+#include <AudioFileSource.h>
+#include <SD.h>
+#include "AssetPack.h"
+
+namespace hal {
+
+class AudioFileSourcePack : public AudioFileSource {
+public:
+    AudioFileSourcePack(const char* packPath, const AssetPack::Extent& extent)
+        : _extent(extent) {
+        _f = SD.open(packPath, FILE_READ);
+        if (_f && !_f.seek(_extent.offset)) _f.close();
+    }
+
+    ~AudioFileSourcePack() override { close(); }
+
+    bool open(const char* filename) override { (void)filename; return false; }
+
+    uint32_t read(void* data, uint32_t len) override {
+        if (!_f) return 0;
+        uint32_t left = _extent.length - _pos;
+        if (len > left) len = left;
+        uint32_t n = _f.read(reinterpret_cast<uint8_t*>(data), len);
+        _pos += n;
+        return n;
+    }
+
+    bool seek(int32_t pos, int dir) override {
+        if (!_f) return false;
+        int64_t target = dir == SEEK_SET ? pos
+                       : dir == SEEK_CUR ? static_cast<int64_t>(_pos) + pos
+                       : static_cast<int64_t>(_extent.length) + pos;
+        if (target < 0 || target > _extent.length) return false;
+        if (!_f.seek(_extent.offset + static_cast<uint32_t>(target))) return false;
+        _pos = static_cast<uint32_t>(target);
+        return true;
+    }
+
+    bool close() override {
+        if (_f) _f.close();
+        return true;
+    }
+
+    bool isOpen() override { return static_cast<bool>(_f); }
+    uint32_t getSize() override { return _f ? _extent.length : 0; }
+    uint32_t getPos() override { return _pos; }
+
+private:
+    File _f;
+    AssetPack::Extent _extent;
+    uint32_t _pos = 0;
+};
+
+} // namespace hal
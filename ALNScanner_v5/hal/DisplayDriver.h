@@ -13,6 +13,7 @@
  * - Bottom-to-top BMP row processing
  * - BGR to RGB565 color conversion
  * - Automatic yield() to prevent watchdog timeouts
+ * - Reads assets from the packed container (AssetPack) when it holds them
  *
  * Extracted from v4.1 monolithic codebase:
  * - Lines 2697-2706: TFT initialization
@@ -23,6 +24,7 @@
 #include <TFT_eSPI.h>
 #include "../config.h"
 #include "SDCard.h"
+#include "AssetPack.h"
 
 namespace hal {
 
@@ -137,7 +139,8 @@ public:
      * Requirements:
      * - 24-bit BMP format (no compression)
      * - Bottom-to-top row order (standard BMP format)
-     * - File must exist on SD card
+     * - File must exist on SD card, or be held by the asset pack (paths
+     *   under /assets/ are looked up there first and read by offset)
      *
      * This function implements the Constitution-compliant SPI pattern:
      * 1. Read from SD FIRST (requires SPI bus)
@@ -168,20 +171,26 @@ public:
             return false;
         }
 
-        // Open BMP file
-        File f = SD.open(path.c_str(), FILE_READ);
-        if (!f) {
+        // Open BMP: pack extent if packed, else the loose file
+        AssetPack::Extent extent;
+        bool packed = AssetPack::getInstance().resolve(path, extent);
+        File f = SD.open(packed ? AssetPack::getInstance().path() : path.c_str(), FILE_READ);
+        if (!f || (packed && !f.seek(extent.offset))) {
             LOG_ERROR("DISPLAY-HAL", "File not found");
             displayError("Missing:", path);
             return false;
         }
+        if (!packed) {
+            extent.length = f.size();
+        }
 
-        LOG_INFO("[DISPLAY-HAL] File opened, size: %d bytes\n", f.size());
+        LOG_INFO("[DISPLAY-HAL] %s opened, size: %d bytes\n", packed ? "Pack extent" : "File",
+                 (int)extent.length);
 
         // Parse BMP header
         int32_t width = 0, height = 0;
         uint16_t bpp = 0;
-        if (!parseBMPHeader(f, width, height, bpp)) {
+        if (!parseBMPHeader(f, extent, width, height, bpp)) {
             f.close();
             displayError("Bad BMP");
             return false;
@@ -281,7 +290,8 @@ private:
 
     /**
      * @brief Parse BMP file header
-     * @param f Open file handle (must be at start of file)
+     * @param f Open file handle (positioned at the start of the BMP)
+     * @param extent Where the BMP lives in f (offset 0 for a loose file)
      * @param width Output: image width in pixels
      * @param height Output: image height in pixels
      * @param bpp Output: bits per pixel
@@ -294,7 +304,8 @@ private:
      *
      * Extracted from v4.1 lines 977-1022
      */
-    inline bool parseBMPHeader(File& f, int32_t& width, int32_t& height, uint16_t& bpp) {
+    inline bool parseBMPHeader(File& f, const AssetPack::Extent& extent,
+                               int32_t& width, int32_t& height, uint16_t& bpp) {
         // Read 54-byte BMP header
         uint8_t header[54];
         size_t bytesRead = f.read(header, 54);
@@ -323,8 +334,16 @@ private:
             return false;
         }
 
+        // Pixel data must lie inside the extent (a packed BMP is followed by
+        // the next asset, not EOF)
+        uint64_t pixelBytes = static_cast<uint64_t>(width) * 3 * (height < 0 ? -height : height);
+        if (dataOffset + pixelBytes > extent.length) {
+            LOG_ERROR("DISPLAY-HAL", "BMP pixel data exceeds file size");
+            return false;
+        }
+
         // Seek to pixel data
-        if (!f.seek(dataOffset)) {
+        if (!f.seek(extent.offset + dataOffset)) {
             LOG_ERROR("DISPLAY-HAL", "Failed to seek to pixel data");
             return false;
         }
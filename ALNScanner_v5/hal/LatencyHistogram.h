@@ -0,0 +1,68 @@
+#pragma once
+
+/**
+ * @file LatencyHistogram.h
+ * @brief Fixed-bucket latency histogram for on-device timing diagnostics.
+ *
+ * No heap, O(1) record(), constant 56-byte footprint — cheap enough to
+ * keep one per RFID phase permanently enabled (see hal::RFIDStats).
+ * LatencyHistogram buckets are roughly log-spaced from 250 us to 100 ms,
+ * which spans everything from a register poll to the 25 ms PCD timeout and
+ * a full scan with retries; NetLatencyHistogram covers 5 ms to 3 s for
+ * network round trips and TLS handshakes. Percentiles resolve to a
+ * bucket's upper bound (the overflow bucket reports the observed max).
+ */
+
+#include <Arduino.h>
+
+namespace hal {
+
+// Inclusive upper bounds in us; the last bucket catches everything above.
+template <uint32_t... Bounds>
+struct BucketedLatency {
+    static constexpr uint8_t BUCKETS = sizeof...(Bounds) + 1;
+    static constexpr uint32_t BOUNDS_US[BUCKETS - 1] = { Bounds... };
+
+    uint32_t buckets[BUCKETS] = {};
+    uint32_t count = 0;
+    uint32_t maxUs = 0;
+    uint64_t totalUs = 0;
+
+    void record(uint32_t us) {
+        uint8_t i = 0;
+        while (i < BUCKETS - 1 && us > BOUNDS_US[i]) {
+            i++;
+        }
+        buckets[i]++;
+        count++;
+        totalUs += us;
+        if (us > maxUs) maxUs = us;
+    }
+
+    uint32_t meanUs() const {
+        return count ? static_cast<uint32_t>(totalUs / count) : 0;
+    }
+
+    // Upper bound of the bucket holding the pct-th percentile sample.
+    uint32_t percentileUs(uint8_t pct) const {
+        if (count == 0) return 0;
+        uint32_t rank = (static_cast<uint64_t>(count) * pct + 99) / 100;
+        if (rank == 0) rank = 1;
+        uint32_t seen = 0;
+        for (uint8_t i = 0; i < BUCKETS; i++) {
+            seen += buckets[i];
+            if (seen >= rank) {
+                return i < BUCKETS - 1 && BOUNDS_US[i] < maxUs ? BOUNDS_US[i] : maxUs;
+            }
+        }
+        return maxUs;
+    }
+};
+
+using LatencyHistogram =
+    BucketedLatency<250, 500, 1000, 2000, 5000, 10000, 25000, 50000, 100000>;
+
+using NetLatencyHistogram =
+    BucketedLatency<5000, 10000, 20000, 50000, 100000, 200000, 500000, 1000000, 3000000>;
+
+} // namespace hal
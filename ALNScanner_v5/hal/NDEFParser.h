@@ -7,11 +7,21 @@
  * Extracted from RFIDReader.h extractNDEFTextInternal() for testability.
  * Takes raw NTAG page bytes as input — no hardware dependencies.
  *
- * Single-buffer API: the caller provides one contiguous buffer covering
- * NTAG pages 3..10 (32 bytes). This replaces the earlier two-buffer
- * signature which was an artifact of the previous two-READ protocol
- * implementation; the unified buffer simplifies parsing and extends
- * the TLV-scan range so NDEF TLVs past page 5 are no longer missed.
+ * Buffers always start at NTAG page 3 (the Capability Container), so byte
+ * offsets here map directly to pages: page = 3 + offset / 4. The caller
+ * may pass as many pages as it has read; locateNDEFText() reports how many
+ * bytes are required to hold the first Text record so the reader can
+ * fetch exactly that and no more (see RFIDReader::readNDEFPages()).
+ *
+ * Supported layout:
+ * - NULL, Lock Control, Memory Control and proprietary TLVs before the
+ *   NDEF Message TLV (skipped), Terminator TLV ends the search.
+ * - 1-byte and 3-byte (0xFF + 16-bit) TLV lengths.
+ * - Multi-record messages: short and normal (4-byte payload length)
+ *   records, optional ID field. The first Well-known 'T' record wins;
+ *   records before it are skipped, records after it are never needed.
+ * - If the CC carries the NDEF magic (0xE1), its data-area size bounds
+ *   every length so a corrupt header can't trigger a runaway read.
  */
 
 #include <Arduino.h>
@@ -19,119 +29,189 @@
 
 namespace hal {
 
+enum class NDEFLayout {
+    Complete,   // First Text record lies entirely within the buffer
+    NeedMore,   // Layout valid so far; buffer ends before the record does
+    Invalid     // Terminator / no Text record / inconsistent lengths
+};
+
+struct NDEFTextSpan {
+    size_t textOffset = 0;  // Offset of the text bytes within the buffer
+    size_t textLength = 0;
+    size_t required = 0;    // Bytes from page 3 needed (Complete/NeedMore)
+};
+
 /**
- * Parse NDEF text record from raw NTAG page data.
+ * Walk CC -> TLVs -> NDEF records and locate the first Text record.
  *
- * @param pages3to10  Raw bytes from NTAG pages 3-10 (32 bytes minimum).
- *                    Byte 0 is the first byte of page 3 (CC).
- * @param len         Length of pages3to10 buffer (must be >= 32).
- * @param sak         SAK byte from card selection (0x00 = NTAG/Ultralight).
- * @return            Extracted text, or empty string on failure.
+ * @param pages  Raw bytes starting at NTAG page 3 (CC).
+ * @param len    Bytes available in `pages`.
+ * @param span   Out: text location on Complete; `required` on NeedMore.
  */
-inline String parseNDEFText(const uint8_t* pages3to10, size_t len, uint8_t sak) {
-    // Only process NTAG/Ultralight cards (SAK=0x00)
-    if (sak != 0x00) {
-        LOG_NDEF("[NDEF-PARSE] Not an NTAG (SAK=0x%02X), skipping\n", sak);
-        return "";
+inline NDEFLayout locateNDEFText(const uint8_t* pages, size_t len, NDEFTextSpan& span) {
+    // CC byte 2 = data area size / 8, data area starts at page 4 (offset 4).
+    size_t areaEnd = (size_t)-1;
+    if (len >= 4 && pages[0] == 0xE1) {
+        areaEnd = 4 + (size_t)pages[2] * 8;
     }
+    auto needMore = [&](size_t bytes) {
+        span.required = bytes;
+        return bytes > areaEnd ? NDEFLayout::Invalid : NDEFLayout::NeedMore;
+    };
 
-    if (len < 32) {
-        LOG_NDEF("[NDEF-PARSE] Insufficient page data (len=%zu)\n", len);
-        return "";
+    if (len < 4) {
+        return needMore(4);
     }
 
-    // Parse TLV structure — look for NDEF Message TLV (0x03).
-    // CC is on page 3 (bytes 0-3); TLVs begin at byte 4 (page 4).
-    // Scan range extends through byte 27 (end of page 9), leaving room
-    // for the length byte at [i+1]. This range is wider than the old
-    // two-buffer parser (which only scanned bytes 4..11), so tokens
-    // with a longer Lock Control TLV preamble are no longer missed.
-    int ndefStart = -1;
-    int ndefLength = 0;
-
-    for (int i = 4; i < 28; i++) {
-        uint8_t tlvType = pages3to10[i];
+    // ─── TLV scan (starts at page 4) ───────────────────────────────────
+    size_t pos = 4;
+    size_t msgStart = 0;
+    size_t msgLen = 0;
+    while (true) {
+        if (pos >= len) return needMore(pos + 1);
 
-        if (tlvType == 0x00) {
-            // NULL TLV, skip
+        uint8_t type = pages[pos];
+        if (type == 0x00) {          // NULL TLV (no length byte)
+            pos++;
             continue;
-        } else if (tlvType == 0xFE) {
-            // Terminator TLV
-            break;
-        } else if (tlvType == 0x01) {
-            // Lock Control TLV: length byte + <length> bytes of lock data
-            if (i + 1 < (int)len) {
-                uint8_t lockLen = pages3to10[i + 1];
-                i += 1 + lockLen;  // Skip this TLV (for-loop i++ advances further)
-            }
-        } else if (tlvType == 0x03) {
-            // NDEF Message TLV
-            if (i + 1 < (int)len) {
-                ndefLength = pages3to10[i + 1];
-                ndefStart = i + 2;
-                break;
-            }
         }
-    }
+        if (type == 0xFE) {          // Terminator TLV
+            LOG_NDEF("[NDEF-PARSE] Terminator before NDEF TLV at %u\n", (unsigned)pos);
+            return NDEFLayout::Invalid;
+        }
 
-    LOG_NDEF("[NDEF-PARSE] TLV result: ndefStart=%d, ndefLength=%d\n", ndefStart, ndefLength);
+        if (pos + 1 >= len) return needMore(pos + 2);
+        size_t tlvLen = pages[pos + 1];
+        size_t hdrLen = 2;
+        if (tlvLen == 0xFF) {        // 3-byte length format
+            if (pos + 3 >= len) return needMore(pos + 4);
+            tlvLen = ((size_t)pages[pos + 2] << 8) | pages[pos + 3];
+            hdrLen = 4;
+        }
 
-    if (ndefStart < 0 || ndefLength <= 0) {
-        LOG_NDEF("[NDEF-PARSE] FAILED: no NDEF TLV found\n");
-        return "";
+        if (type == 0x03) {          // NDEF Message TLV
+            msgStart = pos + hdrLen;
+            msgLen = tlvLen;
+            break;
+        }
+        // Lock Control (0x01), Memory Control (0x02), proprietary (0xFD):
+        // skip the value field.
+        pos += hdrLen + tlvLen;
     }
 
-    // Clamp declared NDEF length to what we actually have. Tokens with
-    // multi-record NDEF messages (e.g., a Text record carrying the tokenId
-    // followed by a URI record) may declare a total TLV length that extends
-    // beyond pages 3..10. The first record — the Text record we care about —
-    // still fits in the buffer and is extractable.
-    int effectiveLen = ndefLength;
-    if (ndefStart + ndefLength > (int)len) {
-        effectiveLen = (int)len - ndefStart;
-        LOG_NDEF("[NDEF-PARSE] Truncating NDEF: declared=%d bytes, available=%d bytes\n",
-                 ndefLength, effectiveLen);
+    LOG_NDEF("[NDEF-PARSE] NDEF TLV: msgStart=%u, msgLen=%u\n",
+             (unsigned)msgStart, (unsigned)msgLen);
+
+    if (msgLen < 3) {
+        LOG_NDEF("[NDEF-PARSE] FAILED: NDEF message too short (%u bytes)\n", (unsigned)msgLen);
+        return NDEFLayout::Invalid;
     }
+    const size_t msgEnd = msgStart + msgLen;
+
+    // ─── Record walk ───────────────────────────────────────────────────
+    size_t rec = msgStart;
+    while (true) {
+        if (rec + 3 > msgEnd) return NDEFLayout::Invalid;
+        if (rec + 1 > len) return needMore(rec + 1);
+
+        uint8_t header = pages[rec];
+        bool shortRecord = header & 0x10;   // SR
+        bool hasId = header & 0x08;         // IL
+        bool lastRecord = header & 0x40;    // ME
+        uint8_t tnf = header & 0x07;
+
+        size_t fixedLen = 2 + (shortRecord ? 1 : 4) + (hasId ? 1 : 0);
+        if (rec + fixedLen > msgEnd) return NDEFLayout::Invalid;
+        if (rec + fixedLen > len) return needMore(rec + fixedLen);
+
+        size_t typeLen = pages[rec + 1];
+        size_t payloadLen;
+        if (shortRecord) {
+            payloadLen = pages[rec + 2];
+        } else {
+            payloadLen = ((uint32_t)pages[rec + 2] << 24) | ((uint32_t)pages[rec + 3] << 16) |
+                         ((uint32_t)pages[rec + 4] << 8)  |  (uint32_t)pages[rec + 5];
+        }
+        // Bound before summing so a corrupt 32-bit length can't wrap.
+        if (payloadLen > msgLen) return NDEFLayout::Invalid;
+        size_t idLen = hasId ? pages[rec + fixedLen - 1] : 0;
+
+        size_t typeOff = rec + fixedLen;
+        size_t payloadOff = typeOff + typeLen + idLen;
+        size_t recEnd = payloadOff + payloadLen;
+        if (recEnd > msgEnd) {
+            LOG_NDEF("[NDEF-PARSE] FAILED: record overruns message (end=%u, msgEnd=%u)\n",
+                     (unsigned)recEnd, (unsigned)msgEnd);
+            return NDEFLayout::Invalid;
+        }
 
-    // NDEF message lives at pages3to10[ndefStart..ndefStart+effectiveLen]
-    const uint8_t* msg = &pages3to10[ndefStart];
+        bool isText = (tnf == 0x01 && typeLen == 1);
+        if (isText) {
+            if (typeOff >= len) return needMore(typeOff + 1);
+            isText = (pages[typeOff] == 'T');
+        }
 
-    // Parse NDEF record (first record only — sufficient for tokenId extraction)
-    if (effectiveLen < 7) {
-        LOG_NDEF("[NDEF-PARSE] FAILED: NDEF message too short (%d bytes)\n", effectiveLen);
-        return "";
-    }
+        if (isText) {
+            if (recEnd > len) return needMore(recEnd);
+            if (recEnd > areaEnd) return NDEFLayout::Invalid;
 
-    uint8_t recordHeader = msg[0];
+            // Status byte plus at least one character; checked before the
+            // status byte is read, which an empty payload does not have
+            if (payloadLen < 2) {
+                LOG_NDEF("[NDEF-PARSE] FAILED: empty text (payload=%u)\n",
+                         (unsigned)payloadLen);
+                return NDEFLayout::Invalid;
+            }
+            uint8_t langCodeLen = pages[payloadOff] & 0x3F;
+            if (payloadLen < 1 + (size_t)langCodeLen + 1) {
+                LOG_NDEF("[NDEF-PARSE] FAILED: empty text (payload=%u, lang=%u)\n",
+                         (unsigned)payloadLen, langCodeLen);
+                return NDEFLayout::Invalid;
+            }
+            span.textOffset = payloadOff + 1 + langCodeLen;
+            span.textLength = payloadLen - 1 - langCodeLen;
+            span.required = recEnd;
+            return NDEFLayout::Complete;
+        }
 
-    // Check TNF=001 (Well-known type)
-    if ((recordHeader & 0x07) != 0x01) {
-        LOG_NDEF("[NDEF-PARSE] FAILED: wrong TNF=0x%02X (expected 0x01)\n", recordHeader & 0x07);
-        return "";
+        LOG_NDEF("[NDEF-PARSE] Skipping record TNF=%u typeLen=%u payload=%u\n",
+                 tnf, (unsigned)typeLen, (unsigned)payloadLen);
+        if (lastRecord) {
+            LOG_NDEF("[NDEF-PARSE] FAILED: no Text record in message\n");
+            return NDEFLayout::Invalid;
+        }
+        rec = recEnd;
     }
+}
 
-    uint8_t typeLength = msg[1];
-    uint8_t payloadLength = msg[2];
-
-    // Must be a Text record (type='T', length=1)
-    if (typeLength != 1 || msg[3] != 'T') {
-        LOG_NDEF("[NDEF-PARSE] FAILED: not a Text record (typeLen=%d, type='%c')\n", typeLength, msg[3]);
+/**
+ * Parse NDEF text record from raw NTAG page data.
+ *
+ * @param pages  Raw bytes starting at NTAG page 3 (CC). Any length; a
+ *               buffer that ends before the first Text record does
+ *               returns empty.
+ * @param len    Length of `pages` in bytes.
+ * @param sak    SAK byte from card selection (0x00 = NTAG/Ultralight).
+ * @return       Extracted text of the first Text record, or empty string.
+ */
+inline String parseNDEFText(const uint8_t* pages, size_t len, uint8_t sak) {
+    // Only process NTAG/Ultralight cards (SAK=0x00)
+    if (sak != 0x00) {
+        LOG_NDEF("[NDEF-PARSE] Not an NTAG (SAK=0x%02X), skipping\n", sak);
         return "";
     }
 
-    uint8_t langCodeLen = msg[4] & 0x3F;
-    int textStart = 5 + langCodeLen;
-    int textLength = payloadLength - 1 - langCodeLen;
-
-    if (textLength <= 0 || textStart + textLength > effectiveLen) {
-        LOG_NDEF("[NDEF-PARSE] FAILED: text bounds invalid (start=%d, len=%d, effLen=%d)\n", textStart, textLength, effectiveLen);
+    NDEFTextSpan span;
+    NDEFLayout layout = locateNDEFText(pages, len, span);
+    if (layout != NDEFLayout::Complete) {
+        LOG_NDEF("[NDEF-PARSE] FAILED: layout=%d (len=%u, required=%u)\n",
+                 static_cast<int>(layout), (unsigned)len, (unsigned)span.required);
         return "";
     }
 
-    // Extract the actual text
     String extractedText = "";
-    for (int k = 0; k < textLength; k++) {
-        extractedText += (char)msg[textStart + k];
+    for (size_t k = 0; k < span.textLength; k++) {
+        extractedText += (char)pages[span.textOffset + k];
     }
 
     LOG_NDEF("[NDEF-PARSE] Extracted: '%s'\n", extractedText.c_str());
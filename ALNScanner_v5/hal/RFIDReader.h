@@ -4,6 +4,7 @@
 #include <MFRC522.h>
 #include "../config.h"
 #include "NDEFParser.h"
+#include "LatencyHistogram.h"
 
 /**
  * RFIDReader HAL Component - ESP32 Software SPI + MFRC522 + NDEF Extraction
@@ -25,7 +26,42 @@
 
 namespace hal {
 
-// Statistics tracking
+/**
+ * Timed phases of a scan. Each gets its own LatencyHistogram so a slow
+ * scan can be attributed: long Wakeup/Select tails point at the antenna
+ * or card placement, long FastRead at SPI speed, many high attempt
+ * numbers at RF noise.
+ */
+enum class RFIDPhase : uint8_t {
+    FieldSettle,  // Antenna OFF->ON incl. settle delay
+    Wakeup,       // WUPA (excludes idle no-card polls)
+    SelectCL1,    // Anticollision + SELECT per cascade level
+    SelectCL2,
+    SelectCL3,
+    FastRead,     // One FAST_READ exchange
+    NdefParse,    // parseNDEFText() on the buffered pages
+    Halt,         // HLTA (normally ends in the PCD timeout)
+    Scan,         // detectCard() start -> extractNDEFText() return
+    Count
+};
+
+inline const char* rfidPhaseName(RFIDPhase phase) {
+    switch (phase) {
+        case RFIDPhase::FieldSettle: return "FieldSettle";
+        case RFIDPhase::Wakeup:      return "Wakeup";
+        case RFIDPhase::SelectCL1:   return "SelectCL1";
+        case RFIDPhase::SelectCL2:   return "SelectCL2";
+        case RFIDPhase::SelectCL3:   return "SelectCL3";
+        case RFIDPhase::FastRead:    return "FastRead";
+        case RFIDPhase::NdefParse:   return "NdefParse";
+        case RFIDPhase::Halt:        return "Halt";
+        case RFIDPhase::Scan:        return "Scan";
+        default:                     return "?";
+    }
+}
+
+// Statistics tracking. Written by the scan task (Core 0) under _statsMux;
+// readers on Core 1 get a copy taken under the same spinlock (getStats()).
 struct RFIDStats {
     uint32_t totalScans = 0;
     uint32_t successfulScans = 0;
@@ -34,6 +70,72 @@ struct RFIDStats {
     uint32_t collisionErrors = 0;
     uint32_t timeoutErrors = 0;
     uint32_t crcErrors = 0;
+
+    // Successes by attempt number (index 0 = first try)
+    uint32_t detectAttempts[rfid_config::MAX_RETRIES] = {};
+    uint32_t readAttempts[rfid_config::MAX_RETRIES] = {};
+
+    LatencyHistogram phases[static_cast<size_t>(RFIDPhase::Count)];
+
+    void record(RFIDPhase phase, uint32_t us) {
+        phases[static_cast<size_t>(phase)].record(us);
+    }
+    const LatencyHistogram& phase(RFIDPhase phase) const {
+        return phases[static_cast<size_t>(phase)];
+    }
+
+    uint32_t cardsSeen() const { return successfulScans + failedScans; }
+    uint32_t tokensRead() const {
+        uint32_t n = 0;
+        for (uint8_t i = 0; i < rfid_config::MAX_RETRIES; i++) n += readAttempts[i];
+        return n;
+    }
+
+    void print() const {
+        Serial.println("\n=== RFID Statistics ===");
+        Serial.printf("Detect polls: %lu\n", (unsigned long)totalScans);
+        Serial.printf("Cards seen: %lu (detect failed: %lu)\n",
+                      (unsigned long)cardsSeen(), (unsigned long)failedScans);
+        Serial.printf("Tokens read: %lu, retries: %lu\n",
+                      (unsigned long)tokensRead(), (unsigned long)retryCount);
+        Serial.printf("Errors: collision %lu, timeout %lu, CRC/BCC %lu\n",
+                      (unsigned long)collisionErrors, (unsigned long)timeoutErrors,
+                      (unsigned long)crcErrors);
+
+        Serial.print("Detect OK on attempt:");
+        for (uint8_t i = 0; i < rfid_config::MAX_RETRIES; i++) {
+            Serial.printf("  #%u=%lu", i + 1, (unsigned long)detectAttempts[i]);
+        }
+        Serial.print("\nRead OK on attempt:  ");
+        for (uint8_t i = 0; i < rfid_config::MAX_RETRIES; i++) {
+            Serial.printf("  #%u=%lu", i + 1, (unsigned long)readAttempts[i]);
+        }
+        Serial.println();
+
+        Serial.println("\nPhase latency (us):   n     mean      p50      p90      max");
+        for (size_t p = 0; p < static_cast<size_t>(RFIDPhase::Count); p++) {
+            const LatencyHistogram& h = phases[p];
+            Serial.printf("  %-12s %6lu %8lu %8lu %8lu %8lu\n",
+                          rfidPhaseName(static_cast<RFIDPhase>(p)),
+                          (unsigned long)h.count, (unsigned long)h.meanUs(),
+                          (unsigned long)h.percentileUs(50), (unsigned long)h.percentileUs(90),
+                          (unsigned long)h.maxUs);
+        }
+
+        Serial.print("\nBuckets (us):  ");
+        for (uint8_t b = 0; b < LatencyHistogram::BUCKETS - 1; b++) {
+            Serial.printf(" <=%-6lu", (unsigned long)LatencyHistogram::BOUNDS_US[b]);
+        }
+        Serial.println("   >100000");
+        for (size_t p = 0; p < static_cast<size_t>(RFIDPhase::Count); p++) {
+            Serial.printf("  %-12s", rfidPhaseName(static_cast<RFIDPhase>(p)));
+            for (uint8_t b = 0; b < LatencyHistogram::BUCKETS; b++) {
+                Serial.printf(" %8lu", (unsigned long)phases[p].buckets[b]);
+            }
+            Serial.println();
+        }
+        Serial.println("=======================\n");
+    }
 };
 
 /**
@@ -74,8 +176,18 @@ public:
     void silenceSPIPins();
 
     // Statistics
-    const RFIDStats& getStats() const { return _stats; }
-    void resetStats() { _stats = {}; }
+    RFIDStats getStats() const {
+        portENTER_CRITICAL(&_statsMux);
+        RFIDStats copy = _stats;
+        portEXIT_CRITICAL(&_statsMux);
+        return copy;
+    }
+
+    void resetStats() {
+        portENTER_CRITICAL(&_statsMux);
+        _stats = {};
+        portEXIT_CRITICAL(&_statsMux);
+    }
 
 private:
     RFIDReader() = default;
@@ -127,21 +239,47 @@ private:
     bool readPage(uint8_t page, uint8_t* buffer, uint8_t* bufferSize);
 
     // Multi-page FAST_READ (0x3A): returns (endPage - startPage + 1) * 4 bytes
-    // in a single exchange. Used by extractNDEFTextInternal() to read pages
-    // 3-10 atomically, eliminating the inter-exchange window where card state
-    // could drop between two sequential READ commands.
+    // in a single exchange. At most FAST_READ_MAX_PAGES per call (FIFO limit).
     bool readPagesFast(uint8_t startPage, uint8_t endPage,
                        uint8_t* buffer, uint8_t* bufferSize);
 
+    // Length-aware read from page 3: fetches the header window, then only
+    // the pages the NDEF layout says are still missing. Returns bytes
+    // buffered (multiple of 4), or 0 on a failed exchange.
+    size_t readNDEFPages(uint8_t* buffer, size_t capacity);
+
     String extractNDEFTextInternal();
 
+    // Records elapsed time into a phase histogram on scope exit, so every
+    // early return in select() etc. is still accounted for.
+    struct PhaseTimer {
+        RFIDPhase phase;
+        uint32_t startUs;
+        explicit PhaseTimer(RFIDPhase p) : phase(p), startUs(micros()) {}
+        ~PhaseTimer() { recordPhase(phase, micros() - startUs); }
+    };
+
+    // Every write to _stats goes through here (Core 0 scan task)
+    template <typename Fn>
+    static void updateStats(Fn fn) {
+        portENTER_CRITICAL(&_statsMux);
+        fn(_stats);
+        portEXIT_CRITICAL(&_statsMux);
+    }
+
+    static void recordPhase(RFIDPhase phase, uint32_t us) {
+        updateStats([=](RFIDStats& st) { st.record(phase, us); });
+    }
+
     // === State ===
 
     static bool _initialized;
     static bool _rfFieldEnabled;
     static MFRC522::Uid _currentUid;
     static RFIDStats _stats;
+    static uint32_t _scanStartUs;
     static portMUX_TYPE _spiMux;
+    static portMUX_TYPE _statsMux;
 };
 
 // === IMPLEMENTATION ===
@@ -151,7 +289,9 @@ bool RFIDReader::_initialized = false;
 bool RFIDReader::_rfFieldEnabled = false;
 MFRC522::Uid RFIDReader::_currentUid = {};
 RFIDStats RFIDReader::_stats = {};
+uint32_t RFIDReader::_scanStartUs = 0;
 portMUX_TYPE RFIDReader::_spiMux = portMUX_INITIALIZER_UNLOCKED;
+portMUX_TYPE RFIDReader::_statsMux = portMUX_INITIALIZER_UNLOCKED;
 
 // === SOFTWARE SPI IMPLEMENTATION ===
 
@@ -314,7 +454,7 @@ MFRC522::StatusCode RFIDReader::transceiveData(
             break;
         }
         if (irq & 0x01) {  // Timeout interrupt
-            _stats.timeoutErrors++;
+            updateStats([](RFIDStats& st) { st.timeoutErrors++; });
             return MFRC522::STATUS_TIMEOUT;
         }
         yield();  // Let other tasks run
@@ -324,7 +464,7 @@ MFRC522::StatusCode RFIDReader::transceiveData(
     clearRegisterBitMask(MFRC522::BitFramingReg, 0x80);
 
     if (!completed) {
-        _stats.timeoutErrors++;
+        updateStats([](RFIDStats& st) { st.timeoutErrors++; });
         return MFRC522::STATUS_TIMEOUT;
     }
 
@@ -342,7 +482,7 @@ MFRC522::StatusCode RFIDReader::transceiveData(
         // Clear FIFO
         setRegisterBitMask(MFRC522::FIFOLevelReg, 0x80);
 
-        _stats.collisionErrors++;
+        updateStats([](RFIDStats& st) { st.collisionErrors++; });
         return MFRC522::STATUS_COLLISION;
     }
 
@@ -444,6 +584,10 @@ MFRC522::StatusCode RFIDReader::select(MFRC522::Uid* uid, uint8_t validBits) {
                 return MFRC522::STATUS_INTERNAL_ERROR;
         }
 
+        PhaseTimer levelTimer(cascadeLevel == 1 ? RFIDPhase::SelectCL1
+                              : cascadeLevel == 2 ? RFIDPhase::SelectCL2
+                              : RFIDPhase::SelectCL3);
+
         // === Step 1: Anticollision ===
         buffer[0] = cmd;
         buffer[1] = 0x20;  // NVB = 2 bytes (just SEL and NVB)
@@ -471,7 +615,7 @@ MFRC522::StatusCode RFIDReader::select(MFRC522::Uid* uid, uint8_t validBits) {
         uint8_t bcc = responseBuffer[0] ^ responseBuffer[1] ^ responseBuffer[2] ^ responseBuffer[3];
         if (bcc != responseBuffer[4]) {
             LOG_DEBUG("[Select CL%d] BCC check failed\n", cascadeLevel);
-            _stats.crcErrors++;
+            updateStats([](RFIDStats& st) { st.crcErrors++; });
             return MFRC522::STATUS_CRC_WRONG;
         }
 
@@ -564,6 +708,7 @@ MFRC522::StatusCode RFIDReader::select(MFRC522::Uid* uid, uint8_t validBits) {
 }
 
 MFRC522::StatusCode RFIDReader::haltA() {
+    PhaseTimer timer(RFIDPhase::Halt);
     uint8_t cmdBuffer[4];
     cmdBuffer[0] = MFRC522::PICC_CMD_HLTA;
     cmdBuffer[1] = 0;
@@ -611,14 +756,15 @@ bool RFIDReader::readPage(uint8_t page, uint8_t* buffer, uint8_t* bufferSize) {
 
 // FAST_READ (0x3A) — reads pages [startPage..endPage] inclusive in a single
 // exchange. Response is (endPage - startPage + 1) * 4 data bytes plus 2 CRC
-// bytes. For NTAG215 pages 3-10, that's 32 + 2 = 34 bytes, well within the
-// MFRC522's 64-byte FIFO.
+// bytes, so one exchange can carry at most 15 pages (60 + 2 bytes) through
+// the MFRC522's 64-byte FIFO. `buffer` needs 2 bytes of slack for the CRC.
 //
-// Collapses two sequential READ commands into one exchange, eliminating the
-// inter-exchange window where card RF-coupling wobble can drop the card out
-// of ACTIVE state (the dominant historical failure mode).
+// Fewer, larger exchanges shrink the inter-exchange window where card
+// RF-coupling wobble can drop the card out of ACTIVE state (the dominant
+// historical failure mode).
 bool RFIDReader::readPagesFast(uint8_t startPage, uint8_t endPage,
                                 uint8_t* buffer, uint8_t* bufferSize) {
+    PhaseTimer timer(RFIDPhase::FastRead);
     uint8_t cmdBuffer[5];
     cmdBuffer[0] = 0x3A;       // FAST_READ command
     cmdBuffer[1] = startPage;
@@ -647,6 +793,50 @@ bool RFIDReader::readPagesFast(uint8_t startPage, uint8_t endPage,
     return true;
 }
 
+// Incremental NDEF read. Starts with NDEF_FIRST_READ_PAGES (enough for a
+// short token in one exchange), asks locateNDEFText() how many bytes the
+// first Text record actually needs, and FAST_READs only the missing pages,
+// in FIFO-sized chunks. Pages always accumulate contiguously from page 3 so
+// the parser sees one flat buffer.
+size_t RFIDReader::readNDEFPages(uint8_t* buffer, size_t capacity) {
+    size_t have = 0;
+    size_t want = rfid_config::NDEF_FIRST_READ_PAGES * 4;
+
+    while (true) {
+        if (want > capacity) {
+            LOG_INFO("[NDEF] Text record needs %u bytes, cap is %u\n",
+                     (unsigned)want, (unsigned)capacity);
+            return have;  // Parser will reject the truncated layout
+        }
+
+        while (have < want) {
+            size_t pages = (want - have + 3) / 4;
+            if (pages > rfid_config::FAST_READ_MAX_PAGES) {
+                pages = rfid_config::FAST_READ_MAX_PAGES;
+            }
+            uint8_t startPage = 3 + have / 4;
+            uint8_t endPage = startPage + pages - 1;
+            // Chunk lands directly in place; its 2 CRC bytes spill into the
+            // slack the caller reserves and are overwritten by the next chunk.
+            uint8_t size = pages * 4 + 2;
+            if (!readPagesFast(startPage, endPage, buffer + have, &size)) {
+                return 0;
+            }
+            have += pages * 4;
+        }
+
+        NDEFTextSpan span;
+        NDEFLayout layout = locateNDEFText(buffer, have, span);
+        if (layout != NDEFLayout::NeedMore) {
+            LOG_DEBUG("[NDEF] Layout %s after %u bytes (pages 3..%u)\n",
+                      layout == NDEFLayout::Complete ? "complete" : "invalid",
+                      (unsigned)have, (unsigned)(3 + have / 4 - 1));
+            return have;
+        }
+        want = (span.required + 3) & ~(size_t)3;  // round up to a page
+    }
+}
+
 String RFIDReader::extractNDEFTextInternal() {
     LOG_INFO("[NDEF] Starting NDEF extraction...\n");
     LOG_DEBUG("[NDEF-DIAG] Pre-extraction heap: %d\n", ESP.getFreeHeap());
@@ -663,29 +853,36 @@ String RFIDReader::extractNDEFTextInternal() {
         return "";
     }
 
-    // Retry loop: FAST_READ pages 3..10 as a single exchange. On failure,
-    // pause briefly; after the first retry, try re-Select to recover from
-    // card state drop (HALT or IDLE) that can happen if RF coupling blips
-    // during the exchange.
+    // Retry loop: length-aware FAST_READ from page 3 (see readNDEFPages()).
+    // On failure, pause briefly; after the first retry, try re-Select to
+    // recover from card state drop (HALT or IDLE) that can happen if RF
+    // coupling blips during the exchange.
     for (uint8_t attempt = 1; attempt <= rfid_config::MAX_RETRIES; attempt++) {
-        uint8_t buffer[34];  // 32 data bytes (pages 3..10) + 2 CRC
-        uint8_t size = sizeof(buffer);
+        uint8_t buffer[rfid_config::NDEF_MAX_READ_BYTES + 2];  // + CRC slack
+        size_t size = readNDEFPages(buffer, rfid_config::NDEF_MAX_READ_BYTES);
 
-        if (readPagesFast(3, 10, buffer, &size)) {
-            LOG_DEBUG("[NDEF] Pages 3-10 via FAST_READ: ");
-            for (int i = 0; i < 32; i++) LOG_DEBUG("%02X ", buffer[i]);
+        if (size > 0) {
+            LOG_DEBUG("[NDEF] Pages 3-%u via FAST_READ: ", (unsigned)(3 + size / 4 - 1));
+            for (size_t i = 0; i < size; i++) LOG_DEBUG("%02X ", buffer[i]);
             LOG_DEBUG("\n");
 
-            LOG_NDEF("[NDEF-DIAG] Pages 3-10 raw: ");
-            for (int i = 0; i < 32; i++) LOG_NDEF("%02X ", buffer[i]);
+            LOG_NDEF("[NDEF-DIAG] Pages 3-%u raw: ", (unsigned)(3 + size / 4 - 1));
+            for (size_t i = 0; i < size; i++) LOG_NDEF("%02X ", buffer[i]);
             LOG_NDEF("\n");
 
             // Delegate parsing to pure function (testable without hardware)
-            String result = hal::parseNDEFText(buffer, 32, _currentUid.sak);
+            String result;
+            {
+                PhaseTimer timer(RFIDPhase::NdefParse);
+                result = hal::parseNDEFText(buffer, size, _currentUid.sak);
+            }
             if (result.length() > 0) {
+                updateStats([attempt](RFIDStats& st) {
+                    st.readAttempts[attempt - 1]++;
+                    st.retryCount += attempt - 1;
+                });
                 if (attempt > 1) {
                     LOG_INFO("[NDEF-RETRY] Recovered on attempt %d\n", attempt);
-                    _stats.retryCount += (attempt - 1);
                 }
                 return result;
             }
@@ -708,7 +905,12 @@ String RFIDReader::extractNDEFTextInternal() {
         // before the next FAST_READ attempt.
         uint8_t bufferATQA[2];
         uint8_t atqaSize = sizeof(bufferATQA);
-        if (requestA(bufferATQA, &atqaSize) == MFRC522::STATUS_OK &&
+        MFRC522::StatusCode wake;
+        {
+            PhaseTimer timer(RFIDPhase::Wakeup);
+            wake = requestA(bufferATQA, &atqaSize);
+        }
+        if (wake == MFRC522::STATUS_OK &&
             select(&_currentUid) == MFRC522::STATUS_OK) {
             LOG_INFO("[NDEF-RETRY] reSelect recovery OK before attempt %d\n", attempt + 1);
         } else {
@@ -726,6 +928,7 @@ String RFIDReader::extractNDEFTextInternal() {
 
 void RFIDReader::enableRFField() {
     if (!_rfFieldEnabled) {
+        PhaseTimer timer(RFIDPhase::FieldSettle);
         writeRegister(MFRC522::TxControlReg, 0x83);  // Enable antenna (bits 0-1 = 11)
         _rfFieldEnabled = true;
         // Settling time for the RF field to stabilize. NTAG passive tags
@@ -860,7 +1063,8 @@ DetectResult RFIDReader::detectCard(MFRC522::Uid& uid) {
         return DetectResult::CommFailed;
     }
 
-    _stats.totalScans++;
+    updateStats([](RFIDStats& st) { st.totalScans++; });
+    _scanStartUs = micros();
 
     // Enable RF field (includes settling delay on OFF->ON transition)
     enableRFField();
@@ -874,14 +1078,17 @@ DetectResult RFIDReader::detectCard(MFRC522::Uid& uid) {
         uint8_t bufferATQA[2];
         uint8_t bufferSize = sizeof(bufferATQA);
 
+        uint32_t wakeStartUs = micros();
         MFRC522::StatusCode status = requestA(bufferATQA, &bufferSize);
 
         if (status == MFRC522::STATUS_TIMEOUT && attempt == 1) {
             // No card in field — normal idle case. Fast return, no retry spent.
+            // Not recorded: idle polls would bury real wakeups in timeouts.
             disableRFField();
             silenceSPIPins();
             return DetectResult::NoCard;
         }
+        recordPhase(RFIDPhase::Wakeup, micros() - wakeStartUs);
 
         if (status != MFRC522::STATUS_OK) {
             LOG_INFO("[RFID-RETRY] requestA attempt %d failed (status=%d)\n",
@@ -897,10 +1104,13 @@ DetectResult RFIDReader::detectCard(MFRC522::Uid& uid) {
         if (status == MFRC522::STATUS_OK) {
             // Success
             memcpy(&uid, &_currentUid, sizeof(MFRC522::Uid));
-            _stats.successfulScans++;
+            updateStats([attempt](RFIDStats& st) {
+                st.successfulScans++;
+                st.detectAttempts[attempt - 1]++;
+                st.retryCount += attempt - 1;
+            });
             if (attempt > 1) {
                 LOG_INFO("[RFID-RETRY] detectCard recovered on attempt %d\n", attempt);
-                _stats.retryCount += (attempt - 1);
             }
 
             LOG_INFO("[RFID] Card detected: ");
@@ -922,7 +1132,7 @@ DetectResult RFIDReader::detectCard(MFRC522::Uid& uid) {
     // All retries exhausted — card was present but we couldn't talk to it.
     disableRFField();
     silenceSPIPins();
-    _stats.failedScans++;
+    updateStats([](RFIDStats& st) { st.failedScans++; });
     LOG_INFO("[RFID-FAIL] detectCard: all %d attempts exhausted\n",
              rfid_config::MAX_RETRIES);
     return DetectResult::CommFailed;
@@ -947,6 +1157,7 @@ String RFIDReader::extractNDEFText() {
     }
     disableRFField();
     silenceSPIPins();
+    recordPhase(RFIDPhase::Scan, micros() - _scanStartUs);
 
     return result;
 }
@@ -0,0 +1,184 @@
+#pragma once
+
+#include <Arduino.h>
+#include <atomic>
+#include "../config.h"
+#include "RFIDReader.h"
+#include "SPSCQueue.h"
+
+/**
+ * RFIDScanTask - Card detection + NDEF extraction off the UI core
+ *
+ * The MFRC522 sits on its own bit-banged software SPI (GPIO 22/27/35/3),
+ * NOT on the VSPI bus shared by SD and TFT. Running detectCard() and
+ * extractNDEFText() inline in the Core-1 main loop meant no card could be
+ * detected while a BMP was drawing or sendScan() was waiting on the
+ * network. This task owns the RFIDReader once started and posts one
+ * RFIDScanEvent per card interaction through a lock-free SPSC queue;
+ * Application consumes the events and applies the UI blocking policy.
+ *
+ * Handshake (one event in flight):
+ * - After posting any non-NoCard event the task disarms itself. It will
+ *   not touch the field again until the consumer calls rearm(), so a
+ *   token resting on the reader during a slow sendScan() can't flood the
+ *   queue with duplicates.
+ * - setPaused(true) stops scanning entirely (UI showing a token, status or
+ *   video modal). This preserves the GPIO 27 beeping mitigation: no RF/SPI
+ *   activity while audio is playing.
+ *
+ * Usage:
+ *   auto& scanTask = hal::RFIDScanTask::getInstance();
+ *   scanTask.start();                        // after RFIDReader::begin()
+ *   ...
+ *   scanTask.setPaused(ui.isBlockingRFID()); // each loop
+ *   hal::RFIDScanEvent ev;
+ *   if (scanTask.poll(ev)) { handle(ev); scanTask.rearm(); }
+ */
+
+namespace hal {
+
+enum class ScanEventResult {
+    TokenRead,    // Card selected and NDEF text extracted (tokenId set)
+    CommFailed,   // Card present but detect/select retries exhausted
+    ReadFailed    // Card selected but NDEF extraction retries exhausted
+};
+
+struct RFIDScanEvent {
+    ScanEventResult result = ScanEventResult::ReadFailed;
+    MFRC522::Uid uid = {};
+    String tokenId;               // Empty unless result == TokenRead
+    uint32_t startedAtMs = 0;     // millis() at start of the detect cycle
+    uint32_t detectedAtMs = 0;    // millis() when detectCard() returned
+    uint32_t completedAtMs = 0;   // millis() when the event was posted
+};
+
+class RFIDScanTask {
+public:
+    static RFIDScanTask& getInstance() {
+        static RFIDScanTask instance;
+        return instance;
+    }
+
+    /**
+     * Create the pinned scan task. RFIDReader::begin() must have succeeded
+     * first (GPIO 3 / Serial RX conflict is handled by the caller). Safe to
+     * call more than once. Starts paused — the consumer unpauses it once
+     * the UI is up.
+     */
+    bool start() {
+        if (_running) {
+            return true;
+        }
+        if (!RFIDReader::getInstance().isInitialized()) {
+            LOG_ERROR("RFID-TASK", "RFID reader not initialized");
+            return false;
+        }
+
+        BaseType_t ok = xTaskCreatePinnedToCore(
+            taskWrapper,
+            "RFIDScan",
+            freertos_config::RFID_TASK_STACK_SIZE,
+            this,
+            freertos_config::RFID_TASK_PRIORITY,
+            nullptr,
+            freertos_config::RFID_TASK_CORE
+        );
+        if (ok != pdPASS) {
+            LOG_ERROR("RFID-TASK", "xTaskCreatePinnedToCore failed");
+            return false;
+        }
+
+        _running = true;
+        LOG_INFO("[RFID-TASK] Scan task started on Core %d (interval %lu ms)\n",
+                 freertos_config::RFID_TASK_CORE,
+                 (unsigned long)timing::RFID_SCAN_INTERVAL_MS);
+        return true;
+    }
+
+    bool isRunning() const { return _running; }
+
+    // Consumer side (Core 1). Returns true and fills `out` if an event is
+    // waiting.
+    bool poll(RFIDScanEvent& out) { return _events.pop(out); }
+
+    // Consumer acknowledges the last event; the task may scan again.
+    void rearm() { _armed.store(true, std::memory_order_release); }
+
+    // UI policy gate. While paused the task leaves the RF field off.
+    void setPaused(bool paused) { _paused.store(paused, std::memory_order_release); }
+    bool isPaused() const { return _paused.load(std::memory_order_acquire); }
+
+    uint32_t droppedEvents() const { return _events.dropped(); }
+
+private:
+    RFIDScanTask() = default;
+    ~RFIDScanTask() = default;
+    RFIDScanTask(const RFIDScanTask&) = delete;
+    RFIDScanTask& operator=(const RFIDScanTask&) = delete;
+
+    static void taskWrapper(void* param) {
+        static_cast<RFIDScanTask*>(param)->taskLoop();
+    }
+
+    void taskLoop() {
+        LOG_INFO("[RFID-TASK] Scan loop running on Core %d\n", xPortGetCoreID());
+
+        auto& rfid = RFIDReader::getInstance();
+        TickType_t lastWake = xTaskGetTickCount();
+
+        while (true) {
+            // Fixed cadence measured from cycle start (same 500 ms rate limit
+            // the main loop used to apply). A long NDEF read simply makes the
+            // next cycle start immediately.
+            vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(timing::RFID_SCAN_INTERVAL_MS));
+
+            if (_paused.load(std::memory_order_acquire) ||
+                !_armed.load(std::memory_order_acquire)) {
+                continue;
+            }
+
+            RFIDScanEvent ev;
+            ev.startedAtMs = millis();
+
+            DetectResult det = rfid.detectCard(ev.uid);
+            if (det == DetectResult::NoCard) {
+                continue;  // Normal idle — nothing to report
+            }
+            ev.detectedAtMs = millis();
+
+            if (det == DetectResult::CommFailed) {
+                ev.result = ScanEventResult::CommFailed;
+            } else {
+                // extractNDEFText() handles its own retries/reSelect and
+                // disables the RF field on return.
+                ev.tokenId = rfid.extractNDEFText();
+                ev.result = ev.tokenId.length() > 0
+                    ? ScanEventResult::TokenRead
+                    : ScanEventResult::ReadFailed;
+            }
+            ev.completedAtMs = millis();
+
+            // Disarm BEFORE publishing so a rearm() that follows the
+            // consumer's pop() can never be overwritten by us.
+            _armed.store(false, std::memory_order_release);
+            if (!_events.push(std::move(ev))) {
+                LOG_INFO("[RFID-TASK] Event queue full, event dropped (%lu total)\n",
+                         (unsigned long)_events.dropped());
+                _armed.store(true, std::memory_order_release);
+            }
+
+            UBaseType_t stackRemaining = uxTaskGetStackHighWaterMark(NULL);
+            if (stackRemaining < 512) {
+                LOG_INFO("[RFID-TASK] ⚠️ WARNING: Low stack! Only %d bytes free\n",
+                         stackRemaining);
+            }
+        }
+    }
+
+    SPSCQueue<RFIDScanEvent, freertos_config::RFID_EVENT_QUEUE_DEPTH> _events;
+    std::atomic<bool> _paused{true};
+    std::atomic<bool> _armed{true};
+    bool _running = false;
+};
+
+} // namespace hal
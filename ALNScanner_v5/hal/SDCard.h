@@ -12,6 +12,8 @@
  * - RAII Lock class for automatic mutex management
  * - FreeRTOS mutex protection for Core 0/Core 1 synchronization
  * - Comprehensive logging for debugging
+ * - Lock wait/hold instrumentation (SDLockStats), long holds logged
+ * - Boot-time SPI clock tuning (SDClockProbe), SD_CLOCK_KHZ override
  *
  * Extracted from v4.1 monolithic codebase (lines 105, 151, 1241-1257, 2709-2718)
  */
@@ -20,6 +22,8 @@
 #include <SPI.h>
 #include <freertos/semphr.h>
 #include "../config.h"
+#include "SDLockStats.h"
+#include "SDClockProbe.h"
 
 namespace hal {
 
@@ -88,8 +92,10 @@ public:
         // Note: TFT also uses VSPI, so SD operations must not hold TFT lock
         _spi.begin(pins::SD_SCK, pins::SD_MISO, pins::SD_MOSI);
 
-        // Attempt SD card mount
-        if (!SD.begin(pins::SD_CS, _spi)) {
+        // Attempt SD card mount (conservative clock; tuneClock() raises it
+        // once config.txt has been read)
+        _clockKHz = sd_config::DEFAULT_CLOCK_KHZ;
+        if (!SD.begin(pins::SD_CS, _spi, _clockKHz * 1000)) {
             LOG_ERROR("SD-HAL", "SD card mount failed - no card present");
             _present = false;
             return false;
@@ -105,6 +111,64 @@ public:
         return true;
     }
 
+    /**
+     * @brief Pick the SPI clock for the rest of the session
+     * @param overrideKHz SD_CLOCK_KHZ from config.txt; 0 = probe
+     * @return Probe/verify result for the clock now in use
+     *
+     * Override: remount at that clock and verify it once, falling back to
+     * DEFAULT_CLOCK_KHZ if the pattern check fails. Otherwise probe
+     * sd_config::PROBE_CLOCKS_KHZ (see SDClockProbe.h). Call at boot before
+     * any other task touches the card — the card is unmounted between
+     * attempts. ~100 ms per clock at 16 KB.
+     */
+    inline SDProbeResult tuneClock(uint32_t overrideKHz) {
+        SDProbeResult result;
+        result.clockKHz = _clockKHz;
+        if (!_present) return result;
+
+        Lock lock("tuneClock", freertos_config::SD_MUTEX_LONG_TIMEOUT_MS);
+        if (!lock.acquired()) return result;
+
+        uint8_t buf[512];
+        auto mount = [this](uint32_t khz) {
+            SD.end();
+            _clockKHz = khz;
+            return SD.begin(pins::SD_CS, _spi, khz * 1000);
+        };
+        auto probe = [&buf](uint32_t khz, SDProbeResult& r) {
+            return sdprobe::verifyReadWrite(sd_config::PROBE_FILE, sd_config::PROBE_BYTES,
+                                            khz, buf, sizeof(buf), r);
+        };
+
+        if (overrideKHz) {
+            uint32_t one[] = { overrideKHz };
+            result = sdprobe::selectClock(one, 1, sd_config::DEFAULT_CLOCK_KHZ, mount, probe);
+            if (!result.ok) {
+                LOG_INFO("[SD-HAL] ⚠ SD_CLOCK_KHZ=%lu failed verification, using %lu kHz\n",
+                         (unsigned long)overrideKHz, (unsigned long)result.clockKHz);
+            }
+        } else {
+            result = sdprobe::selectClock(sd_config::PROBE_CLOCKS_KHZ,
+                                          sizeof(sd_config::PROBE_CLOCKS_KHZ) / sizeof(uint32_t),
+                                          sd_config::DEFAULT_CLOCK_KHZ, mount, probe);
+        }
+
+        _present = SD.cardType() != CARD_NONE;
+        _probe = result;
+        LOG_INFO("[SD-HAL] SPI clock %lu kHz (%s): write %lu.%02lu MB/s, read %lu.%02lu MB/s\n",
+                 (unsigned long)_clockKHz, overrideKHz ? "config" : "auto",
+                 (unsigned long)(result.writeKBps / 1000), (unsigned long)(result.writeKBps % 1000 / 10),
+                 (unsigned long)(result.readKBps / 1000), (unsigned long)(result.readKBps % 1000 / 10));
+        return result;
+    }
+
+    /**
+     * @brief SPI clock currently in use (kHz) and its measured throughput
+     */
+    inline uint32_t getClockKHz() const { return _clockKHz; }
+    inline SDProbeResult getProbeResult() const { return _probe; }
+
     /**
      * @brief Check if SD card is present and mounted
      * @return true if SD card is available, false otherwise
@@ -180,12 +244,22 @@ public:
             return true;
         }
 
+        uint32_t requestUs = micros();
         bool gotLock = xSemaphoreTake(_mutex, timeoutMs / portTICK_PERIOD_MS) == pdTRUE;
 
         if (!gotLock) {
+            portENTER_CRITICAL(&_statsMux);
+            _stats.recordTimeout(caller);
+            portEXIT_CRITICAL(&_statsMux);
             LOG_ERROR("SD-HAL", "Mutex timeout waiting for lock");
-            Serial.printf("        Caller: %s, Timeout: %lu ms\n", caller, timeoutMs);
+            Serial.printf("        Caller: %s, Timeout: %lu ms, holder: %s\n",
+                          caller, timeoutMs, _holder ? _holder : "?");
         } else {
+            _holdStartUs = micros();
+            _holder = caller;
+            portENTER_CRITICAL(&_statsMux);
+            _stats.recordAcquire(caller, _holdStartUs - requestUs);
+            portEXIT_CRITICAL(&_statsMux);
             LOG_DEBUG("[SD-HAL] Mutex acquired by %s\n", caller);
         }
 
@@ -200,11 +274,39 @@ public:
      */
     inline void giveMutex(const char* caller) {
         if (_mutex) {
+            uint32_t holdUs = micros() - _holdStartUs;
+            portENTER_CRITICAL(&_statsMux);
+            bool tooLong = _stats.recordRelease(caller, holdUs,
+                                                freertos_config::SD_LOCK_HOLD_WARN_MS * 1000);
+            portEXIT_CRITICAL(&_statsMux);
+            _holder = nullptr;
             xSemaphoreGive(_mutex);
+            if (tooLong) {
+                LOG_INFO("[SD-HAL] ⚠ %s held SD mutex %lu ms\n", caller,
+                         (unsigned long)(holdUs / 1000));
+            }
             LOG_DEBUG("[SD-HAL] Mutex released by %s\n", caller);
         }
     }
 
+    /**
+     * @brief Snapshot of mutex wait/hold timing since boot (or last reset)
+     *
+     * Includes the per-caller table (SD_STATS serial command). ~1 KB copy.
+     */
+    inline SDLockStats getLockStats() const {
+        portENTER_CRITICAL(&_statsMux);
+        SDLockStats copy = _stats;
+        portEXIT_CRITICAL(&_statsMux);
+        return copy;
+    }
+
+    inline void resetLockStats() {
+        portENTER_CRITICAL(&_statsMux);
+        _stats = SDLockStats();
+        portEXIT_CRITICAL(&_statsMux);
+    }
+
 private:
     // Singleton pattern - private constructors
     SDCard() = default;
@@ -216,12 +318,27 @@ private:
     static SPIClass _spi;           // VSPI bus for SD card
     static SemaphoreHandle_t _mutex;
     static bool _present;
+    static uint32_t _clockKHz;
+    static SDProbeResult _probe;
+
+    // Lock instrumentation. _holdStartUs/_holder are only written by the
+    // mutex holder; _stats is also touched on timeout, hence the spinlock.
+    static SDLockStats _stats;
+    static portMUX_TYPE _statsMux;
+    static uint32_t _holdStartUs;
+    static const char* volatile _holder;
 };
 
 // Static member initialization
 SPIClass SDCard::_spi(VSPI);
 SemaphoreHandle_t SDCard::_mutex = nullptr;
 bool SDCard::_present = false;
+uint32_t SDCard::_clockKHz = sd_config::DEFAULT_CLOCK_KHZ;
+SDProbeResult SDCard::_probe;
+SDLockStats SDCard::_stats;
+portMUX_TYPE SDCard::_statsMux = portMUX_INITIALIZER_UNLOCKED;
+uint32_t SDCard::_holdStartUs = 0;
+const char* volatile SDCard::_holder = nullptr;
 
 } // namespace hal
 
@@ -254,6 +371,8 @@ bool SDCard::_present = false;
  * 4. TIMEOUT VALUES
  *    - Standard timeout: 500ms (SD_MUTEX_TIMEOUT_MS)
  *    - Long operations: 60000ms (SD_MUTEX_LONG_TIMEOUT_MS)
+ *    - Holds over SD_LOCK_HOLD_WARN_MS are logged with the caller name;
+ *      long-running work (downloads) must lock per chunk, not per operation
  *    - Boot phase: Mutex may be nullptr, allow unprotected access
  *
  * 5. LOGGING LEVELS
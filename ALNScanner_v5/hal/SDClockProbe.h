@@ -0,0 +1,137 @@
+#pragma once
+
+/**
+ * @file SDClockProbe.h
+ * @brief Boot-time SD SPI clock selection (see hal::SDCard::tuneClock()).
+ *
+ * SD.begin() defaults to 4 MHz while the TFT on the same VSPI bus runs at
+ * 27 MHz; every BMP draw, audio read and asset write is bound by the SD
+ * clock. Cards, sockets and wiring differ in what they tolerate, so the
+ * clock is picked by experiment: remount at each candidate in ascending
+ * order, write a pseudo-random pattern to a scratch file, read it back and
+ * compare CRCs, and keep the fastest clock that passed. The first failure
+ * ends the probe — a marginal clock that sometimes passes is worse than a
+ * slightly slower one.
+ *
+ * Mounting is injected so the selection logic runs under the native mock.
+ */
+
+#include <Arduino.h>
+#include <SD.h>
+#include "../config.h"
+#include "../services/Crc32.h"
+
+namespace hal {
+
+struct SDProbeResult {
+    uint32_t clockKHz = 0;
+    uint32_t writeKBps = 0;   // 0 if the transfer took < 1 us (mock clock)
+    uint32_t readKBps = 0;
+    bool ok = false;
+};
+
+namespace sdprobe {
+
+inline uint32_t kbps(size_t bytes, uint32_t us) {
+    return us ? static_cast<uint32_t>(static_cast<uint64_t>(bytes) * 1000 / us) : 0;
+}
+
+// xorshift32 stream; a per-clock seed keeps a stale file from passing
+inline void fillPattern(uint8_t* buf, size_t len, uint32_t seed) {
+    uint32_t x = seed ? seed : 0x9E3779B9u;
+    for (size_t i = 0; i < len; i++) {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        buf[i] = static_cast<uint8_t>(x);
+    }
+}
+
+/**
+ * Write `bytes` of pattern to path, read back and CRC-compare.
+ * buf is scratch (>= 512 bytes is plenty); the file is removed afterwards.
+ */
+inline bool verifyReadWrite(const char* path, size_t bytes, uint32_t seed,
+                            uint8_t* buf, size_t bufLen, SDProbeResult& result) {
+    // Expected CRC, generated chunkwise with the same stream the writer uses
+    uint32_t writeCrc = 0;
+    uint32_t readCrc = 0;
+    uint32_t x = seed;
+    bool ok = true;
+
+    File f = SD.open(path, FILE_WRITE);
+    if (!f) return false;
+    uint32_t t0 = micros();
+    for (size_t done = 0; done < bytes; ) {
+        size_t n = bytes - done < bufLen ? bytes - done : bufLen;
+        fillPattern(buf, n, x);
+        x = x * 2654435761u + 1;   // next chunk seed
+        writeCrc = services::crc32(buf, n, writeCrc);
+        if (f.write(buf, n) != n) { ok = false; break; }
+        done += n;
+    }
+    f.flush();
+    f.close();
+    result.writeKBps = kbps(bytes, micros() - t0);
+
+    if (ok) {
+        f = SD.open(path, FILE_READ);
+        if (!f || f.size() != bytes) {
+            ok = false;
+        } else {
+            t0 = micros();
+            for (size_t done = 0; done < bytes; ) {
+                size_t n = bytes - done < bufLen ? bytes - done : bufLen;
+                if (f.read(buf, n) != n) { ok = false; break; }
+                readCrc = services::crc32(buf, n, readCrc);
+                done += n;
+            }
+            result.readKBps = kbps(bytes, micros() - t0);
+        }
+        if (f) f.close();
+    }
+
+    SD.remove(path);
+    return ok && readCrc == writeCrc;
+}
+
+/**
+ * Probe candidate clocks (ascending) and return the fastest that passed.
+ *
+ * mount(khz) -> bool remounts the card at khz; probe(khz, result) -> bool
+ * runs the pattern check. On return the card is mounted at the returned
+ * clock (remounted if the last attempt was a different, failed one).
+ * If nothing passed, result.ok is false and the card is back at fallbackKHz.
+ */
+template<typename MountFn, typename ProbeFn>
+SDProbeResult selectClock(const uint32_t* candidatesKHz, size_t count,
+                          uint32_t fallbackKHz, MountFn mount, ProbeFn probe) {
+    SDProbeResult best;
+    best.clockKHz = fallbackKHz;
+    uint32_t mountedKHz = fallbackKHz;
+
+    for (size_t i = 0; i < count; i++) {
+        SDProbeResult attempt;
+        attempt.clockKHz = candidatesKHz[i];
+        mountedKHz = candidatesKHz[i];
+        if (!mount(candidatesKHz[i]) || !probe(candidatesKHz[i], attempt)) {
+            LOG_INFO("[SD-HAL] Clock %lu kHz failed verification\n",
+                     (unsigned long)candidatesKHz[i]);
+            break;
+        }
+        attempt.ok = true;
+        best = attempt;
+        LOG_DEBUG("[SD-HAL] Clock %lu kHz ok: write %lu KB/s, read %lu KB/s\n",
+                  (unsigned long)attempt.clockKHz, (unsigned long)attempt.writeKBps,
+                  (unsigned long)attempt.readKBps);
+    }
+
+    if (mountedKHz != best.clockKHz && !mount(best.clockKHz)) {
+        // Card stopped answering even at the known-good clock
+        best.ok = false;
+    }
+    return best;
+}
+
+} // namespace sdprobe
+} // namespace hal
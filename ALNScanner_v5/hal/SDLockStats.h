@@ -0,0 +1,139 @@
+#pragma once
+
+/**
+ * @file SDLockStats.h
+ * @brief Wait and hold timing for the SD mutex (see hal::SDCard).
+ *
+ * SDCard::takeMutex()/giveMutex() report every acquisition here so a holder
+ * that keeps the card too long (the old whole-download asset stream held
+ * it for up to 60 s) shows up as a number instead of as stalled image
+ * draws and queue writes. Updates happen while the mutex is held, so they
+ * are already serialised; only timeouts are counted outside it.
+ *
+ * Alongside the global histograms, a fixed table keyed by the Lock caller
+ * name ("drawBMP", "queueScan", "stream:chunk", ...) keeps per-consumer
+ * counts and wait/hold totals — the SD_STATS serial command prints it.
+ * Caller names are string literals, so lookup compares pointers first and
+ * only falls back to strcmp. Once the table is full, unknown callers share
+ * the last row ("(other)").
+ */
+
+#include <Arduino.h>
+#include <string.h>
+#include "../config.h"
+#include "LatencyHistogram.h"
+
+namespace hal {
+
+struct SDCallerStats {
+    const char* name = nullptr;
+    uint32_t acquisitions = 0;
+    uint32_t timeouts = 0;
+    uint32_t longHolds = 0;
+    uint32_t maxWaitUs = 0;
+    uint32_t maxHoldUs = 0;
+    uint64_t totalWaitUs = 0;
+    uint64_t totalHoldUs = 0;
+};
+
+struct SDLockStats {
+    static constexpr uint8_t MAX_CALLERS = freertos_config::SD_LOCK_STATS_CALLERS;
+
+    LatencyHistogram wait;   // Request -> acquired
+    LatencyHistogram hold;   // Acquired -> released
+    uint32_t timeouts = 0;
+    uint32_t longHolds = 0;  // Holds above the warn threshold
+    const char* maxWaitCaller = nullptr;
+    const char* maxHoldCaller = nullptr;
+    SDCallerStats callers[MAX_CALLERS];
+    uint8_t callerCount = 0;
+
+    // Row for caller, claimed on first use; the last row is the overflow
+    SDCallerStats& callerRow(const char* caller) {
+        if (!caller) caller = "?";
+        for (uint8_t i = 0; i < callerCount; i++) {
+            if (callers[i].name == caller) return callers[i];
+        }
+        for (uint8_t i = 0; i < callerCount; i++) {
+            if (strcmp(callers[i].name, caller) == 0) return callers[i];
+        }
+        if (callerCount < MAX_CALLERS - 1) {
+            callers[callerCount].name = caller;
+            return callers[callerCount++];
+        }
+        if (callerCount < MAX_CALLERS) {
+            callers[callerCount++].name = "(other)";
+        }
+        return callers[MAX_CALLERS - 1];
+    }
+
+    void recordAcquire(const char* caller, uint32_t waitUs) {
+        if (waitUs >= wait.maxUs) maxWaitCaller = caller;
+        wait.record(waitUs);
+        SDCallerStats& row = callerRow(caller);
+        row.acquisitions++;
+        row.totalWaitUs += waitUs;
+        if (waitUs > row.maxWaitUs) row.maxWaitUs = waitUs;
+    }
+
+    void recordTimeout(const char* caller) {
+        timeouts++;
+        callerRow(caller).timeouts++;
+    }
+
+    // True if the hold exceeded warnUs (caller logs it)
+    bool recordRelease(const char* caller, uint32_t holdUs, uint32_t warnUs) {
+        if (holdUs >= hold.maxUs) maxHoldCaller = caller;
+        hold.record(holdUs);
+        SDCallerStats& row = callerRow(caller);
+        row.totalHoldUs += holdUs;
+        if (holdUs > row.maxHoldUs) row.maxHoldUs = holdUs;
+        if (holdUs <= warnUs) return false;
+        longHolds++;
+        row.longHolds++;
+        return true;
+    }
+
+    // Row indices ordered by total hold time, heaviest first
+    uint8_t sortedByHold(uint8_t* order) const {
+        for (uint8_t i = 0; i < callerCount; i++) {
+            uint8_t j = i;
+            while (j > 0 && callers[order[j - 1]].totalHoldUs < callers[i].totalHoldUs) {
+                order[j] = order[j - 1];
+                j--;
+            }
+            order[j] = i;
+        }
+        return callerCount;
+    }
+
+    void print() const {
+        Serial.printf("SD lock: %lu acquisitions, %lu timeouts, %lu holds > %lu ms\n",
+                      (unsigned long)hold.count, (unsigned long)timeouts,
+                      (unsigned long)longHolds,
+                      (unsigned long)freertos_config::SD_LOCK_HOLD_WARN_MS);
+        Serial.printf("  hold: mean %lu us, p99 <= %lu us, max %lu us (%s)\n",
+                      (unsigned long)hold.meanUs(), (unsigned long)hold.percentileUs(99),
+                      (unsigned long)hold.maxUs, maxHoldCaller ? maxHoldCaller : "-");
+        Serial.printf("  wait: mean %lu us, p99 <= %lu us, max %lu us (%s)\n",
+                      (unsigned long)wait.meanUs(), (unsigned long)wait.percentileUs(99),
+                      (unsigned long)wait.maxUs, maxWaitCaller ? maxWaitCaller : "-");
+    }
+
+    void printCallers() const {
+        uint8_t order[MAX_CALLERS];
+        uint8_t n = sortedByHold(order);
+        Serial.printf("%-28s %6s %4s %4s %9s %8s %9s %8s\n", "caller", "acq", "t/o",
+                      "long", "hold ms", "max us", "wait ms", "max us");
+        for (uint8_t k = 0; k < n; k++) {
+            const SDCallerStats& c = callers[order[k]];
+            Serial.printf("%-28.28s %6lu %4lu %4lu %9lu %8lu %9lu %8lu\n", c.name,
+                          (unsigned long)c.acquisitions, (unsigned long)c.timeouts,
+                          (unsigned long)c.longHolds,
+                          (unsigned long)(c.totalHoldUs / 1000), (unsigned long)c.maxHoldUs,
+                          (unsigned long)(c.totalWaitUs / 1000), (unsigned long)c.maxWaitUs);
+        }
+    }
+};
+
+} // namespace hal
@@ -0,0 +1,108 @@
+#pragma once
+
+/**
+ * @file SPSCQueue.h
+ * @brief Lock-free single-producer / single-consumer ring buffer.
+ *
+ * Used to hand events between FreeRTOS tasks pinned to different cores
+ * without a mutex on the hot path (e.g. RFIDScanTask on Core 0 posting
+ * scan events to the Core-1 main loop).
+ *
+ * Contract:
+ * - Exactly ONE task calls push(), exactly ONE task calls pop()/peek().
+ * - Capacity must be a power of two; one slot is NOT sacrificed (head/tail
+ *   are free-running counters, masked on access).
+ * - push() never blocks: a full queue returns false and bumps dropped().
+ *
+ * Pure C++17 (std::atomic only) so native tests can exercise it with
+ * std::thread on the host.
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+namespace hal {
+
+template <typename T, size_t Capacity>
+class SPSCQueue {
+    static_assert(Capacity >= 2, "SPSCQueue capacity must be >= 2");
+    static_assert((Capacity & (Capacity - 1)) == 0,
+                  "SPSCQueue capacity must be a power of two");
+
+public:
+    SPSCQueue() = default;
+    SPSCQueue(const SPSCQueue&) = delete;
+    SPSCQueue& operator=(const SPSCQueue&) = delete;
+
+    // Producer side. Moves `item` into the ring; returns false (and counts
+    // a drop) if the consumer hasn't caught up.
+    bool push(T&& item) {
+        const uint32_t head = _head.load(std::memory_order_relaxed);
+        const uint32_t tail = _tail.load(std::memory_order_acquire);
+        if (head - tail >= Capacity) {
+            _dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        _slots[head & MASK] = std::move(item);
+        _head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool push(const T& item) {
+        T copy(item);
+        return push(std::move(copy));
+    }
+
+    // Consumer side. Moves the oldest item into `out`; false when empty.
+    bool pop(T& out) {
+        const uint32_t tail = _tail.load(std::memory_order_relaxed);
+        const uint32_t head = _head.load(std::memory_order_acquire);
+        if (head == tail) {
+            return false;
+        }
+        out = std::move(_slots[tail & MASK]);
+        _slots[tail & MASK] = T();  // release heap-owning members (String) now
+        _tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side. The i-th oldest item, left in place; nullptr past the
+    // end. Valid until the consumer pops or discards it.
+    const T* peek(size_t i = 0) const {
+        const uint32_t tail = _tail.load(std::memory_order_relaxed);
+        const uint32_t head = _head.load(std::memory_order_acquire);
+        if (i >= (size_t)(head - tail)) {
+            return nullptr;
+        }
+        return &_slots[(tail + (uint32_t)i) & MASK];
+    }
+
+    // Consumer side. Drops the n oldest items (fewer if not that many).
+    void discard(size_t n) {
+        T item;
+        while (n-- > 0 && pop(item)) {
+        }
+    }
+
+    // Approximate from either side; exact from the consumer's own view.
+    size_t size() const {
+        return (size_t)(_head.load(std::memory_order_acquire) -
+                        _tail.load(std::memory_order_acquire));
+    }
+
+    bool empty() const { return size() == 0; }
+    static constexpr size_t capacity() { return Capacity; }
+    uint32_t dropped() const { return _dropped.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr uint32_t MASK = (uint32_t)(Capacity - 1);
+
+    T _slots[Capacity];
+    std::atomic<uint32_t> _head{0};     // written by producer only
+    std::atomic<uint32_t> _tail{0};     // written by consumer only
+    std::atomic<uint32_t> _dropped{0};  // written by producer only
+};
+
+} // namespace hal
@@ -15,10 +15,19 @@
 //   - Real touch events: >70ms duration
 //
 // SOLUTION: Pulse Width Measurement (validated Oct 19, 2025)
-//   - Measure how long GPIO36 stays LOW after interrupt
+//   - Measure how long GPIO36 stays LOW after the falling edge
 //   - Filter out pulses < 10ms (WiFi EMI)
 //   - Accept pulses >= 10ms (real touches)
 //
+// TIMING: ISR-timestamped, never blocks the main loop
+//   - CHANGE interrupt stamps both edges in IRAM; a completed press is
+//     queued as a TouchPulse (fall time + width)
+//   - poll() classifies queued pulses against the threshold, and also
+//     accepts a press that is still held once it has been LOW for the
+//     threshold - a tap fires ~10ms after contact instead of on release
+//   - EMI glitches shorter than ISR latency are seen as an edge with the
+//     pin already HIGH and are counted without ever being queued
+//
 // Reference: test-sketches/45-touch-wifi-emi/
 // Extracted from: ALNScanner1021_Orchestrator v4.1 (lines 1187-1207, 2867-2871)
 //
@@ -26,17 +35,66 @@
 
 namespace hal {
 
-// Forward declaration for ISR access to static members
-class TouchDriver;
+// A completed LOW pulse on the touch IRQ line, stamped by the ISR
+struct TouchPulse {
+    uint32_t seq;       // Press sequence number (bumped on each falling edge)
+    uint32_t fallUs;    // micros() at the falling edge
+    uint32_t widthUs;   // LOW duration
+};
+
+// A press that passed the EMI filter
+struct TouchEvent {
+    uint32_t pressedAtUs;   // micros() at the falling edge
+    uint32_t widthUs;       // LOW duration when accepted (>= threshold)
+    bool held;              // Accepted while still pressed (not yet released)
+};
 
-// Global ISR state (DRAM placement for ISR access)
-static volatile bool g_touchInterruptOccurred = false;
-static volatile uint32_t g_touchInterruptTime = 0;
+// Pulse queue depth - only needs to cover EMI bursts between two loop()
+// passes; overflow drops pulses (counted) rather than blocking the ISR
+constexpr uint8_t TOUCH_PULSE_QUEUE_DEPTH = 8;
+
+// Global ISR state (DRAM placement for ISR access). The ISR only touches
+// these plain arrays/counters - no template code that could live in flash.
+static portMUX_TYPE g_touchMux = portMUX_INITIALIZER_UNLOCKED;
+static volatile bool g_touchDown = false;
+static volatile uint32_t g_touchFallUs = 0;
+static volatile uint32_t g_touchSeq = 0;
+static volatile uint32_t g_touchGlitches = 0;
+static volatile uint32_t g_touchPulsesDropped = 0;
+static TouchPulse g_touchPulses[TOUCH_PULSE_QUEUE_DEPTH];
+static volatile uint8_t g_touchPulseHead = 0;
+static volatile uint8_t g_touchPulseTail = 0;
 
 // ISR function (outside class for proper IRAM placement)
 void IRAM_ATTR touchISR() {
-    g_touchInterruptOccurred = true;
-    g_touchInterruptTime = micros();
+    uint32_t now = micros();
+    bool low = (digitalRead(pins::TOUCH_IRQ) == LOW);
+
+    portENTER_CRITICAL_ISR(&g_touchMux);
+    if (low) {
+        // Falling edge. If we were already down a rising edge was missed;
+        // restart the press so the line can never latch "down".
+        g_touchDown = true;
+        g_touchFallUs = now;
+        g_touchSeq++;
+    } else if (g_touchDown) {
+        // Rising edge - queue the completed pulse for classification
+        g_touchDown = false;
+        uint8_t head = g_touchPulseHead;
+        if (static_cast<uint8_t>(head - g_touchPulseTail) < TOUCH_PULSE_QUEUE_DEPTH) {
+            TouchPulse& p = g_touchPulses[head % TOUCH_PULSE_QUEUE_DEPTH];
+            p.seq = g_touchSeq;
+            p.fallUs = g_touchFallUs;
+            p.widthUs = now - g_touchFallUs;
+            g_touchPulseHead = head + 1;
+        } else {
+            g_touchPulsesDropped++;
+        }
+    } else {
+        // Edge with the pin already back HIGH - EMI shorter than ISR latency
+        g_touchGlitches++;
+    }
+    portEXIT_CRITICAL_ISR(&g_touchMux);
 }
 
 class TouchDriver {
@@ -55,56 +113,57 @@ public:
         attachInterrupt(
             digitalPinToInterrupt(pins::TOUCH_IRQ),
             touchISR,
-            FALLING
+            CHANGE
         );
 
-        LOG_INFO("[TOUCH-HAL] Touch interrupt configured (GPIO36 FALLING edge)\n");
+        LOG_INFO("[TOUCH-HAL] Touch interrupt configured (GPIO36 CHANGE, ISR-timed EMI filter)\n");
         return true;
     }
 
-    // Touch Detection API
-    bool isTouched() const {
-        return g_touchInterruptOccurred;
-    }
-
-    void clearTouch() {
-        g_touchInterruptOccurred = false;
-    }
-
-    uint32_t getTouchTime() const {
-        return g_touchInterruptTime;
-    }
-
-    // WiFi EMI Filtering
-    uint32_t measurePulseWidth() {
-        uint32_t startUs = micros();
-        const uint32_t TIMEOUT_US = 500000;  // 500ms max measurement
-
-        // Poll GPIO36 until it goes HIGH or timeout expires
-        while (digitalRead(pins::TOUCH_IRQ) == LOW) {
-            if (micros() - startUs > TIMEOUT_US) {
-                return TIMEOUT_US;  // Still LOW after timeout
+    // Touch Detection API (non-blocking)
+    // Returns the next press that passed the EMI filter. Each physical press
+    // is reported at most once, either while held or on release.
+    bool poll(TouchEvent& out) {
+        TouchPulse pulse;
+        while (popPulse(pulse)) {
+            if (pulse.seq == _acceptedSeq) {
+                continue;  // Already reported while held - this is its release
             }
+            if (pulse.widthUs < timing::TOUCH_PULSE_WIDTH_THRESHOLD_US) {
+                _emiRejected++;
+                continue;
+            }
+            _acceptedSeq = pulse.seq;
+            _accepted++;
+            out = {pulse.fallUs, pulse.widthUs, false};
+            return true;
         }
 
-        return micros() - startUs;
-    }
+        // No completed pulse - accept a press that has been held long enough
+        portENTER_CRITICAL(&g_touchMux);
+        bool down = g_touchDown;
+        uint32_t fallUs = g_touchFallUs;
+        uint32_t seq = g_touchSeq;
+        portEXIT_CRITICAL(&g_touchMux);
 
-    bool isValidTouch() {
-        if (!g_touchInterruptOccurred) {
+        if (!down || seq == _acceptedSeq) {
             return false;
         }
-
-        // Stabilization delay (let GPIO settle)
-        delayMicroseconds(100);
-
-        // Measure pulse width
-        uint32_t pulseWidthUs = measurePulseWidth();
-
-        // Check against threshold (10ms = 10000 microseconds)
-        return (pulseWidthUs >= timing::TOUCH_PULSE_WIDTH_THRESHOLD_US);
+        uint32_t widthUs = micros() - fallUs;
+        if (widthUs < timing::TOUCH_PULSE_WIDTH_THRESHOLD_US) {
+            return false;
+        }
+        _acceptedSeq = seq;
+        _accepted++;
+        out = {fallUs, widthUs, true};
+        return true;
     }
 
+    // Diagnostics
+    uint32_t getAcceptedCount() const { return _accepted; }
+    uint32_t getRejectedCount() const { return _emiRejected + g_touchGlitches; }
+    uint32_t getDroppedCount() const { return g_touchPulsesDropped; }
+
 private:
     // Private constructor (singleton pattern)
     TouchDriver() = default;
@@ -113,6 +172,23 @@ private:
     // Prevent copying
     TouchDriver(const TouchDriver&) = delete;
     TouchDriver& operator=(const TouchDriver&) = delete;
+
+    bool popPulse(TouchPulse& out) {
+        bool popped = false;
+        portENTER_CRITICAL(&g_touchMux);
+        uint8_t tail = g_touchPulseTail;
+        if (tail != g_touchPulseHead) {
+            out = g_touchPulses[tail % TOUCH_PULSE_QUEUE_DEPTH];
+            g_touchPulseTail = tail + 1;
+            popped = true;
+        }
+        portEXIT_CRITICAL(&g_touchMux);
+        return popped;
+    }
+
+    uint32_t _acceptedSeq = 0;
+    uint32_t _accepted = 0;
+    uint32_t _emiRejected = 0;
 };
 
 } // namespace hal
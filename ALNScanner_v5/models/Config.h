@@ -5,6 +5,33 @@
 
 namespace models {
 
+// How asset sync fetches files (ASSET_FETCH, services/AssetService.h)
+enum class AssetFetchMode : uint8_t {
+    Single,    // One orchestrator request per file
+    Pipeline,  // One connection for the run, next GET sent while a body drains
+    Bundle     // One tar stream of everything pending; pipeline for the rest
+};
+
+inline const char* assetFetchModeName(AssetFetchMode mode) {
+    switch (mode) {
+        case AssetFetchMode::Single: return "single";
+        case AssetFetchMode::Pipeline: return "pipeline";
+        case AssetFetchMode::Bundle: return "bundle";
+    }
+    return "pipeline";
+}
+
+// "single" / "pipeline" / "bundle", case-insensitive; false if none
+inline bool parseAssetFetchMode(const String& value, AssetFetchMode& out) {
+    String v = value;
+    v.toLowerCase();
+    if (v == "single") out = AssetFetchMode::Single;
+    else if (v == "pipeline") out = AssetFetchMode::Pipeline;
+    else if (v == "bundle") out = AssetFetchMode::Bundle;
+    else return false;
+    return true;
+}
+
 // Device configuration structure (from v4.1 lines 131-138)
 struct DeviceConfig {
     // WiFi credentials
@@ -21,8 +48,14 @@ struct DeviceConfig {
     // Feature flags
     bool syncTokens = true;     // Sync token database from orchestrator
     bool syncAssets = true;     // Sync BMP images and audio files at boot
+    bool assetPack = false;     // Sync assets into /assets.pack (hal::AssetPack)
+    AssetFetchMode assetFetch = AssetFetchMode::Pipeline;
+    bool pushChannel = true;    // Orchestrator event stream instead of /health polling
     bool debugMode = false;     // Enable serial commands, defer RFID init
 
+    // SD SPI clock in kHz; 0 = auto-tune at boot (hal::SDCard::tuneClock)
+    uint32_t sdClockKHz = 0;
+
     // Default constructor
     DeviceConfig() = default;
 
@@ -88,7 +121,15 @@ struct DeviceConfig {
         Serial.printf("Device ID: %s\n", deviceID.length() > 0 ? deviceID.c_str() : "(auto-generate)");
         Serial.printf("Sync Tokens: %s\n", syncTokens ? "true" : "false");
         Serial.printf("Sync Assets: %s\n", syncAssets ? "true" : "false");
+        Serial.printf("Asset Pack: %s\n", assetPack ? "true" : "false");
+        Serial.printf("Asset Fetch: %s\n", assetFetchModeName(assetFetch));
+        Serial.printf("Push Channel: %s\n", pushChannel ? "true" : "false");
         Serial.printf("Debug Mode: %s\n", debugMode ? "true" : "false");
+        if (sdClockKHz) {
+            Serial.printf("SD Clock: %lu kHz\n", (unsigned long)sdClockKHz);
+        } else {
+            Serial.println("SD Clock: auto");
+        }
         Serial.println("============================\n");
     }
 };
@@ -0,0 +1,326 @@
+#pragma once
+
+/**
+ * @file AssetConnection.h
+ * @brief One keep-alive connection carrying a whole asset sync, with
+ *        pipelined GETs and an optional single-stream bundle.
+ *
+ * Per-file httpGETStreamToSD() waits a full request/response round trip
+ * before each file, and pays a handshake whenever the shared orchestrator
+ * connection was busy or idle-closed in between. Here the sync owns its
+ * connection for the whole run. request() writes the GET straight onto the
+ * socket, so with ASSET_PIPELINE_DEPTH requests in flight the server is
+ * already sending file N+1 while file N is written and verified on SD;
+ * receive() reads the responses back in request order.
+ *
+ * Recovery: requests not yet answered are remembered. If the server closes
+ * (keep-alive limit, error) or a body can't be read in full, the
+ * connection is dropped and the next call reconnects and sends them again.
+ * A non-200 or wrong-size response is skipped by its Content-Length
+ * without losing the connection. Only Content-Length responses are
+ * accepted on the pipelined path (the static asset route always sends
+ * one); the bundle is requested with HTTP/1.0 and read to close.
+ *
+ * Main task only, one instance at a time (shares AssetWriter's buffer).
+ */
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <WiFiClientSecure.h>
+#include <deque>
+#include <memory>
+#include "../config.h"
+#include "AssetStream.h"
+#include "AssetWriter.h"
+
+namespace services {
+
+class AssetConnection {
+public:
+    AssetConnection(const String& baseUrl, uint32_t timeoutMs) : _timeoutMs(timeoutMs) {
+        _valid = parseHttpTarget(baseUrl, _target);
+    }
+
+    ~AssetConnection() { close(); }
+
+    AssetConnection(const AssetConnection&) = delete;
+    AssetConnection& operator=(const AssetConnection&) = delete;
+
+    bool valid() const { return _valid; }
+
+    // Stop issuing requests: the server refused CONNECT_ATTEMPTS in a row
+    bool broken() const { return _connectFailures >= CONNECT_ATTEMPTS; }
+
+    /**
+     * @brief Send GET path (relative to the base URL) behind those in flight
+     * @return false if it could not be sent now; it is retried by receive()
+     */
+    bool request(const String& path) {
+        _pending.push_back(path);
+        if (_sent + 1 == _pending.size() && connected()) {
+            if (!sendRequest(path)) return false;
+            _sent++;
+            return true;
+        }
+        if (_sent == 0) return connect();  // Nothing left to read on the old one
+        return false;
+    }
+
+    size_t inFlight() const { return _pending.size(); }
+
+    /**
+     * @brief Read the response to the oldest request into sink (verified)
+     * @return true once committed; the request is consumed either way
+     */
+    bool receive(AssetSink& sink, size_t expectedSize, const String& expectedSha1,
+                 AssetWriter::Progress onProgress = nullptr) {
+        if (_pending.empty()) return false;
+        String path = _pending.front();
+
+        HttpResponseHead head;
+        bool gotHead = readHead(head);
+        _pending.pop_front();
+        if (_sent > 0) _sent--;
+        if (!gotHead) {
+            Serial.printf("[ASSET-CONN] No response for %s\n", path.c_str());
+            return false;
+        }
+
+        bool ok = receiveBody(path, head, sink, expectedSize, expectedSha1, onProgress);
+        if (!head.keepAlive) close();  // Later requests go out again on reconnect
+        return ok;
+    }
+
+    /**
+     * @brief POST json as HTTP/1.0 and pass the response body to
+     *        onBody(const uint8_t*, size_t) -> bool until the server closes
+     * @return HTTP status; -1 if no usable response. Only with nothing in
+     *         flight; the connection is closed afterwards.
+     */
+    template <typename Fn>
+    int exchange(const String& path, const String& json, Fn onBody) {
+        if (!_pending.empty()) return -1;
+        if (!connected() && !connect()) return -1;
+
+        String head = httpRequestHead("POST", _target, path, false, "application/json",
+                                      json.length());
+        if (!writeAll(head) || !writeAll(json)) {
+            close();
+            return -1;
+        }
+        _requests++;
+
+        HttpResponseHead resp;
+        if (readHeadOnce(resp) != HeadResult::Ok || resp.chunked) {
+            close();
+            return -1;
+        }
+        if (resp.status == 200) {
+            long remaining = resp.contentLength;
+            while (remaining != 0) {
+                size_t want = remaining < 0 || remaining > limits::ASSET_READ_SLICE
+                                  ? limits::ASSET_READ_SLICE
+                                  : static_cast<size_t>(remaining);
+                size_t n = readSome(readSlice(), want);
+                if (n == 0) break;
+                if (remaining > 0) remaining -= n;
+                if (!onBody(static_cast<const uint8_t*>(readSlice()), n)) break;
+                yield();
+            }
+        }
+        close();
+        return resp.status;
+    }
+
+    uint32_t handshakes() const { return _handshakes; }
+    uint32_t reconnects() const { return _handshakes > 0 ? _handshakes - 1 : 0; }
+    uint32_t requests() const { return _requests; }
+
+private:
+    static constexpr uint8_t CONNECT_ATTEMPTS = 3;
+
+    enum class HeadResult { Ok, Closed, Error };
+
+    // Socket read slice for skipped and bundle bodies (.bss, see AssetWriter)
+    static uint8_t* readSlice() {
+        static uint8_t slice[limits::ASSET_READ_SLICE];
+        return slice;
+    }
+
+    bool connected() { return _socket && _socket->connected(); }
+
+    bool connect() {
+        close();
+        if (!_valid || broken()) return false;
+        if (ESP.getFreeHeap() < (uint32_t)limits::ASSET_MIN_FREE_HEAP) {
+            Serial.printf("[ASSET-CONN] Low heap %u, not connecting\n", ESP.getFreeHeap());
+            _connectFailures++;
+            return false;
+        }
+        if (_target.secure) {
+            auto* secure = new WiFiClientSecure();
+            secure->setInsecure();  // Same policy as HTTPHelper
+            _socket.reset(secure);
+        } else {
+            _socket.reset(new WiFiClient());
+        }
+        if (!_socket->connect(_target.host.c_str(), _target.port)) {
+            Serial.printf("[ASSET-CONN] Connect to %s:%u failed\n",
+                          _target.host.c_str(), _target.port);
+            _socket.reset();
+            _connectFailures++;
+            return false;
+        }
+        _handshakes++;
+        _connectFailures = 0;
+
+        // The server may close after answering the first few (keep-alive
+        // request limit); the rest wait for the next reconnect
+        for (const auto& path : _pending) {
+            if (!sendRequest(path)) break;
+            _sent++;
+        }
+        return _sent > 0 || _pending.empty();
+    }
+
+    void close() {
+        _sent = 0;
+        if (!_socket) return;
+        _socket->stop();
+        _socket.reset();
+    }
+
+    bool writeAll(const String& data) {
+        size_t n = _socket->write(reinterpret_cast<const uint8_t*>(data.c_str()),
+                                  data.length());
+        return n == data.length();
+    }
+
+    // A failed write leaves the socket alone: responses to earlier requests
+    // may still be waiting in it. Unsent requests go out on reconnect.
+    bool sendRequest(const String& path) {
+        if (!_socket || !writeAll(httpRequestHead("GET", _target, path, true))) return false;
+        _requests++;
+        return true;
+    }
+
+    // Up to max bytes; 0 once the peer closed or stayed silent too long
+    size_t readSome(uint8_t* buf, size_t max) {
+        uint32_t start = millis();
+        while (true) {
+            int avail = _socket->available();
+            if (avail > 0) {
+                int n = _socket->read(buf, (size_t)avail < max ? (size_t)avail : max);
+                if (n > 0) return static_cast<size_t>(n);
+            }
+            if (!_socket->connected() || millis() - start > _timeoutMs) return 0;
+            delay(2);
+        }
+    }
+
+    // Byte at a time, so nothing of the body (or the next response) is taken
+    HeadResult readHeadOnce(HttpResponseHead& head) {
+        bool any = false;
+        uint32_t last = millis();
+        while (!head.done()) {
+            if (head.failed()) return HeadResult::Error;
+            int c = _socket->available() > 0 ? _socket->read() : -1;
+            if (c < 0) {
+                if (!_socket->connected()) return any ? HeadResult::Error : HeadResult::Closed;
+                if (millis() - last > _timeoutMs) return HeadResult::Error;
+                delay(2);
+                continue;
+            }
+            any = true;
+            last = millis();
+            uint8_t b = static_cast<uint8_t>(c);
+            head.feed(&b, 1);
+        }
+        return HeadResult::Ok;
+    }
+
+    // Oldest pending head. If it never went out on this socket, or the
+    // server closed before answering it, one reconnect re-sends everything
+    // pending.
+    bool readHead(HttpResponseHead& head) {
+        for (int attempt = 0; attempt < 2; attempt++) {
+            if (_sent == 0 && !connect()) return false;
+            head = HttpResponseHead();
+            HeadResult r = readHeadOnce(head);
+            if (r == HeadResult::Ok) return true;
+            close();
+            if (r == HeadResult::Error) return false;
+        }
+        return false;
+    }
+
+    // Discard n body bytes to stay in step with the pipeline
+    bool skip(size_t n) {
+        while (n > 0) {
+            size_t got = readSome(readSlice(), n < (size_t)limits::ASSET_READ_SLICE
+                                                   ? n : limits::ASSET_READ_SLICE);
+            if (got == 0) {
+                close();
+                return false;
+            }
+            n -= got;
+        }
+        return true;
+    }
+
+    bool receiveBody(const String& path, const HttpResponseHead& head, AssetSink& sink,
+                     size_t expectedSize, const String& expectedSha1,
+                     AssetWriter::Progress onProgress) {
+        if (head.chunked || head.contentLength < 0) {
+            Serial.printf("[ASSET-CONN] %s: no Content-Length\n", path.c_str());
+            close();
+            return false;
+        }
+        size_t len = static_cast<size_t>(head.contentLength);
+        if (head.status != 200) {
+            Serial.printf("[ASSET-CONN] HTTP %d for %s\n", head.status, path.c_str());
+            skip(len);
+            return false;
+        }
+        if (len != expectedSize) {
+            Serial.printf("[ASSET-CONN] %s: size mismatch %u != %u\n", path.c_str(),
+                          (unsigned)len, (unsigned)expectedSize);
+            skip(len);
+            return false;
+        }
+
+        AssetWriter writer(sink, expectedSize, expectedSha1, onProgress);
+        if (!writer.open()) {
+            skip(len);
+            return false;
+        }
+        while (writer.received() < len) {
+            size_t room;
+            uint8_t* dst = writer.space(room);
+            size_t want = len - writer.received();
+            size_t n = readSome(dst, want < room ? want : room);
+            if (n == 0) {
+                close();  // Mid-body: the stream position is lost
+                return false;
+            }
+            if (!writer.produced(n)) {
+                skip(len - writer.received());
+                return false;
+            }
+            yield();
+        }
+        return writer.finish();
+    }
+
+    HttpTarget _target;
+    bool _valid = false;
+    uint32_t _timeoutMs;
+    std::unique_ptr<WiFiClient> _socket;
+    std::deque<String> _pending;  // Requested, not yet answered
+    size_t _sent = 0;             // Leading _pending entries written on _socket
+    uint8_t _connectFailures = 0;
+    uint32_t _handshakes = 0;
+    uint32_t _requests = 0;
+};
+
+} // namespace services
@@ -2,21 +2,38 @@
 
 /**
  * @file AssetManifestDiff.h
- * @brief Pure-logic manifest diffing used by AssetService.
+ * @brief Compact asset manifest tables, their streaming parser, and the
+ *        manifest diffing used by AssetService.
  *
- * Kept in its own header so PlatformIO native tests can exercise the diff
- * and path-construction behaviour without pulling in SD/WiFi/mbedtls.
- * AssetService.h includes this header.
+ * Manifest format, remote and local alike:
+ *
+ *   {"images": {"<tokenId>": {"sha1": "<40 hex>", "size": 230454}, ...},
+ *    "audio":  {"<tokenId>": {"sha1": "...", "size": 40000, "ext": "wav"}, ...}}
+ *
+ * The manifest is never held as text or as a JSON document. Parser takes
+ * it in whatever slices the socket or SD card deliver and keeps only what
+ * a sync uses: one 32-byte Record per entry plus its tokenId in a shared
+ * name pool, ~40 bytes an entry. Peak heap for a sync is therefore
+ * proportional to the number of entries rather than to the JSON text, and
+ * the remote and local tables are diffed by binary search.
+ *
+ * Kept in its own header, free of SD/WiFi/mbedtls/ArduinoJson, so
+ * PlatformIO native tests can exercise parsing, diffing and path
+ * construction byte by byte. AssetService.h includes this header.
  */
 
 #include <Arduino.h>
-#include <ArduinoJson.h>
+#include <algorithm>
+#include <cstring>
 #include <vector>
 #include "../config.h"
 
 namespace services {
 namespace manifest {
 
+// Same values as hal::AssetPack::Type
+enum AssetType : uint8_t { IMAGE = 0, AUDIO = 1 };
+
 // One file pending download. `ext` is empty for images (always ".bmp").
 struct Pending {
     String type;       // "image" or "audio"
@@ -26,59 +43,637 @@ struct Pending {
     String ext;
 };
 
-// Append every (tokenId -> {sha1, size, ext?}) entry from `remoteSection`
-// whose hash doesn't match the matching entry in `localSection` (or which
-// is missing locally entirely). Skips entries missing required fields.
-inline void diffSection(JsonObjectConst remoteSection,
-                        JsonObjectConst localSection,
-                        const char* type,
-                        std::vector<Pending>& out) {
-    for (JsonPairConst kv : remoteSection) {
-        const char* tokenId = kv.key().c_str();
-        const char* remoteSha = kv.value()["sha1"] | "";
-        size_t remoteSize = kv.value()["size"] | 0;
-        const char* remoteExt = kv.value()["ext"] | "";
-        if (!remoteSha[0] || remoteSize == 0) continue;
-
-        const char* localSha = "";
-        if (!localSection.isNull() && localSection.containsKey(tokenId)) {
-            localSha = localSection[tokenId]["sha1"] | "";
-        }
-        if (strcmp(localSha, remoteSha) == 0) continue;
+// One manifest entry. Entries without a usable sha1 or size are kept so
+// their local copies are not pruned, but are never downloaded.
+struct Record {
+    uint8_t sha1[20];
+    uint32_t size;
+    uint16_t name;     // tokenId: offset into the table's name pool
+    uint8_t type;      // AssetType
+    uint8_t hasSha1;
+    char ext[4];       // Audio extension without the dot, "" = wav
+};
+static_assert(sizeof(Record) == 32, "manifest::Record should stay 32 bytes");
+
+/**
+ * Entries sorted by (type, tokenId), images first. Bulk loading appends
+ * with add() and sorts once in finalize(); upsert()/remove() keep the
+ * order for per-file commits. Names of removed entries stay in the pool
+ * until the table is cleared.
+ */
+class Table {
+public:
+    static constexpr size_t TOKEN_ID_MAX = 24;  // Same as hal::AssetPack
+
+    void clear() {
+        _records.clear();
+        _names.clear();
+        _sorted = true;
+    }
+
+    size_t size() const { return _records.size(); }
+    bool empty() const { return _records.empty(); }
+    bool full() const { return _records.size() >= (size_t)limits::MANIFEST_MAX_ENTRIES; }
+    const Record& operator[](size_t i) const { return _records[i]; }
+    const char* tokenId(const Record& r) const { return &_names[r.name]; }
+
+    // Heap held by the table
+    size_t heapBytes() const {
+        return _records.capacity() * sizeof(Record) + _names.capacity();
+    }
+
+    /**
+     * @brief Append an entry (call finalize() before lookups)
+     * @param sha1Hex 40 hex digits; anything else leaves the entry without one
+     * @return false if the tokenId or ext is unusable or the table is full
+     */
+    bool add(uint8_t type, const char* tokenId, const char* sha1Hex, uint32_t size,
+             const char* ext) {
+        Record r;
+        size_t idLen = strlen(tokenId);
+        if (full() || type > AUDIO || idLen == 0 || idLen > TOKEN_ID_MAX ||
+            !fill(r, sha1Hex, size, ext) || _names.size() + idLen + 1 > 0xFFFF) {
+            return false;
+        }
+        r.type = type;
+        r.name = static_cast<uint16_t>(_names.size());
+        _names.insert(_names.end(), tokenId, tokenId + idLen + 1);
+        _records.push_back(r);
+        _sorted = false;
+        return true;
+    }
+
+    // Sort and drop duplicate tokenIds (the later entry wins, as in JSON)
+    void finalize() {
+        if (_sorted) return;
+        // Pool offsets grow with insertion order: the tie-break keeps the last
+        std::sort(_records.begin(), _records.end(), [this](const Record& a, const Record& b) {
+            int c = compare(a, b.type, tokenId(b));
+            return c != 0 ? c < 0 : a.name < b.name;
+        });
+        size_t out = 0;
+        for (size_t i = 0; i < _records.size(); i++) {
+            bool last = i + 1 == _records.size() ||
+                        compare(_records[i], _records[i + 1].type, tokenId(_records[i + 1])) != 0;
+            if (last) _records[out++] = _records[i];
+        }
+        _records.resize(out);
+        _records.shrink_to_fit();
+        _names.shrink_to_fit();
+        _sorted = true;
+    }
 
+    const Record* find(uint8_t type, const char* tokenId) const {
+        auto it = lowerBound(type, tokenId);
+        if (it == _records.end() || compare(*it, type, tokenId) != 0) return nullptr;
+        return &*it;
+    }
+
+    // Insert or replace one entry, keeping the order
+    bool upsert(uint8_t type, const char* tokenId, const char* sha1Hex, uint32_t size,
+                const char* ext) {
+        finalize();
+        auto it = lowerBound(type, tokenId);
+        if (it != _records.end() && compare(*it, type, tokenId) == 0) {
+            Record r = *it;
+            if (!fill(r, sha1Hex, size, ext)) return false;
+            *it = r;
+            return true;
+        }
+        size_t at = it - _records.begin();
+        if (!add(type, tokenId, sha1Hex, size, ext)) return false;
+        std::rotate(_records.begin() + at, _records.end() - 1, _records.end());
+        _sorted = true;
+        return true;
+    }
+
+    void remove(size_t i) { _records.erase(_records.begin() + i); }
+
+    String sha1Hex(const Record& r) const {
+        if (!r.hasSha1) return String();
+        char hex[41];
+        for (int i = 0; i < 20; i++) snprintf(&hex[i * 2], 3, "%02x", r.sha1[i]);
+        return String(hex);
+    }
+
+    Pending pending(size_t i) const {
+        const Record& r = _records[i];
         Pending p;
-        p.type = type;
-        p.tokenId = tokenId;
-        p.sha1 = remoteSha;
-        p.size = remoteSize;
-        p.ext = remoteExt;
-        out.push_back(p);
+        p.type = r.type == IMAGE ? "image" : "audio";
+        p.tokenId = tokenId(r);
+        p.sha1 = sha1Hex(r);
+        p.size = r.size;
+        p.ext = r.ext;
+        return p;
     }
-}
 
-// Convenience: diff both sections in canonical (images-first) order so
-// the pending list index is stable for progress UI.
-inline std::vector<Pending> diff(const JsonDocument& remote,
-                                 const JsonDocument& local) {
-    std::vector<Pending> out;
-    diffSection(remote["images"].as<JsonObjectConst>(),
-                local["images"].as<JsonObjectConst>(),
-                "image", out);
-    diffSection(remote["audio"].as<JsonObjectConst>(),
-                local["audio"].as<JsonObjectConst>(),
-                "audio", out);
+    /**
+     * @brief Serialise in the manifest format to out.print(const char*)
+     * @return false if any print came up short
+     */
+    template <typename Out>
+    bool writeJson(Out& out) const {
+        bool ok = put(out, "{\"images\":{");
+        bool first = true;
+        uint8_t section = IMAGE;
+        for (const Record& r : _records) {
+            if (r.type != section) {
+                ok = ok && put(out, "},\"audio\":{");
+                section = AUDIO;
+                first = true;
+            }
+            ok = ok && put(out, first ? "\"" : ",\"") && putEscaped(out, tokenId(r)) &&
+                 put(out, "\":{");
+            if (r.hasSha1) {
+                ok = ok && put(out, "\"sha1\":\"") && put(out, sha1Hex(r).c_str()) &&
+                     put(out, "\",");
+            }
+            char num[24];
+            snprintf(num, sizeof(num), "\"size\":%lu", (unsigned long)r.size);
+            ok = ok && put(out, num);
+            if (r.ext[0]) ok = ok && put(out, ",\"ext\":\"") && put(out, r.ext) && put(out, "\"");
+            ok = ok && put(out, "}");
+            first = false;
+        }
+        if (section == IMAGE) ok = ok && put(out, "},\"audio\":{");
+        return ok && put(out, "}}");
+    }
+
+private:
+    static int hexNibble(char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+
+    // sha1/size/ext of r from their manifest forms
+    static bool fill(Record& r, const char* sha1Hex, uint32_t size, const char* ext) {
+        size_t extLen = ext ? strlen(ext) : 0;
+        if (extLen >= sizeof(r.ext)) return false;
+        memset(r.ext, 0, sizeof(r.ext));
+        if (extLen) memcpy(r.ext, ext, extLen);
+        r.size = size;
+        r.hasSha1 = sha1Hex && strlen(sha1Hex) == 40;
+        for (int i = 0; i < 20 && r.hasSha1; i++) {
+            int hi = hexNibble(sha1Hex[i * 2]);
+            int lo = hexNibble(sha1Hex[i * 2 + 1]);
+            if (hi < 0 || lo < 0) r.hasSha1 = 0;
+            else r.sha1[i] = static_cast<uint8_t>(hi << 4 | lo);
+        }
+        if (!r.hasSha1) memset(r.sha1, 0, sizeof(r.sha1));
+        return true;
+    }
+
+    int compare(const Record& a, uint8_t type, const char* tokenId) const {
+        if (a.type != type) return a.type < type ? -1 : 1;
+        return strcmp(this->tokenId(a), tokenId);
+    }
+
+    std::vector<Record>::iterator lowerBound(uint8_t type, const char* tokenId) {
+        return std::lower_bound(_records.begin(), _records.end(), tokenId,
+                                [this, type](const Record& r, const char* id) {
+                                    return compare(r, type, id) < 0;
+                                });
+    }
+
+    std::vector<Record>::const_iterator lowerBound(uint8_t type, const char* tokenId) const {
+        return std::lower_bound(_records.begin(), _records.end(), tokenId,
+                                [this, type](const Record& r, const char* id) {
+                                    return compare(r, type, id) < 0;
+                                });
+    }
+
+    template <typename Out>
+    static bool put(Out& out, const char* s) {
+        size_t n = strlen(s);
+        return out.print(s) == n;
+    }
+
+    template <typename Out>
+    static bool putEscaped(Out& out, const char* s) {
+        char buf[TOKEN_ID_MAX * 6 + 1];
+        size_t n = 0;
+        for (; *s; s++) {
+            unsigned char c = static_cast<unsigned char>(*s);
+            if (c == '"' || c == '\\') {
+                buf[n++] = '\\';
+                buf[n++] = c;
+            } else if (c < 0x20) {
+                n += snprintf(buf + n, sizeof(buf) - n, "\\u%04x", c);
+            } else {
+                buf[n++] = c;
+            }
+        }
+        buf[n] = '\0';
+        return put(out, buf);
+    }
+
+    std::vector<Record> _records;
+    std::vector<char> _names;
+    bool _sorted = true;
+};
+
+/**
+ * Incremental manifest parser: feed() takes the JSON in any slicing and
+ * adds one Record per entry to the table; finish() checks the document
+ * was complete and sorts the table. Validates JSON syntax as it goes and
+ * skips anything outside images/audio entries (unknown keys, nested
+ * values). A string or number longer than the fields it could fill is
+ * cut short, which makes its entry unusable rather than the parse fail.
+ */
+class Parser {
+public:
+    explicit Parser(Table& table) : _table(table) {}
+
+    // Body interface for OrchestratorService::httpGETStreamWithRetry
+    bool open() {
+        reset();
+        return true;
+    }
+
+    // Start over on an empty table (a retried download)
+    void reset() {
+        _table.clear();
+        _lex = Lex::None;
+        _depth = 0;
+        _started = false;
+        _done = false;
+        _failed = false;
+        _error = nullptr;
+        _section = NO_SECTION;
+        _inEntry = false;
+        _skipped = 0;
+    }
+
+    // false once the input is not a manifest
+    bool feed(const uint8_t* data, size_t len) {
+        for (size_t i = 0; i < len && !_failed; i++) consume(static_cast<char>(data[i]));
+        return !_failed;
+    }
+
+    bool write(const uint8_t* data, size_t len) { return feed(data, len); }
+
+    // Whole document seen; the table is sorted and ready
+    bool finish() {
+        if (!_failed && !_done) fail("truncated");
+        if (_failed) return false;
+        _table.finalize();
+        return true;
+    }
+
+    bool failed() const { return _failed; }
+    const char* error() const { return _error ? _error : "none"; }
+    // Entries dropped for an unusable tokenId or ext
+    uint32_t skipped() const { return _skipped; }
+
+private:
+    static constexpr uint8_t MAX_DEPTH = 16;
+    static constexpr uint8_t NO_SECTION = 0xFF;
+
+    enum class Lex : uint8_t { None, String, Escape, Unicode, Scalar };
+    enum class Expect : uint8_t { Value, Key, KeyOrEnd, Colon, CommaOrEnd, ValueOrEnd };
+    enum class Field : uint8_t { Other, Sha1, Size, Ext };
+
+    struct Frame {
+        bool object;
+        Expect expect;
+    };
+
+    void consume(char c) {
+        switch (_lex) {
+            case Lex::String:
+                if (c == '"') endString();
+                else if (c == '\\') _lex = Lex::Escape;
+                else if (static_cast<unsigned char>(c) < 0x20) fail("control character in string");
+                else push(c);
+                return;
+            case Lex::Escape:
+                escape(c);
+                return;
+            case Lex::Unicode:
+                unicode(c);
+                return;
+            case Lex::Scalar:
+                if (isalnum(static_cast<unsigned char>(c)) || c == '.' || c == '+' || c == '-') {
+                    push(c);
+                    return;
+                }
+                _lex = Lex::None;
+                endScalar();
+                if (_failed) return;
+                break;  // c still needs handling
+            case Lex::None:
+                break;
+        }
+
+        switch (c) {
+            case ' ': case '\t': case '\r': case '\n':
+                return;
+            case '{': case '[':
+                open(c == '{');
+                return;
+            case '}': case ']':
+                close(c == '}');
+                return;
+            case ':':
+                if (_depth == 0 || top().expect != Expect::Colon) fail("unexpected ':'");
+                else top().expect = Expect::Value;
+                return;
+            case ',':
+                if (_depth == 0 || top().expect != Expect::CommaOrEnd) fail("unexpected ','");
+                else top().expect = top().object ? Expect::Key : Expect::Value;
+                return;
+            case '"':
+                startString();
+                return;
+            default:
+                if (c == '-' || (c >= '0' && c <= '9') || c == 't' || c == 'f' || c == 'n') {
+                    if (!beginValue()) return;
+                    _tokLen = 0;
+                    _tokCut = false;
+                    push(c);
+                    _lex = Lex::Scalar;
+                    return;
+                }
+                fail("unexpected character");
+        }
+    }
+
+    Frame& top() { return _stack[_depth - 1]; }
+
+    // A value starts here; false (failed) if none may
+    bool beginValue() {
+        if (_done) return fail("data after the manifest");
+        if (_depth == 0) return fail("manifest is not an object");
+        Expect e = top().expect;
+        if (e != Expect::Value && e != Expect::ValueOrEnd) return fail("unexpected value");
+        top().expect = Expect::CommaOrEnd;
+        return true;
+    }
+
+    void open(bool object) {
+        if (_depth == 0 && !_started && !_done) {
+            if (!object) {
+                fail("manifest is not an object");
+                return;
+            }
+            _started = true;
+        } else if (!beginValue()) {
+            return;
+        }
+        if (_depth == MAX_DEPTH) {
+            fail("nested too deep");
+            return;
+        }
+        // The value of a tokenId key in a known section
+        if (object && _depth == 2 && _stack[1].object && _section != NO_SECTION) {
+            _inEntry = true;
+            _badExt = false;
+            _field = Field::Other;
+            _sha[0] = '\0';
+            _ext[0] = '\0';
+            _size = 0;
+        }
+        _stack[_depth++] = Frame{object, object ? Expect::KeyOrEnd : Expect::ValueOrEnd};
+    }
+
+    void close(bool object) {
+        if (_depth == 0 || top().object != object) {
+            fail("unbalanced brackets");
+            return;
+        }
+        Expect e = top().expect;
+        if (e != Expect::CommaOrEnd && e != Expect::KeyOrEnd && e != Expect::ValueOrEnd) {
+            fail("unexpected end of container");
+            return;
+        }
+        if (_depth == 3 && _inEntry) {
+            _inEntry = false;
+            endEntry();
+            if (_failed) return;
+        }
+        if (--_depth == 0) _done = true;
+    }
+
+    void startString() {
+        if (_depth > 0 && top().object &&
+            (top().expect == Expect::Key || top().expect == Expect::KeyOrEnd)) {
+            _isKey = true;
+            top().expect = Expect::Colon;
+        } else {
+            if (!beginValue()) return;
+            _isKey = false;
+        }
+        _tokLen = 0;
+        _tokCut = false;
+        _lex = Lex::String;
+    }
+
+    void escape(char c) {
+        _lex = Lex::String;
+        switch (c) {
+            case '"': case '\\': case '/': push(c); return;
+            case 'b': push('\b'); return;
+            case 'f': push('\f'); return;
+            case 'n': push('\n'); return;
+            case 'r': push('\r'); return;
+            case 't': push('\t'); return;
+            case 'u':
+                _lex = Lex::Unicode;
+                _uni = 0;
+                _uniDigits = 0;
+                return;
+            default:
+                fail("bad escape");
+        }
+    }
+
+    // \uXXXX as UTF-8 (surrogate halves pass through unpaired)
+    void unicode(char c) {
+        int v = c >= '0' && c <= '9' ? c - '0'
+              : c >= 'a' && c <= 'f' ? c - 'a' + 10
+              : c >= 'A' && c <= 'F' ? c - 'A' + 10 : -1;
+        if (v < 0) {
+            fail("bad escape");
+            return;
+        }
+        _uni = static_cast<uint16_t>(_uni << 4 | v);
+        if (++_uniDigits < 4) return;
+        _lex = Lex::String;
+        if (_uni < 0x80) {
+            push(static_cast<char>(_uni));
+        } else if (_uni < 0x800) {
+            push(static_cast<char>(0xC0 | _uni >> 6));
+            push(static_cast<char>(0x80 | (_uni & 0x3F)));
+        } else {
+            push(static_cast<char>(0xE0 | _uni >> 12));
+            push(static_cast<char>(0x80 | (_uni >> 6 & 0x3F)));
+            push(static_cast<char>(0x80 | (_uni & 0x3F)));
+        }
+    }
+
+    void push(char c) {
+        if (_tokLen < sizeof(_tok) - 1) _tok[_tokLen++] = c;
+        else _tokCut = true;
+    }
+
+    void endString() {
+        _lex = Lex::None;
+        _tok[_tokLen] = '\0';
+        if (_isKey) onKey();
+        else if (_depth == 3 && _inEntry) onEntryString();
+    }
+
+    void endScalar() {
+        _tok[_tokLen] = '\0';
+        if (_tok[0] == 't' || _tok[0] == 'f' || _tok[0] == 'n') {
+            if (strcmp(_tok, "true") != 0 && strcmp(_tok, "false") != 0 &&
+                strcmp(_tok, "null") != 0) {
+                fail("bad literal");
+            }
+            return;
+        }
+        if (_depth == 3 && _inEntry && _field == Field::Size) {
+            // Plain unsigned integers only; anything else leaves size 0
+            char* end;
+            unsigned long v = strtoul(_tok, &end, 10);
+            bool digits = !_tokCut && _tok[0] >= '0' && _tok[0] <= '9' && *end == '\0';
+            _size = digits && v <= 0xFFFFFFFFul ? static_cast<uint32_t>(v) : 0;
+        }
+    }
+
+    void onKey() {
+        if (_depth == 1) {
+            _section = strcmp(_tok, "images") == 0 ? uint8_t(IMAGE)
+                     : strcmp(_tok, "audio") == 0 ? uint8_t(AUDIO) : NO_SECTION;
+        } else if (_depth == 2 && _section != NO_SECTION) {
+            size_t n = _tokCut ? sizeof(_id) : _tokLen;
+            if (n < sizeof(_id)) memcpy(_id, _tok, n + 1);
+            else _id[0] = '\0';  // Too long: the entry is skipped
+        } else if (_depth == 3 && _inEntry) {
+            _field = strcmp(_tok, "sha1") == 0 ? Field::Sha1
+                   : strcmp(_tok, "size") == 0 ? Field::Size
+                   : strcmp(_tok, "ext") == 0 ? Field::Ext : Field::Other;
+        }
+    }
+
+    void onEntryString() {
+        if (_tokCut && _field == Field::Ext) _badExt = true;
+        if (_tokCut) return;
+        if (_field == Field::Sha1 && _tokLen < sizeof(_sha)) memcpy(_sha, _tok, _tokLen + 1);
+        else if (_field == Field::Ext && _tokLen < sizeof(_ext)) memcpy(_ext, _tok, _tokLen + 1);
+        else if (_field == Field::Ext) _badExt = true;
+    }
+
+    void endEntry() {
+        if (_table.full()) {
+            fail("too many entries");
+            return;
+        }
+        if (_badExt || !_table.add(_section, _id, _sha, _size, _ext)) _skipped++;
+    }
+
+    bool fail(const char* why) {
+        if (!_failed) _error = why;
+        _failed = true;
+        return false;
+    }
+
+    Table& _table;
+
+    Lex _lex = Lex::None;
+    char _tok[48];
+    size_t _tokLen = 0;
+    bool _tokCut = false;
+    bool _isKey = false;
+    uint16_t _uni = 0;
+    uint8_t _uniDigits = 0;
+
+    Frame _stack[MAX_DEPTH];
+    uint8_t _depth = 0;
+    bool _started = false;
+    bool _done = false;
+    bool _failed = false;
+    const char* _error = nullptr;
+
+    // Entry being read
+    uint8_t _section = NO_SECTION;
+    bool _inEntry = false;
+    Field _field = Field::Other;
+    char _id[Table::TOKEN_ID_MAX + 1] = "";
+    char _sha[41] = "";
+    char _ext[4] = "";
+    bool _badExt = false;
+    uint32_t _size = 0;
+    uint32_t _skipped = 0;
+};
+
+/**
+ * Remote entries to download, by table index, in table order (images
+ * first). operator[] materialises one Pending at a time, so a first sync
+ * of every asset costs two bytes an entry on top of the table.
+ */
+class Queue {
+public:
+    explicit Queue(const Table& table) : _table(table) {}
+
+    void add(size_t index) { _indices.push_back(static_cast<uint16_t>(index)); }
+    size_t size() const { return _indices.size(); }
+    bool empty() const { return _indices.empty(); }
+    Pending operator[](size_t i) const { return _table.pending(_indices[i]); }
+
+    // Whether entry i is fetched as `remoteName` ("images/<id>.bmp",
+    // "audio/<id>.<ext>"), without building its Pending
+    bool isNamed(size_t i, const char* remoteName) const {
+        const Record& r = _table[_indices[i]];
+        const char* dir = r.type == IMAGE ? "images/" : "audio/";
+        const char* id = _table.tokenId(r);
+        size_t dirLen = strlen(dir);
+        size_t idLen = strlen(id);
+        if (strncmp(remoteName, dir, dirLen) != 0 ||
+            strncmp(remoteName + dirLen, id, idLen) != 0 ||
+            remoteName[dirLen + idLen] != '.') {
+            return false;
+        }
+        return strcmp(remoteName + dirLen + idLen + 1, r.type == IMAGE ? "bmp" : r.ext) == 0;
+    }
+
+private:
+    const Table& _table;
+    std::vector<uint16_t> _indices;
+};
+
+// Every remote entry whose sha1 differs from the local one (or which is
+// missing locally). Entries without sha1 or size are never queued.
+inline Queue diff(const Table& remote, const Table& local) {
+    Queue out(remote);
+    for (size_t i = 0; i < remote.size(); i++) {
+        const Record& r = remote[i];
+        if (!r.hasSha1 || r.size == 0) continue;
+        const Record* l = local.find(r.type, remote.tokenId(r));
+        if (l && l->hasSha1 && memcmp(l->sha1, r.sha1, sizeof(r.sha1)) == 0) continue;
+        out.add(i);
+    }
     return out;
 }
 
-// Collect local entries whose tokenId is not in the remote manifest.
-inline void collectOrphans(JsonObject localSection,
-                           JsonObjectConst remoteSection,
-                           std::vector<String>& outIds) {
-    for (JsonPair kv : localSection) {
-        if (remoteSection.isNull() || !remoteSection.containsKey(kv.key())) {
-            outIds.emplace_back(kv.key().c_str());
-        }
+// Total bytes of every entry with a sha1 (sizes the asset pack's data region)
+inline uint32_t totalBytes(const Table& remote) {
+    uint32_t total = 0;
+    for (size_t i = 0; i < remote.size(); i++) {
+        if (remote[i].hasSha1) total += remote[i].size;
+    }
+    return total;
+}
+
+// Indices of local entries whose tokenId is not in the remote manifest
+inline std::vector<size_t> collectOrphans(const Table& local, const Table& remote) {
+    std::vector<size_t> out;
+    for (size_t i = 0; i < local.size(); i++) {
+        if (!remote.find(local[i].type, local.tokenId(local[i]))) out.push_back(i);
     }
+    return out;
 }
 
 // SD path for a given asset entry. Matches AssetService::_buildPath.
@@ -89,31 +684,5 @@ inline String buildPath(const String& type, const String& tokenId, const String&
     return String(paths::AUDIO_DIR) + tokenId + "." + (ext.length() ? ext : String("wav"));
 }
 
-// Insert or upsert an entry in the local manifest doc. `ext` is optional
-// (audio only). Removes any prior entry before creating to avoid the
-// duplicate-key trap (ArduinoJson createNestedObject APPENDS, never
-// upserts). Repairs a corrupt section (existing key with wrong type)
-// by removing and recreating it.
-inline void updateEntry(JsonDocument& local,
-                        const String& type,
-                        const String& tokenId,
-                        const String& sha1,
-                        size_t size,
-                        const char* ext) {
-    const char* section = (type == "image") ? "images" : "audio";
-
-    if (!local[section].is<JsonObject>()) {
-        local.remove(section);
-        local.createNestedObject(section);
-    }
-    JsonObject sectionObj = local[section].as<JsonObject>();
-
-    sectionObj.remove(tokenId);  // critical: prevents duplicate keys
-    JsonObject entry = sectionObj.createNestedObject(tokenId);
-    entry["sha1"] = sha1;
-    entry["size"] = size;
-    if (ext && *ext) entry["ext"] = ext;
-}
-
 } // namespace manifest
 } // namespace services
@@ -19,21 +19,51 @@
  * drop mid-sync always leaves the device in a recoverable state: the next
  * boot re-diffs and retries whatever wasn't committed.
  *
- * Heap budget: manifest JSON ≤ 128 KB (plus ArduinoJson doc overhead ~2x).
- * Streaming download buffer 4 KB. SHA-1 context ~100 bytes. All downloads
- * run under the SD mutex — safe at boot because the queue-upload task has
- * nothing to process yet.
+ * The manifest request is conditional: the ETag/Last-Modified of the
+ * manifest the last COMPLETE sync ran against is kept beside the local
+ * manifest (SyncValidators.h). A 304 means every file is already current,
+ * so an unchanged boot is one small round trip with no parse or diff. A
+ * partial sync stores no validators, so the next boot diffs again.
+ *
+ * Fetch modes (ASSET_FETCH): `single` issues one orchestrator request per
+ * file. `pipeline` (default) runs the whole download phase over one
+ * AssetConnection, with the next GET already sent while the current body
+ * drains to SD. `bundle` asks for every pending file as one tar stream
+ * and pipelines whatever it did not deliver. Each run's totals (files/s,
+ * MB/s, handshakes) are logged and kept for ASSET_STATS.
+ *
+ * Optional asset pack (ASSET_PACK=true, see hal/AssetPack.h): downloads go
+ * into free extents of one preallocated /assets.pack instead of loose
+ * files, sized from the remote manifest on first use. An asset that does
+ * not fit falls back to a loose file; a loose download removes any older
+ * packed copy so readers never see a stale version.
+ *
+ * Heap budget: the remote and local manifests are stream-parsed into
+ * compact tables of ~40 bytes an entry (≤ MANIFEST_MAX_ENTRIES each); no
+ * manifest text or JSON document is ever held, and the bundle request
+ * body is written straight into one String. Streaming download buffer
+ * 4 KB. SHA-1 context ~100 bytes. Downloads take the SD mutex per 4 KB
+ * chunk write only, so queue writes and image draws keep running during a
+ * mid-session sync.
  */
 
 #include <Arduino.h>
-#include <ArduinoJson.h>
 #include <SD.h>
+#include <atomic>
 #include <functional>
+#include <memory>
 #include <vector>
 #include "../hal/SDCard.h"
+#include "../hal/AssetPack.h"
 #include "../config.h"
+#include "AssetConnection.h"
 #include "AssetManifestDiff.h"
+#include "AssetSink.h"
+#include "AssetStream.h"
+#include "AtomicFile.h"
 #include "OrchestratorService.h"
+#include "PayloadBuilder.h"
+#include "SyncValidators.h"
 
 namespace services {
 
@@ -48,9 +78,9 @@ public:
         size_t bytesTotal;     // current file
     };
 
-    // Invoked synchronously on the main task whenever sync progresses. Used
-    // to drive the boot-screen progress UI. Never invoked from a background
-    // task so no locking is required on the callback side.
+    // Invoked synchronously whenever sync progresses. Used to drive the
+    // boot-screen progress UI and set only for the boot sync (main task);
+    // pushed re-syncs run on the OrchestratorSync task with none set.
     using ProgressCallback = std::function<void(const ProgressInfo&)>;
 
     static AssetService& getInstance() {
@@ -63,16 +93,26 @@ public:
 
     void setProgressCallback(ProgressCallback cb) { _onProgress = cb; }
 
+    // Download into the asset pack (config ASSET_PACK); loose files otherwise
+    void setUsePack(bool usePack) { _usePack = usePack; }
+
+    void setFetchMode(models::AssetFetchMode mode) { _fetchMode = mode; }
+
+    // Totals of the last sync this boot; mode is empty if none ran
+    const AssetSyncStats& lastStats() const { return _stats; }
+
     /**
      * @brief Sync all BMP/audio assets from the orchestrator.
      *
      * Steps:
-     *   1. GET /api/assets/manifest → small JSON describing the canonical
-     *      asset set.
+     *   1. GET /api/assets/manifest → JSON describing the canonical asset
+     *      set, parsed as it arrives; 304 (unchanged since the last
+     *      complete sync) ends the sync here.
      *   2. Load our local manifest (if present).
      *   3. Queue every file whose sha1 differs (or is missing locally).
-     *   4. For each queued file, stream to SD with hash/size verification;
-     *      update local manifest on success.
+     *   4. Stream each queued file to SD with hash/size verification
+     *      (per file, pipelined or bundled - see ASSET_FETCH); update the
+     *      local manifest on each success.
      *   5. Delete local files whose tokenId is no longer in the remote
      *      manifest.
      *
@@ -81,207 +121,479 @@ public:
      * Returns true if every queued file succeeded.
      */
     bool syncFromOrchestrator(const String& orchestratorURL, OrchestratorService& orch) {
+        // Boot and SYNC_ASSETS_NOW run on the main task, pushed re-syncs on
+        // the OrchestratorSync task: one at a time
+        bool idle = false;
+        if (!_syncing.compare_exchange_strong(idle, true)) {
+            LOG_INFO("[ASSET-SVC] Sync already running, skipped\n");
+            return false;
+        }
+        bool ok = _sync(orchestratorURL, orch);
+        _syncing = false;
+        return ok;
+    }
+
+private:
+    AssetService() = default;
+    ProgressCallback _onProgress;
+    bool _usePack = false;
+    models::AssetFetchMode _fetchMode = models::AssetFetchMode::Pipeline;
+    AssetSyncStats _stats;
+    uint32_t _filesStarted = 0;
+    std::atomic<bool> _syncing{false};
+
+    // syncFromOrchestrator() with the run claimed
+    bool _sync(const String& orchestratorURL, OrchestratorService& orch) {
         LOG_INFO("\n[ASSET-SVC] >>> ASSET SYNC START <<<\n");
         LOG_INFO("[ASSET-SVC] Free heap: %d bytes\n", ESP.getFreeHeap());
 
+        const uint32_t startMs = millis();
+        const HttpStats httpBefore = orch.getHttpStats();
+        _stats = AssetSyncStats();
+        _stats.mode = models::assetFetchModeName(_fetchMode);
+        _filesStarted = 0;
+
         if (orchestratorURL.length() == 0) {
             LOG_INFO("[ASSET-SVC] Orchestrator URL not set, skipping.\n");
             return false;
         }
 
-        // Step 1: fetch the remote manifest (a small JSON payload, safe to
-        // buffer via the existing httpGETWithRetry path).
-        String body;
-        int code = orch.httpGETWithRetry(
-            orchestratorURL + "/api/assets/manifest", 15000, "asset manifest fetch", body);
-        if (code != 200) {
-            LOG_INFO("[ASSET-SVC] Manifest fetch failed (HTTP %d). Aborting.\n", code);
-            return false;
+        // Step 1: stream the remote manifest straight into a compact
+        // table (AssetManifestDiff.h) unless it is unchanged since the
+        // last complete sync. The JSON text is never held in RAM.
+        SyncValidators have;
+        {
+            hal::SDCard::Lock lock("AssetService::etag", freertos_config::SD_MUTEX_TIMEOUT_MS);
+            if (lock.acquired()) {
+                have = sync_validators::load(paths::MANIFEST_VALIDATOR_FILE, paths::MANIFEST_FILE);
+            }
         }
-        if ((int)body.length() > limits::MAX_MANIFEST_SIZE) {
-            LOG_INFO("[ASSET-SVC] Manifest too large (%u > %d)\n",
-                     body.length(), limits::MAX_MANIFEST_SIZE);
-            return false;
+        manifest::Table remote;
+        manifest::Parser remoteParser(remote);
+        SyncValidators received;
+        int code = orch.httpGETStreamWithRetry(
+            orchestratorURL + "/api/assets/manifest", remoteParser, 15000,
+            "asset manifest fetch", have, received);
+        if (code == 304) {
+            LOG_INFO("[ASSET-SVC] Manifest not modified (304), assets are current\n");
+            _stats.notModified = true;
+            _finishStats(orch, httpBefore, startMs);
+            LOG_INFO("[ASSET-SVC] <<< ASSET SYNC END: unchanged >>>\n\n");
+            return true;
         }
-
-        // Pre-flight heap budget. ArduinoJson 7's document model is elastic:
-        // the capacity passed to DynamicJsonDocument is IGNORED and heap tracks
-        // the actual parsed size (~1x the JSON). So the live cost is roughly the
-        // manifest body size for EACH of the remote+local docs — NOT the
-        // obsolete v6 "2 * MANIFEST_DOC_SIZE" worst case, which over-reserved
-        // 176 KB and made sync impossible on a WROOM-32 (~190 KB free at boot).
-        // Budget remote+local parsed docs (~2x body each, conservative) plus
-        // TLS + HTTP + streaming-download headroom (~48 KB).
-        const size_t neededHeap = (size_t)body.length() * 4 + 49152;
-        if (ESP.getFreeHeap() < neededHeap) {
-            LOG_INFO("[ASSET-SVC] Aborting: heap %u < required %u (manifest %u B)\n",
-                     ESP.getFreeHeap(), (unsigned)neededHeap, (unsigned)body.length());
+        if (code != 200) {
+            LOG_INFO("[ASSET-SVC] Manifest fetch failed (HTTP %d, parser: %s). Aborting.\n",
+                     code, remoteParser.error());
             return false;
         }
+        if (remoteParser.skipped() > 0) {
+            LOG_INFO("[ASSET-SVC] Manifest: skipped %lu unusable entries\n",
+                     (unsigned long)remoteParser.skipped());
+        }
 
-        DynamicJsonDocument remoteDoc(limits::MANIFEST_DOC_SIZE);
-        DeserializationError err = deserializeJson(remoteDoc, body);
-        if (err) {
-            LOG_INFO("[ASSET-SVC] Manifest parse failed: %s\n", err.c_str());
-            if (err == DeserializationError::NoMemory) {
-                LOG_INFO("[ASSET-SVC] Manifest doc (%d B) too small for payload (%u B). "
-                         "Bump limits::MANIFEST_DOC_SIZE.\n",
-                         limits::MANIFEST_DOC_SIZE, body.length());
-            }
-            return false;
+        // From here local state moves towards this manifest; the old
+        // validators no longer describe it
+        {
+            hal::SDCard::Lock lock("AssetService::etag", freertos_config::SD_MUTEX_LONG_TIMEOUT_MS);
+            if (lock.acquired()) sync_validators::clear(paths::MANIFEST_VALIDATOR_FILE);
         }
-        body = String(); // free the buffered copy ASAP
 
         // Step 2: read whatever local manifest already exists. Missing or
         // corrupt = empty, which forces a full re-sync.
-        DynamicJsonDocument localDoc(limits::MANIFEST_DOC_SIZE);
-        _loadLocalManifest(localDoc);
+        manifest::Table local;
+        _loadLocalManifest(local);
+        LOG_INFO("[ASSET-SVC] Manifest tables: %u remote / %u local entries, %u B heap\n",
+                 (unsigned)remote.size(), (unsigned)local.size(),
+                 (unsigned)(remote.heapBytes() + local.heapBytes()));
 
         // Step 3: build the download queue. We flatten both asset types
         // into a single list so the progress counter is meaningful to the
         // operator ("12 / 147" rather than "12 / 130 images + 0 / 3
         // audio"). Logic lives in AssetManifestDiff.h so native tests can
         // exercise it without SD/WiFi deps.
-        std::vector<manifest::Pending> pending = manifest::diff(remoteDoc, localDoc);
+        manifest::Queue pending = manifest::diff(remote, local);
 
         LOG_INFO("[ASSET-SVC] Queue: %u file(s) to download\n",
                  (unsigned)pending.size());
 
+        auto& pack = hal::AssetPack::getInstance();
+        bool packReady = _usePack && !pending.empty() &&
+                         _preparePack(pack, manifest::totalBytes(remote));
+
         // Step 4: download each queued file; commit local manifest on
         // each success so the next boot resumes from wherever we stopped.
-        int successCount = 0;
-        int failCount = 0;
-        const int total = (int)pending.size();
-        for (int i = 0; i < total; i++) {
-            const auto& p = pending[i];
-            String destPath = _buildPath(p.type, p.tokenId, p.ext);
-            String url = orchestratorURL + "/api/assets/" +
-                         (p.type == "image" ? "images" : "audio") + "/" +
-                         p.tokenId + "." + (p.type == "image" ? "bmp" : p.ext);
-
-            LOG_DEBUG("[ASSET-SVC] (%d/%d) %s %s\n",
-                      i + 1, total, p.type.c_str(), p.tokenId.c_str());
-
-            ProgressInfo info{p.tokenId, p.type, i + 1, total, 0, p.size};
-            if (_onProgress) _onProgress(info);
-
-            auto streamProgress = [&](size_t done, size_t totalBytes) {
-                if (!_onProgress) return;
-                info.bytesDone = done;
-                info.bytesTotal = totalBytes;
-                _onProgress(info);
-            };
-
-            bool ok = orch.httpGETStreamToSD(
-                url, destPath, p.size, p.sha1, limits::ASSET_DOWNLOAD_TIMEOUT_MS, streamProgress);
-            if (!ok) {
-                failCount++;
-                continue;
+        _stats.queued = pending.size();
+        std::vector<bool> done(pending.size(), false);
+        if (!pending.empty() && _fetchMode == models::AssetFetchMode::Single) {
+            _fetchSingle(orchestratorURL, orch, pending, done, packReady, local);
+        } else if (!pending.empty()) {
+            orch.closeIdleHttp();  // The run brings its own TLS context
+            AssetConnection conn(orchestratorURL, limits::ASSET_DOWNLOAD_TIMEOUT_MS);
+            if (_fetchMode == models::AssetFetchMode::Bundle) {
+                _fetchBundle(conn, pending, done, packReady, local);
             }
-
-            // Commit this entry to the local manifest immediately. Cheap
-            // per-file writes are acceptable here — manifest is small and
-            // this is a boot-time operation.
-            manifest::updateEntry(localDoc, p.type, p.tokenId, p.sha1, p.size,
-                                  p.type == "audio" ? p.ext.c_str() : nullptr);
-            _writeLocalManifestAtomic(localDoc);
-            successCount++;
+            _fetchPipelined(conn, pending, done, packReady, local);
+            _stats.requests += conn.requests();
+            _stats.handshakes += conn.handshakes();
+            _stats.reconnects = conn.reconnects();
+        }
+        int successCount = (int)_stats.files;
+        int failCount = (int)(pending.size() - _stats.files);
+
+        // Step 5: orphan pruning. Anything in the local manifest that isn't
+        // in the remote one refers to a token no longer in Notion — delete
+        // both the SD file and the local manifest entry.
+        int prunedCount = _pruneOrphans(remote, local);
+
+        // Every file matches this manifest: the next sync may ask "if changed"
+        if (failCount == 0) {
+            hal::SDCard::Lock lock("AssetService::etag", freertos_config::SD_MUTEX_LONG_TIMEOUT_MS);
+            if (lock.acquired()) sync_validators::save(paths::MANIFEST_VALIDATOR_FILE, received);
         }
 
-        // Step 5: orphan pruning. Anything in localDoc that isn't in
-        // remoteDoc refers to a token no longer in Notion — delete both
-        // the SD file and the local manifest entry.
-        int prunedCount = _pruneOrphans(remoteDoc, localDoc);
+        _stats.failed = failCount;
+        _stats.pruned = prunedCount;
+        _finishStats(orch, httpBefore, startMs);
 
         LOG_INFO("[ASSET-SVC] <<< ASSET SYNC END: %d ok, %d fail, %d pruned >>>\n\n",
                  successCount, failCount, prunedCount);
         return failCount == 0;
     }
 
-private:
-    AssetService() = default;
-    ProgressCallback _onProgress;
+    // Whole run, manifest fetch included, on every connection used
+    void _finishStats(OrchestratorService& orch, const HttpStats& httpBefore, uint32_t startMs) {
+        HttpStats httpAfter = orch.getHttpStats();
+        _stats.requests += httpAfter.requests - httpBefore.requests;
+        _stats.handshakes += (httpAfter.handshakes + httpAfter.oneShot) -
+                             (httpBefore.handshakes + httpBefore.oneShot);
+        _stats.elapsedMs = millis() - startMs;
+        _stats.print();
+    }
+
+    // ─── Fetch modes ───────────────────────────────────────────────────
+
+    // ASSET_FETCH=single: one orchestrator request per file
+    void _fetchSingle(const String& orchestratorURL, OrchestratorService& orch,
+                      const manifest::Queue& pending, std::vector<bool>& done,
+                      bool packReady, manifest::Table& local) {
+        auto& pack = hal::AssetPack::getInstance();
+        for (size_t i = 0; i < pending.size(); i++) {
+            const manifest::Pending p = pending[i];
+            String destPath = _buildPath(p.type, p.tokenId, p.ext);
+            String url = orchestratorURL + "/api/assets/" + _remoteName(p);
+            AssetWriter::Progress streamProgress = _startFile(p, (int)pending.size());
+
+            bool ok;
+            if (packReady && _packHasRoom(pack, p.size)) {
+                ok = orch.httpGETStreamToPack(
+                    url, pack, _packType(p), p.tokenId, _packExt(p), destPath, p.size, p.sha1,
+                    limits::ASSET_DOWNLOAD_TIMEOUT_MS, streamProgress);
+            } else {
+                ok = orch.httpGETStreamToSD(
+                    url, destPath, p.size, p.sha1, limits::ASSET_DOWNLOAD_TIMEOUT_MS, streamProgress);
+                if (ok) _dropPacked(pack, _packType(p), p.tokenId);
+            }
+            if (ok) {
+                _commitEntry(local, p);
+                done[i] = true;
+            }
+        }
+    }
+
+    // ASSET_FETCH=pipeline: ASSET_PIPELINE_DEPTH GETs stay on the wire, so
+    // the server sends the next file while this one is written and verified
+    void _fetchPipelined(AssetConnection& conn, const manifest::Queue& pending,
+                         std::vector<bool>& done, bool packReady,
+                         manifest::Table& local) {
+        std::vector<size_t> todo;
+        for (size_t i = 0; i < pending.size(); i++) {
+            if (!done[i]) todo.push_back(i);
+        }
+
+        size_t sent = 0;
+        for (size_t k = 0; k < todo.size(); k++) {
+            while (sent < todo.size() && sent - k < (size_t)limits::ASSET_PIPELINE_DEPTH &&
+                   !conn.broken()) {
+                conn.request("/api/assets/" + _remoteName(pending[todo[sent]]));
+                sent++;
+            }
+            if (conn.broken()) {
+                LOG_INFO("[ASSET-SVC] Orchestrator unreachable, %u file(s) left for next sync\n",
+                         (unsigned)(todo.size() - k));
+                return;
+            }
+
+            const manifest::Pending p = pending[todo[k]];
+            AssetWriter::Progress streamProgress = _startFile(p, (int)pending.size());
+            bool packed;
+            std::unique_ptr<AssetSink> sink = _makeSink(p, packReady, packed);
+            if (!conn.receive(*sink, p.size, p.sha1, streamProgress)) continue;
+            if (!packed) _dropPacked(hal::AssetPack::getInstance(), _packType(p), p.tokenId);
+            _commitEntry(local, p);
+            done[todo[k]] = true;
+        }
+    }
+
+    // Drives one bundle entry at a time into its sink (TarReader handler)
+    struct BundleReceiver {
+        AssetService& svc;
+        const manifest::Queue& pending;
+        std::vector<bool>& done;
+        bool packReady;
+        manifest::Table& local;
+
+        int current = -1;
+        bool packed = false;
+        std::unique_ptr<AssetSink> sink;      // Declared before the writer:
+        std::unique_ptr<AssetWriter> writer;  // destroyed after it
+
+        BundleReceiver(AssetService& s, const manifest::Queue& p,
+                       std::vector<bool>& d, bool pr, manifest::Table& l)
+            : svc(s), pending(p), done(d), packReady(pr), local(l) {}
+
+        bool onEntry(const char* name, uint32_t size) {
+            for (size_t i = 0; i < pending.size() && current < 0; i++) {
+                if (!done[i] && pending.isNamed(i, name)) current = (int)i;
+            }
+            if (current < 0) return false;  // Not asked for, or already have it
+            const manifest::Pending p = pending[current];
+            if (size != p.size) {
+                LOG_INFO("[ASSET-SVC] Bundle: %s is %lu bytes, manifest says %u\n",
+                         name, (unsigned long)size, (unsigned)p.size);
+                current = -1;
+                return false;
+            }
+            sink = svc._makeSink(p, packReady, packed);
+            writer.reset(new AssetWriter(*sink, p.size, p.sha1,
+                                         svc._startFile(p, (int)pending.size())));
+            if (!writer->open()) {
+                writer.reset();
+                sink.reset();
+                current = -1;
+                return false;
+            }
+            return true;
+        }
+
+        // A failed SD write fails the entry at finish(); the stream goes on
+        bool onData(const uint8_t* data, size_t len) {
+            writer->write(data, len);
+            return true;
+        }
+
+        bool onEntryEnd() {
+            const manifest::Pending p = pending[current];
+            bool ok = writer->finish();
+            writer.reset();
+            sink.reset();
+            if (ok) {
+                if (!packed) svc._dropPacked(hal::AssetPack::getInstance(), _packType(p), p.tokenId);
+                svc._commitEntry(local, p);
+                svc._stats.bundled++;
+                done[current] = true;
+            }
+            current = -1;
+            return true;
+        }
+    };
+
+    // ASSET_FETCH=bundle: POST /api/assets/bundle {"files":[...]} answers
+    // with one ustar stream whose entries are named like the GET paths
+    // ("images/<id>.bmp", "audio/<id>.<ext>"). Whatever it does not
+    // deliver - all of it on an orchestrator without the route - is left
+    // for the pipeline.
+    void _fetchBundle(AssetConnection& conn, const manifest::Queue& pending,
+                      std::vector<bool>& done, bool packReady, manifest::Table& local) {
+        // Written directly: a JsonDocument would hold every name twice
+        String body = "{\"files\":[";
+        for (size_t i = 0; i < pending.size(); i++) {
+            if (i > 0) body += ',';
+            appendJsonString(body, _remoteName(pending[i]));
+        }
+        body += "]}";
+
+        TarReader tar;
+        BundleReceiver rx(*this, pending, done, packReady, local);
+        int status = conn.exchange("/api/assets/bundle", body,
+                                   [&tar, &rx](const uint8_t* data, size_t len) {
+                                       return tar.feed(data, len, rx);
+                                   });
+        if (status == 404 || status == 405) {
+            LOG_INFO("[ASSET-SVC] Orchestrator has no bundle route, pipelining instead\n");
+        } else if (status != 200) {
+            LOG_INFO("[ASSET-SVC] Bundle request failed (HTTP %d), pipelining instead\n", status);
+        } else if (!tar.ended()) {
+            LOG_INFO("[ASSET-SVC] Bundle %s after %lu entries, pipelining the rest\n",
+                     tar.failed() ? "malformed" : "cut short", (unsigned long)tar.entries());
+        }
+        LOG_INFO("[ASSET-SVC] Bundle delivered %lu of %u file(s)\n",
+                 (unsigned long)_stats.bundled, (unsigned)pending.size());
+    }
 
     // ─── Helpers ───────────────────────────────────────────────────────
 
-    // Read /assets/manifest.json into the caller-owned JsonDocument; zero
-    // the doc on any failure so downstream logic sees an empty local state.
-    void _loadLocalManifest(DynamicJsonDocument& doc) {
-        doc.clear();
+    // Report the start of a file; returns its per-chunk progress callback
+    AssetWriter::Progress _startFile(const manifest::Pending& p, int total) {
+        int index = (int)++_filesStarted;
+        ProgressInfo info{p.tokenId, p.type, index < total ? index : total, total, 0, p.size};
+        if (!_onProgress) return nullptr;
+        _onProgress(info);
+        ProgressCallback cb = _onProgress;
+        return [cb, info](size_t done, size_t totalBytes) mutable {
+            info.bytesDone = done;
+            info.bytesTotal = totalBytes;
+            cb(info);
+        };
+    }
+
+    // Record a verified download in the local manifest right away. Cheap
+    // per-file writes are acceptable here - manifest is small and this is
+    // a boot-time operation.
+    void _commitEntry(manifest::Table& local, const manifest::Pending& p) {
+        local.upsert(p.type == "image" ? manifest::IMAGE : manifest::AUDIO, p.tokenId.c_str(),
+                     p.sha1.c_str(), p.size, p.type == "audio" ? p.ext.c_str() : "");
+        _writeLocalManifestAtomic(local);
+        _stats.files++;
+        _stats.bytes += p.size;
+    }
+
+    // Path under /api/assets/, also the bundle entry name
+    static String _remoteName(const manifest::Pending& p) {
+        return String(p.type == "image" ? "images/" : "audio/") + p.tokenId + "." +
+               (p.type == "image" ? String("bmp") : p.ext);
+    }
+
+    static uint8_t _packType(const manifest::Pending& p) {
+        return p.type == "image" ? hal::AssetPack::IMAGE : hal::AssetPack::AUDIO;
+    }
+
+    static String _packExt(const manifest::Pending& p) {
+        return p.type == "image" ? String("bmp") : (p.ext.length() ? p.ext : String("wav"));
+    }
+
+    // A prepared pack extent when one fits, else a loose file
+    std::unique_ptr<AssetSink> _makeSink(const manifest::Pending& p, bool packReady,
+                                         bool& packed) {
+        String destPath = _buildPath(p.type, p.tokenId, p.ext);
+        packed = false;
+        if (packReady) {
+            std::unique_ptr<AssetPackSink> sink(
+                new AssetPackSink(hal::AssetPack::getInstance(), destPath));
+            hal::SDCard::Lock lock("AssetService::pack");
+            if (lock.acquired() &&
+                sink->prepare(_packType(p), p.tokenId, _packExt(p), p.size, p.sha1)) {
+                packed = true;
+                return std::unique_ptr<AssetSink>(sink.release());
+            }
+        }
+        return std::unique_ptr<AssetSink>(new AssetFileSink(destPath));
+    }
+
+    // Load the pack, creating it on first use with room for the whole remote
+    // set plus headroom for side-by-side updates.
+    bool _preparePack(hal::AssetPack& pack, uint32_t remoteBytes) {
+        hal::SDCard::Lock lock("AssetService::pack", freertos_config::SD_MUTEX_LONG_TIMEOUT_MS);
+        if (!lock.acquired()) return false;
+        if (pack.isLoaded() || pack.load()) {
+            if (pack.dataSize() < remoteBytes) {
+                LOG_INFO("[ASSET-SVC] Asset pack smaller than manifest (%lu < %lu KB); "
+                         "overflow goes to loose files\n",
+                         (unsigned long)(pack.dataSize() / 1024),
+                         (unsigned long)(remoteBytes / 1024));
+            }
+            return true;
+        }
+        uint64_t want = static_cast<uint64_t>(remoteBytes) *
+                        (100 + limits::ASSET_PACK_HEADROOM_PCT) / 100;
+        uint32_t size = want < limits::ASSET_PACK_MIN_BYTES
+                            ? limits::ASSET_PACK_MIN_BYTES
+                            : static_cast<uint32_t>(want);
+        return pack.create(size);
+    }
+
+    bool _packHasRoom(hal::AssetPack& pack, size_t size) {
+        hal::SDCard::Lock lock("AssetService::pack");
+        uint32_t offset;
+        return lock.acquired() && pack.reserve(size, offset);
+    }
+
+    // A loose download supersedes any packed copy (readers prefer the pack)
+    void _dropPacked(hal::AssetPack& pack, uint8_t type, const String& tokenId) {
+        if (!pack.isLoaded()) return;
+        hal::SDCard::Lock lock("AssetService::pack");
+        if (lock.acquired()) pack.remove(type, tokenId.c_str());
+    }
+
+    // Parse /assets/manifest.json into the caller-owned table; leave it
+    // empty on any failure so downstream logic sees an empty local state.
+    void _loadLocalManifest(manifest::Table& local) {
+        local.clear();
         hal::SDCard::Lock lock("AssetService::loadManifest",
                                freertos_config::SD_MUTEX_LONG_TIMEOUT_MS);
         if (!lock.acquired()) return;
 
+        if (atomic_file::recover(paths::MANIFEST_TEMP_FILE, paths::MANIFEST_FILE)) {
+            LOG_INFO("[ASSET-SVC] Completed interrupted manifest write\n");
+        }
         if (!SD.exists(paths::MANIFEST_FILE)) {
             LOG_DEBUG("[ASSET-SVC] No local manifest yet (first sync).\n");
             return;
         }
         File f = SD.open(paths::MANIFEST_FILE, FILE_READ);
         if (!f) return;
-        DeserializationError err = deserializeJson(doc, f);
+        manifest::Parser parser(local);
+        parser.reset();
+        uint8_t buf[512];
+        bool ok = true;
+        while (ok && f.available()) {
+            int n = f.read(buf, sizeof(buf));
+            ok = n > 0 && parser.feed(buf, n);
+        }
         f.close();
-        if (err) {
+        if (!ok || !parser.finish()) {
             LOG_INFO("[ASSET-SVC] Local manifest corrupt (%s), treating as empty.\n",
-                     err.c_str());
-            doc.clear();
+                     parser.error());
+            local.clear();
         }
     }
 
-    // Write the doc to a temp file then rename, so a power loss between
-    // write and rename leaves the previous manifest intact.
-    void _writeLocalManifestAtomic(const DynamicJsonDocument& doc) {
+    // Write the table to a temp file then rename, so a power loss leaves
+    // the previous manifest or the new one (see AtomicFile.h), never neither.
+    void _writeLocalManifestAtomic(const manifest::Table& local) {
         hal::SDCard::Lock lock("AssetService::writeManifest",
                                freertos_config::SD_MUTEX_LONG_TIMEOUT_MS);
         if (!lock.acquired()) return;
 
-        SD.remove(paths::MANIFEST_TEMP_FILE); // no-op if absent
-        File f = SD.open(paths::MANIFEST_TEMP_FILE, FILE_WRITE);
-        if (!f) {
-            LOG_INFO("[ASSET-SVC] Could not open manifest tmp for write\n");
-            return;
-        }
-        serializeJson(doc, f);
-        f.flush();
-        f.close();
-
-        SD.remove(paths::MANIFEST_FILE);
-        if (!SD.rename(paths::MANIFEST_TEMP_FILE, paths::MANIFEST_FILE)) {
-            LOG_INFO("[ASSET-SVC] Manifest rename failed\n");
+        bool ok = atomic_file::write(paths::MANIFEST_TEMP_FILE, paths::MANIFEST_FILE,
+                                     [&](File& f) { return local.writeJson(f); });
+        if (!ok) {
+            LOG_INFO("[ASSET-SVC] Manifest write failed\n");
         }
     }
 
     // Remove SD files and local manifest entries whose tokenId no longer
     // exists remotely. Returns count removed.
-    int _pruneOrphans(const JsonDocument& remote, DynamicJsonDocument& local) {
-        int pruned = 0;
-        pruned += _pruneSection(remote, local, "images", "image");
-        pruned += _pruneSection(remote, local, "audio", "audio");
-        if (pruned > 0) _writeLocalManifestAtomic(local);
-        return pruned;
-    }
-
-    int _pruneSection(const JsonDocument& remote, DynamicJsonDocument& local,
-                      const char* sectionKey, const char* type) {
-        if (!local[sectionKey].is<JsonObject>()) return 0;
-        JsonObject section = local[sectionKey].as<JsonObject>();
-        JsonObjectConst remoteSection = remote[sectionKey].as<JsonObjectConst>();
-
-        std::vector<String> toRemove;
-        manifest::collectOrphans(section, remoteSection, toRemove);
-        if (toRemove.empty()) return 0;
-
-        hal::SDCard::Lock lock("AssetService::prune",
-                               freertos_config::SD_MUTEX_LONG_TIMEOUT_MS);
-        if (!lock.acquired()) return 0;
-
-        for (const auto& tokenId : toRemove) {
-            const char* extStr = section[tokenId]["ext"] | "";
-            String destPath = _buildPath(type, tokenId, extStr);
-            SD.remove(destPath.c_str()); // no-op if absent
-            section.remove(tokenId);
-            LOG_DEBUG("[ASSET-SVC] Pruned orphan %s %s\n", type, tokenId.c_str());
+    int _pruneOrphans(const manifest::Table& remote, manifest::Table& local) {
+        std::vector<size_t> orphans = manifest::collectOrphans(local, remote);
+        if (orphans.empty()) return 0;
+
+        {
+            hal::SDCard::Lock lock("AssetService::prune",
+                                   freertos_config::SD_MUTEX_LONG_TIMEOUT_MS);
+            if (!lock.acquired()) return 0;
+
+            auto& pack = hal::AssetPack::getInstance();
+            // Back to front: a removal only shifts the entries after it
+            for (size_t k = orphans.size(); k-- > 0;) {
+                const manifest::Pending p = local.pending(orphans[k]);
+                SD.remove(_buildPath(p.type, p.tokenId, p.ext).c_str()); // no-op if absent
+                if (pack.isLoaded()) pack.remove(_packType(p), p.tokenId.c_str());
+                local.remove(orphans[k]);
+                LOG_DEBUG("[ASSET-SVC] Pruned orphan %s %s\n", p.type.c_str(), p.tokenId.c_str());
+            }
         }
-        return (int)toRemove.size();
+        _writeLocalManifestAtomic(local);
+        return (int)orphans.size();
     }
 
     String _buildPath(const String& type, const String& tokenId, const String& ext) const {
@@ -0,0 +1,129 @@
+#pragma once
+
+/**
+ * @file AssetSink.h
+ * @brief Where OrchestratorService::streamToSink() puts a verified asset body.
+ *
+ * Every call is made with the SD mutex held: open() once, write() per staged
+ * chunk, close() once, then commit() after the SHA-1 check or discard() on
+ * failure. Nothing a reader can see changes before commit().
+ *
+ * The one exception is validate(), run between close() and commit()
+ * without the mutex: a sink that has to re-read its whole body takes the
+ * lock per read itself, so commit() stays a short rename.
+ *
+ * Kept out of OrchestratorService.h (WiFi/HTTP/mbedtls) so the native
+ * power-loss tests can drive the exact SD sequences a download performs.
+ * The pipelined sync picks a sink per file at run time, hence the base.
+ */
+
+#include <Arduino.h>
+#include <SD.h>
+#include "../config.h"
+#include "../hal/AssetPack.h"
+#include "AtomicFile.h"
+
+namespace services {
+
+class AssetSink {
+public:
+    virtual ~AssetSink() = default;
+    virtual const char* name() const = 0;
+    virtual bool open() = 0;
+    virtual size_t write(const uint8_t* data, size_t len) = 0;
+    virtual void close() = 0;
+    virtual void discard() = 0;
+    virtual bool commit() = 0;
+    virtual bool validate() { return true; }  // SD mutex NOT held
+};
+
+// Loose file: <dest>.part, renamed over <dest> on commit
+class AssetFileSink : public AssetSink {
+public:
+    explicit AssetFileSink(const String& destPath)
+        : _dest(destPath), _part(destPath + paths::PART_SUFFIX) {}
+
+    const char* name() const override { return _part.c_str(); }
+
+    // Ensure the parent directory exists (first-boot path), clear any
+    // leftover .part from a prior aborted download, create the new one.
+    bool open() override {
+        int lastSlash = _dest.lastIndexOf('/');
+        if (lastSlash > 0) {
+            String dir = _dest.substring(0, lastSlash);
+            SD.mkdir(dir.c_str()); // no-op if already present
+        }
+        SD.remove(_part.c_str()); // no-op if absent
+        _f = SD.open(_part.c_str(), FILE_WRITE);
+        return static_cast<bool>(_f);
+    }
+
+    size_t write(const uint8_t* data, size_t len) override { return _f.write(data, len); }
+
+    void close() override {
+        _f.flush();
+        _f.close();
+    }
+
+    void discard() override { SD.remove(_part.c_str()); }
+
+    // Swap into the final name. A cut between the remove and the rename
+    // leaves <dest> missing; the manifest still holds the old sha1, so the
+    // next sync downloads it again. The .part is not recovered: it may be
+    // a partial first download.
+    bool commit() override {
+        return atomic_file::replace(_part.c_str(), _dest.c_str());
+    }
+
+private:
+    String _dest;
+    String _part;
+    File _f;
+};
+
+// Free extent of the asset pack; index entry committed on success
+class AssetPackSink : public AssetSink {
+public:
+    AssetPackSink(hal::AssetPack& pack, const String& loosePath)
+        : _pack(pack), _loosePath(loosePath) {}
+
+    const char* name() const override { return _pack.path(); }
+
+    // Reserve the extent and build the entry (before any network I/O)
+    bool prepare(uint8_t type, const String& tokenId, const String& ext,
+                 size_t size, const String& sha1Hex) {
+        uint32_t offset;
+        String sha = sha1Hex;
+        sha.toLowerCase();
+        return _pack.reserve(size, offset) &&
+               hal::AssetPack::makeEntry(type, tokenId, ext, sha, offset, size, _entry);
+    }
+
+    bool open() override {
+        _f = SD.open(_pack.path(), "r+");
+        return _f && _f.seek(_entry.offset);
+    }
+
+    size_t write(const uint8_t* data, size_t len) override { return _f.write(data, len); }
+
+    void close() override {
+        _f.flush();  // Extent durable before the index points at it
+        _f.close();
+    }
+
+    void discard() override {}  // Extent was never referenced
+
+    bool commit() override {
+        if (!_pack.put(_entry)) return false;
+        SD.remove(_loosePath.c_str()); // stale loose copy, no-op if absent
+        return true;
+    }
+
+private:
+    hal::AssetPack& _pack;
+    String _loosePath;
+    hal::AssetPack::Entry _entry;
+    File _f;
+};
+
+} // namespace services
@@ -0,0 +1,371 @@
+#pragma once
+
+/**
+ * @file AssetStream.h
+ * @brief Wire formats of the pipelined asset sync (services/AssetConnection.h):
+ *        response heads read off a raw keep-alive socket, the ustar bundle
+ *        stream, and the per-run totals.
+ *
+ * HTTPClient sends one request and parses one response per call, so it
+ * can't pipeline. The sync connection writes its own requests and reads
+ * its own responses; the parsing lives here, free of WiFi/mbedtls, so the
+ * native tests can feed it byte by byte.
+ */
+
+#include <Arduino.h>
+#include <cstdlib>
+#include <cstring>
+#include "../config.h"
+
+namespace services {
+
+// ─── Target ───────────────────────────────────────────────────────────
+
+struct HttpTarget {
+    bool secure = false;
+    String host;
+    uint16_t port = 0;
+    String basePath;  // Path prefix of the base URL, without trailing '/'
+};
+
+// "http[s]://host[:port][/prefix]" -> target; false for anything else
+inline bool parseHttpTarget(const String& url, HttpTarget& out) {
+    const char* s = url.c_str();
+    const char* rest;
+    if (strncasecmp(s, "https://", 8) == 0) {
+        out.secure = true;
+        rest = s + 8;
+    } else if (strncasecmp(s, "http://", 7) == 0) {
+        out.secure = false;
+        rest = s + 7;
+    } else {
+        return false;
+    }
+
+    const char* path = strchr(rest, '/');
+    const char* end = path ? path : rest + strlen(rest);
+    const char* colon = static_cast<const char*>(memchr(rest, ':', end - rest));
+    String host;
+    for (const char* p = rest; p < (colon ? colon : end); p++) host += *p;
+    if (host.length() == 0) return false;
+
+    if (colon) {
+        char* portEnd;
+        long port = strtol(colon + 1, &portEnd, 10);
+        if (portEnd != end || port <= 0 || port > 65535) return false;
+        out.port = static_cast<uint16_t>(port);
+    } else {
+        out.port = out.secure ? 443 : 80;
+    }
+    out.host = host;
+
+    out.basePath = path ? String(path) : String();
+    while (out.basePath.length() > 0 && out.basePath[out.basePath.length() - 1] == '/') {
+        out.basePath = out.basePath.substring(0, out.basePath.length() - 1);
+    }
+    return true;
+}
+
+/**
+ * @brief Request head for the sync connection.
+ *
+ * HTTP/1.1 requests stay on the connection and may be pipelined; an
+ * HTTP/1.0 request asks the server to close after its response, which
+ * then needs no length (the bundle, the push channel's event stream).
+ */
+inline String httpRequestHead(const char* method, const HttpTarget& target,
+                              const String& path, bool http11,
+                              const char* contentType = nullptr, size_t contentLength = 0,
+                              const char* extraHeaders = nullptr) {
+    String head = String(method) + " " + target.basePath + path +
+                  (http11 ? " HTTP/1.1\r\n" : " HTTP/1.0\r\n");
+    head += "Host: " + target.host;
+    if (target.port != (target.secure ? 443 : 80)) {
+        head += ":" + String(static_cast<unsigned int>(target.port));
+    }
+    head += "\r\n";
+    head += http11 ? "Connection: keep-alive\r\n" : "Connection: close\r\n";
+    if (contentType) {
+        head += "Content-Type: " + String(contentType) + "\r\n";
+        head += "Content-Length: " + String(static_cast<unsigned long>(contentLength)) + "\r\n";
+    }
+    if (extraHeaders) head += extraHeaders;  // Complete "Name: value\r\n" lines
+    head += "\r\n";
+    return head;
+}
+
+// ─── Response head ────────────────────────────────────────────────────
+
+/**
+ * Incremental parser for one HTTP/1.x response head. feed() stops at the
+ * blank line, so the caller can hand it exactly the bytes before the body.
+ * Only what the sync needs is kept: status, Content-Length, keep-alive
+ * and chunked framing (which the sync does not accept).
+ */
+class HttpResponseHead {
+public:
+    int status = 0;
+    long contentLength = -1;  // -1: absent
+    bool keepAlive = false;
+    bool chunked = false;
+
+    // Returns the bytes consumed; less than len once the head is complete
+    size_t feed(const uint8_t* data, size_t len) {
+        size_t used = 0;
+        while (used < len && !done() && !failed()) {
+            char c = static_cast<char>(data[used++]);
+            if (++_total > static_cast<size_t>(limits::ASSET_MAX_HEAD_BYTES)) {
+                _state = State::Failed;
+                break;
+            }
+            if (c == '\r') continue;
+            if (c != '\n') {
+                if (_len < sizeof(_line) - 1) _line[_len++] = c;  // Long lines truncated
+                continue;
+            }
+            _line[_len] = '\0';
+            endLine();
+            _len = 0;
+        }
+        return used;
+    }
+
+    bool done() const { return _state == State::Done; }
+    bool failed() const { return _state == State::Failed; }
+
+private:
+    enum class State { StatusLine, Headers, Done, Failed };
+
+    void endLine() {
+        if (_state == State::StatusLine) {
+            // "HTTP/1.1 200 OK"
+            if (strncmp(_line, "HTTP/1.", 7) != 0 || _len < 12 || _line[8] != ' ') {
+                _state = State::Failed;
+                return;
+            }
+            keepAlive = _line[7] == '1';  // HTTP/1.1 default
+            status = atoi(_line + 9);
+            _state = status >= 100 ? State::Headers : State::Failed;
+            return;
+        }
+        if (_len == 0) {
+            _state = State::Done;
+            return;
+        }
+        char* colon = strchr(_line, ':');
+        if (!colon) return;
+        *colon = '\0';
+        const char* value = colon + 1;
+        while (*value == ' ' || *value == '\t') value++;
+
+        if (strcasecmp(_line, "Content-Length") == 0) {
+            char* end;
+            long n = strtol(value, &end, 10);
+            contentLength = end != value && n >= 0 ? n : -1;
+        } else if (strcasecmp(_line, "Connection") == 0) {
+            if (strcasecmp(value, "close") == 0) keepAlive = false;
+            else if (strcasecmp(value, "keep-alive") == 0) keepAlive = true;
+        } else if (strcasecmp(_line, "Transfer-Encoding") == 0) {
+            chunked = strcasecmp(value, "identity") != 0;
+        }
+    }
+
+    State _state = State::StatusLine;
+    char _line[128];
+    size_t _len = 0;
+    size_t _total = 0;
+};
+
+// ─── Bundle ───────────────────────────────────────────────────────────
+
+/**
+ * Streaming ustar reader for the asset bundle. feed() takes the response
+ * body in any slicing and drives a handler:
+ *
+ *   bool onEntry(const char* name, uint32_t size)  false = skip its data
+ *   bool onData(const uint8_t* data, size_t len)   false = abort
+ *   bool onEntryEnd()                              false = abort
+ *
+ * Only regular files reach the handler; directories, pax and GNU long-name
+ * records are skipped. A zero block ends the archive. Headers failing
+ * their checksum abort the stream (the bundle is not resynchronisable).
+ */
+class TarReader {
+public:
+    static constexpr size_t BLOCK = 512;
+
+    template <typename Handler>
+    bool feed(const uint8_t* data, size_t len, Handler& handler) {
+        while (len > 0 && _state != State::Ended && _state != State::Failed) {
+            if (_state == State::Header) {
+                size_t n = take(_header + _filled, BLOCK - _filled, data, len);
+                _filled += n;
+                if (_filled < BLOCK) break;
+                _filled = 0;
+                beginEntry(handler);
+            } else if (_state == State::Data) {
+                size_t n = _remaining < len ? static_cast<size_t>(_remaining) : len;
+                if (_deliver && !handler.onData(data, n)) _state = State::Failed;
+                data += n;
+                len -= n;
+                _remaining -= n;
+                if (_state != State::Failed && _remaining == 0) endEntry(handler);
+            } else {  // Padding
+                size_t n = _remaining < len ? static_cast<size_t>(_remaining) : len;
+                data += n;
+                len -= n;
+                _remaining -= n;
+                if (_remaining == 0) _state = State::Header;
+            }
+        }
+        return _state != State::Failed;
+    }
+
+    // Saw the end-of-archive block
+    bool ended() const { return _state == State::Ended; }
+    bool failed() const { return _state == State::Failed; }
+    uint32_t entries() const { return _entries; }
+
+private:
+    enum class State { Header, Data, Padding, Ended, Failed };
+
+    static size_t take(uint8_t* dst, size_t want, const uint8_t*& src, size_t& len) {
+        size_t n = want < len ? want : len;
+        memcpy(dst, src, n);
+        src += n;
+        len -= n;
+        return n;
+    }
+
+    // Octal field, NUL/space terminated
+    static bool octal(const uint8_t* field, size_t width, uint32_t& out) {
+        uint64_t v = 0;
+        size_t i = 0;
+        while (i < width && field[i] == ' ') i++;
+        size_t digits = 0;
+        for (; i < width && field[i] >= '0' && field[i] <= '7'; i++, digits++) {
+            v = v * 8 + (field[i] - '0');
+            if (v > UINT32_MAX) return false;
+        }
+        if (digits == 0) return false;
+        for (; i < width; i++) {
+            if (field[i] != ' ' && field[i] != '\0') return false;
+        }
+        out = static_cast<uint32_t>(v);
+        return true;
+    }
+
+    bool checksumOk() const {
+        uint32_t stored;
+        if (!octal(_header + 148, 8, stored)) return false;
+        uint32_t sum = 0;
+        for (size_t i = 0; i < BLOCK; i++) {
+            sum += (i >= 148 && i < 156) ? ' ' : _header[i];
+        }
+        return sum == stored;
+    }
+
+    template <typename Handler>
+    void beginEntry(Handler& handler) {
+        bool zero = true;
+        for (size_t i = 0; i < BLOCK && zero; i++) zero = _header[i] == 0;
+        if (zero) {
+            _state = State::Ended;
+            return;
+        }
+
+        uint32_t size;
+        if (!checksumOk() || !octal(_header + 124, 12, size)) {
+            _state = State::Failed;
+            return;
+        }
+
+        // ustar: prefix (155 @345) + '/' + name (100 @0), each NUL-padded
+        char name[256];
+        size_t n = 0;
+        if (memcmp(_header + 257, "ustar", 5) == 0 && _header[345]) {
+            for (size_t i = 0; i < 155 && _header[345 + i]; i++) name[n++] = _header[345 + i];
+            name[n++] = '/';
+        }
+        for (size_t i = 0; i < 100 && _header[i]; i++) name[n++] = _header[i];
+        name[n] = '\0';
+
+        char type = static_cast<char>(_header[156]);
+        bool regular = type == '0' || type == '\0';
+        _deliver = false;
+        if (regular) {
+            _entries++;
+            _deliver = handler.onEntry(name, size);
+        }
+        _remaining = size;
+        _pad = (BLOCK - size % BLOCK) % BLOCK;
+        _state = State::Data;
+        if (size == 0) endEntry(handler);
+    }
+
+    template <typename Handler>
+    void endEntry(Handler& handler) {
+        if (_deliver && !handler.onEntryEnd()) {
+            _state = State::Failed;
+            return;
+        }
+        _deliver = false;
+        _remaining = _pad;
+        _state = _pad > 0 ? State::Padding : State::Header;
+    }
+
+    State _state = State::Header;
+    uint8_t _header[BLOCK];
+    size_t _filled = 0;
+    uint32_t _remaining = 0;
+    uint32_t _pad = 0;
+    bool _deliver = false;
+    uint32_t _entries = 0;
+};
+
+// ─── Per-run totals ───────────────────────────────────────────────────
+
+/**
+ * One asset sync, from manifest request to last commit. Handshakes and
+ * requests count every connection the run used (the orchestrator
+ * keep-alive one included), so modes compare directly. Logged at the end
+ * of each sync and by the ASSET_STATS serial command.
+ */
+struct AssetSyncStats {
+    const char* mode = "";
+    uint32_t queued = 0;
+    uint32_t files = 0;      // Downloaded and committed
+    uint32_t failed = 0;
+    uint32_t bundled = 0;    // Of files, how many came in the bundle
+    uint32_t pruned = 0;
+    uint32_t bytes = 0;      // Committed payload bytes
+    uint32_t requests = 0;
+    uint32_t handshakes = 0;
+    uint32_t reconnects = 0; // Sync connection re-opened mid-run
+    uint32_t elapsedMs = 0;
+    bool notModified = false;  // Manifest answered 304: nothing to diff
+
+    float filesPerSec() const { return elapsedMs ? files * 1000.0f / elapsedMs : 0.0f; }
+    float mbPerSec() const {
+        return elapsedMs ? bytes / 1048576.0f * 1000.0f / elapsedMs : 0.0f;
+    }
+
+    void print() const {
+        if (notModified) {
+            Serial.printf("ASSET SYNC (%s): manifest not modified; %lu requests, "
+                          "%lu handshakes in %.1f s\n", mode, (unsigned long)requests,
+                          (unsigned long)handshakes, elapsedMs / 1000.0f);
+            return;
+        }
+        Serial.printf("ASSET SYNC (%s): %lu/%lu ok, %lu failed, %lu pruned; "
+                      "%.2f MB in %.1f s\n", mode, (unsigned long)files,
+                      (unsigned long)queued, (unsigned long)failed, (unsigned long)pruned,
+                      bytes / 1048576.0f, elapsedMs / 1000.0f);
+        Serial.printf("  %.2f files/s, %.3f MB/s; %lu requests, %lu handshakes, "
+                      "%lu reconnects, %lu from bundle\n", filesPerSec(), mbPerSec(),
+                      (unsigned long)requests, (unsigned long)handshakes,
+                      (unsigned long)reconnects, (unsigned long)bundled);
+    }
+};
+
+} // namespace services
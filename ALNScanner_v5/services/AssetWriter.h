@@ -0,0 +1,232 @@
+#pragma once
+
+/**
+ * @file AssetWriter.h
+ * @brief Verified write of one downloaded asset body into an AssetSink.
+ *
+ * Shared by OrchestratorService::streamToSink() (one HTTPClient request
+ * per file) and AssetConnection (the pipelined sync connection). The body
+ * is staged unlocked and hashed as it arrives; only the write of a full
+ * chunk, and the open/close/commit, run under a short SD lock, so image
+ * draws and queue writes on other tasks interleave with a mid-session
+ * sync instead of waiting out the whole file.
+ *
+ * Lifecycle: open(); then space()/produced() (socket reads straight into
+ * the staging buffer) or write() for each piece of body; then finish(),
+ * which flushes, checks size and SHA-1 and commits. Destroyed unfinished,
+ * it closes and discards the sink.
+ *
+ * A body nobody published a digest for (the token database) is written
+ * unverified: the caller checks it is whole (Content-Length, gzip trailer)
+ * before finish(), and the SHA-1 is only logged. The sink's validate()
+ * runs before the commit lock is taken, so a check that re-reads the body
+ * never holds the SD mutex for more than one read.
+ */
+
+#include <Arduino.h>
+#include <SD.h>
+#include <mbedtls/sha1.h>
+#include <functional>
+#include "../hal/SDCard.h"
+#include "../config.h"
+#include "AssetSink.h"
+
+namespace services {
+
+class AssetWriter {
+public:
+    using Progress = std::function<void(size_t, size_t)>;
+    static constexpr size_t CHUNK = limits::ASSET_DOWNLOAD_CHUNK_SIZE;
+
+    AssetWriter(AssetSink& sink, size_t expectedSize, const String& expectedSha1,
+                Progress onProgress = nullptr)
+        : _sink(sink), _expectedSize(expectedSize), _expectedSha1(expectedSha1),
+          _onProgress(onProgress) {}
+
+    // Unverified: any size, SHA-1 logged instead of compared
+    explicit AssetWriter(AssetSink& sink, Progress onProgress = nullptr)
+        : _sink(sink), _expectedSize(0), _onProgress(onProgress), _verify(false) {}
+
+    ~AssetWriter() {
+        if (!_opened || _finished) return;
+        {
+            // Long timeout: the handle must not leak
+            hal::SDCard::Lock lock("stream:close", freertos_config::SD_MUTEX_LONG_TIMEOUT_MS);
+            _sink.close();
+        }
+        mbedtls_sha1_free(&_sha);
+        hal::SDCard::Lock lock("stream:cleanup", freertos_config::SD_MUTEX_TIMEOUT_MS);
+        if (lock.acquired()) _sink.discard();
+    }
+
+    AssetWriter(const AssetWriter&) = delete;
+    AssetWriter& operator=(const AssetWriter&) = delete;
+
+    bool open() {
+        hal::SDCard::Lock lock("stream:open", freertos_config::SD_MUTEX_TIMEOUT_MS);
+        if (!lock.acquired()) {
+            Serial.println("[STREAM] SD lock failed");
+            return false;
+        }
+        if (!_sink.open()) {
+            Serial.printf("[STREAM] could not open %s\n", _sink.name());
+            return false;
+        }
+        _opened = true;
+        mbedtls_sha1_init(&_sha);
+        mbedtls_sha1_starts(&_sha);
+        return true;
+    }
+
+    // Free staging space for the next read
+    uint8_t* space(size_t& room) {
+        room = CHUNK - _staged;
+        return stagingBuffer() + _staged;
+    }
+
+    // n bytes were read into space(); false once a chunk write failed
+    bool produced(size_t n) {
+        if (_failed) return false;
+        mbedtls_sha1_update(&_sha, stagingBuffer() + _staged, n);
+        _staged += n;
+        _received += n;
+        if (_staged == CHUNK && !flush()) {
+            _failed = true;
+            return false;
+        }
+        if (_onProgress) _onProgress(_received, _expectedSize);
+        return true;
+    }
+
+    // Copying variant for bodies that arrive through a parser (bundle)
+    bool write(const uint8_t* data, size_t len) {
+        while (len > 0) {
+            size_t room;
+            uint8_t* dst = space(room);
+            size_t n = len < room ? len : room;
+            memcpy(dst, data, n);
+            if (!produced(n)) return false;
+            data += n;
+            len -= n;
+        }
+        return true;
+    }
+
+    size_t received() const { return _received; }
+
+    // Flush, verify size and SHA-1, commit; the sink is discarded on failure
+    bool finish() {
+        bool ok = !_failed && flush();
+        {
+            hal::SDCard::Lock lock("stream:close", freertos_config::SD_MUTEX_LONG_TIMEOUT_MS);
+            _sink.close();
+        }
+        _finished = true;
+
+        unsigned char digest[20];
+        mbedtls_sha1_finish(&_sha, digest);
+        mbedtls_sha1_free(&_sha);
+
+        LOG_INFO("[STREAM] %u bytes in %lu chunk writes, SD lock held max %lu us, "
+                 "waited max %lu us\n", (unsigned)_received, (unsigned long)_chunks,
+                 (unsigned long)_maxHoldUs, (unsigned long)_maxWaitUs);
+
+        if (!ok || (_verify && _received != _expectedSize)) {
+            Serial.printf("[STREAM] short read %u/%u\n",
+                          (unsigned)_received, (unsigned)_expectedSize);
+            hal::SDCard::Lock lock("stream:cleanup", freertos_config::SD_MUTEX_TIMEOUT_MS);
+            if (lock.acquired()) _sink.discard();
+            return false;
+        }
+
+        // Hex-encode digest for manifest comparison.
+        char hex[41];
+        for (int i = 0; i < 20; i++) {
+            snprintf(&hex[i * 2], 3, "%02x", digest[i]);
+        }
+        hex[40] = '\0';
+        String wantSha = _expectedSha1;
+        wantSha.toLowerCase();
+        if (!_verify) LOG_INFO("[STREAM] %s sha1=%s\n", _sink.name(), hex);
+
+        if (!_sink.validate()) {
+            Serial.printf("[STREAM] %s failed validation\n", _sink.name());
+            hal::SDCard::Lock lock("stream:cleanup", freertos_config::SD_MUTEX_TIMEOUT_MS);
+            if (lock.acquired()) _sink.discard();
+            return false;
+        }
+
+        hal::SDCard::Lock lock("stream:commit", freertos_config::SD_MUTEX_TIMEOUT_MS);
+        if (!lock.acquired()) {
+            Serial.println("[STREAM] SD lock failed before commit");
+            return false;  // Nothing visible yet; the next attempt starts over
+        }
+        if (_verify && (wantSha.length() != 40 || wantSha != hex)) {
+            Serial.printf("[STREAM] sha1 mismatch got=%s want=%s\n", hex, wantSha.c_str());
+            _sink.discard();
+            return false;
+        }
+
+        if (!_sink.commit()) {
+            Serial.printf("[STREAM] commit failed for %s\n", _sink.name());
+            _sink.discard();
+            return false;
+        }
+        return true;
+    }
+
+private:
+    // NOT on the stack: the Arduino loopTask stack is only 8 KB and the
+    // mbedTLS handshake already consumes most of it, so a 4 KB on-stack
+    // buffer overflows it - stack-canary panic on the very first asset
+    // download. Static moves it to .bss; safe because asset and token syncs
+    // run one writer at a time on the main task and are never re-entered.
+    static uint8_t* stagingBuffer() {
+        static uint8_t buffer[CHUNK];
+        return buffer;
+    }
+
+    // Write the staged bytes under a short per-chunk lock
+    bool flush() {
+        if (_staged == 0) return true;
+        uint32_t requestUs = micros();
+        hal::SDCard::Lock lock("stream:chunk", freertos_config::SD_MUTEX_TIMEOUT_MS);
+        if (!lock.acquired()) {
+            Serial.println("[STREAM] SD lock failed mid-download");
+            return false;
+        }
+        uint32_t lockedUs = micros();
+        size_t written = _sink.write(stagingBuffer(), _staged);
+        uint32_t holdUs = micros() - lockedUs;
+        if (lockedUs - requestUs > _maxWaitUs) _maxWaitUs = lockedUs - requestUs;
+        if (holdUs > _maxHoldUs) _maxHoldUs = holdUs;
+        _chunks++;
+        if (written != _staged) {
+            Serial.printf("[STREAM] SD write short %u/%u\n",
+                          (unsigned)written, (unsigned)_staged);
+            return false;
+        }
+        _staged = 0;
+        return true;
+    }
+
+    AssetSink& _sink;
+    size_t _expectedSize;
+    String _expectedSha1;
+    Progress _onProgress;
+
+    mbedtls_sha1_context _sha;
+    size_t _staged = 0;
+    size_t _received = 0;
+    bool _opened = false;
+    bool _finished = false;
+    bool _failed = false;
+    bool _verify = true;
+
+    // Per-download lock profile, reported by finish()
+    uint32_t _chunks = 0;
+    uint32_t _maxHoldUs = 0;
+    uint32_t _maxWaitUs = 0;
+};
+
+} // namespace services
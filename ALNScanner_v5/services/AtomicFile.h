@@ -0,0 +1,71 @@
+#pragma once
+
+/**
+ * @file AtomicFile.h
+ * @brief Write-temp-then-rename replacement of SD files, and its boot recovery.
+ *
+ * FATFS cannot rename over an existing file, so a replace is three steps:
+ * write and flush <tmp>, remove <dest>, rename <tmp> -> <dest>. Power loss
+ * leaves one of three states, which recover() folds back to one file:
+ *
+ *   dest + tmp  cut before the remove: dest is still authoritative, tmp
+ *               (partial or complete) is dropped
+ *   tmp only    cut between remove and rename: tmp is complete and is
+ *               renamed into place. (Also the state after a cut during the
+ *               very first write, when no dest existed yet; callers already
+ *               validate what they read - JSON parse, CRC - so a partial
+ *               first write reads as absent, as it would have anyway.)
+ *   dest only   nothing to do
+ *
+ * Without recover() the "tmp only" state reads as a missing file: a lost
+ * local manifest means every asset is downloaded again.
+ *
+ * Callers hold hal::SDCard::Lock.
+ */
+
+#include <Arduino.h>
+#include <SD.h>
+
+namespace services {
+namespace atomic_file {
+
+// Install a flushed and closed tmp as dest
+inline bool replace(const char* tmp, const char* dest) {
+    SD.remove(dest);  // no-op if absent
+    return SD.rename(tmp, dest);
+}
+
+/**
+ * @brief Write dest via tmp; body(File&) -> bool writes the contents
+ * @return false if tmp could not be written (dest untouched) or installed
+ */
+template <typename Fn>
+bool write(const char* tmp, const char* dest, Fn body) {
+    SD.remove(tmp);  // no-op if absent
+    File f = SD.open(tmp, FILE_WRITE);
+    if (!f) return false;
+    bool ok = body(f);
+    f.flush();
+    f.close();
+    if (!ok) {
+        SD.remove(tmp);
+        return false;
+    }
+    return replace(tmp, dest);
+}
+
+/**
+ * @brief Finish or roll back a replace cut short by power loss
+ * @return true if tmp was renamed into place
+ */
+inline bool recover(const char* tmp, const char* dest) {
+    if (!SD.exists(tmp)) return false;
+    if (SD.exists(dest)) {
+        SD.remove(tmp);
+        return false;
+    }
+    return SD.rename(tmp, dest);
+}
+
+} // namespace atomic_file
+} // namespace services
@@ -0,0 +1,113 @@
+#pragma once
+
+/**
+ * @file BatchDrain.h
+ * @brief Batch sizing and throughput bookkeeping for the offline queue
+ *        drain (OrchestratorService::uploadQueueBatch).
+ *
+ * The drain posts one batch after another with no pause while the
+ * orchestrator keeps up. BatchSizer picks each batch's size: it doubles
+ * while a batch comes back well inside BATCH_TARGET_RTT_MS, scales down
+ * in proportion when one takes longer and halves after a failed batch.
+ * The body streams from the ring as it is sent, so heap only gates
+ * whether a batch goes out at all, not its size; bytes per scan is kept
+ * for QUEUE_STATUS. Kept free of WiFi/HTTPClient so the policy is
+ * natively testable; QUEUE_STATUS prints DrainStats.
+ */
+
+#include <Arduino.h>
+#include "../config.h"
+
+namespace services {
+
+class BatchSizer {
+public:
+    /**
+     * @brief Scans for the next batch
+     * @return the current size; 0 if freeHeap is down to the reserve
+     *         (leave the queue for later)
+     */
+    uint16_t next(uint32_t freeHeap) const {
+        return freeHeap > queue_config::BATCH_HEAP_RESERVE ? _size : 0;
+    }
+
+    /**
+     * @param scans     Scans in the acknowledged batch
+     * @param bodyBytes Request body length
+     * @param rttMs     Send to response, retries included
+     */
+    void onSuccess(uint16_t scans, size_t bodyBytes, uint32_t rttMs) {
+        if (scans == 0) return;
+        uint32_t perScan = bodyBytes / scans;
+        // Smoothed: one batch of unusually long tokenIds should not swing it
+        _bytesPerScan = (uint16_t)((_bytesPerScan * 3u + (perScan ? perScan : 1)) / 4u);
+        if (_bytesPerScan == 0) _bytesPerScan = 1;
+
+        if (rttMs > queue_config::BATCH_TARGET_RTT_MS) {
+            uint32_t scaled = (uint32_t)_size * queue_config::BATCH_TARGET_RTT_MS / rttMs;
+            _size = clamp(scaled);
+        } else if (scans >= _size && rttMs <= queue_config::BATCH_TARGET_RTT_MS / 2) {
+            // Only a full batch says anything about a bigger one
+            _size = clamp((uint32_t)_size * 2);
+        }
+    }
+
+    void onFailure() { _size = clamp(_size / 2); }
+
+    uint16_t size() const { return _size; }
+    uint16_t bytesPerScan() const { return _bytesPerScan; }
+
+private:
+    static uint16_t clamp(uint32_t n) {
+        if (n < queue_config::BATCH_MIN_SIZE) return queue_config::BATCH_MIN_SIZE;
+        if (n > queue_config::BATCH_MAX_SIZE) return queue_config::BATCH_MAX_SIZE;
+        return (uint16_t)n;
+    }
+
+    uint16_t _size = queue_config::BATCH_START_SIZE;
+    uint16_t _bytesPerScan = queue_config::BATCH_SCAN_BYTES_GUESS;
+};
+
+struct DrainStats {
+    uint32_t runs = 0;          // Drains that found scans to send
+    uint32_t batches = 0;       // Acknowledged batches
+    uint32_t failures = 0;      // Batches that failed after retries
+    uint32_t scans = 0;
+    uint32_t bytes = 0;
+    uint32_t busyMs = 0;        // Total time spent draining
+    uint32_t lastScans = 0;     // Most recent drain
+    uint32_t lastMs = 0;
+    uint32_t lastRttMs = 0;     // Most recent acknowledged batch
+    uint16_t batchSize = queue_config::BATCH_START_SIZE;  // Next batch
+    uint16_t bytesPerScan = queue_config::BATCH_SCAN_BYTES_GUESS;
+
+    void recordBatch(uint16_t n, size_t bodyBytes, uint32_t rttMs) {
+        batches++;
+        scans += n;
+        bytes += bodyBytes;
+        lastRttMs = rttMs;
+    }
+
+    void recordRun(uint32_t runScans, uint32_t runMs) {
+        if (runScans == 0) return;
+        runs++;
+        busyMs += runMs;
+        lastScans = runScans;
+        lastMs = runMs;
+    }
+
+    static float rate(uint32_t n, uint32_t ms) { return ms ? n * 1000.0f / ms : 0.0f; }
+
+    void print() const {
+        Serial.printf("Drain: last run %lu scans in %.1f s (%.1f scans/s); overall %.1f scans/s\n",
+                      (unsigned long)lastScans, lastMs / 1000.0f, rate(lastScans, lastMs),
+                      rate(scans, busyMs));
+        Serial.printf("  %lu runs, %lu batches, %lu failed; %lu scans, %lu bytes\n",
+                      (unsigned long)runs, (unsigned long)batches, (unsigned long)failures,
+                      (unsigned long)scans, (unsigned long)bytes);
+        Serial.printf("  next batch %u scans (~%u B each), last RTT %lu ms\n",
+                      batchSize, bytesPerScan, (unsigned long)lastRttMs);
+    }
+};
+
+} // namespace services
@@ -167,10 +167,24 @@ public:
                 _config.syncAssets = !(value.equalsIgnoreCase("false") || value == "0");
                 LOG_DEBUG("[CONFIG]       SYNC_ASSETS set to %s\n", _config.syncAssets ? "TRUE" : "FALSE");
                 parsedKeys++;
+            } else if (key == "ASSET_PACK") {
+                _config.assetPack = !(value.equalsIgnoreCase("false") || value == "0");
+                LOG_DEBUG("[CONFIG]       ASSET_PACK set to %s\n", _config.assetPack ? "TRUE" : "FALSE");
+                parsedKeys++;
+            } else if (key == "ASSET_FETCH") {
+                parseAssetFetch(value);
+                parsedKeys++;
+            } else if (key == "PUSH_CHANNEL") {
+                _config.pushChannel = !(value.equalsIgnoreCase("false") || value == "0");
+                LOG_DEBUG("[CONFIG]       PUSH_CHANNEL set to %s\n", _config.pushChannel ? "TRUE" : "FALSE");
+                parsedKeys++;
             } else if (key == "DEBUG_MODE") {
                 _config.debugMode = !(value.equalsIgnoreCase("false") || value == "0");
                 LOG_DEBUG("[CONFIG]       DEBUG_MODE set to %s\n", _config.debugMode ? "TRUE" : "FALSE");
                 parsedKeys++;
+            } else if (key == "SD_CLOCK_KHZ") {
+                _config.sdClockKHz = parseSdClock(value);
+                parsedKeys++;
             } else {
                 LOG_DEBUG("[CONFIG]         (unknown key, ignored)\n");
             }
@@ -187,7 +201,12 @@ public:
         LOG_INFO("  DEVICE_ID: %s\n", _config.deviceID.length() > 0 ? _config.deviceID.c_str() : "(auto-generate)");
         LOG_INFO("  SYNC_TOKENS: %s\n", _config.syncTokens ? "true" : "false");
         LOG_INFO("  SYNC_ASSETS: %s\n", _config.syncAssets ? "true" : "false");
+        LOG_INFO("  ASSET_PACK: %s\n", _config.assetPack ? "true" : "false");
+        LOG_INFO("  ASSET_FETCH: %s\n", models::assetFetchModeName(_config.assetFetch));
+        LOG_INFO("  PUSH_CHANNEL: %s\n", _config.pushChannel ? "true" : "false");
         LOG_INFO("  DEBUG_MODE: %s\n", _config.debugMode ? "true" : "false");
+        LOG_INFO("  SD_CLOCK_KHZ: %lu%s\n", (unsigned long)_config.sdClockKHz,
+                 _config.sdClockKHz ? "" : " (auto)");
         LOG_INFO("[CONFIG] Free heap after parsing: %d bytes\n", ESP.getFreeHeap());
 
         // Auto-generate device ID if not set
@@ -253,8 +272,16 @@ public:
 
         file.printf("SYNC_TOKENS=%s\n", _config.syncTokens ? "true" : "false");
         file.printf("SYNC_ASSETS=%s\n", _config.syncAssets ? "true" : "false");
+        file.printf("ASSET_PACK=%s\n", _config.assetPack ? "true" : "false");
+        file.printf("ASSET_FETCH=%s\n", models::assetFetchModeName(_config.assetFetch));
+        file.printf("PUSH_CHANNEL=%s\n", _config.pushChannel ? "true" : "false");
         file.printf("DEBUG_MODE=%s\n", _config.debugMode ? "true" : "false");
 
+        // Only write SD_CLOCK_KHZ if pinned (absent = auto-tune)
+        if (_config.sdClockKHz) {
+            file.printf("SD_CLOCK_KHZ=%lu\n", (unsigned long)_config.sdClockKHz);
+        }
+
         file.flush();
         file.close();
 
@@ -294,9 +321,21 @@ public:
         } else if (key == "SYNC_ASSETS") {
             _config.syncAssets = !(value.equalsIgnoreCase("false") || value == "0");
             return true;
+        } else if (key == "ASSET_PACK") {
+            _config.assetPack = !(value.equalsIgnoreCase("false") || value == "0");
+            return true;
+        } else if (key == "ASSET_FETCH") {
+            parseAssetFetch(value);
+            return true;
+        } else if (key == "PUSH_CHANNEL") {
+            _config.pushChannel = !(value.equalsIgnoreCase("false") || value == "0");
+            return true;
         } else if (key == "DEBUG_MODE") {
             _config.debugMode = !(value.equalsIgnoreCase("false") || value == "0");
             return true;
+        } else if (key == "SD_CLOCK_KHZ") {
+            _config.sdClockKHz = parseSdClock(value);
+            return true;
         }
 
         return false; // Unknown key
@@ -408,6 +447,10 @@ public:
         // SYNC_TOKENS, SYNC_ASSETS and DEBUG_MODE are always valid (boolean)
         LOG_DEBUG("[VALIDATE] + SYNC_TOKENS valid: %s\n", _config.syncTokens ? "true" : "false");
         LOG_DEBUG("[VALIDATE] + SYNC_ASSETS valid: %s\n", _config.syncAssets ? "true" : "false");
+        LOG_DEBUG("[VALIDATE] + ASSET_PACK valid: %s\n", _config.assetPack ? "true" : "false");
+        LOG_DEBUG("[VALIDATE] + ASSET_FETCH valid: %s\n",
+                  models::assetFetchModeName(_config.assetFetch));
+        LOG_DEBUG("[VALIDATE] + PUSH_CHANNEL valid: %s\n", _config.pushChannel ? "true" : "false");
         LOG_DEBUG("[VALIDATE] + DEBUG_MODE valid: %s\n", _config.debugMode ? "true" : "false");
 
         if (isValid) {
@@ -483,6 +526,28 @@ private:
     ConfigService(const ConfigService&) = delete;
     ConfigService& operator=(const ConfigService&) = delete;
 
+    // SD_CLOCK_KHZ value -> kHz; out-of-range values fall back to auto (0)
+    static uint32_t parseSdClock(const String& value) {
+        long khz = value.toInt();
+        if (khz == 0) return 0;
+        if (khz < (long)sd_config::MIN_CLOCK_KHZ || khz > (long)sd_config::MAX_CLOCK_KHZ) {
+            LOG_INFO("[CONFIG] SD_CLOCK_KHZ=%s out of range (%lu-%lu), using auto\n",
+                     value.c_str(), (unsigned long)sd_config::MIN_CLOCK_KHZ,
+                     (unsigned long)sd_config::MAX_CLOCK_KHZ);
+            return 0;
+        }
+        return static_cast<uint32_t>(khz);
+    }
+
+    // ASSET_FETCH value; unknown values keep the default (pipeline)
+    void parseAssetFetch(const String& value) {
+        if (!models::parseAssetFetchMode(value, _config.assetFetch)) {
+            _config.assetFetch = models::AssetFetchMode::Pipeline;
+            LOG_INFO("[CONFIG] ASSET_FETCH=%s unknown (single|pipeline|bundle), "
+                     "using pipeline\n", value.c_str());
+        }
+    }
+
     // Internal configuration storage
     models::DeviceConfig _config;
 };
@@ -508,6 +573,10 @@ private:
  *    - DEVICE_ID: Custom device identifier (auto-generated from MAC if not set)
  *    - SYNC_TOKENS: Enable/disable token database sync (default: true)
  *    - DEBUG_MODE: Enable/disable debug features (default: false)
+ *    - ASSET_PACK: Sync assets into one packed file (default: false)
+ *    - ASSET_FETCH: Asset download mode single|pipeline|bundle (default: pipeline)
+ *    - PUSH_CHANNEL: Keep an event stream open to the orchestrator (default: true)
+ *    - SD_CLOCK_KHZ: Pin the SD SPI clock (400-40000); absent or 0 = auto-tune
  *
  * 4. BOOLEAN PARSING
  *    - Accepted as TRUE: "true", "1", "TRUE", any non-zero/non-false value
@@ -0,0 +1,27 @@
+#pragma once
+
+/**
+ * @file Crc32.h
+ * @brief CRC-32 (IEEE 802.3, reflected - same as zlib/PNG).
+ *
+ * Bit-wise, table-free: queue records and headers are tens of bytes, so the
+ * 1KB lookup table would cost more flash than it saves time. Pass the
+ * previous result as `crc` to checksum discontiguous spans.
+ */
+
+#include <Arduino.h>
+
+namespace services {
+
+inline uint32_t crc32(const uint8_t* data, size_t len, uint32_t crc = 0) {
+    crc = ~crc;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (uint8_t k = 0; k < 8; k++) {
+            crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+        }
+    }
+    return ~crc;
+}
+
+} // namespace services
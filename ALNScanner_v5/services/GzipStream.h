@@ -0,0 +1,245 @@
+#pragma once
+
+/**
+ * @file GzipStream.h
+ * @brief Streaming gzip (RFC 1952) decoder on the ESP32 ROM inflater (tinfl).
+ *
+ * feed() takes a Content-Encoding: gzip body in any slicing and hands the
+ * decoded bytes to out.write(data, len) as they come out of the inflater;
+ * finish(), at end of body, checks that the deflate stream ended and that
+ * the trailer's CRC-32 and length match what was decoded. Nothing is ever
+ * inflated into RAM whole, so the decoded size is bounded by the SD card.
+ *
+ * The inflater can read a few bytes past the end of the deflate data, so
+ * the trailer is taken from the last 8 bytes fed rather than from what
+ * tinfl leaves unconsumed.
+ *
+ * The decompressor (~11 KB) and its 32 KB history window are allocated by
+ * begin() and freed with the decoder - too big for any task stack.
+ */
+
+#include <Arduino.h>
+#include <esp32/rom/miniz.h>
+#include <new>
+#include "Crc32.h"
+
+namespace services {
+
+class GzipDecoder {
+public:
+    GzipDecoder() = default;
+    ~GzipDecoder() { release(); }
+
+    GzipDecoder(const GzipDecoder&) = delete;
+    GzipDecoder& operator=(const GzipDecoder&) = delete;
+
+    // false if the buffers could not be allocated
+    bool begin() {
+        release();
+        _inflator = new (std::nothrow) tinfl_decompressor;
+        _window = new (std::nothrow) uint8_t[TINFL_LZ_DICT_SIZE];
+        if (!_inflator || !_window) {
+            release();
+            _error = "out of memory";
+            return false;
+        }
+        tinfl_init(_inflator);
+        _state = State::Header;
+        _field = Field::Fixed;
+        _pos = 0;
+        _winPos = 0;
+        _crc = 0;
+        _in = 0;
+        _out = 0;
+        _error = nullptr;
+        return true;
+    }
+
+    /**
+     * @brief Decode the next slice of the body into out.write(data, len)
+     * @return false once the stream is invalid or out refused a write
+     */
+    template <typename Out>
+    bool feed(const uint8_t* data, size_t len, Out& out) {
+        if (_state == State::Failed || !_inflator) return false;
+        keepTail(data, len);
+        _in += len;
+        while (len > 0) {
+            switch (_state) {
+                case State::Header:
+                    headerByte(*data++);
+                    len--;
+                    break;
+                case State::Body:
+                    if (!inflate(data, len, out)) return false;
+                    break;
+                case State::Trailer:
+                    len = 0;  // Kept by keepTail()
+                    break;
+                case State::Failed:
+                    return false;
+            }
+        }
+        return _state != State::Failed;
+    }
+
+    // End of body: stream complete and the trailer matches
+    bool finish() {
+        if (_state == State::Failed) return false;
+        if (_state != State::Trailer) return fail("truncated");
+        if (le32(_tail) != _crc) return fail("crc mismatch");
+        if (le32(_tail + 4) != static_cast<uint32_t>(_out)) return fail("size mismatch");
+        return true;
+    }
+
+    size_t inBytes() const { return _in; }
+    size_t outBytes() const { return _out; }
+    const char* error() const { return _error ? _error : "none"; }
+
+private:
+    enum class State : uint8_t { Header, Body, Trailer, Failed };
+    // Header fields in wire order; optional ones are skipped per FLG
+    enum class Field : uint8_t { Fixed, ExtraLen, Extra, Name, Comment, HeaderCrc, Done };
+
+    static constexpr uint8_t FHCRC = 0x02;
+    static constexpr uint8_t FEXTRA = 0x04;
+    static constexpr uint8_t FNAME = 0x08;
+    static constexpr uint8_t FCOMMENT = 0x10;
+    static constexpr uint8_t FRESERVED = 0xE0;
+
+    void headerByte(uint8_t b) {
+        switch (_field) {
+            case Field::Fixed:
+                _fixed[_pos++] = b;
+                if (_pos < sizeof(_fixed)) return;
+                // ID1 ID2 CM=deflate FLG MTIME(4) XFL OS
+                if (_fixed[0] != 0x1f || _fixed[1] != 0x8b || _fixed[2] != 8 ||
+                    (_fixed[3] & FRESERVED)) {
+                    fail("not gzip");
+                    return;
+                }
+                break;
+            case Field::ExtraLen:
+                _skip |= static_cast<uint16_t>(b) << (8 * _pos++);
+                if (_pos < 2) return;
+                break;
+            case Field::Extra:
+                if (--_skip > 0) return;
+                break;
+            case Field::Name:
+            case Field::Comment:
+                if (b != 0) return;
+                break;
+            case Field::HeaderCrc:
+                if (++_pos < 2) return;
+                break;
+            case Field::Done:
+                return;
+        }
+        nextField();
+    }
+
+    void nextField() {
+        const uint8_t flags = _fixed[3];
+        _pos = 0;
+        for (;;) {
+            _field = static_cast<Field>(static_cast<uint8_t>(_field) + 1);
+            switch (_field) {
+                case Field::ExtraLen:
+                    if (flags & FEXTRA) {
+                        _skip = 0;
+                        return;
+                    }
+                    break;
+                case Field::Extra:
+                    if ((flags & FEXTRA) && _skip > 0) return;
+                    break;
+                case Field::Name:
+                    if (flags & FNAME) return;
+                    break;
+                case Field::Comment:
+                    if (flags & FCOMMENT) return;
+                    break;
+                case Field::HeaderCrc:
+                    if (flags & FHCRC) return;
+                    break;
+                default:
+                    _state = State::Body;
+                    return;
+            }
+        }
+    }
+
+    // Inflate until the input is used up or the deflate stream ends
+    template <typename Out>
+    bool inflate(const uint8_t*& data, size_t& len, Out& out) {
+        for (;;) {
+            size_t inSize = len;
+            size_t outSize = TINFL_LZ_DICT_SIZE - _winPos;
+            tinfl_status status = tinfl_decompress(_inflator, data, &inSize, _window,
+                                                   _window + _winPos, &outSize,
+                                                   TINFL_FLAG_HAS_MORE_INPUT);
+            data += inSize;
+            len -= inSize;
+            if (outSize > 0) {
+                _crc = crc32(_window + _winPos, outSize, _crc);
+                _out += outSize;
+                if (!out.write(_window + _winPos, outSize)) return fail("write failed");
+                _winPos = (_winPos + outSize) & (TINFL_LZ_DICT_SIZE - 1);
+            }
+            if (status == TINFL_STATUS_DONE) {
+                _state = State::Trailer;
+                len = 0;
+                return true;
+            }
+            if (status < 0) return fail("corrupt deflate data");
+            if (status == TINFL_STATUS_NEEDS_MORE_INPUT) {
+                if (len == 0) return true;
+                if (inSize == 0 && outSize == 0) return fail("inflate stalled");
+            }
+        }
+    }
+
+    void keepTail(const uint8_t* data, size_t len) {
+        for (size_t i = len > sizeof(_tail) ? len - sizeof(_tail) : 0; i < len; i++) {
+            memmove(_tail, _tail + 1, sizeof(_tail) - 1);
+            _tail[sizeof(_tail) - 1] = data[i];
+        }
+    }
+
+    static uint32_t le32(const uint8_t* p) {
+        return static_cast<uint32_t>(p[0]) | static_cast<uint32_t>(p[1]) << 8 |
+               static_cast<uint32_t>(p[2]) << 16 | static_cast<uint32_t>(p[3]) << 24;
+    }
+
+    bool fail(const char* why) {
+        _state = State::Failed;
+        _error = why;
+        return false;
+    }
+
+    void release() {
+        delete _inflator;
+        delete[] _window;
+        _inflator = nullptr;
+        _window = nullptr;
+    }
+
+    tinfl_decompressor* _inflator = nullptr;
+    uint8_t* _window = nullptr;
+    size_t _winPos = 0;
+
+    State _state = State::Failed;  // Until begin()
+    Field _field = Field::Fixed;
+    uint8_t _fixed[10] = {};
+    uint8_t _pos = 0;
+    uint16_t _skip = 0;
+
+    uint8_t _tail[8] = {};  // CRC-32, ISIZE once the body has ended
+    uint32_t _crc = 0;
+    size_t _in = 0;
+    size_t _out = 0;
+    const char* _error = nullptr;
+};
+
+} // namespace services
@@ -0,0 +1,127 @@
+#pragma once
+
+/**
+ * @file HttpStats.h
+ * @brief Counters, latency split and leak guard for the orchestrator
+ *        keep-alive connection (OrchestratorService::HTTPHelper).
+ *
+ * Every request is either cold (paid a TCP + TLS handshake) or warm (rode
+ * an open connection). Latency runs from send to response status, so the
+ * cold/warm histograms show directly what reuse saves. Kept free of
+ * WiFi/HTTPClient so the bookkeeping is natively testable; the HTTP_STATS
+ * serial command prints it.
+ */
+
+#include <Arduino.h>
+#include "../config.h"
+#include "../hal/LatencyHistogram.h"
+
+namespace services {
+
+/**
+ * Free heap sampled with the shared connection idle should come back to
+ * the same level after every request. A connection whose idle heap keeps
+ * drifting down is leaking (the failure mode behind the old fresh-client-
+ * per-request rule); after LEAK_STRIKES consecutive low samples the guard
+ * trips and keep-alive stays off until reboot.
+ */
+struct HttpLeakGuard {
+    uint32_t baseline = 0;  // First idle sample on the current connection
+    uint8_t strikes = 0;
+    bool tripped = false;
+
+    void newConnection() {
+        baseline = 0;
+        strikes = 0;
+    }
+
+    // True once tripped
+    bool sample(uint32_t freeHeap) {
+        if (tripped) return true;
+        if (baseline == 0) {
+            baseline = freeHeap;
+            return false;
+        }
+        if (freeHeap + http_config::LEAK_TOLERANCE_BYTES < baseline) {
+            if (++strikes >= http_config::LEAK_STRIKES) tripped = true;
+        } else {
+            strikes = 0;
+        }
+        return tripped;
+    }
+};
+
+struct HttpStats {
+    uint32_t requests = 0;
+    uint32_t handshakes = 0;    // Cold requests on the shared connection
+    uint32_t reused = 0;        // Warm requests
+    uint32_t oneShot = 0;       // Shared connection busy or disabled
+    uint32_t errors = 0;        // Negative HTTPClient codes
+    uint32_t staleRetries = 0;  // Warm send failed, retried cold
+    uint32_t idleCloses = 0;    // Closed for exceeding KEEPALIVE_IDLE_MS
+    uint32_t resets = 0;        // Closed by WiFi loss or origin change
+    uint32_t maxHandshakeHeap = 0;  // Largest heap drop across one handshake
+    hal::NetLatencyHistogram cold;
+    hal::NetLatencyHistogram warm;
+    HttpLeakGuard leak;
+
+    void recordRequest(bool handshake, bool shared, uint32_t us, int code) {
+        requests++;
+        if (!shared) oneShot++;
+        else if (handshake) handshakes++;
+        else reused++;
+        if (code < 0) {
+            errors++;
+            return;
+        }
+        (handshake ? cold : warm).record(us);
+    }
+
+    void recordHandshakeHeap(uint32_t before, uint32_t after) {
+        if (before > after && before - after > maxHandshakeHeap) {
+            maxHandshakeHeap = before - after;
+        }
+    }
+
+    void print() const {
+        Serial.printf("HTTP: %lu requests, %lu handshakes, %lu reused, %lu one-shot, "
+                      "%lu errors\n",
+                      (unsigned long)requests, (unsigned long)handshakes,
+                      (unsigned long)reused, (unsigned long)oneShot, (unsigned long)errors);
+        Serial.printf("  closes: %lu idle, %lu reset, %lu stale retries; keep-alive %s\n",
+                      (unsigned long)idleCloses, (unsigned long)resets,
+                      (unsigned long)staleRetries, leak.tripped ? "OFF (leak guard)" : "on");
+        Serial.printf("  handshake heap: max %lu bytes; idle baseline %lu, strikes %u\n",
+                      (unsigned long)maxHandshakeHeap, (unsigned long)leak.baseline,
+                      leak.strikes);
+        Serial.println("  latency (ms):     n     mean      p50      p90      max");
+        printRow("cold", cold);
+        printRow("warm", warm);
+    }
+
+private:
+    static void printRow(const char* name, const hal::NetLatencyHistogram& h) {
+        Serial.printf("    %-8s %6lu %8lu %8lu %8lu %8lu\n", name, (unsigned long)h.count,
+                      (unsigned long)(h.meanUs() / 1000),
+                      (unsigned long)(h.percentileUs(50) / 1000),
+                      (unsigned long)(h.percentileUs(90) / 1000),
+                      (unsigned long)(h.maxUs / 1000));
+    }
+};
+
+/**
+ * @brief "scheme://host[:port]" of url, the key the shared connection is
+ *        bound to. HTTPClient::setURL() keeps an open socket even when the
+ *        host changes, so a new origin must force a reconnect.
+ * @return empty if url has no scheme
+ */
+inline String httpOrigin(const String& url) {
+    int scheme = url.indexOf("://");
+    if (scheme <= 0) return "";
+    int path = url.indexOf('/', scheme + 3);
+    String origin = path < 0 ? url : url.substring(0, path);
+    origin.toLowerCase();
+    return origin;
+}
+
+} // namespace services
@@ -13,9 +13,11 @@
  * - Singleton pattern for global access
  * - HTTP code consolidation (PRIMARY FLASH SAVINGS)
  * - WiFi event-driven state management
- * - Thread-safe queue operations (JSONL-based)
+ * - Thread-safe queue operations (O(1) SD ring of CRC-framed binary records)
+ * - RAM write-behind journal: offline scans return without touching SD
  * - FreeRTOS background sync task (Core 0)
- * - Stream-based queue removal (memory-safe)
+ * - Push channel (server-sent events) replacing /health polling while up
+ * - MessagePack scan uploads when /health advertises them (JSON otherwise)
  *
  * Extracted from v4.1 monolithic codebase:
  * - WiFi: Lines 2365-2444
@@ -30,18 +32,33 @@
 #include <HTTPClient.h>
 #include <ArduinoJson.h>
 #include <SD.h>
-#include <mbedtls/sha1.h>
 #include <esp_system.h>
+#include <atomic>
 #include <functional>
+#include <memory>
 #include <vector>
 #include "../models/Config.h"
 #include "../models/Token.h"
 #include "../models/ConnectionState.h"
 #include "../hal/SDCard.h"
+#include "../hal/AssetPack.h"
 #include "../config.h"
 #include "PayloadBuilder.h"
+#include "BatchDrain.h"
 #include "BatchId.h"
 #include "ScanResponse.h"
+#include "QueueRing.h"
+#include "ScanRecord.h"
+#include "ScanJournal.h"
+#include "AssetSink.h"
+#include "AssetWriter.h"
+#include "AtomicFile.h"
+#include "HttpStats.h"
+#include "SyncValidators.h"
+#include "GzipStream.h"
+#include "ScanSubmitQueue.h"
+#include "PushEvents.h"
+#include "PushChannel.h"
 
 namespace services {
 
@@ -167,6 +184,26 @@ public:
 
         LOG_INFO("[ORCH] Background sync task started on Core %d\n",
                  freertos_config::BACKGROUND_TASK_CORE);
+
+        // Own task rather than the sync loop: a health check with retries or
+        // a 30 s batch upload there must not hold up a tap's outcome
+        TaskHandle_t submitTask = nullptr;
+        xTaskCreatePinnedToCore(
+            scanSubmitTaskWrapper,
+            "ScanSubmit",
+            freertos_config::SCAN_SUBMIT_TASK_STACK_SIZE,
+            this,
+            freertos_config::SCAN_SUBMIT_TASK_PRIORITY,
+            &submitTask,
+            freertos_config::SCAN_SUBMIT_TASK_CORE
+        );
+        _submitTask = submitTask;
+
+        LOG_INFO("[ORCH] Scan submit task started on Core %d\n",
+                 freertos_config::SCAN_SUBMIT_TASK_CORE);
+
+        // esp_restart() (REBOOT command, config apply) persists journaled scans first
+        esp_register_shutdown_handler(onShutdown);
     }
 
     // ─── Scan Operations ───────────────────────────────────────────────
@@ -177,9 +214,10 @@ public:
      * @param config Device configuration (for orchestrator URL)
      * @return Classified outcome (see services::ScanOutcome / ScanResponse.h)
      *
-     * SCAN-PATH CONTRACT (F-PARITY-06): this runs on the Core-1 main loop
-     * between RFID read and token display. It makes exactly ONE bounded
-     * HTTP attempt (10s timeout) — NO retries, NO backoff. The old
+     * SCAN-PATH CONTRACT (F-PARITY-06): taps reach this through
+     * submitScan() on the Core-0 scan submit task, so the token is already
+     * on screen; SIMULATE_SCAN still calls it inline. It makes exactly ONE
+     * bounded HTTP attempt (10s timeout) — NO retries, NO backoff. The old
      * httpWithRetry here could freeze the device for ~61s with a token on
      * the pad. Retries/backoff belong exclusively to the Core-0 background
      * task (health checks + batch upload of queued scans).
@@ -203,17 +241,29 @@ public:
             return services::ScanOutcome::RETRY_QUEUE;
         }
 
-        // Build JSON payload (extracted to PayloadBuilder.h for DRY + testability)
-        String requestBody = services::buildScanJson(scan);
-
         LOG_INFO("[ORCH-SEND] URL: %s/api/scan\n", config.orchestratorURL.c_str());
-        LOG_INFO("[ORCH-SEND] Payload: %s\n", requestBody.c_str());
-        LOG_INFO("[ORCH-SEND] Payload size: %d bytes\n", requestBody.length());
 
         // SINGLE bounded attempt — no httpWithRetry on the scan path
         // (F-PARITY-06: retries here blocked the main loop up to ~61s)
         String url = config.orchestratorURL + "/api/scan";
-        auto resp = _http.httpPOST(url, requestBody, 10000);
+        const services::PayloadEncoding encoding = getScanEncoding();
+        HTTPHelper::Response resp;
+        if (encoding == services::PayloadEncoding::MsgPack) {
+            std::string requestBody = services::buildScanMsgPack(scan);
+            LOG_INFO("[ORCH-SEND] Payload size: %u bytes (msgpack)\n", (unsigned)requestBody.size());
+            resp = _http.httpPOST(url, reinterpret_cast<const uint8_t*>(requestBody.data()),
+                                  requestBody.size(), services::contentTypeFor(encoding), 10000);
+            if (resp.code == 415) {
+                // Server no longer takes it; the queued copy goes as JSON
+                setScanEncoding(services::PayloadEncoding::Json, "415 from /api/scan");
+            }
+        } else {
+            // Build JSON payload (extracted to PayloadBuilder.h for DRY + testability)
+            String requestBody = services::buildScanJson(scan);
+            LOG_INFO("[ORCH-SEND] Payload: %s\n", requestBody.c_str());
+            LOG_INFO("[ORCH-SEND] Payload size: %d bytes\n", requestBody.length());
+            resp = _http.httpPOST(url, requestBody, 10000);
+        }
 
         unsigned long latencyMs = millis() - startMs;
         LOG_INFO("[ORCH-SEND] HTTP response code: %d\n", resp.code);
@@ -246,24 +296,52 @@ public:
         return outcome;
     }
 
+    /**
+     * @brief Send a scan from the submit task; the outcome comes back
+     *        through pollScanResult() (Core-1 main loop only)
+     * @return false if the submit task isn't running or SCAN_SUBMIT_DEPTH
+     *         scans are already in flight — the caller queues it offline
+     */
+    bool submitScan(const models::ScanData& scan) {
+        TaskHandle_t task = _submitTask;
+        if (!task || !_submits.submit(scan, millis())) return false;
+        xTaskNotifyGive(task);
+        return true;
+    }
+
+    /**
+     * @brief Next outcome of a submitScan() (Core-1 main loop only)
+     *
+     * RETRY_QUEUE results are not queued yet: the caller passes the scan to
+     * queueScan(), keeping the journal's single producer on Core 1.
+     */
+    bool pollScanResult(ScanResult& out) { return _submits.poll(out); }
+
+    size_t scansInFlight() const { return _submits.inFlight(); }
+
     /**
      * @brief Queue scan for later upload (offline mode)
      * @param scan Scan data to queue
      *
      * Implementation from v4.1 lines 1866-1922
-     * Writes JSONL entry to /queue.jsonl with FIFO overflow check
+     * Hands the scan to the RAM journal and returns; the background task
+     * persists it (see ScanJournal.h for the flush triggers). Only when the
+     * journal is full does this write through to the ring itself, after
+     * flushing the journal so FIFO order is kept. At MAX_QUEUE_SIZE the ring
+     * drops its oldest entry in the same header write (no rewrite).
      */
     void queueScan(const models::ScanData& scan) {
-        LOG_INFO("\n[ORCH-QUEUE] ═══ QUEUE SCAN START ═══\n");
+        if (_journal.submit(scan, millis())) {
+            LOG_INFO("[ORCH-QUEUE] Scan journaled (token: %s, %u pending)\n",
+                     scan.tokenId.c_str(), (unsigned)_journal.size());
+            return;
+        }
+
+        LOG_INFO("\n[ORCH-QUEUE] ═══ QUEUE SCAN START (journal full, writing through) ═══\n");
         LOG_INFO("[ORCH-QUEUE] Free heap: %d bytes\n", ESP.getFreeHeap());
 
         unsigned long startMs = millis();
 
-        // Check for queue overflow BEFORE acquiring mutex
-        if (getQueueSize() >= queue_config::MAX_QUEUE_SIZE) {
-            handleQueueOverflow();
-        }
-
         hal::SDCard::Lock lock("queueScan", freertos_config::SD_MUTEX_TIMEOUT_MS);
         if (!lock.acquired()) {
             LOG_ERROR("ORCH-QUEUE", "Failed to acquire SD mutex (timeout)");
@@ -271,41 +349,52 @@ public:
             return;
         }
 
-        // Build JSONL entry (extracted to PayloadBuilder.h for DRY + testability)
-        String jsonLine = services::buildScanJson(scan);
+        flushJournalLocked();
+        uint32_t droppedBefore = _ring.droppedCount();
+        bool ok = appendScan(_ring, scan);
+        setQueueSize(_ring.count());
 
-        LOG_INFO("[ORCH-QUEUE] Entry: %s\n", jsonLine.c_str());
-        LOG_INFO("[ORCH-QUEUE] Entry size: %d bytes\n", jsonLine.length());
-
-        // Append to queue file
-        LOG_INFO("[ORCH-QUEUE] Opening %s for append...\n", queue_config::QUEUE_FILE);
-        File file = SD.open(queue_config::QUEUE_FILE, FILE_APPEND);
-
-        if (file) {
-            unsigned long fileSize = file.size();
-            LOG_INFO("[ORCH-QUEUE] File opened, current size: %lu bytes\n", fileSize);
-
-            file.println(jsonLine);
-            file.flush();
-            file.close();
-
-            // Update queue size (atomic)
-            updateQueueSize(1);
-            int newQueueSize = getQueueSize();
+        if (ok) {
             unsigned long latencyMs = millis() - startMs;
+            uint32_t dropped = _ring.droppedCount() - droppedBefore;
+            if (dropped > 0) {
+                LOG_INFO("[ORCH-QUEUE] Queue full, dropped %lu oldest entr%s (FIFO)\n",
+                         (unsigned long)dropped, dropped == 1 ? "y" : "ies");
+            }
 
             LOG_INFO("[ORCH-QUEUE] ✓✓✓ SUCCESS ✓✓✓ Scan queued (token: %s)\n",
                      scan.tokenId.c_str());
-            LOG_INFO("[ORCH-QUEUE] Queue size: %d entries\n", newQueueSize);
+            LOG_INFO("[ORCH-QUEUE] Queue size: %d entries (%lu/%lu bytes)\n", getQueueSize(),
+                     (unsigned long)_ring.usedBytes(), (unsigned long)_ring.capacity());
             LOG_INFO("[ORCH-QUEUE] Write latency: %lu ms\n", latencyMs);
         } else {
-            LOG_ERROR("ORCH-QUEUE", "Could not open queue file for writing");
+            LOG_ERROR("ORCH-QUEUE", "Could not write scan to queue ring");
         }
 
         LOG_INFO("[ORCH-QUEUE] Free heap after queue: %d bytes\n", ESP.getFreeHeap());
         LOG_INFO("[ORCH-QUEUE] ═══ QUEUE SCAN END ═══\n\n");
     }
 
+    /**
+     * @brief Persist every journaled scan to the ring in one batched append
+     * @param timeoutMs SD mutex timeout
+     * @return false if the SD mutex could not be acquired
+     *
+     * Called by the background task when the journal is due and by the
+     * shutdown handler before a restart. Safe from any task: holding the SD
+     * lock makes the caller the journal's only consumer.
+     */
+    bool flushJournal(uint32_t timeoutMs = freertos_config::SD_MUTEX_TIMEOUT_MS) {
+        if (_journal.empty()) return true;
+        hal::SDCard::Lock lock("journalFlush", timeoutMs);
+        if (!lock.acquired()) {
+            LOG_ERROR("ORCH-QUEUE", "Could not acquire SD mutex to flush journal");
+            return false;
+        }
+        flushJournalLocked();
+        return true;
+    }
+
     // ─── State Queries ─────────────────────────────────────────────────
 
     /**
@@ -324,7 +413,57 @@ public:
         portENTER_CRITICAL(&_queue.mutex);
         int size = _queue.size;
         portEXIT_CRITICAL(&_queue.mutex);
-        return size;
+        return size + static_cast<int>(_journal.size());  // Journaled scans count as queued
+    }
+
+    // ─── Push Channel ──────────────────────────────────────────────────
+
+    // Re-syncs asked for by the orchestrator (REFRESH_* bits)
+    enum RemoteRefresh : uint8_t {
+        REFRESH_TOKENS = 1 << 0,
+        REFRESH_ASSETS = 1 << 1,
+    };
+
+    /**
+     * @brief Runs the re-syncs the orchestrator pushed
+     * @param what   REFRESH_* bits
+     * @param config The background task's copy of the device config
+     *
+     * Called on the OrchestratorSync task once the pushes have been quiet
+     * for PUSH_REFRESH_SETTLE_MS, so a burst of edits costs one sync. It
+     * may take as long as the downloads do: the UI loop never waits on it.
+     */
+    using RemoteRefreshJob = void (*)(uint8_t what, const models::DeviceConfig& config);
+
+    // Set before startBackgroundTask(); without one, pushed re-syncs are ignored
+    void setRemoteRefreshJob(RemoteRefreshJob job) { _refreshJob = job; }
+
+    // Game session as last pushed; UNKNOWN until the channel has reported it
+    SessionState getSessionState() const {
+        return static_cast<SessionState>(_session.load());
+    }
+
+    /**
+     * @brief Push channel link state and counters - PUSH_STATS serial command
+     */
+    PushStats getPushStats() const {
+        portENTER_CRITICAL(&_pushMux);
+        PushStats copy = _pushStats;
+        portEXIT_CRITICAL(&_pushMux);
+        return copy;
+    }
+
+    // Offline queue drain throughput and batch sizing - QUEUE_STATUS
+    DrainStats getDrainStats() const {
+        portENTER_CRITICAL(&_drainMux);
+        DrainStats copy = _drainStats;
+        portEXIT_CRITICAL(&_drainMux);
+        return copy;
+    }
+
+    // Body encoding for /api/scan and /api/scan/batch, as last negotiated
+    services::PayloadEncoding getScanEncoding() const {
+        return static_cast<services::PayloadEncoding>(_scanEncoding.load());
     }
 
     // ─── Health Check ──────────────────────────────────────────────────
@@ -346,10 +485,11 @@ public:
             return _http.httpGET(url, 5000);
         }, "health check");
 
-        // Apply POSIX timezone from /health response (auto-derived by backend).
-        // Quiet on the happy path; a mismatch or parse failure logs.
+        // Apply POSIX timezone and upload encoding from /health response
+        // (auto-derived by backend). Quiet on the happy path; a change or
+        // parse failure logs.
         if (resp.code == 200 && resp.body.length() > 0) {
-            applyTimezoneFromHealth(resp.body);
+            applyHealthBody(resp.body);
         }
 
         return (resp.code == 200);
@@ -357,23 +497,29 @@ public:
 
     /**
      * @brief Parse `timezone` from /health response body and apply via
-     *        setenv+tzset when it differs from the currently applied value.
+     *        setenv+tzset when it differs from the currently applied value;
+     *        with negotiate, also pick the upload encoding from
+     *        `scanEncodings`.
      *
      * The POSIX TZ string (e.g. "PST8PDT,M3.2.0,M11.1.0") governs how
      * generateTimestamp() renders local time. It is cached in
      * `_appliedTimezone` so re-calls don't churn the C runtime state.
+     * A server that does not list "msgpack" gets JSON.
      *
      * Silent on malformed bodies — the caller already succeeded on the
      * 200 status, so this is best-effort; we'd rather scan with default
      * (likely UTC) offsets than reject a reachable orchestrator.
      */
-    void applyTimezoneFromHealth(const String& body) {
-        StaticJsonDocument<256> doc;
+    void applyHealthBody(const String& body, bool negotiate = true) {
+        JsonDocument doc;
         DeserializationError err = deserializeJson(doc, body);
         if (err) {
             LOG_INFO("[ORCH-TZ] Failed to parse /health body: %s\n", err.c_str());
             return;
         }
+        if (negotiate) {
+            setScanEncoding(services::negotiateEncoding(doc["scanEncodings"]), "/health");
+        }
         const char* tz = doc["timezone"] | "";
         if (!tz || !*tz) return;
 
@@ -385,15 +531,72 @@ public:
         LOG_INFO("[ORCH-TZ] Applied timezone from /health: %s\n", tz);
     }
 
+    void setScanEncoding(services::PayloadEncoding encoding, const char* source) {
+        uint8_t prev = _scanEncoding.exchange(static_cast<uint8_t>(encoding));
+        if (prev != static_cast<uint8_t>(encoding)) {
+            LOG_INFO("[ORCH] Upload encoding %s (%s)\n", services::encodingName(encoding), source);
+        }
+    }
+
+    /**
+     * @brief Act on one event from the push channel (OrchestratorSync task)
+     *
+     * health and timezone carry the /health body shape, so the timezone
+     * goes through applyHealthBody() either way; only health renegotiates
+     * the upload encoding. Token and asset
+     * changes only raise flags; the main task syncs when the UI is idle.
+     */
+    void onPushEvent(const char* name, const char* data) {
+        updatePushStats([](PushStats& s) { s.events++; });
+
+        switch (parsePushEvent(name)) {
+            case PushEvent::Health:
+                applyHealthBody(data);
+                if (_connState.get() == models::ORCH_WIFI_CONNECTED) {
+                    LOG_INFO("[PUSH] Orchestrator reachable\n");
+                    _connState.set(models::ORCH_CONNECTED);
+                }
+                break;
+            case PushEvent::Timezone:
+                applyHealthBody(data, false);
+                break;
+            case PushEvent::Session: {
+                JsonDocument doc;
+                if (deserializeJson(doc, data)) {
+                    LOG_INFO("[PUSH] Bad session event: %s\n", data);
+                    break;
+                }
+                SessionState state = parseSessionState(doc["status"] | "");
+                if (_session.exchange(static_cast<uint8_t>(state)) != static_cast<uint8_t>(state)) {
+                    LOG_INFO("[PUSH] Session %s\n", sessionStateName(state));
+                }
+                break;
+            }
+            case PushEvent::Tokens:
+                requestRemoteRefresh(REFRESH_TOKENS, "Tokens");
+                break;
+            case PushEvent::Assets:
+                requestRemoteRefresh(REFRESH_ASSETS, "Assets");
+                break;
+            default:
+                LOG_DEBUG("[PUSH] Ignoring event '%s'\n", name);
+                break;
+        }
+    }
+
     /**
-     * @brief Initialize queue size from disk file (call after SD ready)
-     * @return true if queue valid, false if corrupted and deleted
+     * @brief Open the queue ring and recover its size (call after SD ready)
+     * @return true if queue valid, false if corrupted and reset
      *
-     * Validates queue file, counts entries, sets cached size.
-     * If file size > 100KB, deletes as corrupted and resets to 0.
+     * Recovery reads the two ring header slots and validates that checkpoint
+     * against the oldest and newest records - constant time regardless of
+     * how many scans are queued. Only a mismatch falls back to a scan. A
+     * /queue.jsonl left by older firmware is imported into the ring once and
+     * then deleted; the 100KB size check still guards that import against
+     * power-loss corruption (e.g. the 1.7GB file seen from incomplete
+     * writes).
      *
      * MUST be called from Application::setup() after SD card initialized.
-     * Designed to catch power-loss corruption (e.g., 1.7GB file from incomplete writes).
      */
     bool initializeQueue() {
         LOG_INFO("\n[ORCH-QUEUE-INIT] ═══ QUEUE INITIALIZATION START ═══\n");
@@ -404,170 +607,98 @@ public:
             return false;
         }
 
-        // Check if queue file exists
-        if (!SD.exists(queue_config::QUEUE_FILE)) {
-            LOG_INFO("[ORCH-QUEUE-INIT] No queue file, starting fresh\n");
-            portENTER_CRITICAL(&_queue.mutex);
-            _queue.size = 0;
-            portEXIT_CRITICAL(&_queue.mutex);
-            LOG_INFO("[ORCH-QUEUE-INIT] ═══ QUEUE INITIALIZATION END ═══\n\n");
-            return true;
+        recoverRingUpgrade();
+        if (!loadDeviceIds()) {
+            LOG_INFO("[ORCH-QUEUE-INIT] No deviceId table, starting empty\n");
         }
 
-        File file = SD.open(queue_config::QUEUE_FILE, FILE_READ);
-        if (!file) {
-            LOG_ERROR("ORCH-QUEUE-INIT", "Could not open queue file");
-            return false;
+        bool valid = true;
+        switch (_ring.open()) {
+            case QueueRing::OpenResult::Loaded:
+                LOG_INFO("[ORCH-QUEUE-INIT] Ring loaded (header seq %lu)\n",
+                         (unsigned long)_ring.headerSeq());
+                break;
+            case QueueRing::OpenResult::Recovered:
+                LOG_ERROR("ORCH-QUEUE-INIT", "Checkpoint mismatch - queue rebuilt by scan");
+                LOG_INFO("[ORCH-QUEUE-INIT] %lu entries kept, %lu lost\n",
+                         (unsigned long)_ring.count(), (unsigned long)_ring.damagedCount());
+                break;
+            case QueueRing::OpenResult::Created:
+                LOG_INFO("[ORCH-QUEUE-INIT] No queue ring, created %s\n", queue_config::QUEUE_FILE);
+                break;
+            case QueueRing::OpenResult::Reset:
+                LOG_ERROR("ORCH-QUEUE-INIT", "CORRUPTION DETECTED - queue ring reset");
+                valid = false;
+                break;
+            case QueueRing::OpenResult::Failed:
+                LOG_ERROR("ORCH-QUEUE-INIT", "Could not open or create queue ring");
+                setQueueSize(0);
+                return false;
         }
 
-        // CORRUPTION CHECK: File size validation
-        unsigned long fileSize = file.size();
-        LOG_INFO("[ORCH-QUEUE-INIT] Queue file size: %lu bytes\n", fileSize);
-
-        if (fileSize > queue_config::MAX_QUEUE_FILE_SIZE) {
-            LOG_ERROR("ORCH-QUEUE-INIT", "CORRUPTION DETECTED");
-            LOG_INFO("[ORCH-QUEUE-INIT] File size %lu exceeds threshold %lu\n",
-                     fileSize, queue_config::MAX_QUEUE_FILE_SIZE);
-            LOG_INFO("[ORCH-QUEUE-INIT] Deleting corrupted queue file\n");
-
-            file.close();
-            SD.remove(queue_config::QUEUE_FILE);
-
-            portENTER_CRITICAL(&_queue.mutex);
-            _queue.size = 0;
-            portEXIT_CRITICAL(&_queue.mutex);
-
-            LOG_INFO("[ORCH-QUEUE-INIT] ✓ Corrupted queue deleted, reset to 0\n");
-            LOG_INFO("[ORCH-QUEUE-INIT] ═══ QUEUE INITIALIZATION END ═══\n\n");
-            return false;  // Indicate corruption was found and handled
+        if (_ring.version() == QueueRing::VERSION_JSONL && !upgradeRingFormat()) {
+            valid = false;
         }
-
-        // Count actual entries (newlines)
-        int lineCount = 0;
-        while (file.available()) {
-            file.readStringUntil('\n');
-            lineCount++;
+        if (SD.exists(queue_config::QUEUE_TEMP_FILE)) {
+            SD.remove(queue_config::QUEUE_TEMP_FILE);  // Interrupted legacy rebuild
+        }
+        if (SD.exists(queue_config::LEGACY_QUEUE_FILE) && !migrateLegacyQueue()) {
+            valid = false;
         }
-        file.close();
 
-        // Update cached size with actual count
-        portENTER_CRITICAL(&_queue.mutex);
-        _queue.size = lineCount;
-        portEXIT_CRITICAL(&_queue.mutex);
+        setQueueSize(_ring.count());
 
-        LOG_INFO("[ORCH-QUEUE-INIT] ✓ Queue validated: %d entries\n", lineCount);
+        LOG_INFO("[ORCH-QUEUE-INIT] ✓ Queue validated: %d entries (%lu/%lu bytes)\n",
+                 getQueueSize(), (unsigned long)_ring.usedBytes(),
+                 (unsigned long)_ring.capacity());
         LOG_INFO("[ORCH-QUEUE-INIT] ═══ QUEUE INITIALIZATION END ═══\n\n");
-        return true;
+        return valid;
     }
 
     // ─── Queue Operations ──────────────────────────────────────────────
 
     /**
-     * @brief Upload batch of queued scans to orchestrator
+     * @brief Drain the offline queue to the orchestrator, batch after batch
      * @param config Device configuration (for orchestrator URL)
-     * @return true if batch uploaded successfully, false otherwise
+     * @return true once the queue is empty, false if a batch failed or the
+     *         heap could not afford one (the rest waits for the next pass)
      *
-     * Implementation from v4.1 lines 1725-1824
-     * Uses consolidated HTTP helper (FLASH SAVINGS)
+     * Batches go out back to back with no pause; BatchSizer (BatchDrain.h)
+     * sizes each one from the last round trip, free heap only gating it.
+     * Bodies use the negotiated encoding (JSON or MessagePack). The only
+     * backoff is httpWithRetry's, on a failing batch.
      */
     bool uploadQueueBatch(const models::DeviceConfig& config) {
         LOG_INFO("\n[ORCH-BATCH] ═══════════════════════════════════\n");
-        LOG_INFO("[ORCH-BATCH]   QUEUE BATCH UPLOAD START\n");
+        LOG_INFO("[ORCH-BATCH]   QUEUE DRAIN START\n");
         LOG_INFO("[ORCH-BATCH] ═══════════════════════════════════\n");
         LOG_INFO("[ORCH-BATCH] Free heap before: %d bytes\n", ESP.getFreeHeap());
         LOG_INFO("[ORCH-BATCH] Current queue size: %d entries\n", getQueueSize());
 
-        // Read batch of up to 10 entries
-        std::vector<models::ScanData> batch;
-
-        {
-            hal::SDCard::Lock lock("uploadBatch", freertos_config::SD_MUTEX_TIMEOUT_MS);
-            if (!lock.acquired()) {
-                LOG_ERROR("ORCH-BATCH", "Could not acquire SD mutex");
-                LOG_INFO("[ORCH-BATCH] ═══════════════════════════════════\n\n");
-                return false;
-            }
-
-            readQueue(batch, queue_config::BATCH_UPLOAD_SIZE);
-        }  // Lock released here
-
-        if (batch.empty()) {
-            LOG_INFO("[ORCH-BATCH] Queue is empty, nothing to upload\n");
-            LOG_INFO("[ORCH-BATCH] ═══════════════════════════════════\n\n");
-            return true;
-        }
-
-        LOG_INFO("[ORCH-BATCH] Uploading batch of %zu entries\n", batch.size());
-
         // Ensure the per-boot nonce is ready (lazy draw, post-WiFi entropy).
         // Must happen before the first makeBatchId() call this boot.
         _ensureBootNonce();
 
-        // Generate batch ID for idempotency. Stable across HTTP retries of
-        // THIS batch (counter advances only on success), but unique across
-        // reboots via the per-boot nonce (F-SCAN-02: the old boot-reset
-        // counter collided with the backend's 1-hour idempotency cache and
-        // silently lost scans).
-        //
-        // Reboot-window trade-off: if the device reboots while httpWithRetry
-        // is in flight for this batch, the next boot draws a fresh nonce and
-        // re-uploads the same scans under a new batchId.  The backend will
-        // process them again, producing duplicates.  For player-scanner scans
-        // duplicates are benign (players can re-view the same token); losing
-        // scans is NOT acceptable (permanent audit gap).  Duplicate-on-reboot
-        // is therefore the deliberate choice over loss-on-reboot.
-        String batchId = services::makeBatchId(config.deviceID, _batchBootNonce, _nextBatchId);
-        LOG_INFO("[ORCH-BATCH] Batch ID: %s\n", batchId.c_str());
-
-        // Build batch request JSON (extracted to PayloadBuilder.h for DRY + testability)
-        String requestBody = services::buildBatchJson(batchId, batch);
-
-        LOG_INFO("[ORCH-BATCH] Request body size: %d bytes\n", requestBody.length());
-
-        // Send via consolidated HTTP helper with retry logic
-        String url = config.orchestratorURL + "/api/scan/batch";
-        unsigned long startTime = millis();
-        auto resp = httpWithRetry([&]() {
-            return _http.httpPOST(url, requestBody, 30000);
-        }, "batch upload");
-        unsigned long latency = millis() - startTime;
-
-        if (resp.body.length() > 0 && resp.body.length() < 200) {
-            LOG_INFO("[ORCH-BATCH] Response: %s\n", resp.body.c_str());
+        const uint32_t startMs = millis();
+        uint32_t sent = 0;
+        int result;
+        while ((result = uploadNextBatch(config, sent)) > 0) {
+            yield();  // Next batch right away; just let the scheduler in
         }
-
-        LOG_INFO("[ORCH-BATCH] HTTP %d response, latency: %lu ms\n", resp.code, latency);
-
-        if (resp.code == 200) {
-            LOG_INFO("[ORCH-BATCH] ✓✓✓ SUCCESS ✓✓✓ Batch upload successful\n");
-
-            // Remove uploaded entries from queue (stream-based)
-            removeUploadedEntries(batch.size());
-
-            // Increment batch ID for next batch
-            _nextBatchId++;
-
-            // Check if more entries remain
-            int remainingSize = getQueueSize();
-            LOG_INFO("[ORCH-BATCH] Queue size after upload: %d entries\n", remainingSize);
-
-            if (remainingSize > 0) {
-                LOG_INFO("[ORCH-BATCH] More entries in queue, uploading next batch after 1s delay\n");
-                LOG_INFO("[ORCH-BATCH] ═══════════════════════════════════\n\n");
-                delay(1000);  // 1-second delay between batches
-                return uploadQueueBatch(config);  // Recursive upload
-            }
-
-            LOG_INFO("[ORCH-BATCH] Free heap after: %d bytes\n", ESP.getFreeHeap());
+        const uint32_t elapsedMs = millis() - startMs;
+        updateDrainStats([&](DrainStats& s) { s.recordRun(sent, elapsedMs); });
+
+        LOG_INFO("[ORCH-BATCH] Drained %lu scans in %lu ms (%.1f scans/s)\n",
+                 (unsigned long)sent, (unsigned long)elapsedMs,
+                 DrainStats::rate(sent, elapsedMs));
+        LOG_INFO("[ORCH-BATCH] Free heap after: %d bytes\n", ESP.getFreeHeap());
+        if (result == 0) {
             LOG_INFO("[ORCH-BATCH] ✓ All queue entries uploaded\n");
-            LOG_INFO("[ORCH-BATCH] ═══════════════════════════════════\n\n");
-            return true;
         } else {
-            LOG_INFO("[ORCH-BATCH] ✗✗✗ FAILURE ✗✗✗ HTTP %d\n", resp.code);
             LOG_INFO("[ORCH-BATCH] Entries remain in queue for retry on next health check\n");
-            LOG_INFO("[ORCH-BATCH] ═══════════════════════════════════\n\n");
-            return false;
         }
+        LOG_INFO("[ORCH-BATCH] ═══════════════════════════════════\n\n");
+        return result == 0;
     }
 
     /**
@@ -580,12 +711,11 @@ public:
             return;
         }
 
-        SD.remove(queue_config::QUEUE_FILE);
-
-        // Reset queue size (atomic)
-        portENTER_CRITICAL(&_queue.mutex);
-        _queue.size = 0;
-        portEXIT_CRITICAL(&_queue.mutex);
+        models::ScanData discarded;
+        while (_journal.pop(discarded)) {}
+        _journal.flushed();
+        _ring.clear();
+        setQueueSize(_ring.count());
 
         LOG_INFO("[ORCH-QUEUE] Queue cleared\n");
     }
@@ -595,39 +725,90 @@ public:
     /**
      * @brief Print queue contents (for debugging)
      */
-    void printQueue() const {
+    void printQueue() {
         hal::SDCard::Lock lock("printQueue", freertos_config::SD_MUTEX_TIMEOUT_MS);
         if (!lock.acquired()) {
             LOG_ERROR("ORCH-QUEUE", "Could not acquire SD mutex to print queue");
             return;
         }
+        flushJournalLocked();
 
-        File file = SD.open(queue_config::QUEUE_FILE, FILE_READ);
-        if (!file) {
-            LOG_INFO("[ORCH-QUEUE] Queue file not found (empty)\n");
+        if (_ring.count() == 0) {
+            LOG_INFO("[ORCH-QUEUE] Queue is empty\n");
             return;
         }
 
         LOG_INFO("\n[ORCH-QUEUE] ═══ Queue Contents ═══\n");
         int count = 0;
-        while (file.available() && count < 10) {  // Limit to first 10 entries
-            String line = file.readStringUntil('\n');
-            line.trim();
-            if (line.length() > 0) {
-                LOG_INFO("[%d] %s\n", count + 1, line.c_str());
-                count++;
+        _ring.peek(10, [this, &count](const uint8_t* data, uint16_t len) {  // First 10 entries
+            models::ScanData scan;
+            if (services::decodeScanRecord(data, len, _deviceIds, scan)) {
+                LOG_INFO("[%d] %s\n", ++count, services::buildScanJson(scan).c_str());
+            } else {
+                LOG_INFO("[%d] <undecodable %u-byte record>\n", ++count, len);
             }
-        }
+        });
 
         int total = getQueueSize();
         if (total > count) {
             LOG_INFO("... and %d more entries\n", total - count);
         }
 
-        file.close();
         LOG_INFO("[ORCH-QUEUE] ═══ End Queue ═══\n\n");
     }
 
+    /**
+     * @brief Print queue ring diagnostics (QUEUE_STATUS command)
+     */
+    void printQueueStatus() {
+        int cachedSize = getQueueSize();
+        Serial.printf("Cached size: %d entries (from RAM)\n", cachedSize);
+
+        Serial.printf("Journal: %u pending in RAM (depth %u), %lu write-through fallbacks, "
+                      "%lu too large for a record\n",
+                      (unsigned)_journal.size(), (unsigned)_journal.capacity(),
+                      (unsigned long)_journal.overflowCount(), (unsigned long)_journalUnfit);
+
+        hal::SDCard::Lock lock("queueStatus", freertos_config::SD_MUTEX_TIMEOUT_MS);
+        if (!lock.acquired()) {
+            Serial.println("✗ Could not acquire SD mutex");
+            return;
+        }
+        flushJournalLocked();
+        cachedSize = getQueueSize();
+
+        Serial.printf("Ring file: %s (%lu bytes, preallocated)\n",
+                      queue_config::QUEUE_FILE, (unsigned long)_ring.fileSize());
+        Serial.printf("Ring entries: %lu (max %d)\n",
+                      (unsigned long)_ring.count(), queue_config::MAX_QUEUE_SIZE);
+        Serial.printf("Ring usage: %lu / %lu bytes\n",
+                      (unsigned long)_ring.usedBytes(), (unsigned long)_ring.capacity());
+        Serial.printf("Header seq: %lu\n", (unsigned long)_ring.headerSeq());
+        Serial.printf("Overflow drops since boot: %lu\n", (unsigned long)_ring.droppedCount());
+        Serial.printf("Damaged records skipped since boot: %lu\n",
+                      (unsigned long)_ring.damagedCount());
+        Serial.printf("Interned deviceIds: %u\n", _deviceIds.count);
+        getDrainStats().print();
+        Serial.printf("Upload encoding: %s\n", services::encodingName(getScanEncoding()));
+
+        if (cachedSize != static_cast<int>(_ring.count())) {
+            Serial.printf("⚠️  WARNING: Cache divergence detected! (cached %d, ring %lu)\n",
+                          cachedSize, (unsigned long)_ring.count());
+        } else {
+            Serial.println("✓ Cache matches ring");
+        }
+
+        _ring.peek(1, [this](const uint8_t* data, uint16_t len) {
+            models::ScanData scan;
+            if (services::decodeScanRecord(data, len, _deviceIds, scan)) {
+                Serial.printf("\nFirst entry (%u bytes): %s @ %s\n", len,
+                              scan.tokenId.c_str(), scan.timestamp.c_str());
+            } else {
+                Serial.printf("\nFirst entry (%u bytes): undecodable\n", len);
+            }
+        });
+    }
+
     // ─── Public HTTP Methods (for use by other services) ──────────────────
 
     /**
@@ -645,6 +826,23 @@ public:
         return resp.code;
     }
 
+    /**
+     * @brief Conditional GET with retry logic
+     * @param have Validators of the copy we hold; sent as If-None-Match /
+     *        If-Modified-Since when present
+     * @param received On 200, the ETag / Last-Modified of the new body
+     * @return HTTP response code: 304 = our copy is current (no body)
+     */
+    int httpGETConditionalWithRetry(const String& url, uint32_t timeoutMs, const char* operation,
+                                    const SyncValidators& have, String& responseBody,
+                                    SyncValidators& received) {
+        auto resp = httpWithRetry([&]() {
+            return _http.httpGETConditional(url, timeoutMs, have, received);
+        }, operation);
+        responseBody = resp.body;
+        return resp.code;
+    }
+
     /**
      * @brief Execute HTTP POST request with retry logic
      * @param url Full URL to POST
@@ -661,6 +859,18 @@ public:
         return resp.code;
     }
 
+    /**
+     * @brief Keep-alive connection counters and cold/warm latency since boot
+     *        (or last reset) - HTTP_STATS serial command
+     */
+    HttpStats getHttpStats() const { return _http.getStats(); }
+
+    void resetHttpStats() { _http.resetStats(); }
+
+    // Drop the idle keep-alive connection now, freeing its TLS context for
+    // a transfer that brings its own (AssetConnection)
+    void closeIdleHttp() { _http.closeIdle(); }
+
     /**
      * @brief Streaming GET that writes the response body directly to an SD
      *        card path, computing SHA-1 on the fly and verifying against the
@@ -669,16 +879,21 @@ public:
      *        String-based read.
      *
      * Writes to `<destPath>.part` first and renames on success, so a
-     * partial download can never be mistaken for a valid file. Uses a fresh
-     * WiFiClientSecure per call (see OrchestratorService heap-corruption
-     * notes). Holds the SD mutex for the entire download (safe at boot —
-     * the background upload task has no scans to process yet).
+     * partial download can never be mistaken for a valid file. Runs on the
+     * HTTPHelper keep-alive connection when it is free, so a sync of many
+     * assets pays one TLS handshake instead of one per file.
+     *
+     * The SD mutex is taken per chunk, never across a network read: the
+     * body is read unlocked into a staging buffer, and only the write of a
+     * full chunk (plus file open/close/rename) runs under a short-timeout
+     * lock. Image draws and queue writes on other tasks interleave with a
+     * mid-session sync instead of waiting out the whole file.
      *
      * Uses HTTP/1.0 (via HTTPClient::useHTTP10) to avoid chunked transfer
      * encoding; our static-file endpoint always serves with Content-Length
-     * so this is the simplest correct path. Handshakes are not reused
-     * across calls (fresh client-per-request pattern precludes
-     * setReuse()).
+     * so this is the simplest correct path. HTTPClient still asks for
+     * keep-alive, and the connection is handed back open only when exactly
+     * Content-Length bytes were read.
      *
      * @param url          Full URL, must be https:// on the configured
      *                     orchestrator port.
@@ -697,155 +912,234 @@ public:
         uint32_t timeoutMs,
         std::function<void(size_t, size_t)> onProgress = nullptr
     ) {
-        const uint32_t heapBefore = ESP.getFreeHeap();
-        if (heapBefore < limits::ASSET_MIN_FREE_HEAP) {
-            Serial.printf("[ORCH] STREAM: abort, low heap %u < %d\n",
-                          heapBefore, limits::ASSET_MIN_FREE_HEAP);
-            return false;
-        }
-
-        String partPath = destPath + paths::PART_SUFFIX;
-
-        // Fresh HTTPS context per download (heap-corruption mitigation, same
-        // as httpGET / httpPOST in HTTPHelper above).
-        HTTPClient client;
-        WiFiClientSecure secureClient;
-        if (url.startsWith("https://")) {
-            secureClient.setInsecure();
-            client.begin(secureClient, url);
-        } else {
-            client.begin(url);
-        }
-        client.setTimeout(timeoutMs);
-        client.useHTTP10(true); // disable chunked transfer-encoding
+        AssetFileSink sink(destPath);
+        return streamToSink(url, expectedSize, expectedSha1, timeoutMs, onProgress, sink);
+    }
 
-        int code = client.GET();
-        if (code != 200) {
-            Serial.printf("[ORCH] STREAM: HTTP %d for %s\n", code, url.c_str());
-            client.end();
-            return false;
+    /**
+     * @brief Same as httpGETStreamToSD, but into a free extent of the asset
+     *        pack (hal/AssetPack.h) instead of a loose file.
+     *
+     * The index entry for (type, tokenId) is committed only after the SHA-1
+     * matches, so the previous version stays readable until then. On
+     * success any loose copy at destPath is removed. Returns false without
+     * touching the network if the pack has no room — the caller falls back
+     * to httpGETStreamToSD.
+     */
+    bool httpGETStreamToPack(
+        const String& url,
+        hal::AssetPack& pack,
+        uint8_t type,
+        const String& tokenId,
+        const String& ext,
+        const String& destPath,
+        size_t expectedSize,
+        const String& expectedSha1,
+        uint32_t timeoutMs,
+        std::function<void(size_t, size_t)> onProgress = nullptr
+    ) {
+        AssetPackSink sink(pack, destPath);
+        {
+            hal::SDCard::Lock lock("stream:reserve", freertos_config::SD_MUTEX_TIMEOUT_MS);
+            if (!lock.acquired() ||
+                !sink.prepare(type, tokenId, ext, expectedSize, expectedSha1)) {
+                return false;
+            }
         }
+        return streamToSink(url, expectedSize, expectedSha1, timeoutMs, onProgress, sink);
+    }
 
-        int contentLen = client.getSize();
-        if (contentLen > 0 && (size_t)contentLen != expectedSize) {
-            Serial.printf("[ORCH] STREAM: size mismatch %d != %u\n",
-                          contentLen, (unsigned)expectedSize);
-            client.end();
-            return false;
-        }
+    /**
+     * @brief Conditional streaming GET, with retry, of a document nobody
+     *        publishes a digest for (the token database) into sink.
+     *
+     * Like httpGETStreamToSD the body goes to SD a chunk at a time and is
+     * never held in RAM, so its size is bounded by the card. When the heap
+     * can afford the inflater the request offers Accept-Encoding: gzip and
+     * a gzip body is decoded on the way to the sink (GzipStream.h).
+     *
+     * The sink commits only a whole body: exactly Content-Length bytes, or
+     * for gzip a complete stream whose trailer matches. A cut or corrupt
+     * transfer is retried from scratch.
+     *
+     * @param have     Validators of the copy we hold (empty = plain GET)
+     * @param received On 200, the ETag / Last-Modified of the new body
+     * @return HTTP status: 200 once the sink committed, 304 if `have` is
+     *         current; anything else failed and the sink was discarded
+     */
+    int httpGETDocumentWithRetry(const String& url, AssetSink& sink, uint32_t timeoutMs,
+                                 const char* operation, const SyncValidators& have,
+                                 SyncValidators& received) {
+        auto resp = httpWithRetry([&]() {
+            AssetWriter writer(sink);
+            return streamDocument(url, writer, timeoutMs, have, received);
+        }, operation);
+        return resp.code;
+    }
 
-        // SD mutex held for the whole download. Safe pre-game: the scan
-        // upload task has nothing to upload yet.
-        hal::SDCard::Lock lock("OrchestratorService::stream",
-                               freertos_config::SD_MUTEX_LONG_TIMEOUT_MS);
-        if (!lock.acquired()) {
-            Serial.println("[ORCH] STREAM: SD lock failed");
-            client.end();
-            return false;
-        }
+    /**
+     * @brief httpGETDocumentWithRetry into any body consumer rather than a
+     *        file (the asset manifest parser, AssetManifestDiff.h).
+     *
+     * Each attempt calls body.open() once the response is known good, then
+     * body.write(data, len) with the decoded bytes (false aborts), and
+     * counts as a success only if body.finish() accepts the whole body.
+     */
+    template <typename Body>
+    int httpGETStreamWithRetry(const String& url, Body& body, uint32_t timeoutMs,
+                               const char* operation, const SyncValidators& have,
+                               SyncValidators& received) {
+        auto resp = httpWithRetry([&]() {
+            return streamDocument(url, body, timeoutMs, have, received);
+        }, operation);
+        return resp.code;
+    }
 
-        // Ensure the parent directory exists (first-boot path).
-        int lastSlash = destPath.lastIndexOf('/');
-        if (lastSlash > 0) {
-            String dir = destPath.substring(0, lastSlash);
-            SD.mkdir(dir.c_str()); // no-op if already present
+private:
+    // One attempt of httpGETDocumentWithRetry / httpGETStreamWithRetry;
+    // success only once the body accepted the whole document
+    template <typename Body>
+    HTTPHelper::Response streamDocument(const String& url, Body& body, uint32_t timeoutMs,
+                                        const SyncValidators& have, SyncValidators& received) {
+        HTTPHelper::Response resp;
+        resp.success = false;
+        const bool offerGzip = ESP.getFreeHeap() >= (uint32_t)limits::GZIP_MIN_FREE_HEAP;
+
+        HTTPHelper::Lease lease(_http, url, timeoutMs);
+        HTTPClient& client = lease.client();
+        // HTTP/1.0: no chunked transfer-encoding
+        resp.code = lease.send([&](HTTPClient& c) {
+            static const char* keys[] = {"ETag", "Last-Modified", "Content-Encoding"};
+            c.collectHeaders(keys, 3);
+            if (offerGzip) c.addHeader("Accept-Encoding", "gzip");
+            HTTPHelper::addValidators(c, have);
+            return c.GET();
+        }, true);
+        if (resp.code == 304) lease.release(true);  // No body
+        if (resp.code != 200) return resp;
+
+        // Headers before release: a one-shot client goes with it
+        received.etag = client.header("ETag");
+        received.lastModified = client.header("Last-Modified");
+        String encoding = client.header("Content-Encoding");
+        encoding.toLowerCase();
+        const bool gzip = encoding == "gzip";
+        if (!gzip && encoding.length() > 0 && encoding != "identity") {
+            Serial.printf("[ORCH] DOC: unsupported Content-Encoding %s\n", encoding.c_str());
+            return resp;
         }
 
-        // Clear any leftover .part from a prior aborted download.
-        SD.remove(partPath.c_str()); // no-op if absent
-
-        File f = SD.open(partPath.c_str(), FILE_WRITE);
-        if (!f) {
-            Serial.printf("[ORCH] STREAM: could not open %s\n", partPath.c_str());
-            client.end();
-            return false;
+        GzipDecoder inflater;
+        if (gzip && !inflater.begin()) {
+            Serial.printf("[ORCH] DOC: no heap for gzip (%u free)\n", ESP.getFreeHeap());
+            return resp;
         }
+        if (!body.open()) return resp;
 
-        mbedtls_sha1_context shaCtx;
-        mbedtls_sha1_init(&shaCtx);
-        mbedtls_sha1_starts(&shaCtx);
-
-        WiFiClient* stream = client.getStreamPtr();
-        // NOT on the stack: the Arduino loopTask stack is only 8 KB and the
-        // mbedTLS handshake (client.GET() above) already consumes most of it,
-        // so a 4 KB on-stack buffer here overflows the stack — stack-canary
-        // panic on the very first asset download. 'static' moves it to .bss;
-        // safe because asset sync is single-threaded at boot (one file at a
-        // time) and never re-entered.
-        static uint8_t buffer[limits::ASSET_DOWNLOAD_CHUNK_SIZE];
-        size_t totalRead = 0;
+        const int contentLen = client.getSize();  // -1: ends when the server closes
+        const uint32_t startMs = millis();
+        uint32_t lastByteMs = startMs;
+        size_t wire = 0;
         bool ok = true;
-
-        // Read until we've consumed the whole body. Break on connection
-        // close once we either have the expected size or the server just
-        // stops sending.
-        while (client.connected() && (contentLen <= 0 || (size_t)contentLen > totalRead)) {
+        uint8_t in[512];
+        WiFiClient* stream = client.getStreamPtr();
+        while (ok && (contentLen < 0 || wire < (size_t)contentLen)) {
             size_t avail = stream->available();
             if (avail == 0) {
+                if (!client.connected()) break;
+                if (millis() - lastByteMs > timeoutMs) break;
                 delay(5);
                 continue;
             }
-            size_t toRead = avail > sizeof(buffer) ? sizeof(buffer) : avail;
-            int n = stream->readBytes(buffer, toRead);
-            if (n <= 0) break;
-
-            size_t written = f.write(buffer, n);
-            if (written != (size_t)n) {
-                Serial.printf("[ORCH] STREAM: SD write short %u/%d\n",
-                              (unsigned)written, n);
-                ok = false;
-                break;
+            if (contentLen >= 0 && avail > (size_t)contentLen - wire) {
+                avail = (size_t)contentLen - wire;
+            }
+            int n = stream->readBytes(in, avail < sizeof(in) ? avail : sizeof(in));
+            ok = n > 0 && (gzip ? inflater.feed(in, n, body) : body.write(in, n));
+            if (n > 0) {
+                wire += n;
+                lastByteMs = millis();
             }
-            mbedtls_sha1_update(&shaCtx, buffer, n);
-            totalRead += n;
-
-            if (onProgress) onProgress(totalRead, expectedSize);
             yield(); // WDT + cooperative scheduling
         }
+        lease.release(contentLen >= 0 && wire == (size_t)contentLen);
 
-        f.flush();
-        f.close();
-
-        unsigned char digest[20];
-        mbedtls_sha1_finish(&shaCtx, digest);
-        mbedtls_sha1_free(&shaCtx);
-        client.end();
+        bool whole = ok && (contentLen < 0 || wire == (size_t)contentLen);
+        if (whole && gzip && !inflater.finish()) {
+            Serial.printf("[ORCH] DOC: gzip %s after %u bytes\n", inflater.error(), (unsigned)wire);
+            whole = false;
+        }
+        if (!whole) {
+            Serial.printf("[ORCH] DOC: incomplete body %u/%d bytes\n", (unsigned)wire, contentLen);
+            return resp;  // An unfinished body discards what it got
+        }
+        LOG_INFO("[ORCH] DOC: %u bytes%s -> %u bytes in %lu ms\n", (unsigned)wire,
+                 gzip ? " gzip" : "", (unsigned)(gzip ? inflater.outBytes() : wire),
+                 (unsigned long)(millis() - startMs));
+        resp.success = body.finish();
+        return resp;
+    }
 
-        if (!ok || totalRead != expectedSize) {
-            Serial.printf("[ORCH] STREAM: short read %u/%u\n",
-                          (unsigned)totalRead, (unsigned)expectedSize);
-            SD.remove(partPath.c_str());
+    // Shared body of httpGETStreamToSD / httpGETStreamToPack (sinks: AssetSink.h)
+    bool streamToSink(
+        const String& url,
+        size_t expectedSize,
+        const String& expectedSha1,
+        uint32_t timeoutMs,
+        std::function<void(size_t, size_t)> onProgress,
+        AssetSink& sink
+    ) {
+        const uint32_t heapBefore = ESP.getFreeHeap();
+        if (heapBefore < limits::ASSET_MIN_FREE_HEAP) {
+            Serial.printf("[ORCH] STREAM: abort, low heap %u < %d\n",
+                          heapBefore, limits::ASSET_MIN_FREE_HEAP);
             return false;
         }
 
-        // Hex-encode digest for manifest comparison.
-        char hex[41];
-        for (int i = 0; i < 20; i++) {
-            snprintf(&hex[i * 2], 3, "%02x", digest[i]);
-        }
-        hex[40] = '\0';
-        String wantSha = expectedSha1;
-        wantSha.toLowerCase();
-        if (wantSha.length() != 40 || wantSha != hex) {
-            Serial.printf("[ORCH] STREAM: sha1 mismatch got=%s want=%s\n",
-                          hex, wantSha.c_str());
-            SD.remove(partPath.c_str());
+        // Rides the keep-alive connection when free; released as soon as
+        // the body is read so SD verify/commit doesn't hold it
+        HTTPHelper::Lease lease(_http, url, timeoutMs);
+        HTTPClient& client = lease.client();
+        // HTTP/1.0: no chunked transfer-encoding
+        int code = lease.send([](HTTPClient& c) { return c.GET(); }, true);
+        if (code != 200) {
+            Serial.printf("[ORCH] STREAM: HTTP %d for %s\n", code, url.c_str());
             return false;
         }
 
-        // Atomic swap into the final name.
-        SD.remove(destPath.c_str()); // no-op if absent
-        if (!SD.rename(partPath.c_str(), destPath.c_str())) {
-            Serial.printf("[ORCH] STREAM: rename failed %s -> %s\n",
-                          partPath.c_str(), destPath.c_str());
-            SD.remove(partPath.c_str());
+        int contentLen = client.getSize();
+        if (contentLen > 0 && (size_t)contentLen != expectedSize) {
+            Serial.printf("[ORCH] STREAM: size mismatch %d != %u\n",
+                          contentLen, (unsigned)expectedSize);
             return false;
         }
 
-        return true;
+        AssetWriter writer(sink, expectedSize, expectedSha1, onProgress);
+        if (!writer.open()) return false;
+
+        // Read until we've consumed the whole body. Break on connection
+        // close once we either have the expected size or the server just
+        // stops sending. Network reads land in the writer's staging buffer
+        // unlocked; only full chunks take the SD lock.
+        WiFiClient* stream = client.getStreamPtr();
+        while (client.connected() &&
+               (contentLen <= 0 || (size_t)contentLen > writer.received())) {
+            size_t avail = stream->available();
+            if (avail == 0) {
+                delay(5);
+                continue;
+            }
+            size_t room;
+            uint8_t* dst = writer.space(room);
+            int n = stream->readBytes(dst, avail > room ? room : avail);
+            if (n <= 0 || !writer.produced(n)) break;
+            yield(); // WDT + cooperative scheduling
+        }
+        lease.release(contentLen > 0 && writer.received() == (size_t)contentLen);
+        return writer.finish();
     }
 
-private:
+
     // ─── Singleton Pattern ─────────────────────────────────────────────
 
     OrchestratorService() {
@@ -873,6 +1167,21 @@ private:
         mutable portMUX_TYPE mutex;
     } _queue = {0, portMUX_INITIALIZER_UNLOCKED};
 
+    // On-SD queue storage (all access under hal::SDCard::Lock)
+    QueueRing _ring{queue_config::QUEUE_FILE, queue_config::QUEUE_RING_CAPACITY,
+                    queue_config::MAX_QUEUE_SIZE};
+
+    // deviceIds referenced by index from queued records (persisted to QUEUE_DICT_FILE)
+    DeviceIdTable _deviceIds;
+
+    // Scans accepted by queueScan() but not yet in the ring
+    ScanJournal<queue_config::SCAN_JOURNAL_DEPTH> _journal;
+    uint32_t _journalUnfit = 0;  // Journaled scans too large for a ring record
+
+    // Online scans on their way to / back from the scan submit task
+    ScanSubmitQueue<queue_config::SCAN_SUBMIT_DEPTH> _submits;
+    TaskHandle_t volatile _submitTask = nullptr;
+
     // Device config (for background task - includes orchestratorURL and deviceID)
     models::DeviceConfig _config;
 
@@ -892,11 +1201,32 @@ private:
     bool _batchBootNonceReady = false;
 
     // Last POSIX TZ string applied via setenv/tzset. Initialized from the
-    // orchestrator's /health response on each successful health check; the
-    // comparison prevents redundant setenv/tzset calls (every 10s polling
-    // would otherwise churn the C runtime TZ state unnecessarily).
+    // orchestrator's /health response on each successful health check (or
+    // a pushed health/timezone event); the comparison prevents redundant
+    // setenv/tzset calls (every 10s polling would otherwise churn the C
+    // runtime TZ state unnecessarily).
     String _appliedTimezone = "";
 
+    // Push channel (OrchestratorSync task only, except the atomics and stats)
+    PushChannel _push;
+    PushBackoff _pushBackoff;
+    uint32_t _pushRetryAtMs = 0;
+    PushStats _pushStats;
+    mutable portMUX_TYPE _pushMux = portMUX_INITIALIZER_UNLOCKED;
+
+    // Offline queue drain (whichever task runs it; stats read from any)
+    BatchSizer _batchSizer;
+    DrainStats _drainStats;
+    mutable portMUX_TYPE _drainMux = portMUX_INITIALIZER_UNLOCKED;
+
+    // Upload encoding: set from /health (background or push task), read
+    // by the submit task and the drain; a 415 drops it back to JSON
+    std::atomic<uint8_t> _scanEncoding{static_cast<uint8_t>(services::PayloadEncoding::Json)};
+    std::atomic<uint8_t> _session{static_cast<uint8_t>(SessionState::Unknown)};
+    std::atomic<uint8_t> _refreshPending{0};        // REFRESH_* bits
+    std::atomic<uint32_t> _refreshRequestedMs{0};   // Latest token/asset event
+    RemoteRefreshJob _refreshJob = nullptr;
+
     // ─── HTTP Helper Class (CRITICAL FLASH SAVINGS) ───────────────────
 
     /**
@@ -917,6 +1247,18 @@ private:
      * **HTTPS SUPPORT:** Uses WiFiClientSecure with setInsecure() for HTTPS URLs.
      * Certificate validation is skipped (acceptable for local network deployments).
      * Required for Android NFC scanning API which mandates HTTPS even on local networks.
+     *
+     * **KEEP-ALIVE:** One connection to the orchestrator stays open between
+     * requests, so a scan POST or health poll no longer pays a TCP + TLS
+     * handshake (~40 KB of mbedTLS heap and a few hundred ms) every time.
+     * It is handed out by Lease under a mutex; a request that can't get it
+     * within SHARED_WAIT_MS uses a one-shot connection instead. The shared
+     * connection is closed - and the next handshake gets a fresh
+     * WiFiClientSecure - after any error or partially read body, after
+     * KEEPALIVE_IDLE_MS idle, on WiFi loss, and on an origin change. A
+     * used SSL context is never handshaken again (see implementation
+     * note 2). HttpStats.h tracks handshakes vs reuse, cold/warm latency
+     * and the idle-heap leak guard (HTTP_STATS serial command).
      */
     class HTTPHelper {
     public:
@@ -924,6 +1266,108 @@ private:
             int code;           // HTTP response code (or negative for errors)
             String body;        // Response body (if available)
             bool success;       // true if 2xx response code
+            bool retryable = true;  // false: resending cannot help (httpWithRetry stops)
+        };
+
+        HTTPHelper() { _mutex = xSemaphoreCreateMutex(); }
+
+        HTTPHelper(const HTTPHelper&) = delete;
+        HTTPHelper& operator=(const HTTPHelper&) = delete;
+
+        /**
+         * @class Lease
+         * @brief One request's hold on a connection, released on scope exit.
+         *
+         * send() issues the request; release(true) hands the shared
+         * connection back open once the body has been read to the end.
+         * Any other exit closes it.
+         */
+        class Lease {
+        public:
+            Lease(HTTPHelper& owner, const String& url, uint32_t timeoutMs)
+                : _owner(owner), _url(url), _timeoutMs(timeoutMs) {
+                _shared = owner.acquireShared(url);
+                if (_shared) {
+                    _warm = owner._client->connected();
+                    _client = owner._client.get();
+                } else {
+                    _client = openConnection(url, false, _ownTransport, _ownClient);
+                }
+                _client->setTimeout(timeoutMs);
+            }
+
+            ~Lease() { release(false); }
+
+            Lease(const Lease&) = delete;
+            Lease& operator=(const Lease&) = delete;
+
+            HTTPClient& client() { return *_client; }
+
+            /**
+             * @brief Run request(HTTPClient&) -> status code, timed into HttpStats
+             * @param http10 HTTP/1.0 request (no chunked body; still keep-alive)
+             *
+             * A reused connection the server dropped while idle fails before
+             * anything is sent; that one case is retried once on a fresh
+             * connection. Later failures may have reached the server and are
+             * returned as-is.
+             */
+            template <typename Fn>
+            int send(Fn request, bool http10 = false) {
+                int code = attempt(request, http10);
+                if (_shared && _warm && isStaleSend(code)) {
+                    _owner.closeShared(HttpCloseReason::Stale);
+                    _client = _owner.openShared(_url);
+                    _client->setTimeout(_timeoutMs);
+                    _warm = false;
+                    code = attempt(request, http10);
+                }
+                _code = code;
+                return code;
+            }
+
+            // clean: response body consumed to the last byte
+            void release(bool clean) {
+                if (!_client) return;
+                if (_shared) {
+                    _owner.releaseShared(clean && _code > 0);
+                } else {
+                    _client->end();
+                    _ownClient.reset();      // HTTPClient first: it points at the transport
+                    _ownTransport.reset();
+                }
+                _client = nullptr;
+            }
+
+        private:
+            template <typename Fn>
+            int attempt(Fn& request, bool http10) {
+                _client->useHTTP10(http10);  // Also clears reuse; set it after
+                _client->setReuse(_shared);
+                uint32_t heapBefore = ESP.getFreeHeap();
+                uint32_t startUs = micros();
+                int code = request(*_client);
+                uint32_t us = micros() - startUs;
+                uint32_t heapAfter = ESP.getFreeHeap();
+                _owner.recordRequest(!_warm, _shared, us, code, heapBefore, heapAfter);
+                return code;
+            }
+
+            static bool isStaleSend(int code) {
+                return code == HTTPC_ERROR_CONNECTION_REFUSED ||
+                       code == HTTPC_ERROR_SEND_HEADER_FAILED ||
+                       code == HTTPC_ERROR_NOT_CONNECTED;
+            }
+
+            HTTPHelper& _owner;
+            String _url;
+            uint32_t _timeoutMs;
+            bool _shared = false;
+            bool _warm = false;
+            int _code = 0;
+            HTTPClient* _client = nullptr;
+            std::unique_ptr<WiFiClient> _ownTransport;  // One-shot only
+            std::unique_ptr<HTTPClient> _ownClient;
         };
 
         /**
@@ -931,68 +1375,252 @@ private:
          * @param url Full URL to GET
          * @param timeoutMs Request timeout in milliseconds
          * @return Response struct with code, body, success
-         *
-         * CRITICAL FIX: Creates WiFiClientSecure locally per request to avoid
-         * heap corruption from reusing SSL context across failed connections.
-         * See: ESP32 GitHub issues #3808, #6257, #9636
          */
         Response httpGET(const String& url, uint32_t timeoutMs = 5000) {
-            HTTPClient client;
-            WiFiClientSecure secureClient;  // Declare at function scope (CRITICAL!)
+            Lease lease(*this, url, timeoutMs);
+            int code = lease.send([](HTTPClient& client) { return client.GET(); });
 
-            // Create WiFiClientSecure locally (fresh SSL context each request)
-            if (url.startsWith("https://")) {
-                secureClient.setInsecure();  // Skip certificate validation
-                client.begin(secureClient, url);
-            } else {
-                client.begin(url);
-            }
-            client.setTimeout(timeoutMs);
+            Response resp;
+            resp.code = code;
+            resp.body = (code > 0) ? lease.client().getString() : "";
+            resp.success = (code >= 200 && code < 300);
+
+            lease.release(code > 0);
+            return resp;
+        }
+
+        /**
+         * @brief GET that the server may answer 304 Not Modified
+         * @param have Validators sent with the request (empty = plain GET)
+         * @param received ETag / Last-Modified of a 200 response
+         */
+        Response httpGETConditional(const String& url, uint32_t timeoutMs,
+                                    const SyncValidators& have, SyncValidators& received) {
+            Lease lease(*this, url, timeoutMs);
+            int code = lease.send([&have](HTTPClient& client) {
+                static const char* keys[] = {"ETag", "Last-Modified"};
+                client.collectHeaders(keys, 2);
+                addValidators(client, have);
+                return client.GET();
+            });
 
-            int code = client.GET();
             Response resp;
             resp.code = code;
-            resp.body = (code > 0) ? client.getString() : "";
+            // 304 has no body by definition; reading one would wait out the timeout
+            resp.body = (code > 0 && code != 304) ? lease.client().getString() : "";
             resp.success = (code >= 200 && code < 300);
+            if (code == 200) {
+                received.etag = lease.client().header("ETag");
+                received.lastModified = lease.client().header("Last-Modified");
+            }
 
-            client.end();
+            lease.release(code > 0);
             return resp;
         }
 
+        // If-None-Match / If-Modified-Since for the copy we hold, if any
+        static void addValidators(HTTPClient& client, const SyncValidators& have) {
+            if (have.etag.length()) client.addHeader("If-None-Match", have.etag);
+            if (have.lastModified.length()) {
+                client.addHeader("If-Modified-Since", have.lastModified);
+            }
+        }
+
         /**
          * @brief Send HTTP POST request with JSON payload
          * @param url Full URL to POST
          * @param json JSON string payload
          * @param timeoutMs Request timeout in milliseconds
          * @return Response struct with code, body, success
-         *
-         * CRITICAL FIX: Creates WiFiClientSecure locally per request to avoid
-         * heap corruption from reusing SSL context across failed connections.
-         * See: ESP32 GitHub issues #3808, #6257, #9636
          */
         Response httpPOST(const String& url, const String& json, uint32_t timeoutMs = 5000) {
-            HTTPClient client;
-            WiFiClientSecure secureClient;  // Declare at function scope (CRITICAL!)
+            return httpPOST(url, reinterpret_cast<const uint8_t*>(json.c_str()), json.length(),
+                            "application/json", timeoutMs);
+        }
 
-            // Create WiFiClientSecure locally (fresh SSL context each request)
-            if (url.startsWith("https://")) {
-                secureClient.setInsecure();  // Skip certificate validation
-                client.begin(secureClient, url);
-            } else {
-                client.begin(url);
-            }
-            client.setTimeout(timeoutMs);
-            client.addHeader("Content-Type", "application/json");
+        // Binary-safe form (MessagePack bodies hold NUL bytes)
+        Response httpPOST(const String& url, const uint8_t* body, size_t length,
+                          const char* contentType, uint32_t timeoutMs = 5000) {
+            Lease lease(*this, url, timeoutMs);
+            int code = lease.send([&](HTTPClient& client) {
+                client.addHeader("Content-Type", contentType);
+                return client.POST(const_cast<uint8_t*>(body), length);
+            });
 
-            int code = client.POST(json);
             Response resp;
             resp.code = code;
-            resp.body = (code > 0) ? client.getString() : "";
+            resp.body = (code > 0) ? lease.client().getString() : "";
             resp.success = (code >= 200 && code < 300);
 
-            client.end();
+            lease.release(code > 0);
             return resp;
         }
+
+        /**
+         * @brief POST a body pulled from a Stream, Content-Length up front
+         * @param body Stream with length(), contentType() and rewind();
+         *        rewound before each send, as a stale keep-alive
+         *        connection is retried once
+         *
+         * HTTPClient copies it to the socket through its own 1460-byte
+         * buffer, so the body is never in RAM as a whole.
+         */
+        template <typename Body>
+        Response httpPOSTStream(const String& url, Body& body, uint32_t timeoutMs = 5000) {
+            Lease lease(*this, url, timeoutMs);
+            int code = lease.send([&body](HTTPClient& client) {
+                body.rewind();
+                client.addHeader("Content-Type", body.contentType());
+                return client.sendRequest("POST", &body, body.length());
+            });
+
+            Response resp;
+            resp.code = code;
+            resp.body = (code > 0) ? lease.client().getString() : "";
+            resp.success = (code >= 200 && code < 300);
+
+            lease.release(code > 0);
+            return resp;
+        }
+
+        // Close the shared connection before its next use (WiFi event task)
+        void requestReset() { _resetRequested = true; }
+
+        // Close the shared connection now, unless a request holds it
+        void closeIdle() {
+            if (!_mutex ||
+                xSemaphoreTake(_mutex, pdMS_TO_TICKS(http_config::SHARED_WAIT_MS)) != pdTRUE) {
+                return;
+            }
+            closeShared(HttpCloseReason::Reset);
+            xSemaphoreGive(_mutex);
+        }
+
+        HttpStats getStats() const {
+            portENTER_CRITICAL(&_statsMux);
+            HttpStats copy = _stats;
+            portEXIT_CRITICAL(&_statsMux);
+            return copy;
+        }
+
+        // Counters only; a tripped leak guard stays tripped until reboot
+        void resetStats() {
+            portENTER_CRITICAL(&_statsMux);
+            HttpLeakGuard leak = _stats.leak;
+            _stats = HttpStats();
+            _stats.leak = leak;
+            portEXIT_CRITICAL(&_statsMux);
+        }
+
+    private:
+        enum class HttpCloseReason { Error, Idle, Reset, Stale, Leak };
+
+        static HTTPClient* openConnection(const String& url, bool reuse,
+                                          std::unique_ptr<WiFiClient>& transport,
+                                          std::unique_ptr<HTTPClient>& client) {
+            if (url.startsWith("https://")) {
+                auto* secure = new WiFiClientSecure();
+                secure->setInsecure();  // Skip certificate validation
+                transport.reset(secure);
+            } else {
+                transport.reset(new WiFiClient());
+            }
+            client.reset(new HTTPClient());
+            client->setReuse(reuse);
+            client->begin(*transport, url);
+            return client.get();
+        }
+
+        // With _mutex taken: the shared client, pointed at url
+        HTTPClient* openShared(const String& url) {
+            openConnection(url, true, _transport, _client);
+            _origin = httpOrigin(url);
+            portENTER_CRITICAL(&_statsMux);
+            _stats.leak.newConnection();
+            portEXIT_CRITICAL(&_statsMux);
+            return _client.get();
+        }
+
+        // Take the shared connection, ready for url; false -> use a one-shot
+        bool acquireShared(const String& url) {
+            if (!_mutex || _stats.leak.tripped) return false;
+            if (xSemaphoreTake(_mutex, pdMS_TO_TICKS(http_config::SHARED_WAIT_MS)) != pdTRUE) {
+                return false;
+            }
+
+            if (_client) {
+                if (_resetRequested || httpOrigin(url) != _origin) {
+                    closeShared(HttpCloseReason::Reset);
+                } else if (millis() - _lastUsedMs > http_config::KEEPALIVE_IDLE_MS) {
+                    closeShared(HttpCloseReason::Idle);
+                } else if (!_client->connected()) {
+                    closeShared(HttpCloseReason::Error);  // Server closed it
+                } else {
+                    // Idle heap with the connection open: nothing of this
+                    // request allocated yet
+                    portENTER_CRITICAL(&_statsMux);
+                    bool leaking = _stats.leak.sample(ESP.getFreeHeap());
+                    portEXIT_CRITICAL(&_statsMux);
+                    if (leaking) {
+                        LOG_ERROR("ORCH-HTTP", "Idle heap keeps dropping - keep-alive disabled");
+                        closeShared(HttpCloseReason::Leak);
+                        xSemaphoreGive(_mutex);
+                        return false;
+                    }
+                }
+            }
+            _resetRequested = false;
+
+            if (_client) {
+                _client->setURL(url);  // Same origin: keeps the socket
+            } else {
+                openShared(url);
+            }
+            return true;
+        }
+
+        void releaseShared(bool keep) {
+            _client->end();  // Leaves the socket open if the server agreed to keep-alive
+            if (keep && _client->connected()) {
+                _lastUsedMs = millis();
+            } else {
+                closeShared(HttpCloseReason::Error);
+            }
+            xSemaphoreGive(_mutex);
+        }
+
+        void closeShared(HttpCloseReason reason) {
+            if (!_client) return;
+            portENTER_CRITICAL(&_statsMux);
+            if (reason == HttpCloseReason::Idle) _stats.idleCloses++;
+            else if (reason == HttpCloseReason::Reset) _stats.resets++;
+            else if (reason == HttpCloseReason::Stale) _stats.staleRetries++;
+            portEXIT_CRITICAL(&_statsMux);
+
+            _client->end();
+            _transport->stop();
+            _client.reset();      // HTTPClient first: it points at the transport
+            _transport.reset();
+            _origin = "";
+        }
+
+        void recordRequest(bool handshake, bool shared, uint32_t us, int code,
+                           uint32_t heapBefore, uint32_t heapAfter) {
+            portENTER_CRITICAL(&_statsMux);
+            _stats.recordRequest(handshake, shared, us, code);
+            if (handshake && code > 0) _stats.recordHandshakeHeap(heapBefore, heapAfter);
+            portEXIT_CRITICAL(&_statsMux);
+        }
+
+        SemaphoreHandle_t _mutex = nullptr;  // Guards the shared connection
+        std::unique_ptr<WiFiClient> _transport;
+        std::unique_ptr<HTTPClient> _client;
+        String _origin;
+        uint32_t _lastUsedMs = 0;
+        volatile bool _resetRequested = false;
+
+        HttpStats _stats;
+        mutable portMUX_TYPE _statsMux = portMUX_INITIALIZER_UNLOCKED;
     };
 
     HTTPHelper _http;  // Singleton HTTP helper instance
@@ -1024,14 +1652,19 @@ private:
         for (int attempt = 1; attempt <= MAX_ATTEMPTS; attempt++) {
             HTTPHelper::Response resp = requestFn();
 
-            // Success or semantic error (don't retry)
-            if (resp.success || resp.code == 404 || resp.code == 409) {
+            // Success, not modified, or semantic error (don't retry)
+            if (resp.success || resp.code == 304 || resp.code == 404 || resp.code == 409) {
                 if (attempt > 1) {
                     LOG_INFO("[ORCH-RETRY] %s succeeded on attempt %d\n", operation, attempt);
                 }
                 return resp;
             }
 
+            if (!resp.retryable) {
+                LOG_INFO("[ORCH-RETRY] %s failed (attempt %d), not retryable\n", operation, attempt);
+                return resp;
+            }
+
             // Connection failure or server error
             LOG_INFO("[ORCH-RETRY] %s failed (attempt %d/%d), code: %d\n",
                      operation, attempt, MAX_ATTEMPTS, resp.code);
@@ -1078,172 +1711,565 @@ private:
         }
     }
 
-    // ─── Queue File Operations ─────────────────────────────────────────
+    // ─── Queue Drain ───────────────────────────────────────────────────
 
     /**
-     * @brief Read queue entries from JSONL file
-     * @param batch Vector to populate with scan data
-     * @param maxEntries Maximum entries to read
-     *
-     * Implementation from v4.1 lines 1947-1994
-     * Must be called with SD mutex already acquired
+     * @brief Upload the next batch from the head of the queue
+     * @param sent Incremented by the scans acknowledged
+     * @return records removed from the queue (> 0: go on), 0 once it is
+     *         empty, -1 on failure
      */
-    void readQueue(std::vector<models::ScanData>& batch, int maxEntries) {
-        LOG_INFO("\n[ORCH-QUEUE-READ] ═══ READING QUEUE BATCH ═══\n");
-        LOG_INFO("[ORCH-QUEUE-READ] Max entries: %d\n", maxEntries);
+    int uploadNextBatch(const models::DeviceConfig& config, uint32_t& sent) {
+        const uint16_t want = _batchSizer.next(ESP.getFreeHeap());
+        if (want == 0) {
+            LOG_INFO("[ORCH-BATCH] Heap too low for a batch (%u free)\n", ESP.getFreeHeap());
+            return -1;
+        }
 
-        File file = SD.open(queue_config::QUEUE_FILE, FILE_READ);
-        if (!file) {
-            LOG_INFO("[ORCH-QUEUE-READ] ✗ Queue file not found\n");
-            return;
+        // Generate batch ID for idempotency. Stable across HTTP retries of
+        // THIS batch (counter advances only on success), but unique across
+        // reboots via the per-boot nonce (F-SCAN-02: the old boot-reset
+        // counter collided with the backend's 1-hour idempotency cache and
+        // silently lost scans). A batch that failed outright is re-sent
+        // under the same ID, possibly shrunk: always a prefix of the failed
+        // one, so a replayed ack never covers a scan it did not contain.
+        //
+        // Reboot-window trade-off: if the device reboots while httpWithRetry
+        // is in flight for this batch, the next boot draws a fresh nonce and
+        // re-uploads the same scans under a new batchId.  The backend will
+        // process them again, producing duplicates.  For player-scanner scans
+        // duplicates are benign (players can re-view the same token); losing
+        // scans is NOT acceptable (permanent audit gap).  Duplicate-on-reboot
+        // is therefore the deliberate choice over loss-on-reboot.
+        services::BatchHeader header;
+        header.batchId = services::makeBatchId(config.deviceID, _batchBootNonce, _nextBatchId);
+        header.encoding = getScanEncoding();
+        const String& batchId = header.batchId;
+
+        size_t bodyBytes = 0;
+        QueueRingCursor cursor;
+        {
+            hal::SDCard::Lock lock("uploadBatch", freertos_config::SD_MUTEX_TIMEOUT_MS);
+            if (!lock.acquired()) {
+                LOG_ERROR("ORCH-BATCH", "Could not acquire SD mutex");
+                return -1;
+            }
+
+            flushJournalLocked();  // Pending scans ride this batch
+            cursor = measureQueue(header, want, bodyBytes);
+        }  // Lock released here
+
+        const uint32_t scans = header.scans;
+        if (scans == 0) {
+            if (cursor.count == 0) return 0;
+            // Every record in this window was unparseable - drop them so
+            // they cannot wedge the head of the queue
+            return removeUploadedEntries(cursor) ? (int)cursor.count : -1;
         }
 
-        int count = 0;
-        int skipped = 0;
+        // The body is streamed from the ring as it is sent (Content-Length
+        // measured above), so heap use does not grow with the batch
+        QueueBatchSource source(*this, cursor);
+        BatchBodyStream body(header, bodyBytes, source);
 
-        while (file.available() && count < maxEntries) {
-            String line = file.readStringUntil('\n');
-            line.trim();
-            if (line.length() == 0) continue;
+        // Send via consolidated HTTP helper with retry logic
+        String url = config.orchestratorURL + "/api/scan/batch";
+        unsigned long startTime = millis();
+        auto resp = httpWithRetry([&]() {
+            auto r = _http.httpPOSTStream(url, body, 30000);
+            r.retryable = !source.evicted() && r.code != 415;
+            return r;
+        }, "batch upload");
+        unsigned long latency = millis() - startTime;
 
-            models::ScanData scan;
-            // parseScanFromJsonl returns false for both corrupt JSON and missing
-            // required fields. The raw line is logged for post-game diagnosis.
-            if (services::parseScanFromJsonl(line, scan)) {
-                batch.push_back(scan);
-                count++;
-
-                LOG_INFO("[ORCH-QUEUE-READ] Entry %d: tokenId=%s\n",
-                         count, scan.tokenId.c_str());
-            } else {
-                skipped++;
-                LOG_INFO("[ORCH-QUEUE-READ] ✗ Skipped invalid line: %s\n",
-                         line.c_str());
+        if (resp.body.length() > 0 && resp.body.length() < 200) {
+            LOG_INFO("[ORCH-BATCH] Response: %s\n", resp.body.c_str());
+        }
+
+        if (resp.code != 200) {
+            LOG_INFO("[ORCH-BATCH] ✗✗✗ FAILURE ✗✗✗ Batch %s: HTTP %d after %lu ms\n",
+                     batchId.c_str(), resp.code, latency);
+            if (resp.code == 415 && header.encoding != services::PayloadEncoding::Json) {
+                // Not processed: the next drain re-sends it as JSON under
+                // the same ID. Says nothing about the batch size.
+                setScanEncoding(services::PayloadEncoding::Json, "415 from /api/scan/batch");
+                return -1;
             }
+            if (source.evicted()) {
+                // Drop-oldest took scans this ID may already have carried:
+                // retire it rather than reuse it for a different set
+                _nextBatchId++;
+                LOG_INFO("[ORCH-BATCH] Queue head evicted mid-upload, batch ID retired\n");
+            }
+            _batchSizer.onFailure();
+            updateDrainStats([this](DrainStats& s) {
+                s.failures++;
+                s.batchSize = _batchSizer.size();
+            });
+            return -1;
         }
 
-        file.close();
+        // Remove uploaded entries from queue (O(1) header update)
+        const bool removed = removeUploadedEntries(cursor);
+
+        // Increment batch ID for next batch
+        _nextBatchId++;
+        sent += scans;
+
+        _batchSizer.onSuccess((uint16_t)scans, bodyBytes, latency);
+        updateDrainStats([&](DrainStats& s) {
+            s.recordBatch((uint16_t)scans, bodyBytes, latency);
+            s.batchSize = _batchSizer.size();
+            s.bytesPerScan = _batchSizer.bytesPerScan();
+        });
+        LOG_INFO("[ORCH-BATCH] ✓ Batch %s: %u scans, %u bytes %s, %lu ms; next size %u, %d left\n",
+                 batchId.c_str(), (unsigned)scans, (unsigned)bodyBytes,
+                 services::encodingName(header.encoding), latency,
+                 _batchSizer.size(), getQueueSize());
+        return removed ? (int)cursor.count : -1;  // Never re-send an acked head in a loop
+    }
 
-        LOG_INFO("[ORCH-QUEUE-READ] ✓ Read %d entries, skipped %d corrupt\n", count, skipped);
-        LOG_INFO("[ORCH-QUEUE-READ] ═══ READING COMPLETE ═══\n\n");
+    template <typename Fn>
+    void updateDrainStats(Fn fn) {
+        portENTER_CRITICAL(&_drainMux);
+        fn(_drainStats);
+        portEXIT_CRITICAL(&_drainMux);
     }
 
     /**
-     * @brief Remove first N entries from queue (FIFO, stream-based)
-     * @param numEntries Number of entries to remove
+     * @class QueueBatchSource
+     * @brief The scans of one measured batch, for BatchBodyReader
      *
-     * **CRITICAL IMPLEMENTATION:** Stream-based queue rebuild to prevent RAM spikes.
-     * Original v4.1 implementation loaded entire queue into RAM, causing OOM on
-     * large queues. This version streams from source to temp file.
+     * Re-reads the ring BATCH_SLICE_RECORDS at a time while the body
+     * streams; the SD lock is held per slice, never across a socket write.
+     * If drop-oldest evicts the head meanwhile, the records are no longer
+     * the measured ones: next() fails and evicted() says why.
+     */
+    class QueueBatchSource {
+    public:
+        QueueBatchSource(OrchestratorService& owner, const QueueRingCursor& batch)
+            : _owner(owner), _firstIndex(batch.firstIndex), _records(batch.count) {}
+
+        bool evicted() const { return _evicted; }
+
+        void rewind() {
+            _cursor = QueueRingCursor();
+            _started = false;
+            _slice.clear();
+            _next = 0;
+        }
+
+        // 1 = a scan, 0 = batch done, -1 = failed
+        int next(models::ScanData& scan) {
+            while (_next == _slice.size()) {
+                if (_started && _cursor.count >= _records) return 0;
+                if (!readSlice()) return -1;
+            }
+            scan = _slice[_next++];
+            return 1;
+        }
+
+    private:
+        bool readSlice() {
+            _slice.clear();
+            _next = 0;
+
+            hal::SDCard::Lock lock("uploadSlice", freertos_config::SD_MUTEX_TIMEOUT_MS);
+            if (!lock.acquired()) {
+                LOG_ERROR("ORCH-BATCH", "Could not acquire SD mutex");
+                return false;
+            }
+
+            auto decode = [this](const uint8_t* data, uint16_t len) {
+                models::ScanData scan;
+                // Undecodable records were left out when measuring too
+                if (services::decodeScanRecord(data, len, _owner._deviceIds, scan)) {
+                    _slice.push_back(scan);
+                }
+            };
+            if (!_started) {
+                _cursor = _owner._ring.peek(0, decode);  // Just the head position
+                _started = true;
+                _evicted = _cursor.firstIndex != _firstIndex;
+            }
+
+            uint32_t before = _cursor.count;
+            uint32_t want = _records - before;
+            if (want > queue_config::BATCH_SLICE_RECORDS) want = queue_config::BATCH_SLICE_RECORDS;
+            if (_evicted || !_owner._ring.peekMore(_cursor, want, decode)) {
+                _evicted = true;
+                return false;
+            }
+            return _cursor.count > before;  // No progress: SD read failed
+        }
+
+        OrchestratorService& _owner;
+        uint32_t _firstIndex;
+        uint32_t _records;            // Ring records covered, undecodable ones included
+        QueueRingCursor _cursor;
+        bool _started = false;
+        bool _evicted = false;
+        std::vector<models::ScanData> _slice;
+        size_t _next = 0;
+    };
+
+    /**
+     * @class BatchBodyStream
+     * @brief BatchBodyReader as the Stream HTTPClient::sendRequest() pulls
      *
-     * Implementation from v4.1 lines 2004-2089
-     * Handles its own mutex acquisition
+     * A failed source reports available() == -1, which ends the send with
+     * HTTPC_ERROR_SEND_PAYLOAD_FAILED instead of waiting on the socket.
      */
-    void removeUploadedEntries(int numEntries) {
-        LOG_INFO("\n[ORCH-QUEUE-REBUILD] ═══ REMOVING UPLOADED ENTRIES ═══\n");
-        LOG_INFO("[ORCH-QUEUE-REBUILD] Entries to remove: %d\n", numEntries);
-        LOG_INFO("[ORCH-QUEUE-REBUILD] Free heap before: %d bytes\n", ESP.getFreeHeap());
+    class BatchBodyStream : public Stream {
+    public:
+        BatchBodyStream(const services::BatchHeader& header, size_t length,
+                        QueueBatchSource& source)
+            : _reader(header, length, source), _contentType(services::contentTypeFor(header.encoding)) {}
 
-        unsigned long startMs = millis();
+        size_t length() const { return _reader.length(); }
+        const char* contentType() const { return _contentType; }
+        void rewind() { _reader.rewind(); }
 
-        if (numEntries <= 0) {
-            LOG_INFO("[ORCH-QUEUE-REBUILD] ✗ No entries to remove\n");
-            return;
+        int available() override {
+            return _reader.failed() ? -1 : (int)_reader.remaining();
         }
 
-        hal::SDCard::Lock lock("removeEntries", freertos_config::SD_MUTEX_LONG_TIMEOUT_MS);
-        if (!lock.acquired()) {
-            LOG_ERROR("ORCH-QUEUE-REBUILD", "Could not acquire SD mutex");
-            return;
+        int read() override {
+            uint8_t c;
+            return _reader.read(&c, 1) == 1 ? c : -1;
         }
 
-        File src = SD.open(queue_config::QUEUE_FILE, FILE_READ);
-        if (!src) {
-            LOG_INFO("[ORCH-QUEUE-REBUILD] ✗ Queue file not found, nothing to remove\n");
-            return;
+        int peek() override { return _reader.peek(); }
+
+        using Stream::readBytes;
+        size_t readBytes(char* buffer, size_t length) override {
+            return _reader.read(reinterpret_cast<uint8_t*>(buffer), length);
         }
 
-        File tmp = SD.open(queue_config::QUEUE_TEMP_FILE, FILE_WRITE);
-        if (!tmp) {
-            LOG_ERROR("ORCH-QUEUE-REBUILD", "Could not open temp file for writing");
-            src.close();
-            return;
+        size_t write(uint8_t) override { return 0; }  // Read-only
+
+    private:
+        services::BatchBodyReader<QueueBatchSource> _reader;
+        const char* _contentType;
+    };
+
+    // ─── Queue File Operations ─────────────────────────────────────────
+
+    /**
+     * @brief Measure the next batch at the head of the ring
+     * @param header batchId and encoding in; deviceId/deviceType (first
+     *        scan) and scans (decodable ones, the transactions) out
+     * @param maxEntries Maximum entries to cover
+     * @param bodyBytes Set to the encoded batch length (the Content-Length)
+     * @return Cursor covering every record read (parsed or skipped), for
+     *         QueueBatchSource and removeUploadedEntries()
+     *
+     * Nothing is kept: the body is rebuilt from the ring while it streams.
+     * Must be called with SD mutex already acquired
+     */
+    QueueRingCursor measureQueue(services::BatchHeader& header, int maxEntries,
+                                 size_t& bodyBytes) {
+        LOG_INFO("\n[ORCH-QUEUE-READ] ═══ READING QUEUE BATCH ═══\n");
+        LOG_INFO("[ORCH-QUEUE-READ] Max entries: %d\n", maxEntries);
+
+        int skipped = 0;
+        header.scans = 0;
+        bodyBytes = 0;
+
+        QueueRingCursor cursor = _ring.peek(maxEntries,
+            [&](const uint8_t* data, uint16_t len) {
+                models::ScanData scan;
+                // The ring already skipped records failing their CRC; this only
+                // fails for a deviceId index the table lost or a codec mismatch.
+                if (services::decodeScanRecord(data, len, _deviceIds, scan)) {
+                    if (header.scans == 0) {
+                        header.deviceId = scan.deviceId;
+                        header.deviceType = scan.deviceType;
+                    }
+                    bodyBytes += services::batchEntry(header, scan, header.scans == 0).size();
+                    header.scans++;
+
+                    LOG_INFO("[ORCH-QUEUE-READ] Entry %lu: tokenId=%s\n",
+                             (unsigned long)header.scans, scan.tokenId.c_str());
+                } else {
+                    skipped++;
+                    LOG_INFO("[ORCH-QUEUE-READ] ✗ Skipped undecodable %u-byte record\n", len);
+                }
+            });
+        // The head depends on the count (MessagePack array header)
+        bodyBytes += services::batchHead(header).size() + services::batchTail(header).size();
+
+        LOG_INFO("[ORCH-QUEUE-READ] ✓ Read %lu entries (%u bytes), skipped %d corrupt\n",
+                 (unsigned long)header.scans, (unsigned)bodyBytes, skipped);
+        LOG_INFO("[ORCH-QUEUE-READ] ═══ READING COMPLETE ═══\n\n");
+        return cursor;
+    }
+
+    /**
+     * @brief Remove the entries covered by a measureQueue() cursor (FIFO)
+     * @param cursor Records to remove
+     * @return false if the ring could not be updated (entries still queued)
+     *
+     * Replaces the v4.1 stream-to-temp-file rebuild: removal is now a single
+     * ring header write, independent of how much is still queued.
+     * Handles its own mutex acquisition
+     */
+    bool removeUploadedEntries(const QueueRingCursor& cursor) {
+        LOG_INFO("[ORCH-QUEUE] Removing %lu uploaded entries\n", (unsigned long)cursor.count);
+
+        hal::SDCard::Lock lock("removeEntries", freertos_config::SD_MUTEX_TIMEOUT_MS);
+        if (!lock.acquired()) {
+            LOG_ERROR("ORCH-QUEUE", "Could not acquire SD mutex");
+            return false;
         }
 
-        LOG_INFO("[ORCH-QUEUE-REBUILD] Starting stream-based rebuild...\n");
+        bool ok = _ring.consume(cursor);
+        if (!ok) {
+            LOG_ERROR("ORCH-QUEUE", "Could not commit queue ring header");
+        }
+        setQueueSize(_ring.count());
+        return ok;
+    }
 
-        int linesRead = 0;
-        int linesSkipped = 0;
-        int linesKept = 0;
+    /**
+     * @brief Update queue size cache (atomic)
+     * @param size Entries currently in the ring
+     */
+    void setQueueSize(int size) {
+        portENTER_CRITICAL(&_queue.mutex);
+        _queue.size = size;
+        portEXIT_CRITICAL(&_queue.mutex);
+    }
 
-        // Stream-read original, stream-write to temp (MEMORY-SAFE)
-        while (src.available()) {
-            String line = src.readStringUntil('\n');
-            line.trim();
-            linesRead++;
+    /**
+     * @brief Import a pre-ring /queue.jsonl into the ring, then delete it
+     * @return false if the legacy file was corrupt and discarded
+     *
+     * Must be called with SD mutex already acquired
+     */
+    bool migrateLegacyQueue() {
+        File file = SD.open(queue_config::LEGACY_QUEUE_FILE, FILE_READ);
+        if (!file) return true;
 
-            if (line.length() == 0) continue;  // Skip empty lines
+        unsigned long fileSize = file.size();
+        LOG_INFO("[ORCH-QUEUE-INIT] Migrating legacy %s (%lu bytes)\n",
+                 queue_config::LEGACY_QUEUE_FILE, fileSize);
 
-            if (linesSkipped < numEntries) {
-                // Skip this line (remove from queue)
-                linesSkipped++;
+        // CORRUPTION CHECK: File size validation
+        if (fileSize > queue_config::MAX_QUEUE_FILE_SIZE) {
+            LOG_ERROR("ORCH-QUEUE-INIT", "CORRUPTION DETECTED");
+            LOG_INFO("[ORCH-QUEUE-INIT] File size %lu exceeds threshold %lu, deleting\n",
+                     fileSize, queue_config::MAX_QUEUE_FILE_SIZE);
+            file.close();
+            SD.remove(queue_config::LEGACY_QUEUE_FILE);
+            return false;
+        }
+
+        int imported = 0;
+        int skipped = 0;
+        while (file.available()) {
+            String line = file.readStringUntil('\n');
+            line.trim();
+            if (line.length() == 0) continue;
+            models::ScanData scan;
+            if (services::parseScanFromJsonl(line, scan) && appendScan(_ring, scan)) {
+                imported++;
             } else {
-                // Keep this line
-                tmp.println(line);
-                linesKept++;
+                skipped++;
             }
         }
+        file.close();
+        SD.remove(queue_config::LEGACY_QUEUE_FILE);
 
-        src.close();
-        tmp.flush();
-        tmp.close();
+        LOG_INFO("[ORCH-QUEUE-INIT] ✓ Imported %d legacy entries (%d invalid)\n",
+                 imported, skipped);
+        return true;
+    }
 
-        LOG_INFO("[ORCH-QUEUE-REBUILD] Read: %d lines, Skipped: %d, Kept: %d\n",
-                 linesRead, linesSkipped, linesKept);
+    /**
+     * @brief Encode a scan and append it to a ring
+     *
+     * Must be called with SD mutex already acquired
+     */
+    bool appendScan(QueueRing& ring, const models::ScanData& scan) {
+        internDeviceId(scan.deviceId);
 
-        // Atomic file replacement
-        LOG_INFO("[ORCH-QUEUE-REBUILD] Replacing original queue file...\n");
-        if (!SD.remove(queue_config::QUEUE_FILE)) {
-            LOG_ERROR("ORCH-QUEUE-REBUILD", "Could not remove original queue file");
-            return;
+        uint8_t record[QueueRing::MAX_RECORD_BYTES];
+        size_t len = services::encodeScanRecord(scan, _deviceIds, record, sizeof(record));
+        if (len == 0) {
+            LOG_ERROR("ORCH-QUEUE", "Scan does not fit a queue record");
+            return false;
         }
+        LOG_INFO("[ORCH-QUEUE] Entry: tokenId=%s, %u bytes\n", scan.tokenId.c_str(),
+                 (unsigned)len);
+        return ring.append(record, len);
+    }
 
-        if (!SD.rename(queue_config::QUEUE_TEMP_FILE, queue_config::QUEUE_FILE)) {
-            LOG_ERROR("ORCH-QUEUE-REBUILD", "Could not rename temp file");
-            return;
+    /**
+     * @brief Drain the journal into the ring (one file open, one header commit)
+     * @return Scans persisted (in RAM and in the committed ring header)
+     *
+     * Scans are only peeked while the batch is written and leave the journal
+     * once the header covers them. A failed write ends the batch there and a
+     * failed commit keeps the whole batch: the rest waits for the next flush.
+     * A scan too large for a record is the one thing dropped, and counted.
+     *
+     * Must be called with SD mutex already acquired
+     */
+    uint32_t flushJournalLocked() {
+        if (_journal.empty()) {
+            _journal.flushed();
+            return 0;
         }
 
-        // Update queue size cache (atomic)
-        updateQueueSize(-linesSkipped);
+        unsigned long startMs = millis();
+        uint32_t droppedBefore = _ring.droppedCount();
+        size_t examined = 0;     // Journal entries looked at
+        size_t lastRecord = 0;   // Journal index of the newest record handed over
+        uint32_t handed = 0;     // Records handed to the ring
+        uint32_t unfit = 0;      // Too-large scans among `examined`
+        uint32_t unfitBeforeLast = 0;
+        uint32_t written = _ring.appendBatch([&](uint8_t* buf, uint16_t cap) -> uint16_t {
+            while (const models::ScanData* scan = _journal.peek(examined)) {
+                internDeviceId(scan->deviceId);
+                size_t len = services::encodeScanRecord(*scan, _deviceIds, buf, cap);
+                examined++;
+                if (len > 0) {
+                    lastRecord = examined - 1;
+                    unfitBeforeLast = unfit;
+                    handed++;
+                    return len;
+                }
+                unfit++;
+            }
+            return 0;
+        });
+
+        // Everything went in; or the ring stopped at the last record handed
+        // over (written before it, committed); or the commit failed (nothing)
+        size_t done = 0;
+        uint32_t lost = 0;
+        if (written == handed) {
+            done = examined;
+            lost = unfit;
+        } else if (written + 1 == handed) {
+            done = lastRecord;
+            lost = unfitBeforeLast;
+        }
+        _journal.discard(done);
+        if (done == examined) _journal.flushed();
+        setQueueSize(_ring.count());
+
+        LOG_INFO("[ORCH-QUEUE] Journal flush: %lu scan(s) persisted in %lu ms\n",
+                 (unsigned long)written, millis() - startMs);
+        if (lost > 0) {
+            _journalUnfit += lost;
+            LOG_INFO("[ORCH-QUEUE] Dropped %lu scan(s) too large for a queue record\n",
+                     (unsigned long)lost);
+        }
+        if (done < examined) {
+            LOG_ERROR("ORCH-QUEUE", "Queue ring write failed, scans kept in journal");
+            LOG_INFO("[ORCH-QUEUE] %u scan(s) wait for the next flush\n",
+                     (unsigned)_journal.size());
+        }
+        uint32_t dropped = _ring.droppedCount() - droppedBefore;
+        if (dropped > 0) {
+            LOG_INFO("[ORCH-QUEUE] Queue full, dropped %lu oldest entr%s (FIFO)\n",
+                     (unsigned long)dropped, dropped == 1 ? "y" : "ies");
+        }
+        return written;
+    }
 
-        unsigned long latencyMs = millis() - startMs;
-        LOG_INFO("[ORCH-QUEUE-REBUILD] ✓✓✓ SUCCESS ✓✓✓ Queue rebuilt in %lu ms\n", latencyMs);
-        LOG_INFO("[ORCH-QUEUE-REBUILD] New queue size: %d\n", getQueueSize());
-        LOG_INFO("[ORCH-QUEUE-REBUILD] Free heap after: %d bytes\n", ESP.getFreeHeap());
-        LOG_INFO("[ORCH-QUEUE-REBUILD] ═══ REMOVAL COMPLETE ═══\n\n");
+    /**
+     * @brief Make sure a deviceId has a persisted table index if possible
+     *
+     * A new table entry is written to SD before any record references it.
+     * Must be called with SD mutex already acquired
+     */
+    void internDeviceId(const String& deviceId) {
+        if (_deviceIds.find(deviceId) >= 0) return;
+        if (_ring.count() == 0) _deviceIds = DeviceIdTable();  // Nothing references old ids
+        if (_deviceIds.intern(deviceId) >= 0 && !saveDeviceIds()) {
+            _deviceIds.count--;  // Not persisted: records inline it instead
+        }
     }
 
     /**
-     * @brief Update queue size cache (atomic)
-     * @param delta Change in queue size (+1 for add, -N for remove)
+     * @brief Load the deviceId table, falling back to an unrenamed temp copy
+     * Must be called with SD mutex already acquired
      */
-    void updateQueueSize(int delta) {
-        portENTER_CRITICAL(&_queue.mutex);
-        _queue.size += delta;
-        if (_queue.size < 0) _queue.size = 0;  // Clamp to zero
-        portEXIT_CRITICAL(&_queue.mutex);
+    bool loadDeviceIds() {
+        for (const char* path : {queue_config::QUEUE_DICT_FILE, queue_config::QUEUE_DICT_TEMP_FILE}) {
+            File f = SD.open(path, FILE_READ);
+            if (!f) continue;
+            uint8_t raw[256];
+            size_t n = f.read(raw, sizeof(raw));
+            f.close();
+            if (_deviceIds.deserialize(raw, n)) return true;
+        }
+        return false;
     }
 
     /**
-     * @brief Handle queue overflow (FIFO removal)
+     * @brief Persist the deviceId table (write temp, then replace)
+     * Must be called with SD mutex already acquired
+     */
+    bool saveDeviceIds() {
+        uint8_t raw[256];
+        size_t n = _deviceIds.serialize(raw, sizeof(raw));
+        if (n == 0) return false;
+
+        return atomic_file::write(queue_config::QUEUE_DICT_TEMP_FILE, queue_config::QUEUE_DICT_FILE,
+                                  [&](File& f) { return f.write(raw, n) == n; });
+    }
+
+    /**
+     * @brief Finish a v1->v2 ring rebuild cut short by power loss
      *
-     * Implementation from v4.1 lines 1872-1874
-     * Removes oldest entry when queue reaches MAX_QUEUE_SIZE
+     * The rebuilt ring only replaces the old one once complete, so a leftover
+     * QUEUE_UPGRADE_FILE is either finished (old ring already removed) or
+     * partial (old ring still present). Must be called before _ring.open()
      */
-    void handleQueueOverflow() {
-        LOG_INFO("[ORCH-QUEUE] Queue overflow (%d >= %d), removing oldest entry\n",
-                 getQueueSize(), queue_config::MAX_QUEUE_SIZE);
-        removeUploadedEntries(1);  // Remove oldest entry (FIFO)
+    void recoverRingUpgrade() {
+        if (atomic_file::recover(queue_config::QUEUE_UPGRADE_FILE, queue_config::QUEUE_FILE)) {
+            LOG_INFO("[ORCH-QUEUE-INIT] Completed interrupted ring upgrade\n");
+        }
+    }
+
+    /**
+     * @brief Rewrite a VERSION_JSONL ring as CRC-framed binary records
+     * @return false if entries were dropped or the new ring not installed
+     *
+     * Streams every entry into a second ring, then swaps it in; the old ring
+     * stays authoritative until the rename. Must be called with SD mutex
+     * already acquired
+     */
+    bool upgradeRingFormat() {
+        LOG_INFO("[ORCH-QUEUE-INIT] Upgrading %lu JSON ring entries to binary records\n",
+                 (unsigned long)_ring.count());
+
+        SD.remove(queue_config::QUEUE_UPGRADE_FILE);
+        QueueRing upgraded(queue_config::QUEUE_UPGRADE_FILE, queue_config::QUEUE_RING_CAPACITY,
+                           queue_config::MAX_QUEUE_SIZE);
+        if (upgraded.open() == QueueRing::OpenResult::Failed) return false;
+
+        int skipped = 0;
+        _ring.peek(_ring.count(), [&](const uint8_t* data, uint16_t) {
+            String line(reinterpret_cast<const char*>(data));
+            models::ScanData scan;
+            if (!services::parseScanFromJsonl(line, scan) || !appendScan(upgraded, scan)) {
+                skipped++;
+            }
+        });
+
+        if (!atomic_file::replace(queue_config::QUEUE_UPGRADE_FILE, queue_config::QUEUE_FILE)) {
+            LOG_ERROR("ORCH-QUEUE-INIT", "Could not install upgraded queue ring");
+            return false;
+        }
+        _ring.open();
+        LOG_INFO("[ORCH-QUEUE-INIT] ✓ Ring upgraded: %lu entries (%d invalid dropped)\n",
+                 (unsigned long)_ring.count(), skipped);
+        return skipped == 0;
     }
 
     // ─── Background Task ───────────────────────────────────────────────
@@ -1257,16 +2283,172 @@ private:
         self->backgroundTaskLoop();
     }
 
+    static void scanSubmitTaskWrapper(void* param) {
+        static_cast<OrchestratorService*>(param)->scanSubmitLoop();
+    }
+
+    /**
+     * @brief Scan submit task loop (runs on Core 0)
+     *
+     * Sleeps until submitScan() notifies it, then sends every pending scan
+     * in order with the same single bounded attempt sendScan() always made.
+     */
+    void scanSubmitLoop() {
+        LOG_INFO("[ORCH-SUBMIT] Scan submit task started on Core %d\n", xPortGetCoreID());
+
+        while (true) {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+            ScanSubmission sub;
+            while (_submits.next(sub)) {
+                LOG_DEBUG("[ORCH-SUBMIT] %s waited %lu ms for the task\n",
+                          sub.scan.tokenId.c_str(),
+                          (unsigned long)(millis() - sub.submittedAtMs));
+                ScanOutcome outcome = sendScan(sub.scan, _config);
+                _submits.complete(sub, outcome, millis());
+            }
+        }
+    }
+
+    /**
+     * @brief esp_restart() hook: persist journaled scans before reset
+     */
+    static void onShutdown() {
+        getInstance().flushJournal();
+    }
+
+    void requestRemoteRefresh(uint8_t what, const char* label) {
+        LOG_INFO("[PUSH] %s changed on orchestrator\n", label);
+        _refreshRequestedMs = millis();
+        _refreshPending |= what;
+    }
+
+    /**
+     * @brief Run the pushed re-syncs once they have settled (OrchestratorSync task)
+     *
+     * Scans journaled meanwhile are flushed first, since the loop stops
+     * while the job runs. An asset sync opens its own TLS connection
+     * (AssetConnection), so the push channel and the idle keep-alive
+     * connection are closed before it; the channel reopens on the next
+     * iteration.
+     */
+    void runRemoteRefresh(unsigned long now) {
+        if (!_refreshJob || _refreshPending.load() == 0 ||
+            now - _refreshRequestedMs.load() < http_config::PUSH_REFRESH_SETTLE_MS) {
+            return;
+        }
+        uint8_t what = _refreshPending.exchange(0);
+
+        flushJournal();
+        const bool reopenPush = (what & REFRESH_ASSETS) && _push.up();
+        if (reopenPush) {
+            uint32_t upMs = now - _push.upSinceMs();
+            _push.close();
+            updatePushStats([=](PushStats& s) {
+                s.up = false;
+                s.upMs += upMs;
+            });
+            LOG_INFO("[PUSH] Event stream closed for the asset sync\n");
+        }
+        if (what & REFRESH_ASSETS) closeIdleHttp();
+
+        _refreshJob(what, _config);
+        if (reopenPush) _pushRetryAtMs = millis();
+    }
+
+    template <typename Fn>
+    void updatePushStats(Fn fn) {
+        portENTER_CRITICAL(&_pushMux);
+        fn(_pushStats);
+        portEXIT_CRITICAL(&_pushMux);
+    }
+
+    // SseParser handler: events go to onPushEvent()
+    struct PushHandler {
+        OrchestratorService& orch;
+        void onEvent(const char* name, const char* data) { orch.onPushEvent(name, data); }
+    };
+
+    /**
+     * @brief Keep the push channel open and read it (OrchestratorSync task)
+     * @return true when the link just came up or went down, so the caller
+     *         re-evaluates orchestrator health now instead of in 10 s
+     */
+    bool servicePushChannel(unsigned long now) {
+        if (!_config.pushChannel) return false;
+
+        if (_push.up()) {
+            bool alive = _connState.hasWiFi();
+            if (alive) {
+                PushHandler handler{*this};
+                alive = _push.poll(handler);
+            } else {
+                _push.close();
+            }
+            uint32_t heartbeats = _push.takeHeartbeats();
+            uint32_t dropped = _push.takeDropped();
+            uint32_t upMs = alive ? 0 : now - _push.upSinceMs();
+            bool stalled = !alive && _push.stalled();
+            updatePushStats([=](PushStats& s) {
+                s.heartbeats += heartbeats;
+                s.dropped += dropped;
+                if (!alive) {
+                    s.up = false;
+                    s.drops++;
+                    if (stalled) s.stalls++;
+                    s.upMs += upMs;
+                }
+            });
+            if (alive) return false;
+
+            _pushBackoff.setHint(_push.retryHintMs());
+            _pushRetryAtMs = now + _pushBackoff.afterDrop(upMs);
+            LOG_INFO("[PUSH] Link %s after %lu s, polling /health\n",
+                     stalled ? "stalled" : "closed", (unsigned long)(upMs / 1000));
+            return true;
+        }
+
+        if (!_connState.hasWiFi() || (int32_t)(now - _pushRetryAtMs) < 0) return false;
+
+        switch (_push.open(_config.orchestratorURL, _config.deviceID)) {
+            case PushChannel::OpenResult::Up:
+                updatePushStats([](PushStats& s) {
+                    s.connects++;
+                    s.up = true;
+                });
+                LOG_INFO("[PUSH] Event stream open, /health polling paused\n");
+                if (_connState.get() != models::ORCH_CONNECTED) {
+                    _connState.set(models::ORCH_CONNECTED);
+                }
+                return true;
+            case PushChannel::OpenResult::Unsupported:
+                updatePushStats([](PushStats& s) { s.unsupported++; });
+                _pushRetryAtMs = millis() + _pushBackoff.afterUnsupported();
+                LOG_DEBUG("[PUSH] Orchestrator has no event stream, polling\n");
+                return false;
+            default:
+                updatePushStats([](PushStats& s) { s.failures++; });
+                _pushRetryAtMs = millis() + _pushBackoff.afterFailure();
+                return false;
+        }
+    }
+
     /**
      * @brief Background task loop (runs on Core 0)
      *
      * Implementation from v4.1 lines 2447-2496
-     * Checks orchestrator health every 10 seconds, uploads queue if connected
+     * Checks orchestrator health every 10 seconds, uploads queue if connected.
+     * While the push channel is up the health GET is skipped (the link itself
+     * is the health signal) and the queue check stays on the same cadence;
+     * the link opening or dropping triggers a check at once. Re-syncs the
+     * orchestrator pushed run here too, ahead of the queue upload.
+     * Every iteration (100 ms) also drains the scan journal when it is due.
      */
     void backgroundTaskLoop() {
         LOG_INFO("[ORCH-BG-TASK] Background task started on Core 0\n");
 
         unsigned long lastCheck = 0;
+        bool checkNow = false;
         const unsigned long checkInterval = timing::ORCHESTRATOR_CHECK_INTERVAL_MS;
 
         while (true) {
@@ -1279,8 +2461,16 @@ private:
                          stackRemaining);
             }
 
-            if (now - lastCheck > checkInterval) {
+            // Write-behind: persist journaled scans once any flush trigger fires
+            if (_journal.flushDue(now, ESP.getFreeHeap())) {
+                flushJournal();
+            }
+
+            if (servicePushChannel(now)) checkNow = true;
+
+            if (checkNow || now - lastCheck > checkInterval) {
                 lastCheck = now;
+                checkNow = false;
 
                 // Log stack health every 10 seconds
                 LOG_DEBUG("[ORCH-BG-TASK] Stack high water mark: %d bytes free\n",
@@ -1289,13 +2479,21 @@ private:
                 models::ConnectionState state = _connState.get();
 
                 if (state == models::ORCH_WIFI_CONNECTED || state == models::ORCH_CONNECTED) {
-                    // Check orchestrator health
-                    if (checkHealth(_config)) {
+                    // Check orchestrator health (the open push link vouches for it)
+                    bool healthy = _push.up();
+                    if (!healthy) {
+                        if (_config.pushChannel) updatePushStats([](PushStats& s) { s.polls++; });
+                        healthy = checkHealth(_config);
+                    }
+                    if (healthy) {
                         if (state != models::ORCH_CONNECTED) {
                             LOG_INFO("[ORCH-BG-TASK] Orchestrator now reachable\n");
                             _connState.set(models::ORCH_CONNECTED);
                         }
 
+                        // Re-syncs pushed by the orchestrator (token DB, assets)
+                        runRemoteRefresh(now);
+
                         // Upload queue if not empty
                         int queueSize = getQueueSize();
                         if (queueSize > 0) {
@@ -1365,6 +2563,9 @@ private:
         auto& instance = getInstance();
         instance._connState.set(models::ORCH_DISCONNECTED);
 
+        // The keep-alive socket died with the link
+        instance._http.requestReset();
+
         // WiFi will auto-reconnect, don't call WiFi.reconnect() here to avoid storm
     }
 };
@@ -1381,29 +2582,39 @@ private:
  *    - This is the SINGLE BIGGEST flash optimization in v5.0 refactor
  *
  * 2. WIFI CLIENT SECURE FIX (HEAP CORRUPTION PREVENTION)
- *    - CRITICAL: WiFiClientSecure created LOCALLY per request (not member variable)
+ *    - CRITICAL: a WiFiClientSecure is never handshaken twice
  *    - Prevents heap corruption from reusing SSL context across failed connections
  *    - Known ESP32 library bugs: GitHub issues #3808, #6257, #9636
  *    - Each failed HTTPS connection leaks ~4KB if WiFiClientSecure is reused
- *    - Local instance ensures clean SSL state for each request
- *    - Auto-cleanup on scope exit prevents buffer overflow into heap metadata
+ *    - Keep-alive reuses an OPEN session only; every new handshake (first
+ *      request, after an error, idle timeout, WiFi loss, origin change) gets
+ *      freshly heap-allocated HTTPClient + WiFiClientSecure, deleted on close
+ *    - Leak guard: idle free heap with the connection open must stay near its
+ *      post-handshake level; repeated drift disables keep-alive until reboot
+ *      and every request falls back to a one-shot connection
+ *    - TLS session tickets/IDs are not exposed by WiFiClientSecure, so the
+ *      saving comes from keep-alive rather than abbreviated handshakes
  *
  * 3. THREAD-SAFE QUEUE OPERATIONS
  *    - Queue size cache uses portENTER_CRITICAL/EXIT_CRITICAL (spinlock)
  *    - SD card operations use hal::SDCard::Lock (RAII mutex)
  *    - Background task (Core 0) and main loop (Core 1) both access queue
- *    - Stream-based queue removal prevents RAM spikes (100-entry queue: 100 bytes vs 10KB)
+ *    - Queue lives in a preallocated ring (QueueRing.h): removing an uploaded
+ *      batch is one header write, never a rewrite, and reads stream one
+ *      record at a time, so RAM use does not grow with queue length
  *
  * 4. WIFI EVENT-DRIVEN STATE MANAGEMENT
  *    - WiFi events update connection state automatically
  *    - Background task checks orchestrator health every 10 seconds
+ *      (skipped while the push channel is up; its open/drop forces a check)
  *    - State transitions: DISCONNECTED → WIFI_CONNECTED → CONNECTED
  *    - Auto-reconnect handled by WiFi library, no manual intervention needed
  *
  * 5. QUEUE OVERFLOW PROTECTION
- *    - MAX_QUEUE_SIZE (100 entries) enforced before queueScan()
- *    - FIFO removal of oldest entry when full
- *    - Prevents SD card filling up with stale scans
+ *    - MAX_QUEUE_SIZE (100 entries) and QUEUE_RING_CAPACITY bytes bound the ring
+ *    - Drop-oldest happens inside QueueRing::writeRecord while appending,
+ *      folded into that append's header commit; drops are counted
+ *    - The ring file never grows, so stale scans cannot fill the SD card
  *
  * 6. BACKGROUND TASK STACK MONITORING
  *    - 16KB stack size (BACKGROUND_TASK_STACK_SIZE)
@@ -9,12 +9,33 @@
  *
  * These functions have NO I/O dependencies — only ArduinoJson + model types.
  * Tested in test/test_payload/ with real ArduinoJson on native platform.
+ *
+ * The batch body also comes in pieces (batchHead / batchEntry / batchTail,
+ * pulled through BatchBodyReader) so the queue drain can stream it to the
+ * socket scan by scan instead of holding it in RAM.
+ *
+ * MessagePack is the binary alternative to JSON, used once /health lists
+ * "msgpack" in scanEncodings (negotiateEncoding):
+ *
+ *   /api/scan        {tokenId, teamId?, deviceId, deviceType, timestamp}
+ *   /api/scan/batch  {batchId, deviceId, deviceType,
+ *                     transactions: [[tokenId, teamId|nil, timestamp
+ *                                     (, deviceId, deviceType)], ...]}
+ *
+ * timestamp is UTC epoch milliseconds (uint), or the original string when
+ * it does not parse. A batch names its device once; a transaction from a
+ * different deviceId (renamed mid-queue) carries its own as elements 4-5.
+ * Written directly rather than through a JsonDocument: the batch has to
+ * come out piecewise, and both passes must produce identical bytes.
  */
 
 #include <Arduino.h>
 #include <ArduinoJson.h>
+#include <string.h>
+#include <string>
 #include <vector>
 #include "../models/Token.h"
+#include "ScanRecord.h"
 
 namespace services {
 
@@ -86,4 +107,355 @@ inline String buildBatchJson(const String& batchId,
     return String(buf.c_str());
 }
 
+// ─── Streamed batch body ──────────────────────────────────────────────
+
+/**
+ * Append s to out as a JSON string literal. Quotes, backslashes and the
+ * short escapes match ArduinoJson; other control characters become \u00XX.
+ */
+inline void appendJsonString(String& out, const String& s) {
+    static const char HEX_DIGITS[] = "0123456789abcdef";
+    out += '"';
+    for (unsigned int i = 0; i < s.length(); i++) {
+        const char c = s.charAt(i);
+        switch (c) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\b': out += "\\b"; break;
+            case '\f': out += "\\f"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if ((uint8_t)c < 0x20) {
+                    out += "\\u00";
+                    out += HEX_DIGITS[(uint8_t)c >> 4];
+                    out += HEX_DIGITS[c & 0x0F];
+                } else {
+                    out += c;
+                }
+        }
+    }
+    out += '"';
+}
+
+/** Opening of the batch body, up to the first transaction. */
+inline String batchJsonHead(const String& batchId) {
+    String out = "{\"batchId\":";
+    appendJsonString(out, batchId);
+    out += ",\"transactions\":[";
+    return out;
+}
+
+/** One transaction as buildBatchJson writes it, comma-led unless first. */
+inline String batchJsonEntry(const models::ScanData& scan, bool first) {
+    String out = first ? "{\"tokenId\":" : ",{\"tokenId\":";
+    appendJsonString(out, scan.tokenId);
+    if (scan.teamId.length() > 0) {
+        out += ",\"teamId\":";
+        appendJsonString(out, scan.teamId);
+    }
+    out += ",\"deviceId\":";
+    appendJsonString(out, scan.deviceId);
+    out += ",\"deviceType\":";
+    appendJsonString(out, scan.deviceType);
+    out += ",\"timestamp\":";
+    appendJsonString(out, scan.timestamp);
+    out += '}';
+    return out;
+}
+
+constexpr const char* BATCH_JSON_TAIL = "]}";
+
+// ─── MessagePack ──────────────────────────────────────────────────────
+
+enum class PayloadEncoding : uint8_t { Json, MsgPack };
+
+inline const char* contentTypeFor(PayloadEncoding encoding) {
+    return encoding == PayloadEncoding::MsgPack ? "application/msgpack" : "application/json";
+}
+
+inline const char* encodingName(PayloadEncoding encoding) {
+    return encoding == PayloadEncoding::MsgPack ? "msgpack" : "json";
+}
+
+/**
+ * Pick the upload encoding from the scanEncodings array of /health.
+ * JSON unless the server lists "msgpack"; a missing or malformed field
+ * means an older server.
+ */
+inline PayloadEncoding negotiateEncoding(JsonVariantConst advertised) {
+    if (!advertised.is<JsonArrayConst>()) return PayloadEncoding::Json;
+    for (JsonVariantConst name : advertised.as<JsonArrayConst>()) {
+        const char* s = name.as<const char*>();
+        if (s && strcmp(s, "msgpack") == 0) return PayloadEncoding::MsgPack;
+    }
+    return PayloadEncoding::Json;
+}
+
+namespace msgpack {
+
+inline void putNil(std::string& out) { out += '\xc0'; }
+
+inline void putBigEndian(std::string& out, uint64_t v, uint8_t bytes) {
+    while (bytes-- > 0) out += static_cast<char>((v >> (8 * bytes)) & 0xFF);
+}
+
+// Smallest unsigned form: positive fixint, uint8/16/32/64
+inline void putUint(std::string& out, uint64_t v) {
+    if (v < 0x80) {
+        out += static_cast<char>(v);
+    } else if (v <= 0xFF) {
+        out += '\xcc';
+        putBigEndian(out, v, 1);
+    } else if (v <= 0xFFFF) {
+        out += '\xcd';
+        putBigEndian(out, v, 2);
+    } else if (v <= 0xFFFFFFFFull) {
+        out += '\xce';
+        putBigEndian(out, v, 4);
+    } else {
+        out += '\xcf';
+        putBigEndian(out, v, 8);
+    }
+}
+
+// fixstr / str8 / str16; scan fields are far below str16's 64 KB
+inline void putStr(std::string& out, const char* s, size_t len) {
+    if (len < 32) {
+        out += static_cast<char>(0xA0 | len);
+    } else if (len <= 0xFF) {
+        out += '\xd9';
+        putBigEndian(out, len, 1);
+    } else {
+        out += '\xda';
+        putBigEndian(out, len, 2);
+    }
+    out.append(s, len);
+}
+
+inline void putStr(std::string& out, const String& s) { putStr(out, s.c_str(), s.length()); }
+inline void putStr(std::string& out, const char* s) { putStr(out, s, strlen(s)); }
+
+inline void putHeader(std::string& out, uint32_t n, uint8_t fix, char tag16) {
+    if (n < 16) {
+        out += static_cast<char>(fix | n);
+    } else if (n <= 0xFFFF) {
+        out += tag16;
+        putBigEndian(out, n, 2);
+    } else {
+        out += static_cast<char>(tag16 + 1);  // array32 / map32
+        putBigEndian(out, n, 4);
+    }
+}
+
+inline void putArrayHeader(std::string& out, uint32_t n) { putHeader(out, n, 0x90, '\xdc'); }
+inline void putMapHeader(std::string& out, uint32_t n) { putHeader(out, n, 0x80, '\xde'); }
+
+// Epoch milliseconds when the timestamp parses, else the string as-is
+inline void putTimestamp(std::string& out, const String& ts) {
+    uint64_t ms;
+    if (epochMsFromTimestamp(ts, ms)) {
+        putUint(out, ms);
+    } else {
+        putStr(out, ts);
+    }
+}
+
+} // namespace msgpack
+
+/**
+ * MessagePack body for POST /api/scan (application/msgpack).
+ * Same fields as buildScanJson, timestamp as epoch milliseconds.
+ */
+inline std::string buildScanMsgPack(const models::ScanData& scan) {
+    const bool hasTeam = scan.teamId.length() > 0;
+    std::string out;
+    msgpack::putMapHeader(out, hasTeam ? 5 : 4);
+    msgpack::putStr(out, "tokenId");
+    msgpack::putStr(out, scan.tokenId);
+    if (hasTeam) {
+        msgpack::putStr(out, "teamId");
+        msgpack::putStr(out, scan.teamId);
+    }
+    msgpack::putStr(out, "deviceId");
+    msgpack::putStr(out, scan.deviceId);
+    msgpack::putStr(out, "deviceType");
+    msgpack::putStr(out, scan.deviceType);
+    msgpack::putStr(out, "timestamp");
+    msgpack::putTimestamp(out, scan.timestamp);
+    return out;
+}
+
+// ─── Batch body pieces ────────────────────────────────────────────────
+
+/**
+ * What a batch body says once, ahead of its transactions. deviceId and
+ * deviceType come from the first scan and scans counts the transactions
+ * (MessagePack only; JSON ignores them).
+ */
+struct BatchHeader {
+    String batchId;
+    PayloadEncoding encoding = PayloadEncoding::Json;
+    String deviceId;
+    String deviceType;
+    uint32_t scans = 0;
+};
+
+inline std::string batchHead(const BatchHeader& h) {
+    if (h.encoding == PayloadEncoding::Json) {
+        String head = batchJsonHead(h.batchId);
+        return std::string(head.c_str(), head.length());
+    }
+    std::string out;
+    msgpack::putMapHeader(out, 4);
+    msgpack::putStr(out, "batchId");
+    msgpack::putStr(out, h.batchId);
+    msgpack::putStr(out, "deviceId");
+    msgpack::putStr(out, h.deviceId);
+    msgpack::putStr(out, "deviceType");
+    msgpack::putStr(out, h.deviceType);
+    msgpack::putStr(out, "transactions");
+    msgpack::putArrayHeader(out, h.scans);
+    return out;
+}
+
+inline std::string batchEntry(const BatchHeader& h, const models::ScanData& scan, bool first) {
+    if (h.encoding == PayloadEncoding::Json) {
+        String entry = batchJsonEntry(scan, first);
+        return std::string(entry.c_str(), entry.length());
+    }
+    const bool ownDevice = scan.deviceId != h.deviceId || scan.deviceType != h.deviceType;
+    std::string out;
+    msgpack::putArrayHeader(out, ownDevice ? 5 : 3);
+    msgpack::putStr(out, scan.tokenId);
+    if (scan.teamId.length() > 0) {
+        msgpack::putStr(out, scan.teamId);
+    } else {
+        msgpack::putNil(out);
+    }
+    msgpack::putTimestamp(out, scan.timestamp);
+    if (ownDevice) {
+        msgpack::putStr(out, scan.deviceId);
+        msgpack::putStr(out, scan.deviceType);
+    }
+    return out;
+}
+
+// Nothing follows the last MessagePack transaction: the header counted them
+inline std::string batchTail(const BatchHeader& h) {
+    return h.encoding == PayloadEncoding::Json ? std::string(BATCH_JSON_TAIL) : std::string();
+}
+
+/**
+ * Serves a batch body a few bytes at a time, building one transaction per
+ * scan pulled from the source, without ever holding more than one of
+ * them. In JSON the bytes are those of buildBatchJson() for the same scans.
+ *
+ * Source provides int next(models::ScanData&) (1 = a scan, 0 = no more,
+ * -1 = failed) and void rewind(). length is the Content-Length sent ahead
+ * of the body (batchHead + every batchEntry + batchTail, measured with
+ * the same header). If the source fails or its scans do not add up to
+ * length, read() stops short of it and failed() is set: the server never
+ * gets a complete body holding different scans than the ones measured.
+ */
+template <typename Source>
+class BatchBodyReader {
+public:
+    BatchBodyReader(const BatchHeader& header, size_t length, Source& source)
+        : _header(header), _length(length), _source(source) {}
+
+    size_t length() const { return _length; }
+    size_t remaining() const { return _length - _sent; }
+    bool failed() const { return _failed; }
+    bool done() const { return _stage == Stage::Done && _pos == _piece.length(); }
+
+    // Start over (a resend on a fresh connection); rewinds the source too
+    void rewind() {
+        _source.rewind();
+        _stage = Stage::Head;
+        _piece.clear();
+        _pos = 0;
+        _built = 0;
+        _sent = 0;
+        _entries = 0;
+        _failed = false;
+    }
+
+    /** @return bytes copied; short of len only at the end or on failure */
+    size_t read(uint8_t* buf, size_t len) {
+        size_t n = 0;
+        while (n < len && !_failed) {
+            if (_pos == _piece.length()) {
+                if (!nextPiece()) break;
+                continue;
+            }
+            size_t take = _piece.length() - _pos;
+            if (take > len - n) take = len - n;
+            memcpy(buf + n, _piece.data() + _pos, take);
+            _pos += take;
+            n += take;
+        }
+        _sent += n;
+        return n;
+    }
+
+    /** @return the next byte without consuming it, -1 at the end or on failure */
+    int peek() {
+        if (_pos == _piece.length() && !_failed) nextPiece();
+        return _pos < _piece.length() ? (uint8_t)_piece[_pos] : -1;
+    }
+
+private:
+    enum class Stage : uint8_t { Head, Entries, Done };
+
+    bool nextPiece() {
+        _pos = 0;
+        switch (_stage) {
+            case Stage::Head:
+                _piece = batchHead(_header);
+                _stage = Stage::Entries;
+                break;
+            case Stage::Entries: {
+                models::ScanData scan;
+                int got = _source.next(scan);
+                if (got < 0) return fail();
+                if (got > 0) {
+                    _piece = batchEntry(_header, scan, _entries++ == 0);
+                } else {
+                    _piece = batchTail(_header);
+                    _stage = Stage::Done;
+                }
+                break;
+            }
+            case Stage::Done:
+                _piece.clear();
+                return false;
+        }
+        _built += _piece.length();
+        // Checked before a byte of the piece goes out; the tail only
+        // follows when everything before it matched
+        if (_built > _length || (_stage == Stage::Done && _built != _length)) return fail();
+        return true;
+    }
+
+    bool fail() {
+        _failed = true;
+        _piece.clear();
+        _pos = 0;
+        return false;
+    }
+
+    BatchHeader _header;
+    size_t _length;
+    Source& _source;
+    Stage _stage = Stage::Head;
+    std::string _piece;        // Current head/entry/tail (binary-safe)
+    size_t _pos = 0;           // Served from _piece
+    size_t _built = 0;         // Bytes of every piece built so far
+    size_t _sent = 0;
+    uint32_t _entries = 0;
+    bool _failed = false;
+};
+
 } // namespace services
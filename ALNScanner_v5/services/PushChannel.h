@@ -0,0 +1,168 @@
+#pragma once
+
+/**
+ * @file PushChannel.h
+ * @brief Long-lived event stream from the orchestrator (server-sent events).
+ *
+ * One GET of http_config::PUSH_EVENTS_PATH held open by the OrchestratorSync
+ * task. open() connects and checks the response head; poll() then reads
+ * whatever has arrived without blocking and hands complete events to a
+ * handler (see PushEvents.h for the events). The request is HTTP/1.0, so
+ * the stream comes unchunked and simply ends when the server closes.
+ *
+ * A link that closes is noticed on the next poll (100 ms task period);
+ * one that goes silent is declared dead after PUSH_STALL_TIMEOUT_MS.
+ *
+ * OrchestratorSync task only.
+ */
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <WiFiClientSecure.h>
+#include <memory>
+#include "../config.h"
+#include "AssetStream.h"
+#include "PushEvents.h"
+
+namespace services {
+
+class PushChannel {
+public:
+    enum class OpenResult : uint8_t { Up, Failed, Unsupported };
+
+    PushChannel() = default;
+    ~PushChannel() { close(); }
+
+    PushChannel(const PushChannel&) = delete;
+    PushChannel& operator=(const PushChannel&) = delete;
+
+    OpenResult open(const String& baseUrl, const String& deviceId) {
+        close();
+        HttpTarget target;
+        if (!parseHttpTarget(baseUrl, target)) return OpenResult::Failed;
+        if (ESP.getFreeHeap() < http_config::PUSH_MIN_FREE_HEAP) {
+            LOG_DEBUG("[PUSH] Low heap %u, not connecting\n", ESP.getFreeHeap());
+            return OpenResult::Failed;
+        }
+
+        // The timeout overloads aren't virtual: call them on the real type
+        bool connected;
+        if (target.secure) {
+            auto* secure = new WiFiClientSecure();
+            secure->setInsecure();  // Same policy as HTTPHelper
+            _socket.reset(secure);
+            connected = secure->connect(target.host.c_str(), target.port,
+                                        (int32_t)http_config::PUSH_CONNECT_TIMEOUT_MS);
+        } else {
+            _socket.reset(new WiFiClient());
+            connected = _socket->connect(target.host.c_str(), target.port,
+                                         (int32_t)http_config::PUSH_CONNECT_TIMEOUT_MS);
+        }
+        if (!connected) {
+            _socket.reset();
+            return OpenResult::Failed;
+        }
+
+        String path = String(http_config::PUSH_EVENTS_PATH) + "?deviceId=" + deviceId;
+        String head = httpRequestHead("GET", target, path, false, nullptr, 0,
+                                      "Accept: text/event-stream\r\n");
+        size_t n = _socket->write(reinterpret_cast<const uint8_t*>(head.c_str()),
+                                  head.length());
+        HttpResponseHead resp;
+        if (n != head.length() || !readHead(resp)) {
+            close();
+            return OpenResult::Failed;
+        }
+        if (resp.status != 200 || resp.chunked) {
+            LOG_DEBUG("[PUSH] HTTP %d from %s\n", resp.status, path.c_str());
+            close();
+            return resp.status == 404 ? OpenResult::Unsupported : OpenResult::Failed;
+        }
+
+        _parser = SseParser();
+        _upSinceMs = _lastByteMs = millis();
+        _stalled = false;
+        _comments = 0;
+        _dropped = 0;
+        return OpenResult::Up;
+    }
+
+    /**
+     * @brief Pass everything received so far to handler.onEvent(name, data)
+     * @return false once the link is gone (closed or stalled); it is closed
+     */
+    template <typename Handler>
+    bool poll(Handler& handler) {
+        if (!_socket) return false;
+        uint8_t buf[256];
+        int avail;
+        while ((avail = _socket->available()) > 0) {
+            int n = _socket->read(buf, (size_t)avail < sizeof(buf) ? (size_t)avail : sizeof(buf));
+            if (n <= 0) break;
+            _lastByteMs = millis();
+            _parser.feed(buf, static_cast<size_t>(n), handler);
+        }
+        if (!_socket->connected()) {
+            close();
+            return false;
+        }
+        if (millis() - _lastByteMs > http_config::PUSH_STALL_TIMEOUT_MS) {
+            _stalled = true;
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void close() {
+        if (!_socket) return;
+        _socket->stop();
+        _socket.reset();
+    }
+
+    bool up() const { return _socket != nullptr; }
+    bool stalled() const { return _stalled; }
+    uint32_t upSinceMs() const { return _upSinceMs; }
+    uint32_t retryHintMs() const { return _parser.retryMs(); }
+
+    // Heartbeats and oversized events since the last call
+    uint32_t takeHeartbeats() { return take(_parser.comments(), _comments); }
+    uint32_t takeDropped() { return take(_parser.dropped(), _dropped); }
+
+private:
+    static uint32_t take(uint32_t total, uint32_t& seen) {
+        uint32_t delta = total - seen;
+        seen = total;
+        return delta;
+    }
+
+    // Byte at a time, so the first events stay in the socket for poll()
+    bool readHead(HttpResponseHead& head) {
+        uint32_t start = millis();
+        while (!head.done()) {
+            if (head.failed()) return false;
+            int c = _socket->available() > 0 ? _socket->read() : -1;
+            if (c < 0) {
+                if (!_socket->connected() ||
+                    millis() - start > http_config::PUSH_CONNECT_TIMEOUT_MS) {
+                    return false;
+                }
+                delay(2);
+                continue;
+            }
+            uint8_t b = static_cast<uint8_t>(c);
+            head.feed(&b, 1);
+        }
+        return true;
+    }
+
+    std::unique_ptr<WiFiClient> _socket;
+    SseParser _parser;
+    uint32_t _upSinceMs = 0;
+    uint32_t _lastByteMs = 0;
+    bool _stalled = false;
+    uint32_t _comments = 0;  // Parser totals already taken
+    uint32_t _dropped = 0;
+};
+
+} // namespace services
@@ -0,0 +1,241 @@
+#pragma once
+
+/**
+ * @file PushEvents.h
+ * @brief Wire format of the orchestrator push channel (services/PushChannel.h):
+ *        server-sent event parsing, event and session names, reconnect
+ *        backoff and counters.
+ *
+ * The channel is one long-lived GET of http_config::PUSH_EVENTS_PATH
+ * answered with text/event-stream:
+ *
+ *   event: health     data: same JSON as GET /health (timezone included)
+ *   event: timezone   data: {"timezone":"PST8PDT,M3.2.0,M11.1.0"}
+ *   event: session    data: {"status":"active"|"paused"|"ended"|null}
+ *   event: tokens     data: anything - token database changed
+ *   event: assets     data: anything - asset manifest changed
+ *   ": ..."           comment, sent as a heartbeat at least every 5 s
+ *
+ * SSE rather than WebSocket: it is plain HTTP, so it rides the same raw
+ * socket code as the asset sync and needs no framing or masking. Kept
+ * free of WiFi so the native tests can feed it byte by byte.
+ */
+
+#include <Arduino.h>
+#include <cstdlib>
+#include <cstring>
+#include "../config.h"
+
+namespace services {
+
+// ─── Names ────────────────────────────────────────────────────────────
+
+enum class PushEvent : uint8_t { Unknown, Health, Timezone, Session, Tokens, Assets };
+
+inline PushEvent parsePushEvent(const char* name) {
+    if (strcmp(name, "health") == 0) return PushEvent::Health;
+    if (strcmp(name, "timezone") == 0) return PushEvent::Timezone;
+    if (strcmp(name, "session") == 0) return PushEvent::Session;
+    if (strcmp(name, "tokens") == 0) return PushEvent::Tokens;
+    if (strcmp(name, "assets") == 0) return PushEvent::Assets;
+    return PushEvent::Unknown;
+}
+
+// Game session as last pushed by the orchestrator
+enum class SessionState : uint8_t { Unknown, None, Active, Paused, Ended };
+
+// nullptr or "" means no session; unrecognised values stay Unknown
+inline SessionState parseSessionState(const char* status) {
+    if (!status || !*status || strcmp(status, "none") == 0) return SessionState::None;
+    if (strcmp(status, "active") == 0) return SessionState::Active;
+    if (strcmp(status, "paused") == 0) return SessionState::Paused;
+    if (strcmp(status, "ended") == 0) return SessionState::Ended;
+    return SessionState::Unknown;
+}
+
+inline const char* sessionStateName(SessionState state) {
+    switch (state) {
+        case SessionState::None:    return "NONE";
+        case SessionState::Active:  return "ACTIVE";
+        case SessionState::Paused:  return "PAUSED";
+        case SessionState::Ended:   return "ENDED";
+        default:                    return "UNKNOWN";
+    }
+}
+
+// ─── Event stream ─────────────────────────────────────────────────────
+
+/**
+ * Incremental text/event-stream parser. feed() takes the body in any
+ * slicing and calls handler.onEvent(const char* name, const char* data)
+ * for each complete event ("message" when unnamed). Lines end in LF, CR
+ * or CRLF; multi-line data is joined with '\n'. An event longer than
+ * PUSH_MAX_EVENT_BYTES is dropped whole rather than delivered cut.
+ */
+class SseParser {
+public:
+    template <typename Handler>
+    void feed(const uint8_t* data, size_t len, Handler& handler) {
+        for (size_t i = 0; i < len; i++) {
+            char c = static_cast<char>(data[i]);
+            if (c == '\n' && _afterCR) {
+                _afterCR = false;
+                continue;
+            }
+            _afterCR = c == '\r';
+            if (c != '\r' && c != '\n') {
+                if (_lineLen < sizeof(_line) - 1) _line[_lineLen++] = c;
+                else _lineCut = true;
+                continue;
+            }
+            _line[_lineLen] = '\0';
+            endLine(handler);
+            _lineLen = 0;
+        }
+    }
+
+    uint32_t comments() const { return _comments; }
+    uint32_t dropped() const { return _dropped; }
+    // Server's "retry:" reconnect delay, 0 if never sent
+    uint32_t retryMs() const { return _retryMs; }
+
+private:
+    static constexpr size_t MAX = http_config::PUSH_MAX_EVENT_BYTES;
+
+    template <typename Handler>
+    void endLine(Handler& handler) {
+        bool cut = _lineCut;
+        _lineCut = false;
+        if (_lineLen == 0) {
+            dispatch(handler);
+            return;
+        }
+        if (_line[0] == ':') {
+            _comments++;
+            return;
+        }
+        if (cut) _overflow = true;  // A truncated field spoils its event
+        char* value = strchr(_line, ':');
+        if (value) {
+            *value++ = '\0';
+            if (*value == ' ') value++;
+        } else {
+            value = _line + _lineLen;  // Field with empty value
+        }
+
+        if (strcmp(_line, "data") == 0) {
+            size_t n = strlen(value);
+            size_t need = n + (_hasData ? 1 : 0);
+            if (_dataLen + need >= MAX) {
+                _overflow = true;
+                return;
+            }
+            if (_hasData) _data[_dataLen++] = '\n';
+            memcpy(_data + _dataLen, value, n);
+            _dataLen += n;
+            _data[_dataLen] = '\0';
+            _hasData = true;
+        } else if (strcmp(_line, "event") == 0) {
+            strncpy(_name, value, sizeof(_name) - 1);
+            _name[sizeof(_name) - 1] = '\0';
+        } else if (strcmp(_line, "retry") == 0) {
+            char* end;
+            unsigned long ms = strtoul(value, &end, 10);
+            if (end != value && *end == '\0') _retryMs = static_cast<uint32_t>(ms);
+        }
+        // "id" and unknown fields: not used
+    }
+
+    template <typename Handler>
+    void dispatch(Handler& handler) {
+        if (_overflow) _dropped++;
+        else if (_hasData) handler.onEvent(_name[0] ? _name : "message", _data);
+        _name[0] = '\0';
+        _data[0] = '\0';
+        _dataLen = 0;
+        _hasData = false;
+        _overflow = false;
+    }
+
+    char _line[MAX];
+    size_t _lineLen = 0;
+    bool _lineCut = false;
+    char _name[24] = "";
+    char _data[MAX] = "";
+    size_t _dataLen = 0;
+    bool _hasData = false;
+    bool _overflow = false;
+    bool _afterCR = false;
+    uint32_t _comments = 0;
+    uint32_t _dropped = 0;
+    uint32_t _retryMs = 0;
+};
+
+// ─── Reconnect ────────────────────────────────────────────────────────
+
+/**
+ * Delay before the next connect attempt. Failures double it from the
+ * base (the server's retry: hint, else PUSH_RETRY_MIN_MS) up to
+ * PUSH_RETRY_MAX_MS; a link that stayed up PUSH_STABLE_MS starts over.
+ * An orchestrator without the route is asked again only rarely, so old
+ * servers simply see the /health polling they always did.
+ */
+class PushBackoff {
+public:
+    void setHint(uint32_t ms) {
+        if (ms == 0) return;
+        _base = ms < http_config::PUSH_RETRY_MIN_MS ? http_config::PUSH_RETRY_MIN_MS
+              : ms > http_config::PUSH_RETRY_MAX_MS ? http_config::PUSH_RETRY_MAX_MS : ms;
+    }
+
+    uint32_t afterFailure() {
+        _delay = _delay == 0 ? _base : _delay * 2;
+        if (_delay > http_config::PUSH_RETRY_MAX_MS) _delay = http_config::PUSH_RETRY_MAX_MS;
+        return _delay;
+    }
+
+    // The link was up for upMs before it closed
+    uint32_t afterDrop(uint32_t upMs) {
+        if (upMs >= http_config::PUSH_STABLE_MS) _delay = 0;
+        return afterFailure();
+    }
+
+    uint32_t afterUnsupported() {
+        _delay = 0;
+        return http_config::PUSH_UNSUPPORTED_RETRY_MS;
+    }
+
+private:
+    uint32_t _base = http_config::PUSH_RETRY_MIN_MS;
+    uint32_t _delay = 0;
+};
+
+// ─── Counters ─────────────────────────────────────────────────────────
+
+struct PushStats {
+    uint32_t connects = 0;     // Links that reached the event stream
+    uint32_t failures = 0;     // Connect or request failed, non-200
+    uint32_t unsupported = 0;  // 404: orchestrator has no push route
+    uint32_t drops = 0;        // Links lost (closed or stalled)
+    uint32_t stalls = 0;       // Of drops, silent past PUSH_STALL_TIMEOUT_MS
+    uint32_t events = 0;
+    uint32_t heartbeats = 0;
+    uint32_t dropped = 0;      // Oversized events
+    uint32_t polls = 0;        // /health requests made while the link was down
+    uint32_t upMs = 0;         // Total time up, closed links only
+    bool up = false;
+
+    void print() const {
+        Serial.printf("PUSH CHANNEL: %s; %lu connects, %lu failures, %lu unsupported, "
+                      "%lu drops (%lu stalled)\n", up ? "UP" : "DOWN",
+                      (unsigned long)connects, (unsigned long)failures,
+                      (unsigned long)unsupported, (unsigned long)drops,
+                      (unsigned long)stalls);
+        Serial.printf("  %lu events, %lu heartbeats, %lu oversized; %.0f s up; "
+                      "%lu health polls while down\n", (unsigned long)events,
+                      (unsigned long)heartbeats, (unsigned long)dropped,
+                      upMs / 1000.0f, (unsigned long)polls);
+    }
+};
+
+} // namespace services
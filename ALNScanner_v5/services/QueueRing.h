@@ -0,0 +1,670 @@
+#pragma once
+
+/**
+ * @file QueueRing.h
+ * @brief Fixed-capacity on-SD ring log backing the offline scan queue.
+ *
+ * Replaces the append-only /queue.jsonl, whose FIFO removal streamed the
+ * whole file through /queue.tmp after every uploaded batch (and on every
+ * enqueue once the queue was full). Every operation here is O(1) in the
+ * number of queued entries:
+ *
+ *   enqueue      one record write into free space + one header write
+ *   dequeue-N    one header write (using the cursor returned by peek())
+ *   drop-oldest  one head-record read, folded into the enqueue header write
+ *
+ * File layout (preallocated once, never grows or shrinks):
+ *
+ *   [0..31]    header slot A  - commits alternate between the two slots;
+ *   [32..63]   header slot B    the valid one with the higher sequence wins
+ *   [64..]     data region, `capacity` bytes, records wrap at the end
+ *
+ * Record framing (VERSION 2):
+ *
+ *   u8 0xA5 sync | u16 LE payload length | u32 LE CRC32(length + payload) | payload
+ *
+ * A record that fails its CRC is skipped by scanning forward for the next
+ * sync byte that starts a valid record, so damage costs only the records it
+ * touched. VERSION 1 rings (u16 length + payload, no CRC) are still readable
+ * so OrchestratorService can migrate them; appends require VERSION 2.
+ *
+ * Power loss: record bytes land in free space and are flushed before the
+ * header that makes them visible, and a torn header write leaves the other
+ * slot (the previous state) intact. Worst case is losing the single scan
+ * whose header commit was interrupted.
+ *
+ * Boot: the header is the checkpoint (head, used bytes, count, newest record
+ * length, CRC). open() checks it against the data in O(1) by validating the
+ * oldest and newest records; only on a mismatch does it walk head..tail with
+ * the block-wise sync scan and commit a corrected header (Recovered).
+ *
+ * Not thread-safe: callers hold hal::SDCard::Lock around every call.
+ */
+
+#include <Arduino.h>
+#include <SD.h>
+#include "../config.h"
+#include "Crc32.h"
+
+namespace services {
+
+/**
+ * Records returned by one peek(); hand it back to consume() once they have
+ * been delivered. Stays valid if drop-oldest removed some of them meanwhile.
+ */
+struct QueueRingCursor {
+    uint32_t firstIndex = 0;  // Dequeue index of the first record covered
+    uint32_t count = 0;       // Records covered
+    uint32_t bytes = 0;       // Ring bytes covered (framing and skipped damage included)
+    uint32_t endOffset = 0;   // Data offset just past the last record
+};
+
+class QueueRing {
+public:
+    static constexpr uint32_t MAGIC = 0x514E4C41;  // "ALNQ"
+    static constexpr uint16_t VERSION = 2;
+    static constexpr uint16_t VERSION_JSONL = 1;   // Pre-CRC framing, read-only
+    static constexpr uint32_t SLOT_SIZE = 32;
+    static constexpr uint32_t DATA_OFFSET = 2 * SLOT_SIZE;
+    static constexpr uint8_t SYNC = 0xA5;
+    static constexpr uint16_t RECORD_OVERHEAD = 7;  // sync + length + CRC
+    static constexpr uint16_t V1_RECORD_OVERHEAD = 2;
+    static constexpr uint16_t MAX_RECORD_BYTES = 512;
+
+    enum class OpenResult {
+        Loaded,     // Existing ring, checkpoint matched its data
+        Recovered,  // Checkpoint disagreed with the data; rebuilt by scan
+        Created,  // No ring on card, fresh one preallocated
+        Reset,    // Ring unreadable (size/header mismatch), recreated empty
+        Failed    // Could not create the file
+    };
+
+    QueueRing(const char* path, uint32_t capacity, uint32_t maxEntries)
+        : _path(path), _capacity(capacity), _maxEntries(maxEntries) {}
+
+    /**
+     * @brief Load the ring header from SD, creating the file if needed
+     *
+     * A VERSION_JSONL ring loads read-only (see version()); the caller
+     * migrates its records and calls format().
+     */
+    OpenResult open() {
+        File f = SD.open(_path, "r+");
+        if (!f) {
+            return format() ? OpenResult::Created : OpenResult::Failed;
+        }
+
+        if (f.size() != fileSize()) {
+            LOG_INFO("[QUEUE-RING] Size %lu != expected %lu, recreating\n",
+                     (unsigned long)f.size(), (unsigned long)fileSize());
+            f.close();
+            return format() ? OpenResult::Reset : OpenResult::Failed;
+        }
+
+        Header a, b;
+        bool okA = readSlot(f, 0, a);
+        bool okB = readSlot(f, 1, b);
+
+        if (!okA && !okB) {
+            f.close();
+            LOG_INFO("[QUEUE-RING] No valid header slot, recreating\n");
+            return format() ? OpenResult::Reset : OpenResult::Failed;
+        }
+
+        const Header& h = (okA && okB)
+            ? (static_cast<int32_t>(a.seq - b.seq) > 0 ? a : b)
+            : (okA ? a : b);
+        _version = h.version;
+        _head = h.head;
+        _used = h.used;
+        _count = h.count;
+        _seq = h.seq;
+        _lastLen = h.lastLen;
+
+        // VERSION_JSONL has no CRCs to check against; it is migrated anyway
+        OpenResult result = OpenResult::Loaded;
+        if (_version == VERSION && _count > 0 && !checkpointMatches(f)) {
+            recoverByScan(f);
+            result = OpenResult::Recovered;
+        }
+        f.close();
+        return result;
+    }
+
+    /**
+     * @brief (Re)create the file empty at the current VERSION
+     */
+    bool format() {
+        File f = SD.open(_path, FILE_WRITE);
+        if (!f) {
+            LOG_ERROR("QUEUE-RING", "Could not create queue ring file");
+            return false;
+        }
+
+        // Preallocate header + data so later writes never extend the file
+        uint8_t zeros[128] = {};
+        uint32_t remaining = fileSize();
+        while (remaining > 0) {
+            uint32_t n = remaining < sizeof(zeros) ? remaining : sizeof(zeros);
+            if (f.write(zeros, n) != n) {
+                f.close();
+                return false;
+            }
+            remaining -= n;
+        }
+
+        _version = VERSION;
+        _headIndex += _count;
+        _head = 0;
+        _used = 0;
+        _count = 0;
+        _seq = 0;
+        _lastLen = 0;
+        bool ok = commit(f);
+        f.close();
+        LOG_INFO("[QUEUE-RING] Created %s (%lu bytes)\n", _path, (unsigned long)fileSize());
+        return ok;
+    }
+
+    /**
+     * @brief Append one record, dropping the oldest entries if full
+     * @return false if the record is oversized, the ring is an unmigrated
+     *         VERSION_JSONL ring, or the card write failed
+     */
+    bool append(const uint8_t* data, uint16_t len) {
+        if (!appendable(len)) return false;
+
+        File f = SD.open(_path, "r+");
+        if (!f) return false;
+        State before = state();
+        bool ok = writeRecord(f, data, len);
+        f.flush();  // Record durable before the header exposes it
+        ok = ok && commit(f);
+        if (!ok) restore(before);
+        f.close();
+        return ok;
+    }
+
+    /**
+     * @brief Append several records with one file open and one header commit
+     * @param next Called as next(uint8_t* buf, uint16_t cap) -> uint16_t,
+     *             fills buf with the next record and returns its length
+     *             (0 = no more records)
+     * @return Records appended and committed
+     *
+     * The batch becomes visible atomically: power loss before the commit
+     * leaves the previous header, i.e. none of the batch.
+     *
+     * The batch ends at the first record that cannot be written; next() is
+     * not called again, so that record is the caller's to keep. Records
+     * before it are committed. If the header commit itself fails, RAM rolls
+     * back to the card's header and 0 is returned.
+     */
+    template <typename Fn>
+    uint32_t appendBatch(Fn next) {
+        if (_version != VERSION) return 0;
+        File f = SD.open(_path, "r+");
+        if (!f) return 0;
+
+        State before = state();
+        uint8_t record[MAX_RECORD_BYTES];  // _buf is in use by drop-oldest reads
+        uint32_t appended = 0;
+        uint16_t len;
+        while ((len = next(record, MAX_RECORD_BYTES)) > 0) {
+            if (!appendable(len) || !writeRecord(f, record, len)) break;
+            appended++;
+        }
+        if (appended > 0) {
+            f.flush();
+            if (!commit(f)) {
+                restore(before);
+                appended = 0;
+            }
+        }
+        f.close();
+        return appended;
+    }
+
+    /**
+     * @brief Read up to maxRecords from the head without removing them
+     * @param fn Called as fn(const uint8_t* data, uint16_t len) per record;
+     *           data is NUL-terminated and valid only during the call
+     *
+     * Damaged records are skipped (and counted in damagedCount()); the
+     * cursor still covers their bytes so consume() reclaims them.
+     */
+    template <typename Fn>
+    QueueRingCursor peek(uint32_t maxRecords, Fn fn) {
+        QueueRingCursor cursor;
+        cursor.firstIndex = _headIndex;
+        cursor.endOffset = _head;
+        peekMore(cursor, maxRecords, fn);
+        return cursor;
+    }
+
+    /**
+     * @brief Continue a peek(): read up to maxRecords past the end of
+     *        cursor, extending it
+     *
+     * Lets a long batch be read in short slices, the SD lock released in
+     * between (streamed uploads). A cursor from an empty peek(0, ...)
+     * starts at the head.
+     *
+     * @return false if drop-oldest evicted records since the cursor was
+     *         started: its offsets no longer describe the ring
+     */
+    template <typename Fn>
+    bool peekMore(QueueRingCursor& cursor, uint32_t maxRecords, Fn fn) {
+        if (cursor.firstIndex != _headIndex) return false;
+        if (cursor.count >= _count || maxRecords == 0) return true;
+
+        File f = SD.open(_path, FILE_READ);
+        if (!f) return true;
+
+        uint32_t offset = cursor.endOffset;
+        for (uint32_t n = 0; n < maxRecords && cursor.count < _count; n++) {
+            Record rec;
+            if (!nextRecord(f, offset, _used - cursor.bytes, rec)) {
+                // Nothing valid left: everything after here is damage
+                cursor.bytes = _used;
+                cursor.endOffset = (_head + _used) % _capacity;
+                dropUnreadable(cursor.count);
+                break;
+            }
+            if (rec.skipped > 0) {
+                noteDamage(f, offset, cursor.count, rec.skipped);  // Reuses _buf
+                rec.loaded = false;
+            }
+            if (!rec.loaded && !readData(f, rec.payload, _buf, rec.len)) break;
+            _buf[rec.len] = 0;
+            fn(_buf, rec.len);
+
+            offset = rec.next;
+            cursor.count++;
+            cursor.bytes += rec.skipped + rec.overhead + rec.len;
+            cursor.endOffset = offset;
+        }
+        f.close();
+        return true;
+    }
+
+    /**
+     * @brief Remove the records covered by a cursor from peek()
+     *
+     * O(1) header write in the normal case. If drop-oldest evicted part of
+     * the batch since the peek, only the survivors are skipped.
+     */
+    bool consume(const QueueRingCursor& cursor) {
+        uint32_t gone = _headIndex - cursor.firstIndex;
+        if (cursor.bytes == 0 || (gone > 0 && gone >= cursor.count)) return true;
+
+        File f = SD.open(_path, "r+");
+        if (!f) return false;
+
+        if (gone == 0) {
+            _head = cursor.endOffset;
+            _used -= cursor.bytes;
+            _count -= cursor.count;
+            _headIndex += cursor.count;
+        } else {
+            for (uint32_t i = gone; i < cursor.count && _count > 0; i++) {
+                if (!advanceHead(f)) break;
+            }
+        }
+        if (_count == 0) {
+            _head = (_head + _used) % _capacity;
+            _used = 0;
+        }
+
+        bool ok = commit(f);
+        f.close();
+        return ok;
+    }
+
+    /**
+     * @brief Drop every record (single header write)
+     */
+    bool clear() {
+        File f = SD.open(_path, "r+");
+        if (!f) return false;
+        _headIndex += _count;
+        _head = 0;
+        _used = 0;
+        _count = 0;
+        bool ok = commit(f);
+        f.close();
+        return ok;
+    }
+
+    // ─── State ─────────────────────────────────────────────────────────
+
+    uint16_t version() const { return _version; }
+    uint32_t count() const { return _count; }
+    uint32_t usedBytes() const { return _used; }
+    uint32_t capacity() const { return _capacity; }
+    uint32_t fileSize() const { return DATA_OFFSET + _capacity; }
+    uint32_t droppedCount() const { return _dropped; }   // Overflow evictions since boot
+    uint32_t damagedCount() const { return _damaged; }   // Records lost to CRC damage since boot
+    uint32_t headerSeq() const { return _seq; }
+
+private:
+    struct Header {
+        uint16_t version;
+        uint16_t lastLen;
+        uint32_t head;
+        uint32_t used;
+        uint32_t count;
+        uint32_t seq;
+    };
+
+    // What a failed header commit rolls back, so RAM keeps describing the
+    // header on the card (and the next commit goes to the torn slot)
+    struct State {
+        uint16_t lastLen;
+        uint32_t head;
+        uint32_t used;
+        uint32_t count;
+        uint32_t seq;
+        uint32_t headIndex;
+        uint32_t dropped;
+    };
+
+    struct Record {
+        uint32_t skipped;   // Damaged bytes before the record
+        uint32_t payload;   // Data offset of the payload
+        uint16_t len;
+        uint16_t overhead;  // Framing bytes
+        uint32_t next;      // Data offset just past the record
+        bool loaded;        // Payload already in _buf (CRC check read it)
+    };
+
+    State state() const {
+        return State{_lastLen, _head, _used, _count, _seq, _headIndex, _dropped};
+    }
+
+    void restore(const State& st) {
+        _lastLen = st.lastLen;
+        _head = st.head;
+        _used = st.used;
+        _count = st.count;
+        _seq = st.seq;
+        _headIndex = st.headIndex;
+        _dropped = st.dropped;
+    }
+
+    static void put32(uint8_t* p, uint32_t v) {
+        p[0] = v; p[1] = v >> 8; p[2] = v >> 16; p[3] = v >> 24;
+    }
+
+    static uint32_t get32(const uint8_t* p) {
+        return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24);
+    }
+
+    bool appendable(uint16_t len) const {
+        return _version == VERSION && len > 0 && len <= MAX_RECORD_BYTES &&
+               static_cast<uint32_t>(RECORD_OVERHEAD + len) <= _capacity;
+    }
+
+    // Frame and write one record at the tail, making room first (drop-oldest).
+    // Updates RAM state only; the caller flushes and commits.
+    bool writeRecord(File& f, const uint8_t* data, uint16_t len) {
+        uint32_t need = RECORD_OVERHEAD + len;
+        while (_count > 0 && (_count >= _maxEntries || _capacity - _used < need)) {
+            if (!advanceHead(f)) break;
+            _dropped++;
+        }
+        if (_count == 0) {
+            _used = 0;  // Nothing live: reclaim any skipped damage too
+        }
+
+        uint8_t frame[RECORD_OVERHEAD];
+        frame[0] = SYNC;
+        frame[1] = len & 0xFF;
+        frame[2] = len >> 8;
+        put32(frame + 3, crc32(data, len, crc32(frame + 1, 2)));
+
+        uint32_t tail = (_head + _used) % _capacity;
+        if (!writeData(f, tail, frame, RECORD_OVERHEAD) ||
+            !writeData(f, (tail + RECORD_OVERHEAD) % _capacity, data, len)) {
+            return false;
+        }
+        _used += need;
+        _count++;
+        _lastLen = len;
+        return true;
+    }
+
+    // Slot: magic, version, newest record length, capacity, head, used, count, seq, crc
+    bool readSlot(File& f, uint8_t slot, Header& out) {
+        uint8_t raw[SLOT_SIZE];
+        if (!f.seek(slot * SLOT_SIZE) || f.read(raw, SLOT_SIZE) != SLOT_SIZE) {
+            return false;
+        }
+        out.version = raw[4] | (raw[5] << 8);
+        if (get32(raw) != MAGIC || (out.version != VERSION && out.version != VERSION_JSONL) ||
+            get32(raw + 8) != _capacity || get32(raw + 28) != crc32(raw, 28)) {
+            return false;
+        }
+        out.lastLen = raw[6] | (raw[7] << 8);
+        out.head = get32(raw + 12);
+        out.used = get32(raw + 16);
+        out.count = get32(raw + 20);
+        out.seq = get32(raw + 24);
+        return out.head < _capacity && out.used <= _capacity &&
+               out.count * V1_RECORD_OVERHEAD <= out.used;
+    }
+
+    bool commit(File& f) {
+        _seq++;
+        uint8_t raw[SLOT_SIZE] = {};
+        put32(raw, MAGIC);
+        raw[4] = _version & 0xFF;
+        raw[5] = _version >> 8;
+        raw[6] = _lastLen & 0xFF;
+        raw[7] = _lastLen >> 8;
+        put32(raw + 8, _capacity);
+        put32(raw + 12, _head);
+        put32(raw + 16, _used);
+        put32(raw + 20, _count);
+        put32(raw + 24, _seq);
+        put32(raw + 28, crc32(raw, 28));
+
+        bool ok = f.seek((_seq & 1) * SLOT_SIZE) && f.write(raw, SLOT_SIZE) == SLOT_SIZE;
+        f.flush();
+        return ok;
+    }
+
+    // Validate the record framed at `offset` (no resync)
+    bool recordAt(File& f, uint32_t offset, uint32_t available, Record& rec) {
+        if (_version == VERSION_JSONL) {
+            uint8_t prefix[V1_RECORD_OVERHEAD];
+            if (available < V1_RECORD_OVERHEAD ||
+                !readData(f, offset, prefix, V1_RECORD_OVERHEAD)) {
+                return false;
+            }
+            rec.len = prefix[0] | (prefix[1] << 8);
+            rec.overhead = V1_RECORD_OVERHEAD;
+            rec.loaded = false;
+        } else {
+            uint8_t frame[RECORD_OVERHEAD];
+            if (available < RECORD_OVERHEAD || !readData(f, offset, frame, RECORD_OVERHEAD) ||
+                frame[0] != SYNC) {
+                return false;
+            }
+            rec.len = frame[1] | (frame[2] << 8);
+            rec.overhead = RECORD_OVERHEAD;
+            if (rec.len == 0 || rec.len > MAX_RECORD_BYTES ||
+                static_cast<uint32_t>(RECORD_OVERHEAD + rec.len) > available ||
+                !readData(f, (offset + RECORD_OVERHEAD) % _capacity, _buf, rec.len) ||
+                crc32(_buf, rec.len, crc32(frame + 1, 2)) != get32(frame + 3)) {
+                return false;
+            }
+            rec.loaded = true;
+        }
+        if (rec.len == 0 || rec.len > MAX_RECORD_BYTES ||
+            static_cast<uint32_t>(rec.overhead + rec.len) > available) {
+            return false;
+        }
+        rec.payload = (offset + rec.overhead) % _capacity;
+        rec.next = (offset + rec.overhead + rec.len) % _capacity;
+        return true;
+    }
+
+    // First valid record at or after `offset`, within `available` bytes.
+    // VERSION_JSONL has no sync/CRC, so it cannot resync past damage.
+    bool nextRecord(File& f, uint32_t offset, uint32_t available, Record& rec) {
+        uint32_t skipped = 0;
+        while (available > 0) {
+            if (recordAt(f, offset, available, rec)) {
+                rec.skipped = skipped;
+                return true;
+            }
+            if (_version == VERSION_JSONL) return false;
+
+            // Resync on the next sync byte after this one
+            uint32_t step = 1 + distanceToSync(f, (offset + 1) % _capacity, available - 1);
+            offset = (offset + step) % _capacity;
+            available -= step;
+            skipped += step;
+        }
+        return false;
+    }
+
+    // Bytes from `offset` to the next SYNC byte, or `available` if none
+    uint32_t distanceToSync(File& f, uint32_t offset, uint32_t available) {
+        uint8_t chunk[32];
+        uint32_t scanned = 0;
+        while (scanned < available) {
+            uint32_t run = available - scanned;
+            if (run > sizeof(chunk)) run = sizeof(chunk);
+            if (run > _capacity - offset) run = _capacity - offset;
+            if (!readData(f, offset, chunk, run)) return available;
+            const void* hit = memchr(chunk, SYNC, run);
+            if (hit) return scanned + (static_cast<const uint8_t*>(hit) - chunk);
+            scanned += run;
+            offset = (offset + run) % _capacity;
+        }
+        return available;
+    }
+
+    // O(1) checkpoint check: the oldest record and the newest one (located
+    // from the tail by its recorded length) must both frame and CRC-check
+    bool checkpointMatches(File& f) {
+        Record rec;
+        if (!recordAt(f, _head, _used, rec)) return false;
+        if (_lastLen == 0) return true;  // Written before lengths were tracked
+
+        uint32_t lastSize = RECORD_OVERHEAD + _lastLen;
+        if (lastSize > _used) return false;
+        uint32_t last = (_head + _used + _capacity - lastSize) % _capacity;
+        return recordAt(f, last, lastSize, rec) && rec.len == _lastLen;
+    }
+
+    // Checkpoint mismatch: keep every record between head and tail that still
+    // validates, trim damage off both ends, and commit the corrected header
+    void recoverByScan(File& f) {
+        uint32_t offset = _head;
+        uint32_t available = _used;
+        uint32_t live = 0;
+        uint32_t leading = 0;   // Damaged bytes before the first valid record
+        uint32_t validEnd = 0;  // Bytes from head to the end of the last one
+        uint16_t lastLen = 0;
+        Record rec;
+        while (available > 0 && nextRecord(f, offset, available, rec)) {
+            if (live == 0) leading = rec.skipped;
+            live++;
+            available -= rec.skipped + rec.overhead + rec.len;
+            validEnd = _used - available;
+            lastLen = rec.len;
+            offset = rec.next;
+        }
+
+        uint32_t lost = _count > live ? _count - live : 0;
+        LOG_INFO("[QUEUE-RING] Checkpoint mismatch: scan kept %lu of %lu record(s)\n",
+                 (unsigned long)live, (unsigned long)_count);
+        _head = (_head + leading) % _capacity;
+        _used = live > 0 ? validEnd - leading : 0;
+        _count = live;
+        _lastLen = lastLen;
+        _damaged += lost;
+        commit(f);
+    }
+
+    // Damage found while reading: re-derive the live record count by walking
+    // from the damaged record to the tail (corruption path only)
+    void noteDamage(File& f, uint32_t offset, uint32_t before, uint32_t skippedBytes) {
+        uint32_t available = _used - (offset + _capacity - _head) % _capacity;
+        uint32_t live = 0;
+        Record rec;
+        while (available > 0 && nextRecord(f, offset, available, rec)) {
+            live++;
+            available -= rec.skipped + rec.overhead + rec.len;
+            offset = rec.next;
+        }
+        uint32_t expected = _count - before;
+        uint32_t lost = expected > live ? expected - live : 0;
+        _count = before + live;
+        _damaged += lost;
+        LOG_INFO("[QUEUE-RING] Skipped %lu damaged bytes, %lu record(s) lost\n",
+                 (unsigned long)skippedBytes, (unsigned long)lost);
+    }
+
+    // No valid record remains past the first `kept` records from the head
+    void dropUnreadable(uint32_t kept) {
+        uint32_t lost = _count - kept;
+        _damaged += lost;
+        _count = kept;
+        LOG_INFO("[QUEUE-RING] Tail unreadable, %lu record(s) lost\n", (unsigned long)lost);
+    }
+
+    // Remove the head record (and any damage in front of it)
+    bool advanceHead(File& f) {
+        Record rec;
+        if (!nextRecord(f, _head, _used, rec)) {
+            LOG_ERROR("QUEUE-RING", "No readable record left, discarding queue");
+            _damaged += _count;
+            _headIndex += _count;
+            _head = (_head + _used) % _capacity;
+            _used = 0;
+            _count = 0;
+            return false;
+        }
+        _used -= rec.skipped + rec.overhead + rec.len;
+        _head = rec.next;
+        _count--;
+        _headIndex++;
+        return true;
+    }
+
+    bool readData(File& f, uint32_t offset, uint8_t* buf, uint32_t len) {
+        uint32_t first = _capacity - offset < len ? _capacity - offset : len;
+        if (!f.seek(DATA_OFFSET + offset) || f.read(buf, first) != first) return false;
+        if (first == len) return true;
+        return f.seek(DATA_OFFSET) && f.read(buf + first, len - first) == len - first;
+    }
+
+    bool writeData(File& f, uint32_t offset, const uint8_t* buf, uint32_t len) {
+        uint32_t first = _capacity - offset < len ? _capacity - offset : len;
+        if (!f.seek(DATA_OFFSET + offset) || f.write(buf, first) != first) return false;
+        if (first == len) return true;
+        return f.seek(DATA_OFFSET) && f.write(buf + first, len - first) == len - first;
+    }
+
+    const char* _path;
+    uint32_t _capacity;
+    uint32_t _maxEntries;
+
+    uint16_t _version = VERSION;
+    uint16_t _lastLen = 0;    // Payload length of the newest record (checkpoint)
+    uint32_t _head = 0;       // Data offset of the oldest record
+    uint32_t _used = 0;       // Bytes from head to tail (records + skipped damage)
+    uint32_t _count = 0;      // Live records queued
+    uint32_t _seq = 0;        // Last committed header sequence
+    uint32_t _headIndex = 0;  // Records ever removed from the head (RAM only)
+    uint32_t _dropped = 0;
+    uint32_t _damaged = 0;
+
+    uint8_t _buf[MAX_RECORD_BYTES + 1];
+};
+
+} // namespace services
@@ -0,0 +1,81 @@
+#pragma once
+
+/**
+ * @file ScanJournal.h
+ * @brief RAM write-behind buffer in front of the SD queue ring.
+ *
+ * OrchestratorService::queueScan() runs on the Core-1 scan path; it now only
+ * pushes the scan here (no SD access), and the Core-0 background task
+ * persists everything pending in one batched QueueRing append.
+ *
+ * A pending scan is flushed when the first of these holds (flushDue()):
+ * - it has been pending SCAN_JOURNAL_FLUSH_MS
+ * - SCAN_JOURNAL_BATCH scans are pending
+ * - free heap dropped below SCAN_JOURNAL_LOW_HEAP_BYTES
+ * - requestFlush() was called (reboot, QUEUE_STATUS, ...)
+ *
+ * Threading: submit() is the producer side and belongs to the Core-1 main
+ * loop. pop() is the consumer side and is only called with
+ * hal::SDCard::Lock held; the lock serialises consumers, so SPSCQueue's
+ * single-consumer contract holds even when a shutdown flush drains from
+ * Core 1 instead of the background task.
+ */
+
+#include <Arduino.h>
+#include <atomic>
+#include "../config.h"
+#include "../hal/SPSCQueue.h"
+#include "../models/Token.h"
+
+namespace services {
+
+template <size_t Depth>
+class ScanJournal {
+public:
+    /**
+     * @brief Buffer a scan (producer side)
+     * @return false if the journal is full; the caller persists directly
+     */
+    bool submit(const models::ScanData& scan, uint32_t nowMs) {
+        // Stamp only the transition from empty. Racing the consumer's last
+        // pop can leave an older stamp, which just flushes a little early.
+        bool wasEmpty = _pending.empty();
+        if (!_pending.push(scan)) return false;
+        if (wasEmpty) _firstPendingMs.store(nowMs, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side: caller holds hal::SDCard::Lock
+    bool pop(models::ScanData& out) { return _pending.pop(out); }
+
+    // Consumer side: look at the i-th pending scan without taking it, and
+    // drop the first n once the ring header covers them
+    const models::ScanData* peek(size_t i) const { return _pending.peek(i); }
+    void discard(size_t n) { _pending.discard(n); }
+
+    bool flushDue(uint32_t nowMs, uint32_t freeHeap) const {
+        if (_pending.empty()) return false;
+        return _flushRequested.load(std::memory_order_acquire) ||
+               _pending.size() >= queue_config::SCAN_JOURNAL_BATCH ||
+               freeHeap < queue_config::SCAN_JOURNAL_LOW_HEAP_BYTES ||
+               nowMs - _firstPendingMs.load(std::memory_order_acquire) >=
+                   queue_config::SCAN_JOURNAL_FLUSH_MS;
+    }
+
+    void requestFlush() { _flushRequested.store(true, std::memory_order_release); }
+
+    // Consumer calls this once it has drained the journal
+    void flushed() { _flushRequested.store(false, std::memory_order_release); }
+
+    size_t size() const { return _pending.size(); }
+    bool empty() const { return _pending.empty(); }
+    uint32_t overflowCount() const { return _pending.dropped(); }  // Fell back to direct writes
+    static constexpr size_t capacity() { return Depth; }
+
+private:
+    hal::SPSCQueue<models::ScanData, Depth> _pending;
+    std::atomic<uint32_t> _firstPendingMs{0};
+    std::atomic<bool> _flushRequested{false};
+};
+
+} // namespace services
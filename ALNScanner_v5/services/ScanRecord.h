@@ -0,0 +1,319 @@
+#pragma once
+
+/**
+ * @file ScanRecord.h
+ * @brief Compact binary encoding of a queued scan (offline queue payload).
+ *
+ * Replaces one JSON line per queue entry: ~20 bytes instead of ~130, and a
+ * read is a few length-prefixed copies instead of a JsonDocument per entry.
+ * Integrity (CRC32) is checked by the record framing in QueueRing.h, not here.
+ *
+ * Layout (SCAN_RECORD_VERSION 1):
+ *
+ *   u8   format version
+ *   u8   flags (SCAN_REC_*)
+ *   str  tokenId                         str = u8 length + bytes
+ *   str  teamId        if HAS_TEAM
+ *   str  deviceId      if DEVICE_INLINE, else u8 index into DeviceIdTable
+ *   str  deviceType    if TYPE_INLINE,   else "esp32"
+ *   str  timestamp     if TIME_INLINE,   else 7-byte compact timestamp
+ *
+ * Compact timestamp: u16 local days since 1970-01-01, u32 ms of day, i8 UTC
+ * offset in 15-minute units (127 = "Z"). Used only when it renders back to
+ * the exact original string (both generateTimestamp() formats do), so
+ * decoding is always lossless.
+ *
+ * Pure functions — no I/O. Tested in test/test_scan_record/.
+ */
+
+#include <Arduino.h>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include "../models/Token.h"
+#include "Crc32.h"
+
+namespace services {
+
+constexpr uint8_t SCAN_RECORD_VERSION = 1;
+
+constexpr uint8_t SCAN_REC_HAS_TEAM      = 0x01;
+constexpr uint8_t SCAN_REC_DEVICE_INLINE = 0x02;
+constexpr uint8_t SCAN_REC_TYPE_INLINE   = 0x04;
+constexpr uint8_t SCAN_REC_TIME_INLINE   = 0x08;
+
+constexpr uint8_t COMPACT_TIMESTAMP_BYTES = 7;
+constexpr int8_t COMPACT_TZ_UTC_Z = 127;
+
+/**
+ * Interned deviceIds referenced by index from queued records. Every scan
+ * from one scanner carries the same deviceId, so the table normally holds
+ * a single entry; it only grows if the configured ID changes while scans
+ * are still queued. Persisted by OrchestratorService next to the queue.
+ */
+struct DeviceIdTable {
+    static constexpr uint8_t MAX_IDS = 8;
+    static constexpr uint8_t MAGIC = 0xD1;
+
+    String ids[MAX_IDS];
+    uint8_t count = 0;
+
+    int find(const String& id) const {
+        for (uint8_t i = 0; i < count; i++) {
+            if (ids[i] == id) return i;
+        }
+        return -1;
+    }
+
+    // Index of id, adding it if new; -1 when full (records then inline it)
+    int intern(const String& id) {
+        int i = find(id);
+        if (i >= 0) return i;
+        if (count >= MAX_IDS || id.length() == 0 || id.length() > 255) return -1;
+        ids[count] = id;
+        return count++;
+    }
+
+    // [MAGIC][count]{u8 len, bytes}...[crc32 LE]; 0 if cap too small
+    size_t serialize(uint8_t* out, size_t cap) const {
+        size_t n = 2;
+        for (uint8_t i = 0; i < count; i++) n += 1 + ids[i].length();
+        if (n + 4 > cap) return 0;
+
+        size_t p = 0;
+        out[p++] = MAGIC;
+        out[p++] = count;
+        for (uint8_t i = 0; i < count; i++) {
+            out[p++] = ids[i].length();
+            memcpy(out + p, ids[i].c_str(), ids[i].length());
+            p += ids[i].length();
+        }
+        uint32_t crc = crc32(out, p);
+        for (uint8_t k = 0; k < 4; k++) out[p++] = crc >> (8 * k);
+        return p;
+    }
+
+    bool deserialize(const uint8_t* in, size_t len) {
+        if (len < 6 || in[0] != MAGIC || in[1] > MAX_IDS) return false;
+        uint32_t crc = in[len - 4] | (in[len - 3] << 8) | (in[len - 2] << 16) |
+                       (static_cast<uint32_t>(in[len - 1]) << 24);
+        if (crc32(in, len - 4) != crc) return false;
+
+        DeviceIdTable parsed;
+        size_t p = 2;
+        for (uint8_t i = 0; i < in[1]; i++) {
+            if (p >= len - 4 || p + 1 + in[p] > len - 4) return false;
+            std::string id(reinterpret_cast<const char*>(in + p + 1), in[p]);
+            parsed.ids[i] = id.c_str();
+            p += 1 + in[p];
+        }
+        if (p != len - 4) return false;
+        parsed.count = in[1];
+        *this = parsed;
+        return true;
+    }
+};
+
+// ─── Compact timestamp ────────────────────────────────────────────────
+
+// Days since 1970-01-01 for a proleptic Gregorian date (H. Hinnant)
+inline int32_t daysFromCivil(int y, unsigned m, unsigned d) {
+    y -= m <= 2;
+    const int era = (y >= 0 ? y : y - 399) / 400;
+    const unsigned yoe = static_cast<unsigned>(y - era * 400);
+    const unsigned doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast<int32_t>(doe) - 719468;
+}
+
+inline void civilFromDays(int32_t z, int& y, unsigned& m, unsigned& d) {
+    z += 719468;
+    const int era = (z >= 0 ? z : z - 146096) / 146097;
+    const unsigned doe = static_cast<unsigned>(z - era * 146097);
+    const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const unsigned mp = (5 * doy + 2) / 153;
+    d = doy - (153 * mp + 2) / 5 + 1;
+    m = mp < 10 ? mp + 3 : mp - 9;
+    y = static_cast<int>(yoe) + era * 400 + (m <= 2);
+}
+
+inline String unpackTimestamp(const uint8_t* in) {
+    int32_t days = in[0] | (in[1] << 8);
+    uint32_t msOfDay = in[2] | (in[3] << 8) | (in[4] << 16) |
+                       (static_cast<uint32_t>(in[5]) << 24);
+    int8_t tz = static_cast<int8_t>(in[6]);
+
+    int y;
+    unsigned m, d;
+    civilFromDays(days, y, m, d);
+    unsigned long s = msOfDay / 1000;
+
+    char buf[36];
+    int n = snprintf(buf, sizeof(buf), "%04d-%02u-%02uT%02lu:%02lu:%02lu.%03lu",
+                     y, m, d, s / 3600, (s / 60) % 60, s % 60,
+                     static_cast<unsigned long>(msOfDay % 1000));
+    if (tz == COMPACT_TZ_UTC_Z) {
+        snprintf(buf + n, sizeof(buf) - n, "Z");
+    } else {
+        int off = tz * 15;
+        char sign = off < 0 ? '-' : '+';
+        if (off < 0) off = -off;
+        snprintf(buf + n, sizeof(buf) - n, "%c%02d:%02d", sign, off / 60, off % 60);
+    }
+    return String(buf);
+}
+
+// Pack "YYYY-MM-DDTHH:MM:SS.mmm(Z|±HH:MM)"; false if not exactly representable
+inline bool packTimestamp(const String& ts, uint8_t* out) {
+    int y, mo, d, h, mi, s, ms, consumed = 0;
+    if (sscanf(ts.c_str(), "%4d-%2d-%2dT%2d:%2d:%2d.%3d%n",
+               &y, &mo, &d, &h, &mi, &s, &ms, &consumed) != 7) {
+        return false;
+    }
+    const char* rest = ts.c_str() + consumed;
+    int tz;
+    if (strcmp(rest, "Z") == 0) {
+        tz = COMPACT_TZ_UTC_Z;
+    } else {
+        int oh, om;
+        if ((rest[0] != '+' && rest[0] != '-') ||
+            sscanf(rest + 1, "%2d:%2d", &oh, &om) != 2 || om % 15 != 0) {
+            return false;
+        }
+        tz = (oh * 60 + om) / 15 * (rest[0] == '-' ? -1 : 1);
+        if (tz <= -COMPACT_TZ_UTC_Z || tz >= COMPACT_TZ_UTC_Z) return false;
+    }
+    if (mo < 1 || mo > 12 || d < 1 || d > 31 || h > 23 || mi > 59 || s > 59) {
+        return false;
+    }
+
+    int32_t days = daysFromCivil(y, mo, d);
+    if (days < 0 || days > 0xFFFF) return false;
+    uint32_t msOfDay = ((h * 60 + mi) * 60 + s) * 1000u + ms;
+
+    out[0] = days;
+    out[1] = days >> 8;
+    for (uint8_t k = 0; k < 4; k++) out[2 + k] = msOfDay >> (8 * k);
+    out[6] = static_cast<uint8_t>(static_cast<int8_t>(tz));
+
+    // Lossless or nothing: reject anything that would not round-trip
+    return unpackTimestamp(out) == ts;
+}
+
+// UTC epoch milliseconds of a timestamp packTimestamp() accepts (binary
+// upload encoding); false for anything else, which is then sent as text
+inline bool epochMsFromTimestamp(const String& ts, uint64_t& epochMs) {
+    uint8_t packed[COMPACT_TIMESTAMP_BYTES];
+    if (!packTimestamp(ts, packed)) return false;
+
+    int64_t days = packed[0] | (packed[1] << 8);
+    uint32_t msOfDay = packed[2] | (packed[3] << 8) | (packed[4] << 16) |
+                       (static_cast<uint32_t>(packed[5]) << 24);
+    int8_t tz = static_cast<int8_t>(packed[6]);
+    int64_t offsetMin = (tz == COMPACT_TZ_UTC_Z) ? 0 : tz * 15;
+
+    int64_t ms = days * 86400000LL + msOfDay - offsetMin * 60000LL;
+    if (ms < 0) return false;
+    epochMs = static_cast<uint64_t>(ms);
+    return true;
+}
+
+// ─── Record encode / decode ───────────────────────────────────────────
+
+/**
+ * Encode a scan into `out`. deviceId is written as a table index when the
+ * table already holds it (caller interns + persists the table first).
+ * Returns bytes written, or 0 if a field exceeds 255 bytes or cap is short.
+ */
+inline size_t encodeScanRecord(const models::ScanData& scan, const DeviceIdTable& table,
+                               uint8_t* out, size_t cap) {
+    size_t n = 0;
+    bool ok = true;
+    auto put = [&](const void* data, size_t len) {
+        if (!ok || n + len > cap) { ok = false; return; }
+        memcpy(out + n, data, len);
+        n += len;
+    };
+    auto putByte = [&](uint8_t b) { put(&b, 1); };
+    auto putStr = [&](const String& str) {
+        if (str.length() > 255) { ok = false; return; }
+        putByte(str.length());
+        put(str.c_str(), str.length());
+    };
+
+    int deviceIndex = table.find(scan.deviceId);
+    uint8_t packed[COMPACT_TIMESTAMP_BYTES];
+    bool compactTime = packTimestamp(scan.timestamp, packed);
+
+    uint8_t flags = 0;
+    if (scan.teamId.length() > 0) flags |= SCAN_REC_HAS_TEAM;
+    if (deviceIndex < 0) flags |= SCAN_REC_DEVICE_INLINE;
+    if (scan.deviceType != "esp32") flags |= SCAN_REC_TYPE_INLINE;
+    if (!compactTime) flags |= SCAN_REC_TIME_INLINE;
+
+    putByte(SCAN_RECORD_VERSION);
+    putByte(flags);
+    putStr(scan.tokenId);
+    if (flags & SCAN_REC_HAS_TEAM) putStr(scan.teamId);
+    if (flags & SCAN_REC_DEVICE_INLINE) putStr(scan.deviceId);
+    else putByte(deviceIndex);
+    if (flags & SCAN_REC_TYPE_INLINE) putStr(scan.deviceType);
+    if (flags & SCAN_REC_TIME_INLINE) putStr(scan.timestamp);
+    else put(packed, COMPACT_TIMESTAMP_BYTES);
+
+    return ok ? n : 0;
+}
+
+/**
+ * Decode a record produced by encodeScanRecord(). Returns false on an
+ * unknown version, truncation, trailing bytes, a deviceId index missing
+ * from the table, or an empty required field.
+ */
+inline bool decodeScanRecord(const uint8_t* in, size_t len, const DeviceIdTable& table,
+                             models::ScanData& scan) {
+    size_t p = 0;
+    bool ok = true;
+    auto getByte = [&]() -> uint8_t {
+        if (p >= len) { ok = false; return 0; }
+        return in[p++];
+    };
+    auto getStr = [&](String& outStr) {
+        uint8_t n = getByte();
+        if (!ok || p + n > len) { ok = false; return; }
+        std::string s(reinterpret_cast<const char*>(in + p), n);
+        outStr = s.c_str();
+        p += n;
+    };
+
+    if (getByte() != SCAN_RECORD_VERSION || !ok) return false;
+    uint8_t flags = getByte();
+
+    models::ScanData out;
+    getStr(out.tokenId);
+    if (flags & SCAN_REC_HAS_TEAM) getStr(out.teamId);
+    if (flags & SCAN_REC_DEVICE_INLINE) {
+        getStr(out.deviceId);
+    } else {
+        uint8_t index = getByte();
+        if (index >= table.count) return false;
+        out.deviceId = table.ids[index];
+    }
+    if (flags & SCAN_REC_TYPE_INLINE) getStr(out.deviceType);
+    if (flags & SCAN_REC_TIME_INLINE) {
+        getStr(out.timestamp);
+    } else {
+        if (p + COMPACT_TIMESTAMP_BYTES > len) return false;
+        out.timestamp = unpackTimestamp(in + p);
+        p += COMPACT_TIMESTAMP_BYTES;
+    }
+
+    if (!ok || p != len || out.tokenId.length() == 0 ||
+        out.deviceId.length() == 0 || out.timestamp.length() == 0) {
+        return false;
+    }
+    scan = out;
+    return true;
+}
+
+} // namespace services
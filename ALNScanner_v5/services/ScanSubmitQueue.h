@@ -0,0 +1,121 @@
+#pragma once
+
+/**
+ * @file ScanSubmitQueue.h
+ * @brief Hand-off of online scans from the Core-1 scan path to the Core-0
+ *        submit task, and of their outcomes back.
+ *
+ * handleScanEvent() used to call sendScan() inline, so a slow orchestrator
+ * held the tap for up to the 10 s request timeout before anything was
+ * drawn. Now the main loop submits the scan and shows the token at once;
+ * the submit task POSTs it and returns a ScanResult, which the main loop
+ * reconciles with whatever is on screen by then (lateOutcomeAction()).
+ *
+ * Threading: submit()/poll() belong to the Core-1 main loop, next()/
+ * complete() to the submit task; two SPSC rings, no locks. submit()
+ * refuses once Depth scans are in flight (submitted, not yet polled), so
+ * the result ring can never be full and an outcome is never dropped. That
+ * matters: a RETRY_QUEUE result carries the scan back to Core 1 for
+ * queueScan(), whose journal has a single (Core-1) producer.
+ */
+
+#include <Arduino.h>
+#include "../hal/SPSCQueue.h"
+#include "../models/Token.h"
+#include "ScanResponse.h"
+
+namespace services {
+
+struct ScanSubmission {
+    models::ScanData scan;
+    uint32_t submittedAtMs = 0;
+};
+
+struct ScanResult {
+    models::ScanData scan;
+    ScanOutcome outcome = ScanOutcome::RETRY_QUEUE;
+    uint32_t submittedAtMs = 0;
+    uint32_t completedAtMs = 0;
+};
+
+template <size_t Depth>
+class ScanSubmitQueue {
+public:
+    /**
+     * @brief Hand a scan to the submit task (Core 1)
+     * @return false with Depth scans in flight; the caller queues it offline
+     */
+    bool submit(const models::ScanData& scan, uint32_t nowMs) {
+        if (inFlight() >= Depth) return false;
+        ScanSubmission s;
+        s.scan = scan;
+        s.submittedAtMs = nowMs;
+        if (!_pending.push(std::move(s))) return false;
+        _submitted++;
+        return true;
+    }
+
+    // Submit task: oldest scan still to be sent
+    bool next(ScanSubmission& out) { return _pending.pop(out); }
+
+    // Submit task: post the outcome of a scan taken with next()
+    void complete(ScanSubmission& sub, ScanOutcome outcome, uint32_t nowMs) {
+        ScanResult r;
+        r.scan = std::move(sub.scan);
+        r.outcome = outcome;
+        r.submittedAtMs = sub.submittedAtMs;
+        r.completedAtMs = nowMs;
+        _results.push(std::move(r));  // Never full, see submit()
+    }
+
+    // Core 1: next outcome to reconcile
+    bool poll(ScanResult& out) {
+        if (!_results.pop(out)) return false;
+        _polled++;
+        return true;
+    }
+
+    // Exact on Core 1
+    size_t inFlight() const { return _submitted - _polled; }
+    static constexpr size_t capacity() { return Depth; }
+
+private:
+    hal::SPSCQueue<ScanSubmission, Depth> _pending;
+    hal::SPSCQueue<ScanResult, Depth> _results;
+    uint32_t _submitted = 0;  // Core 1 only
+    uint32_t _polled = 0;     // Core 1 only
+};
+
+/**
+ * What the UI does with an outcome that arrives after the optimistic
+ * display. The token was drawn as if ACCEPTED ("Sending..." for video).
+ */
+enum class LateOutcomeAction {
+    None,              ///< Display already right, or has moved on
+    VideoUnavailable,  ///< Relabel the processing modal (A4)
+    RevertNoSession    ///< Replace the token with the NO SESSION failure
+};
+
+/**
+ * @param tokenOnScreen The scanned token is still displayed
+ * @param uiIdle        Nothing else is displayed (ready / scan-failed)
+ */
+inline LateOutcomeAction lateOutcomeAction(ScanOutcome outcome, bool tokenOnScreen,
+                                           bool uiIdle) {
+    switch (outcome) {
+        case ScanOutcome::ACCEPTED:
+            return LateOutcomeAction::None;
+        case ScanOutcome::REJECTED_NO_SESSION:
+            // Not recorded: the player must know, unless that would cut
+            // into another token they have scanned since
+            return tokenOnScreen || uiIdle ? LateOutcomeAction::RevertNoSession
+                                           : LateOutcomeAction::None;
+        case ScanOutcome::ACCEPTED_NO_VIDEO:
+        case ScanOutcome::RETRY_QUEUE:
+            return tokenOnScreen ? LateOutcomeAction::VideoUnavailable
+                                 : LateOutcomeAction::None;
+    }
+    return LateOutcomeAction::None;
+}
+
+} // namespace services
@@ -0,0 +1,107 @@
+#pragma once
+
+/**
+ * @file SyncValidators.h
+ * @brief HTTP cache validators kept beside a synced file, so the next sync
+ *        can ask the orchestrator "only if changed".
+ *
+ * The token database and the asset manifest are re-fetched on every boot
+ * although they rarely change. The ETag / Last-Modified of the response a
+ * file was built from is stored in a small sidecar file; the next request
+ * sends them as If-None-Match / If-Modified-Since and a 304 skips the
+ * download, the parse, the SD rewrite and (for assets) the diff.
+ *
+ * A sidecar is only valid while the file it describes is complete:
+ * callers clear() it before they start changing that file and save() it
+ * once the file matches the response again, and only send it while the
+ * file exists. A cut anywhere in between leaves no sidecar, which just
+ * costs one full download.
+ *
+ * Sidecar format, one header per line:
+ *   ETag: W/"5a1-Hc2n1kGCbV1TnO8CPiwSG5M0dSI"
+ *   Last-Modified: Wed, 14 Oct 2026 18:02:11 GMT
+ *
+ * Callers hold hal::SDCard::Lock.
+ */
+
+#include <Arduino.h>
+#include <SD.h>
+
+namespace services {
+
+struct SyncValidators {
+    String etag;
+    String lastModified;
+
+    bool empty() const { return etag.length() == 0 && lastModified.length() == 0; }
+};
+
+namespace sync_validators {
+
+// Sidecar text -> validators; unknown lines ignored
+inline SyncValidators parse(const String& text) {
+    SyncValidators v;
+    int start = 0;
+    while (start < (int)text.length()) {
+        int end = text.indexOf('\n', start);
+        if (end < 0) end = text.length();
+        String line = text.substring(start, end);
+        start = end + 1;
+
+        int colon = line.indexOf(':');
+        if (colon <= 0) continue;
+        String name = line.substring(0, colon);
+        String value = line.substring(colon + 1);
+        value.trim();
+        name.toLowerCase();
+        if (name == "etag") v.etag = value;
+        else if (name == "last-modified") v.lastModified = value;
+    }
+    return v;
+}
+
+inline String format(const SyncValidators& v) {
+    String text;
+    if (v.etag.length()) text += "ETag: " + v.etag + "\n";
+    if (v.lastModified.length()) text += "Last-Modified: " + v.lastModified + "\n";
+    return text;
+}
+
+/**
+ * @brief Validators for dataPath, read from its sidecar
+ * @return empty if dataPath or the sidecar is missing (send no condition)
+ */
+inline SyncValidators load(const char* sidecarPath, const char* dataPath) {
+    if (!SD.exists(dataPath) || !SD.exists(sidecarPath)) return SyncValidators();
+    File f = SD.open(sidecarPath, FILE_READ);
+    if (!f) return SyncValidators();
+    String text;
+    while (f.available()) {
+        text += f.readStringUntil('\n');
+        text += "\n";
+        if (text.length() > 512) break;  // Not ours; ignore the rest
+    }
+    f.close();
+    return parse(text);
+}
+
+inline void clear(const char* sidecarPath) {
+    SD.remove(sidecarPath);  // no-op if absent
+}
+
+// An empty set just clears: the server offered nothing to revalidate with
+inline bool save(const char* sidecarPath, const SyncValidators& v) {
+    clear(sidecarPath);
+    if (v.empty()) return true;
+    File f = SD.open(sidecarPath, FILE_WRITE);
+    if (!f) return false;
+    String text = format(v);
+    bool ok = f.print(text) == text.length();
+    f.flush();
+    f.close();
+    if (!ok) clear(sidecarPath);
+    return ok;
+}
+
+} // namespace sync_validators
+} // namespace services
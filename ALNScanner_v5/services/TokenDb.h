@@ -0,0 +1,74 @@
+#pragma once
+
+/**
+ * @file TokenDb.h
+ * @brief /tokens.json -> token list, for TokenService::loadDatabaseFromSD().
+ *
+ * The token DB has no size cap since sync streams it to SD, so the load
+ * must not hold the whole file either. It parses through a filter that
+ * keeps only tokens.<id>.video (the one field the scanner reads); image,
+ * audio and anything else the orchestrator adds are skipped as they are
+ * read. What stays in the document is the token IDs and video names.
+ *
+ * check() is the sync's test of a downloaded .part before it replaces
+ * tokens.json: a filter that keeps nothing, so it costs one read of the
+ * file and no copy of it.
+ */
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <vector>
+#include "../models/Token.h"
+
+namespace services {
+namespace token_db {
+
+/**
+ * @brief Parse a token DB read from `in` (File or any ArduinoJson reader)
+ * @param tokens Replaced with the file's tokens once it parses
+ * @param error  Set when the JSON does not parse
+ * @return false on a parse error (tokens untouched) or when there is no
+ *         "tokens" object (tokens left empty, error Ok)
+ */
+template <typename Reader>
+bool parse(Reader& in, std::vector<models::TokenMetadata>& tokens,
+           DeserializationError& error) {
+    JsonDocument filter;
+    filter["tokens"]["*"]["video"] = true;
+
+    JsonDocument doc;
+    error = deserializeJson(doc, in, DeserializationOption::Filter(filter));
+    if (error) return false;
+
+    tokens.clear();
+    JsonObject entries = doc["tokens"];
+    if (!entries) return false;
+
+    tokens.reserve(entries.size());
+    for (JsonPair kv : entries) {
+        models::TokenMetadata token;
+        token.tokenId = String(kv.key().c_str());
+        token.video = kv.value()["video"] | "";
+        // Note: image, audio, processingImage fields removed from v5
+        // Paths are now ALWAYS constructed from tokenId via getImagePath()/getAudioPath()
+        tokens.push_back(token);
+    }
+    return true;
+}
+
+/**
+ * @brief Whether `in` holds one whole JSON object
+ * @param error Set when the JSON does not parse
+ */
+template <typename Reader>
+bool check(Reader& in, DeserializationError& error) {
+    JsonDocument filter;
+    filter["tokens"] = false;
+
+    JsonDocument doc;
+    error = deserializeJson(doc, in, DeserializationOption::Filter(filter));
+    return !error && doc.is<JsonObject>();
+}
+
+} // namespace token_db
+} // namespace services
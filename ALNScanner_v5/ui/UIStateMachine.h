@@ -149,6 +149,7 @@ public:
 
         // Transition and render
         transitionTo(State::DISPLAYING_TOKEN, std::move(screen));
+        _screenTokenId = token.tokenId;
 
         // Reset touch state for double-tap detection
         _lastTouchWasValid = false;
@@ -171,12 +172,13 @@ public:
                  token.tokenId.c_str(), label.c_str());
 
         // Create processing screen with token metadata
-        auto screen = std::unique_ptr<ProcessingScreen>(
-            new ProcessingScreen(token, label, sublabel)
-        );
+        auto* processingScreen = new ProcessingScreen(token, label, sublabel);
+        auto screen = std::unique_ptr<ProcessingScreen>(processingScreen);
 
         // Transition and render
         transitionTo(State::PROCESSING_VIDEO, std::move(screen));
+        _processingScreenPtr = processingScreen;
+        _screenTokenId = token.tokenId;
 
         // Start auto-hide timer
         _processingStartTime = millis();
@@ -216,9 +218,10 @@ public:
     // Handle touch events with WiFi EMI filtering and state routing
     // Source: Touch handling logic lines 3577-3664
     void handleTouch() {
-        // Check for touch interrupt
-        if (!_touch.isTouched()) {
-            // No interrupt - check for expired single-tap timeout
+        // Take the next press that passed the WiFi EMI filter (non-blocking)
+        hal::TouchEvent event;
+        if (!_touch.poll(event)) {
+            // No touch - check for expired single-tap timeout
             if (_lastTouchWasValid &&
                 (millis() - _lastTouchTime) >= timing::DOUBLE_TAP_TIMEOUT_MS) {
                 _lastTouchWasValid = false;  // Clear single-tap flag
@@ -226,17 +229,8 @@ public:
             return;
         }
 
-        // Touch interrupt detected - apply WiFi EMI filter
-        if (!_touch.isValidTouch()) {
-            // EMI rejected - pulse width too brief
-            _touch.clearTouch();
-            return;
-        }
-
-        LOG_INFO("[UI-STATE] Valid touch detected (passed EMI filter)\n");
-
-        // Clear interrupt flag
-        _touch.clearTouch();
+        LOG_INFO("[UI-STATE] Valid touch detected (passed EMI filter, %lums%s)\n",
+                 (unsigned long)(event.widthUs / 1000), event.held ? " held" : "");
 
         // Apply debouncing
         uint32_t now = millis();
@@ -288,6 +282,32 @@ public:
         _statusProvider = std::move(provider);
     }
 
+    // True while tokenId's token display or processing modal is up
+    bool isShowingToken(const String& tokenId) const {
+        return (_state == State::DISPLAYING_TOKEN || _state == State::PROCESSING_VIDEO) &&
+               _screenTokenId == tokenId;
+    }
+
+    // Nothing the player is looking at (ready screen or transient failure)
+    bool isIdle() const {
+        return _state == State::READY || _state == State::SCAN_FAILED;
+    }
+
+    // Late scan outcome: relabel the processing modal if it still shows
+    // tokenId, restarting its auto-hide so the new text can be read
+    bool relabelProcessing(const String& tokenId, const String& label,
+                           const String& sublabel = "") {
+        if (_state != State::PROCESSING_VIDEO || !_processingScreenPtr ||
+            _screenTokenId != tokenId) {
+            return false;
+        }
+        LOG_INFO("[UI-STATE] Relabel PROCESSING_VIDEO (token: %s, label: %s)\n",
+                 tokenId.c_str(), label.c_str());
+        _processingScreenPtr->relabel(_display, label, sublabel);
+        _processingStartTime = millis();
+        return true;
+    }
+
     // Check if UI is blocking RFID scanning
     // Source: lines 3661-3664
     bool isBlockingRFID() const {
@@ -307,6 +327,8 @@ private:
     State _state;
     std::unique_ptr<Screen> _currentScreen;
     TokenDisplayScreen* _tokenScreenPtr;  // Raw pointer for audio updates (no ownership)
+    ProcessingScreen* _processingScreenPtr = nullptr;  // For late relabel (no ownership)
+    String _screenTokenId;  // Token on screen in DISPLAYING_TOKEN / PROCESSING_VIDEO
 
     // Touch handling state (from v4.1 lines 98-104)
     uint32_t _lastTouchTime;
@@ -339,6 +361,8 @@ private:
 
         // Update state
         _state = newState;
+        _processingScreenPtr = nullptr;  // Callers re-set these after the transition
+        _screenTokenId = "";
 
         // Replace screen (old screen auto-destroyed by unique_ptr)
         _currentScreen = std::move(screen);
@@ -8,6 +8,7 @@
  * - WiFi connection status with SSID and local IP
  * - Orchestrator connection state (color-coded)
  * - Queue size with visual status indicators
+ * - RFID scan summary (tokens read / cards seen, p90 scan time, retries)
  * - Team ID and Device ID
  * - User instruction to dismiss screen
  *
@@ -82,6 +83,10 @@ public:
         int maxQueueSize;                   // Queue capacity (typically 100)
         String teamID;                      // Team identifier (e.g., "001")
         String deviceID;                    // Device identifier (e.g., "SCANNER_FLOOR1_001")
+        uint32_t rfidCardsSeen = 0;         // Cards detected (hal::RFIDStats::cardsSeen)
+        uint32_t rfidTokensRead = 0;        // Of those, NDEF read succeeded
+        uint32_t rfidRetries = 0;           // Retries spent across all scans
+        uint32_t rfidScanP90Ms = 0;         // 90th percentile detect->read time
     };
 
     /**
@@ -111,6 +116,9 @@ protected:
      *                              
      *  Queue: [N scans/FULL]       
      *                              
+     *  RFID: [read]/[seen] read    
+     *    p90 [N]ms, [N] retry      
+     *                              
      *  Team: [XXX]                 
      *  Device: [SCANNER_XXX]       
      *                              
@@ -131,6 +139,7 @@ protected:
      * - WiFi: GREEN if connected, RED if disconnected
      * - Orchestrator: GREEN if ORCH_CONNECTED, ORANGE if ORCH_WIFI_CONNECTED, RED otherwise
      * - Queue: GREEN if empty, YELLOW if 1-99, RED if full (>=maxQueueSize)
+     * - RFID: GREEN if every card read, YELLOW if >= 90%, RED below
      * - Labels: WHITE for field names
      * - Instructions: CYAN for user guidance
      */
@@ -192,6 +201,29 @@ protected:
         }
         tft.println("");
 
+        // RFID scan summary (full per-phase table: RFID_STATS on serial)
+        tft.setTextColor(TFT_WHITE, TFT_BLACK);
+        tft.print("RFID: ");
+        if (_status.rfidCardsSeen == 0) {
+            tft.println("no scans yet");
+        } else {
+            uint32_t read = _status.rfidTokensRead;
+            uint32_t seen = _status.rfidCardsSeen;
+            if (read >= seen) {
+                tft.setTextColor(TFT_GREEN, TFT_BLACK);
+            } else if (read * 10 >= seen * 9) {
+                tft.setTextColor(TFT_YELLOW, TFT_BLACK);
+            } else {
+                tft.setTextColor(TFT_RED, TFT_BLACK);
+            }
+            tft.printf("%lu/%lu read\n", (unsigned long)read, (unsigned long)seen);
+            tft.setTextColor(TFT_WHITE, TFT_BLACK);
+            tft.printf("p90 %lums %luR\n",
+                       (unsigned long)_status.rfidScanP90Ms,
+                       (unsigned long)_status.rfidRetries);
+        }
+        tft.println("");
+
         // Team ID (FR-042, lines 2299-2302)
         tft.setTextColor(TFT_WHITE, TFT_BLACK);
         tft.print("Team: ");
@@ -311,7 +343,7 @@ private:
  * Future Enhancements:
  * ====================
  * 1. Add memory usage statistics (free heap, largest block)
- * 2. Add RFID scan statistics (success rate, error counts)
+ * 2. (Done) RFID scan statistics - summary lines, see hal::RFIDStats
  * 3. Add uptime display (time since boot)
  * 4. Add last sync timestamp (when queue was last uploaded)
  * 5. Add scrolling support for long device IDs
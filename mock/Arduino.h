@@ -8,10 +8,15 @@
  * - isDigit() function
  * - F() macro and __FlashStringHelper type
  * - Arduino type aliases (byte, uint8_t, etc.)
+ * - Simulated time (millis, micros, delay, delayMicroseconds) and GPIO
+ *   (pinMode, digitalWrite, digitalRead) with an optional PinDevice hook
+ * - The ESP32 core bits hal/RFIDReader.h touches (portMUX, ESP.getFreeHeap)
+ * - GPIO interrupts (attachInterrupt) fired synchronously by mock::drivePin()
  *
- * NOTE: This does NOT mock hardware APIs (WiFi, SD, SPI, I2S, FreeRTOS).
- * Only models/ headers are testable with this mock. Testing services/ or hal/
- * requires additional mocks (future phase).
+ * NOTE: This does NOT mock WiFi, hardware SPI, I2S or FreeRTOS tasks. SD
+ * lives in mock/SD.h (in-memory or host-directory backed, with a timing model).
+ * Bit-banged peripherals are modelled by attaching a mock::PinDevice — see
+ * mock/MFRC522Emulator.h for the RFID reader.
  */
 
 #include <cstdint>
@@ -66,6 +71,25 @@ public:
         return _buf.compare(0, std::strlen(prefix), prefix) == 0;
     }
     bool startsWith(const String& prefix) const { return startsWith(prefix.c_str()); }
+    int indexOf(char c, unsigned int from = 0) const {
+        size_t pos = _buf.find(c, from);
+        return pos == std::string::npos ? -1 : static_cast<int>(pos);
+    }
+    int indexOf(const char* s, unsigned int from = 0) const {
+        size_t pos = _buf.find(s, from);
+        return pos == std::string::npos ? -1 : static_cast<int>(pos);
+    }
+    int lastIndexOf(char c) const {
+        size_t pos = _buf.rfind(c);
+        return pos == std::string::npos ? -1 : static_cast<int>(pos);
+    }
+    String substring(unsigned int from) const {
+        return from < _buf.length() ? String(_buf.substr(from).c_str()) : String();
+    }
+    String substring(unsigned int from, unsigned int to) const {
+        if (from >= _buf.length() || to <= from) return String();
+        return String(_buf.substr(from, to - from).c_str());
+    }
 
     // Mutation (Arduino String mutates in place, returns void)
     void replace(const char* from, const char* to) {
@@ -120,6 +144,7 @@ public:
     void println(const char*) {}
     void println(const __FlashStringHelper*) {}
     void println(int) {}
+    void flush() {}
     // printf is variadic — use va_list to accept any args
     void printf(const char*, ...) {}
 };
@@ -130,3 +155,105 @@ inline SerialMock Serial;
 // ─── Arduino functions ────────────────────────────────────────────────
 
 inline bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+// ─── Simulated time ───────────────────────────────────────────────────
+// One virtual microsecond clock. delay()/delayMicroseconds() advance it
+// instantly instead of sleeping, so busy-wait timing in hal/ code runs
+// deterministically and a test can read back exactly how much device time
+// an operation would have taken.
+
+namespace mock {
+inline uint64_t nowUs = 0;
+}
+
+inline unsigned long micros() { return static_cast<unsigned long>(mock::nowUs); }
+inline unsigned long millis() { return static_cast<unsigned long>(mock::nowUs / 1000); }
+inline void delayMicroseconds(unsigned int us) { mock::nowUs += us; }
+inline void delay(unsigned long ms) { mock::nowUs += static_cast<uint64_t>(ms) * 1000; }
+inline void yield() {}
+
+// ─── GPIO ─────────────────────────────────────────────────────────────
+// Pin levels are latched locally; if a PinDevice is attached every write
+// is forwarded to it and reads come from it, so a peripheral model can sit
+// on a bit-banged bus (e.g. RFIDReader's software SPI).
+
+#define LOW    0x0
+#define HIGH   0x1
+#define INPUT  0x01
+#define OUTPUT 0x03
+
+namespace mock {
+struct PinDevice {
+    virtual ~PinDevice() = default;
+    virtual void onPinWrite(uint8_t pin, uint8_t level) = 0;
+    virtual int onPinRead(uint8_t pin) = 0;
+};
+
+inline PinDevice* pinDevice = nullptr;
+inline uint8_t pinLevels[40] = {};
+}
+
+inline void pinMode(uint8_t, uint8_t) {}
+
+inline void digitalWrite(uint8_t pin, uint8_t level) {
+    if (pin < sizeof(mock::pinLevels)) mock::pinLevels[pin] = level;
+    if (mock::pinDevice) mock::pinDevice->onPinWrite(pin, level);
+}
+
+inline int digitalRead(uint8_t pin) {
+    if (mock::pinDevice) return mock::pinDevice->onPinRead(pin);
+    return pin < sizeof(mock::pinLevels) ? mock::pinLevels[pin] : LOW;
+}
+
+// ─── GPIO interrupts ──────────────────────────────────────────────────
+// attachInterrupt() records the handler; mock::drivePin() changes an input
+// level and runs the handler inline when the edge matches its mode, as the
+// ISR would on hardware. mock::pulseEdge() fires the handler without a
+// level change (an edge the ISR saw too late to read).
+
+#define IRAM_ATTR
+#define RISING  0x01
+#define FALLING 0x02
+#define CHANGE  0x03
+#define digitalPinToInterrupt(p) (p)
+
+namespace mock {
+inline void (*pinIsr[40])() = {};
+inline int pinIsrMode[40] = {};
+
+inline void drivePin(uint8_t pin, uint8_t level) {
+    uint8_t prev = pinLevels[pin];
+    pinLevels[pin] = level;
+    if (!pinIsr[pin] || prev == level) return;
+    int edge = level ? RISING : FALLING;
+    if (pinIsrMode[pin] & edge) pinIsr[pin]();
+}
+
+inline void pulseEdge(uint8_t pin) {
+    if (pinIsr[pin]) pinIsr[pin]();
+}
+}
+
+inline void attachInterrupt(uint8_t pin, void (*isr)(), int mode) {
+    mock::pinIsr[pin] = isr;
+    mock::pinIsrMode[pin] = mode;
+}
+
+inline void detachInterrupt(uint8_t pin) { mock::pinIsr[pin] = nullptr; }
+
+// ─── ESP32 core subset ────────────────────────────────────────────────
+// Single-threaded host tests: critical sections are no-ops.
+
+typedef struct { int owner; } portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED {0}
+#define portENTER_CRITICAL(mux) ((void)(mux))
+#define portEXIT_CRITICAL(mux) ((void)(mux))
+#define portENTER_CRITICAL_ISR(mux) ((void)(mux))
+#define portEXIT_CRITICAL_ISR(mux) ((void)(mux))
+
+class EspClass {
+public:
+    uint32_t getFreeHeap() { return 200000; }
+};
+
+inline EspClass ESP;
@@ -0,0 +1,442 @@
+#pragma once
+/**
+ * MFRC522 register-level emulator for native RFID tests
+ *
+ * Sits on the bit-banged software SPI that hal/RFIDReader.h drives
+ * (attach() installs it as the mock::PinDevice) and decodes SPI mode 0
+ * frames into register reads/writes, so the real RFIDReader code — retry
+ * loops, reSelect recovery, incremental NDEF read — runs unmodified on
+ * the host against a scripted mock::NtagCard.
+ *
+ * Modelled:
+ * - 64-byte FIFO (FIFODataReg / FIFOLevelReg, FlushBuffer, BufferOvfl)
+ * - ComIrqReg / DivIrqReg with Set1 write semantics
+ * - CRC coprocessor (PCD_CalcCRC, ModeReg CRCPreset, CRCResultReg)
+ * - Timer (TModeReg TAuto + prescaler/reload) -> TimerIRq on silence
+ * - Transceive: BitFramingReg StartSend/TxLastBits, RxIRq, ControlReg
+ *   RxLastBits, ErrorReg Parity/Coll, CollReg CollPos
+ * - Antenna (TxControlReg) gating card power, with a power-up delay
+ * - PCD_SoftReset, VersionReg (0x92)
+ *
+ * Timing uses the mock's virtual clock: SPI costs whatever delays the
+ * reader's bit-banging spends, RF frames cost their 106 kbit/s air time
+ * plus the card's frame delay. Nothing here advances the clock itself, so
+ * micros() deltas around a reader call are the simulated device time.
+ *
+ * Counters (SPI transactions/bytes, register accesses, RF frames, CRC
+ * runs, field-on time) are deterministic for a given script, so tests can
+ * pin down the cost of a scan and catch regressions in the reader.
+ */
+
+#include <Arduino.h>
+#include <MFRC522.h>
+#include <deque>
+#include "NtagCard.h"
+
+namespace mock {
+
+struct MFRC522Counters {
+    uint32_t spiTransactions = 0;     // SS low..high
+    uint32_t spiBytes = 0;            // Bytes clocked, incl. address bytes
+    uint32_t registerReads = 0;
+    uint32_t registerWrites = 0;
+    uint32_t rfFrames = 0;            // Transceive StartSend
+    uint32_t rfTimeouts = 0;          // Frames that ended in TimerIRq
+    uint32_t crcCalcs = 0;
+    uint32_t fieldOnTransitions = 0;
+};
+
+class MFRC522Emulator : public PinDevice {
+public:
+    static constexpr uint32_t CARD_POWER_UP_US = 1000;  // PICC boot after field on
+    static constexpr uint32_t FRAME_DELAY_US = 90;      // PCD->PICC FDT (~86 us)
+    static constexpr uint8_t VERSION = 0x92;
+
+    MFRC522Emulator(uint8_t sck, uint8_t mosi, uint8_t miso, uint8_t ss)
+        : _sck(sck), _mosi(mosi), _miso(miso), _ss(ss) {
+        softReset();
+    }
+
+    ~MFRC522Emulator() { detach(); }
+
+    void attach() { mock::pinDevice = this; }
+    void detach() {
+        if (mock::pinDevice == this) mock::pinDevice = nullptr;
+    }
+
+    // ─── Scripting ──────────────────────────────────────────────────────
+
+    void insertCard(NtagCard* card) {
+        _card = card;
+        if (_card && fieldOn()) {
+            _card->powerOn();
+            _cardPoweredAtUs = mock::nowUs;
+        }
+    }
+
+    void removeCard() {
+        if (_card) _card->powerOff();
+        _card = nullptr;
+    }
+
+    // ─── Inspection ─────────────────────────────────────────────────────
+
+    bool fieldOn() const { return (_regs[R(MFRC522::TxControlReg)] & 0x03) != 0; }
+
+    uint64_t fieldOnTimeUs() const {
+        return _fieldOnTotalUs + (fieldOn() ? mock::nowUs - _fieldOnSinceUs : 0);
+    }
+
+    // Register value without read side effects (FIFO pop etc).
+    uint8_t peek(MFRC522::PCD_Register reg) const { return _regs[R(reg)]; }
+    size_t fifoLevel() const { return _fifo.size(); }
+
+    const MFRC522Counters& counters() const { return _counters; }
+    void resetCounters() {
+        _counters = {};
+        _fieldOnTotalUs = 0;
+        _fieldOnSinceUs = mock::nowUs;
+    }
+
+    // ─── PinDevice ──────────────────────────────────────────────────────
+
+    void onPinWrite(uint8_t pin, uint8_t level) override {
+        if (pin == _ss) {
+            if (level == LOW && !_selected) {
+                _selected = true;
+                _byteIndex = 0;
+                _bitIndex = 0;
+                _inByte = 0;
+                _outByte = 0;
+            } else if (level == HIGH && _selected) {
+                _selected = false;
+                _counters.spiTransactions++;
+            }
+        } else if (pin == _mosi) {
+            _mosiLevel = level;
+        } else if (pin == _sck) {
+            if (level == HIGH && !_sckLevel && _selected) {
+                clockRisingEdge();
+            }
+            _sckLevel = level;
+        }
+    }
+
+    int onPinRead(uint8_t pin) override {
+        if (pin == _miso) return _misoLevel;
+        return pin < sizeof(mock::pinLevels) ? mock::pinLevels[pin] : LOW;
+    }
+
+private:
+    enum class Awaiting { None, Reply, Timer };
+
+    static constexpr uint8_t R(MFRC522::PCD_Register reg) { return reg >> 1; }
+
+    // 106 kbit/s: 128/13.56 MHz per bit = 9.44 us; each byte carries parity.
+    static uint32_t airTimeUs(uint32_t bits) { return (bits * 944 + 99) / 100; }
+
+    static uint32_t frameBits(uint8_t len, uint8_t lastBits) {
+        if (len == 0) return 0;
+        return lastBits ? (len - 1) * 9u + lastBits : len * 9u;
+    }
+
+    // ─── SPI decoding (mode 0, MSB first) ───────────────────────────────
+
+    void clockRisingEdge() {
+        // Output byte for a read is fetched lazily at its first clock, so a
+        // trailing address byte with no following byte (RFIDReader sends
+        // the FIFO address on every multi-read byte) never pops the FIFO.
+        if (_bitIndex == 0 && _byteIndex > 0 && _reading) {
+            _outByte = readRegister(_nextReadAddr);
+        }
+        _misoLevel = (_outByte >> (7 - _bitIndex)) & 0x01;
+        _inByte = static_cast<uint8_t>((_inByte << 1) | (_mosiLevel ? 1 : 0));
+
+        if (++_bitIndex == 8) {
+            byteComplete(_inByte);
+            _bitIndex = 0;
+            _inByte = 0;
+            _byteIndex++;
+        }
+    }
+
+    void byteComplete(uint8_t b) {
+        _counters.spiBytes++;
+        if (_byteIndex == 0) {
+            _reading = (b & 0x80) != 0;
+            _addr = (b >> 1) & 0x3F;
+            _nextReadAddr = _addr;
+            _outByte = 0;
+            return;
+        }
+        if (_reading) {
+            _nextReadAddr = (b >> 1) & 0x3F;
+        } else {
+            writeRegister(_addr, b);
+        }
+    }
+
+    // ─── Register file ──────────────────────────────────────────────────
+
+    void softReset() {
+        bool wasOn = fieldOn();
+        memset(_regs, 0, sizeof(_regs));
+        _regs[R(MFRC522::CommandReg)] = 0x20;
+        _regs[R(MFRC522::ComIEnReg)] = 0x80;
+        _regs[R(MFRC522::ComIrqReg)] = 0x14;
+        _regs[R(MFRC522::Status1Reg)] = 0x21;
+        _regs[R(MFRC522::WaterLevelReg)] = 0x08;
+        _regs[R(MFRC522::ControlReg)] = 0x10;
+        _regs[R(MFRC522::CollReg)] = 0xA0;
+        _regs[R(MFRC522::ModeReg)] = 0x3F;
+        _regs[R(MFRC522::TxControlReg)] = 0x80;
+        _regs[R(MFRC522::TxSelReg)] = 0x10;
+        _regs[R(MFRC522::RxSelReg)] = 0x84;
+        _regs[R(MFRC522::RxThresholdReg)] = 0x84;
+        _regs[R(MFRC522::DemodReg)] = 0x4D;
+        _regs[R(MFRC522::MfTxReg)] = 0x62;
+        _regs[R(MFRC522::SerialSpeedReg)] = 0xEB;
+        _regs[R(MFRC522::CRCResultRegH)] = 0xFF;
+        _regs[R(MFRC522::CRCResultRegL)] = 0xFF;
+        _regs[R(MFRC522::ModWidthReg)] = 0x26;
+        _regs[R(MFRC522::RFCfgReg)] = 0x48;
+        _regs[R(MFRC522::GsNReg)] = 0x88;
+        _regs[R(MFRC522::CWGsPReg)] = 0x20;
+        _regs[R(MFRC522::ModGsPReg)] = 0x20;
+        _regs[R(MFRC522::VersionReg)] = VERSION;
+        _fifo.clear();
+        _command = MFRC522::PCD_Idle;
+        _awaiting = Awaiting::None;
+        if (wasOn) fieldChanged(true);
+    }
+
+    uint8_t readRegister(uint8_t a) {
+        update();
+        _counters.registerReads++;
+        if (a == R(MFRC522::FIFODataReg)) {
+            if (_fifo.empty()) return 0;
+            uint8_t v = _fifo.front();
+            _fifo.pop_front();
+            return v;
+        }
+        if (a == R(MFRC522::FIFOLevelReg)) {
+            return static_cast<uint8_t>(_fifo.size());
+        }
+        return _regs[a];
+    }
+
+    void writeRegister(uint8_t a, uint8_t v) {
+        update();
+        _counters.registerWrites++;
+        switch (a) {
+            case R(MFRC522::CommandReg):
+                _regs[a] = v;
+                executeCommand(v & 0x0F);
+                break;
+
+            case R(MFRC522::ComIrqReg):
+            case R(MFRC522::DivIrqReg):
+                // Set1 (bit 7): 1 = set the marked bits, 0 = clear them
+                if (v & 0x80) _regs[a] |= (v & 0x7F);
+                else _regs[a] &= ~(v & 0x7F);
+                break;
+
+            case R(MFRC522::FIFODataReg):
+                if (_fifo.size() < 64) _fifo.push_back(v);
+                else _regs[R(MFRC522::ErrorReg)] |= 0x10;  // BufferOvfl
+                break;
+
+            case R(MFRC522::FIFOLevelReg):
+                if (v & 0x80) {  // FlushBuffer
+                    _fifo.clear();
+                    _regs[R(MFRC522::ErrorReg)] &= ~0x10;
+                }
+                break;
+
+            case R(MFRC522::BitFramingReg):
+                _regs[a] = v;
+                if ((v & 0x80) && _command == MFRC522::PCD_Transceive &&
+                    _awaiting == Awaiting::None) {
+                    startTransceive();
+                }
+                break;
+
+            case R(MFRC522::TxControlReg): {
+                bool was = fieldOn();
+                _regs[a] = v;
+                if (fieldOn() != was) fieldChanged(was);
+                break;
+            }
+
+            // Read-only
+            case R(MFRC522::ErrorReg):
+            case R(MFRC522::Status1Reg):
+            case R(MFRC522::Status2Reg):
+            case R(MFRC522::CRCResultRegH):
+            case R(MFRC522::CRCResultRegL):
+            case R(MFRC522::VersionReg):
+                break;
+
+            default:
+                _regs[a] = v;
+                break;
+        }
+    }
+
+    void executeCommand(uint8_t cmd) {
+        switch (cmd) {
+            case MFRC522::PCD_Idle:
+                _command = MFRC522::PCD_Idle;
+                _awaiting = Awaiting::None;  // Cancels a pending transceive
+                break;
+
+            case MFRC522::PCD_CalcCRC: {
+                _command = MFRC522::PCD_CalcCRC;
+                static const uint16_t presets[4] = {0x0000, 0x6363, 0xA671, 0xFFFF};
+                uint8_t buf[64];
+                size_t n = 0;
+                while (!_fifo.empty()) {
+                    buf[n++] = _fifo.front();
+                    _fifo.pop_front();
+                }
+                uint16_t crc = crcA(buf, n, presets[_regs[R(MFRC522::ModeReg)] & 0x03]);
+                _regs[R(MFRC522::CRCResultRegL)] = crc & 0xFF;
+                _regs[R(MFRC522::CRCResultRegH)] = crc >> 8;
+                _regs[R(MFRC522::DivIrqReg)] |= 0x04;  // CRCIRq
+                _counters.crcCalcs++;
+                break;
+            }
+
+            case MFRC522::PCD_Transceive:
+                _command = MFRC522::PCD_Transceive;  // Waits for StartSend
+                break;
+
+            case MFRC522::PCD_SoftReset:
+                softReset();
+                break;
+
+            default:
+                _command = cmd;
+                break;
+        }
+    }
+
+    void fieldChanged(bool wasOn) {
+        if (!wasOn) {
+            _counters.fieldOnTransitions++;
+            _fieldOnSinceUs = mock::nowUs;
+            _cardPoweredAtUs = mock::nowUs;
+            if (_card) _card->powerOn();
+        } else {
+            _fieldOnTotalUs += mock::nowUs - _fieldOnSinceUs;
+            if (_card) _card->powerOff();
+            _awaiting = Awaiting::None;
+        }
+    }
+
+    uint32_t timerPeriodUs() const {
+        uint32_t prescaler = ((_regs[R(MFRC522::TModeReg)] & 0x0F) << 8) |
+                             _regs[R(MFRC522::TPrescalerReg)];
+        uint32_t reload = (_regs[R(MFRC522::TReloadRegH)] << 8) |
+                          _regs[R(MFRC522::TReloadRegL)];
+        // (2 * TPrescaler + 1) * (TReload + 1) / 13.56 MHz
+        return static_cast<uint32_t>(
+            (uint64_t)(2 * prescaler + 1) * (reload + 1) * 100 / 1356);
+    }
+
+    // ─── RF ─────────────────────────────────────────────────────────────
+
+    void startTransceive() {
+        uint8_t frame[64];
+        uint8_t len = 0;
+        while (!_fifo.empty()) {
+            frame[len++] = _fifo.front();
+            _fifo.pop_front();
+        }
+        uint8_t lastBits = _regs[R(MFRC522::BitFramingReg)] & 0x07;
+        _regs[R(MFRC522::ErrorReg)] &= 0x10;  // New command clears all but BufferOvfl
+        _counters.rfFrames++;
+
+        uint64_t txEnd = mock::nowUs + airTimeUs(frameBits(len, lastBits));
+        bool cardHears = _card && fieldOn() &&
+                         mock::nowUs >= _cardPoweredAtUs + CARD_POWER_UP_US;
+
+        _reply = CardReply();
+        if (cardHears) {
+            _reply = _card->receive(frame, len, lastBits);
+        }
+
+        if (_reply.present) {
+            _awaiting = Awaiting::Reply;
+            _doneAtUs = txEnd + FRAME_DELAY_US +
+                        airTimeUs(frameBits(_reply.len, _reply.lastBits));
+        } else if (_regs[R(MFRC522::TModeReg)] & 0x80) {  // TAuto
+            _awaiting = Awaiting::Timer;
+            _doneAtUs = txEnd + timerPeriodUs();
+        } else {
+            // No timer: the reader's own millis() timeout has to catch it.
+            _awaiting = Awaiting::None;
+        }
+    }
+
+    void update() {
+        if (_awaiting == Awaiting::None || mock::nowUs < _doneAtUs) return;
+
+        if (_awaiting == Awaiting::Timer) {
+            _regs[R(MFRC522::ComIrqReg)] |= 0x01;  // TimerIRq
+            _counters.rfTimeouts++;
+        } else {
+            for (uint8_t i = 0; i < _reply.len; i++) {
+                if (_fifo.size() < 64) _fifo.push_back(_reply.data[i]);
+                else _regs[R(MFRC522::ErrorReg)] |= 0x10;
+            }
+            uint8_t& control = _regs[R(MFRC522::ControlReg)];
+            control = (control & ~0x07) | (_reply.lastBits & 0x07);
+
+            uint8_t err = 0;
+            if (_reply.parityError) err |= 0x02;
+            if (_reply.collision) {
+                err |= 0x08;
+                uint8_t& coll = _regs[R(MFRC522::CollReg)];
+                coll = (coll & 0x80) | (_reply.collisionPos & 0x1F);
+            }
+            _regs[R(MFRC522::ErrorReg)] |= err;
+            _regs[R(MFRC522::ComIrqReg)] |= 0x20 | (err ? 0x02 : 0);  // RxIRq, ErrIRq
+        }
+        _awaiting = Awaiting::None;
+    }
+
+    // Pins
+    uint8_t _sck, _mosi, _miso, _ss;
+    uint8_t _sckLevel = LOW;
+    uint8_t _mosiLevel = LOW;
+    uint8_t _misoLevel = LOW;
+
+    // SPI frame state
+    bool _selected = false;
+    bool _reading = false;
+    uint8_t _addr = 0;
+    uint8_t _nextReadAddr = 0;
+    uint8_t _byteIndex = 0;
+    uint8_t _bitIndex = 0;
+    uint8_t _inByte = 0;
+    uint8_t _outByte = 0;
+
+    // Chip state
+    uint8_t _regs[64] = {};
+    std::deque<uint8_t> _fifo;
+    uint8_t _command = MFRC522::PCD_Idle;
+    Awaiting _awaiting = Awaiting::None;
+    uint64_t _doneAtUs = 0;
+    CardReply _reply;
+
+    // Field / card
+    NtagCard* _card = nullptr;
+    uint64_t _cardPoweredAtUs = 0;
+    uint64_t _fieldOnSinceUs = 0;
+    uint64_t _fieldOnTotalUs = 0;
+
+    MFRC522Counters _counters;
+};
+
+} // namespace mock
@@ -0,0 +1,395 @@
+#pragma once
+/**
+ * NTAG213/215 card model for native RFID tests
+ *
+ * Frame-level model of an NXP NTAG21x PICC as seen through the MFRC522's
+ * antenna (mock/MFRC522Emulator.h hands it each transmitted frame and
+ * delivers the reply). Covers what hal/RFIDReader.h exercises:
+ *
+ * - ISO 14443-3 state machine: IDLE -> READY1 -> READY2 -> ACTIVE, HALT.
+ *   REQA wakes IDLE only, WUPA wakes IDLE and HALT. Any unexpected or
+ *   corrupt frame in READY/ACTIVE drops the card back to IDLE (or HALT if
+ *   it was woken from HALT) — this is what the reader's reSelect recovery
+ *   has to cope with.
+ * - 7-byte UID over two cascade levels (CT + BCC), SAK 0x04 / 0x00.
+ * - READ (0x30), FAST_READ (0x3A), GET_VERSION (0x60), HLTA (0x50).
+ *   Every command carrying CRC_A is checked; replies append CRC_A (the
+ *   reader runs with hardware RX CRC disabled, so it sees those bytes).
+ *   Out-of-range addresses answer a 4-bit NAK and return to IDLE.
+ *
+ * Fault injection is scripted per command byte (or any frame) with a skip
+ * count, so a test can say "drop power on the 2nd FAST_READ":
+ * - Dropout:     card loses field power mid-frame; no reply, resets to IDLE
+ * - Mute:        card ignores this frame (state unchanged) — weak coupling
+ * - ParityError: reply delivered but the PCD flags a parity error
+ * - Collision:   a second PICC answers at the same time (CollErr)
+ * - Corrupt:     XOR a byte of the reply; parity still passes (silent)
+ */
+
+#include <Arduino.h>
+#include <vector>
+
+namespace mock {
+
+// ISO 14443-3 CRC_A (preset 0x6363), LSB first — shared with the PCD's
+// CRC coprocessor model.
+inline uint16_t crcA(const uint8_t* data, size_t len, uint16_t preset = 0x6363) {
+    uint16_t crc = preset;
+    for (size_t i = 0; i < len; i++) {
+        uint8_t b = data[i] ^ static_cast<uint8_t>(crc & 0xFF);
+        b ^= static_cast<uint8_t>(b << 4);
+        crc = (crc >> 8) ^ (static_cast<uint16_t>(b) << 8) ^
+              (static_cast<uint16_t>(b) << 3) ^ (b >> 4);
+    }
+    return crc;
+}
+
+enum class NtagType { NTAG213, NTAG215 };
+
+enum class CardState { Idle, Ready1, Ready2, Active, Halt };
+
+enum class CardFault { Dropout, Mute, ParityError, Collision, Corrupt };
+
+// What the card put on the air for one frame (before PCD decoding).
+struct CardReply {
+    bool present = false;        // false = silence (PCD timer will fire)
+    uint8_t data[64] = {};
+    uint8_t len = 0;
+    uint8_t lastBits = 0;        // 0 = whole bytes, 4 = NAK
+    bool parityError = false;
+    bool collision = false;
+    uint8_t collisionPos = 0;    // 1-based bit position (CollReg CollPos)
+};
+
+class NtagCard {
+public:
+    static constexpr uint8_t ANY_COMMAND = 0xFF;
+    static constexpr uint8_t NAK_INVALID = 0x0;
+    static constexpr uint8_t NAK_CRC = 0x1;
+
+    explicit NtagCard(NtagType type = NtagType::NTAG215) : _type(type) {
+        static const uint8_t defaultUid[7] = {0x04, 0xA1, 0xB2, 0xC3, 0xD4, 0xE5, 0x80};
+        setUid(defaultUid);
+        formatBlank();
+    }
+
+    // ─── Scripting ──────────────────────────────────────────────────────
+
+    void setUid(const uint8_t uid[7]) {
+        memcpy(_uid, uid, 7);
+        // Pages 0-2 mirror the UID with its two check bytes (BCC0 covers CT).
+        _mem[0] = uid[0]; _mem[1] = uid[1]; _mem[2] = uid[2];
+        _mem[3] = 0x88 ^ uid[0] ^ uid[1] ^ uid[2];
+        _mem[4] = uid[3]; _mem[5] = uid[4]; _mem[6] = uid[5]; _mem[7] = uid[6];
+        _mem[8] = uid[3] ^ uid[4] ^ uid[5] ^ uid[6];
+    }
+    const uint8_t* uid() const { return _uid; }
+
+    uint16_t pageCount() const { return _type == NtagType::NTAG213 ? 45 : 135; }
+    uint16_t userBytes() const { return _type == NtagType::NTAG213 ? 144 : 504; }
+
+    // Factory state: CC on page 3, empty NDEF TLV on page 4.
+    void formatBlank() {
+        memset(_mem + 9, 0, sizeof(_mem) - 9);
+        _mem[12] = 0xE1; _mem[13] = 0x10;
+        _mem[14] = static_cast<uint8_t>(userBytes() / 8); _mem[15] = 0x00;
+        _mem[16] = 0x03; _mem[17] = 0x00; _mem[18] = 0xFE;
+    }
+
+    // Single well-known Text record (lang "en") — what the tools write.
+    void writeNdefText(const char* text) {
+        std::vector<uint8_t> rec;
+        size_t textLen = strlen(text);
+        size_t payloadLen = 1 + 2 + textLen;
+        bool shortRecord = payloadLen <= 255;
+        rec.push_back(shortRecord ? 0xD1 : 0xC1);
+        rec.push_back(0x01);
+        if (shortRecord) {
+            rec.push_back(static_cast<uint8_t>(payloadLen));
+        } else {
+            for (int shift = 24; shift >= 0; shift -= 8) {
+                rec.push_back(static_cast<uint8_t>(payloadLen >> shift));
+            }
+        }
+        rec.push_back('T');
+        rec.push_back(0x02); rec.push_back('e'); rec.push_back('n');
+        rec.insert(rec.end(), text, text + textLen);
+        writeNdefMessage(rec.data(), rec.size());
+    }
+
+    // Wrap raw NDEF message bytes in a Message TLV + Terminator at page 4.
+    void writeNdefMessage(const uint8_t* msg, size_t len) {
+        std::vector<uint8_t> tlv;
+        tlv.push_back(0x03);
+        if (len < 0xFF) {
+            tlv.push_back(static_cast<uint8_t>(len));
+        } else {
+            tlv.push_back(0xFF);
+            tlv.push_back(static_cast<uint8_t>(len >> 8));
+            tlv.push_back(static_cast<uint8_t>(len));
+        }
+        tlv.insert(tlv.end(), msg, msg + len);
+        tlv.push_back(0xFE);
+        writeUserMemory(tlv.data(), tlv.size());
+    }
+
+    // Raw bytes from page 4 (after the CC).
+    void writeUserMemory(const uint8_t* bytes, size_t len) {
+        memset(_mem + 16, 0, userBytes());
+        memcpy(_mem + 16, bytes, len < userBytes() ? len : userBytes());
+    }
+
+    void writePage(uint8_t page, const uint8_t bytes[4]) {
+        if (page < pageCount()) memcpy(_mem + page * 4, bytes, 4);
+    }
+
+    /**
+     * Schedule a fault on frames whose first byte is `command` (or any
+     * frame with ANY_COMMAND). The first `skip` matching frames pass
+     * untouched, the next `count` are faulted. Corrupt XORs reply byte
+     * `byteIndex` with `xorMask`.
+     */
+    void injectFault(CardFault kind, uint8_t command = ANY_COMMAND,
+                     uint16_t skip = 0, uint16_t count = 1,
+                     uint8_t byteIndex = 0, uint8_t xorMask = 0x01) {
+        _faults.push_back({kind, command, skip, count, byteIndex, xorMask});
+    }
+    void clearFaults() { _faults.clear(); }
+
+    // ─── Field coupling (driven by the PCD model) ───────────────────────
+
+    void powerOn() { _state = CardState::Idle; _fromHalt = false; }
+    void powerOff() { _state = CardState::Idle; _fromHalt = false; }
+
+    CardState state() const { return _state; }
+
+    // Frame counters, for asserting on reader behaviour.
+    uint32_t framesReceived = 0;
+    uint32_t fastReads = 0;
+    uint32_t reads = 0;
+    uint32_t halts = 0;
+    uint32_t wakeups = 0;
+
+    /**
+     * Handle one frame from the PCD. `lastBits` is TxLastBits (0 = whole
+     * bytes). Returns what the card (and any injected interference) put
+     * on the air.
+     */
+    CardReply receive(const uint8_t* frame, uint8_t len, uint8_t lastBits) {
+        framesReceived++;
+        CardReply reply;
+        if (len == 0) return reply;
+
+        Fault* fault = matchFault(frame[0]);
+        if (fault && fault->kind == CardFault::Dropout) {
+            powerOff();
+            return reply;
+        }
+        if (fault && fault->kind == CardFault::Mute) {
+            return reply;
+        }
+
+        reply = respond(frame, len, lastBits);
+
+        if (fault && reply.present) {
+            switch (fault->kind) {
+                case CardFault::ParityError:
+                    reply.parityError = true;
+                    break;
+                case CardFault::Collision:
+                    reply.collision = true;
+                    reply.collisionPos = 1 + (fault->byteIndex % reply.len) * 8;
+                    break;
+                case CardFault::Corrupt:
+                    if (fault->byteIndex < reply.len) {
+                        reply.data[fault->byteIndex] ^= fault->xorMask;
+                    }
+                    break;
+                default:
+                    break;
+            }
+        }
+        return reply;
+    }
+
+private:
+    struct Fault {
+        CardFault kind;
+        uint8_t command;
+        uint16_t skip;
+        uint16_t count;
+        uint8_t byteIndex;
+        uint8_t xorMask;
+    };
+
+    Fault* matchFault(uint8_t command) {
+        for (auto& f : _faults) {
+            if (f.count == 0) continue;
+            if (f.command != ANY_COMMAND && f.command != command) continue;
+            if (f.skip > 0) { f.skip--; continue; }
+            f.count--;
+            return &f;
+        }
+        return nullptr;
+    }
+
+    static bool crcOk(const uint8_t* frame, uint8_t len) {
+        if (len < 3) return false;
+        uint16_t crc = crcA(frame, len - 2);
+        return frame[len - 2] == (crc & 0xFF) && frame[len - 1] == (crc >> 8);
+    }
+
+    static void appendCrc(CardReply& r) {
+        uint16_t crc = crcA(r.data, r.len);
+        r.data[r.len++] = crc & 0xFF;
+        r.data[r.len++] = crc >> 8;
+    }
+
+    // Unexpected frame: back to IDLE (or HALT), no answer.
+    CardReply reject() {
+        _state = _fromHalt ? CardState::Halt : CardState::Idle;
+        return CardReply();
+    }
+
+    CardReply nak(uint8_t code) {
+        CardReply r;
+        r.present = true;
+        r.data[0] = code;
+        r.len = 1;
+        r.lastBits = 4;
+        _state = _fromHalt ? CardState::Halt : CardState::Idle;
+        return r;
+    }
+
+    CardReply respond(const uint8_t* frame, uint8_t len, uint8_t lastBits) {
+        CardReply r;
+        uint8_t cmd = frame[0];
+
+        // Short frame (7 bits): REQA / WUPA
+        if (len == 1 && lastBits == 7) {
+            bool wake = (cmd == 0x26 && _state == CardState::Idle) ||
+                        (cmd == 0x52 && (_state == CardState::Idle || _state == CardState::Halt));
+            if (!wake) {
+                if (_state != CardState::Idle && _state != CardState::Halt) reject();
+                return r;
+            }
+            _fromHalt = (_state == CardState::Halt);
+            _state = CardState::Ready1;
+            wakeups++;
+            r.present = true;
+            r.data[0] = 0x44; r.data[1] = 0x00;  // ATQA NTAG21x
+            r.len = 2;
+            return r;
+        }
+
+        switch (_state) {
+            case CardState::Idle:
+            case CardState::Halt:
+                return r;  // Only REQA/WUPA are heard
+
+            case CardState::Ready1:
+            case CardState::Ready2: {
+                bool cl1 = (_state == CardState::Ready1);
+                uint8_t sel = cl1 ? 0x93 : 0x95;
+                uint8_t uidPart[5];
+                if (cl1) {
+                    uidPart[0] = 0x88; uidPart[1] = _uid[0];
+                    uidPart[2] = _uid[1]; uidPart[3] = _uid[2];
+                } else {
+                    memcpy(uidPart, _uid + 3, 4);
+                }
+                uidPart[4] = uidPart[0] ^ uidPart[1] ^ uidPart[2] ^ uidPart[3];
+
+                if (cmd != sel) return reject();
+                if (len == 2 && frame[1] == 0x20) {          // ANTICOLLISION
+                    r.present = true;
+                    memcpy(r.data, uidPart, 5);
+                    r.len = 5;
+                    return r;
+                }
+                if (len == 9 && frame[1] == 0x70) {          // SELECT
+                    if (!crcOk(frame, len) || memcmp(frame + 2, uidPart, 5) != 0) {
+                        return reject();
+                    }
+                    r.present = true;
+                    r.data[0] = cl1 ? 0x04 : 0x00;           // cascade bit on CL1
+                    r.len = 1;
+                    appendCrc(r);
+                    _state = cl1 ? CardState::Ready2 : CardState::Active;
+                    return r;
+                }
+                return reject();
+            }
+
+            case CardState::Active:
+                return respondActive(frame, len);
+        }
+        return r;
+    }
+
+    CardReply respondActive(const uint8_t* frame, uint8_t len) {
+        CardReply r;
+        uint8_t cmd = frame[0];
+
+        if (cmd == 0x50 && len == 4) {                       // HLTA
+            if (!crcOk(frame, len)) return reject();
+            halts++;
+            _state = CardState::Halt;
+            return r;                                        // never answers
+        }
+        if (len < 3) return reject();
+        if (!crcOk(frame, len)) return nak(NAK_CRC);
+
+        switch (cmd) {
+            case 0x30: {                                     // READ (4 pages)
+                if (len != 4) return reject();
+                uint8_t page = frame[1];
+                if (page >= pageCount()) return nak(NAK_INVALID);
+                reads++;
+                for (int i = 0; i < 16; i++) {
+                    r.data[i] = _mem[((page * 4 + i) % (pageCount() * 4))];
+                }
+                r.len = 16;
+                break;
+            }
+            case 0x3A: {                                     // FAST_READ
+                if (len != 5) return reject();
+                uint8_t start = frame[1], end = frame[2];
+                if (start > end || end >= pageCount()) return nak(NAK_INVALID);
+                size_t bytes = (end - start + 1) * 4;
+                if (bytes + 2 > sizeof(r.data)) {
+                    // Larger than the model's air buffer; the real reader
+                    // never asks for this (64-byte PCD FIFO).
+                    bytes = sizeof(r.data) - 2;
+                }
+                fastReads++;
+                memcpy(r.data, _mem + start * 4, bytes);
+                r.len = static_cast<uint8_t>(bytes);
+                break;
+            }
+            case 0x60: {                                     // GET_VERSION
+                if (len != 3) return reject();
+                const uint8_t v[8] = {0x00, 0x04, 0x04, 0x02, 0x01, 0x00,
+                                      static_cast<uint8_t>(_type == NtagType::NTAG213 ? 0x0F : 0x11),
+                                      0x03};
+                memcpy(r.data, v, 8);
+                r.len = 8;
+                break;
+            }
+            default:
+                return reject();
+        }
+        r.present = true;
+        appendCrc(r);
+        return r;
+    }
+
+    NtagType _type;
+    uint8_t _uid[7] = {};
+    uint8_t _mem[135 * 4] = {};
+    CardState _state = CardState::Idle;
+    bool _fromHalt = false;
+    std::vector<Fault> _faults;
+};
+
+} // namespace mock
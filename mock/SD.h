@@ -0,0 +1,488 @@
+#pragma once
+/**
+ * SD / File mock for PlatformIO native testing
+ *
+ * Filesystem with the subset of the ESP32 fs::File / SDFS API the storage
+ * code uses: open with "r", "w", "a" and "r+" modes, seek, block read/write,
+ * println/readStringUntil for line-oriented files, exists, mkdir, remove and
+ * rename. Seeking past the end of a writable file extends it, as FATFS
+ * f_lseek does. Every handle onto the same path shares one file, as FATFS
+ * does for a file that is open twice.
+ *
+ * Two backends:
+ * - In-memory (default): files live in mock::sdFiles, which tests may poke
+ *   directly. Directories are not modelled.
+ * - Host directory: mock::sdMountHost(dir) roots "/" in a real directory
+ *   (mock::sdMakeTempRoot() creates one under the system temp dir). Files
+ *   are real, survive handle loss, and can be large. Closer to FATFS:
+ *   opening for write in a missing directory fails, and rename fails if the
+ *   destination exists.
+ *
+ * mock::sdStats counts opens, bytes moved and namespace operations so tests
+ * can compare the SD traffic of two implementations without hardware.
+ * mock::sdTiming charges a per-operation cost to the virtual clock
+ * (mock::nowUs), so micros() deltas around a storage path approximate its
+ * on-device time; see mock::SD_SPI_4MHZ / SD_SPI_20MHZ. The default timing
+ * is free, which keeps tests that do not opt in unaffected.
+ *
+ * Power-loss injection: mock::sdArmPowerCut(n) makes the n-th mutating
+ * operation (write, flush, closing a writable handle, seek-extend, opening
+ * for "w"/"a", remove, rename, mkdir) fail as the power goes out. A write
+ * that is cut lands half its bytes first (torn write). After the cut every
+ * call fails, and each file opened for writing loses whatever it grew by
+ * since its last flush()/close(), as FATFS only records a new size in the
+ * directory entry on f_sync. mock::sdPowerRestore() is the reboot.
+ * mock::sdFault.ops counts mutating operations whether armed or not.
+ */
+
+#include <Arduino.h>
+#include <algorithm>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <vector>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define FILE_READ   "r"
+#define FILE_WRITE  "w"
+#define FILE_APPEND "a"
+
+namespace mock {
+
+struct SDStats {
+    uint32_t opens = 0;
+    uint64_t bytesRead = 0;
+    uint64_t bytesWritten = 0;
+    uint32_t flushes = 0;
+    uint32_t removes = 0;
+    uint32_t renames = 0;
+    uint32_t mkdirs = 0;
+    uint64_t busyUs = 0;     // Time charged by sdTiming
+};
+
+/**
+ * Cost model: fixed per-operation latency plus a per-byte transfer time.
+ * Reads and writes also pay perCallUs each (command/response framing and
+ * FATFS bookkeeping for one f_read/f_write).
+ */
+struct SDTiming {
+    uint32_t openUs = 0;          // Directory walk + FAT lookup
+    uint32_t flushUs = 0;         // f_sync: FAT + directory entry writeback
+    uint32_t namespaceUs = 0;     // remove / rename / mkdir
+    uint32_t perCallUs = 0;
+    uint32_t readBytesPerSec = 0;  // 0 = free
+    uint32_t writeBytesPerSec = 0;
+};
+
+// SPI delivers clock/8 bytes/s at best; framing, CRC and inter-block gaps
+// take roughly a quarter of that on reads, and card program-busy time about
+// half on writes. Latencies are dominated by the sectors each op touches.
+inline constexpr SDTiming SD_SPI_4MHZ  { 2500, 3000, 5000, 60, 380000, 260000 };
+inline constexpr SDTiming SD_SPI_20MHZ {  900, 1500, 2500, 20, 1800000, 1100000 };
+
+struct SDFault {
+    uint32_t ops = 0;        // Mutating operations since arm/restore
+    uint32_t cutAt = 0;      // Power fails during this op (0 = never)
+    uint32_t failAt = 0;     // This op alone fails; the card keeps working
+    bool powerLost = false;
+};
+
+inline SDStats sdStats;
+inline SDTiming sdTiming;
+inline SDFault sdFault;
+inline std::map<std::string, std::shared_ptr<std::vector<uint8_t>>> sdFiles;
+inline std::string sdHostRoot;   // Empty = in-memory backend
+inline std::map<std::string, size_t> sdSyncedSize;  // File key -> size on last sync
+
+inline void sdCharge(uint64_t us) {
+    nowUs += us;
+    sdStats.busyUs += us;
+}
+
+inline uint64_t sdTransferUs(size_t bytes, uint32_t bytesPerSec) {
+    return bytesPerSec ? static_cast<uint64_t>(bytes) * 1000000 / bytesPerSec : 0;
+}
+
+inline std::string sdHostPath(const char* path) {
+    return sdHostRoot + (path[0] == '/' ? "" : "/") + path;
+}
+
+// Root the mock in a host directory ("" switches back to in-memory)
+inline void sdMountHost(const std::string& dir) { sdHostRoot = dir; }
+
+// Fresh directory under the system temp dir, for sdMountHost()
+inline std::string sdMakeTempRoot() {
+    std::string tmpl = (std::filesystem::temp_directory_path() / "sdmock-XXXXXX").string();
+    std::vector<char> buf(tmpl.begin(), tmpl.end());
+    buf.push_back('\0');
+    return mkdtemp(buf.data()) ? std::string(buf.data()) : std::string();
+}
+
+// Drop every file and zero the counters (host root is emptied, not removed)
+inline void sdReset() {
+    sdFiles.clear();
+    if (!sdHostRoot.empty()) {
+        std::error_code ec;
+        for (const auto& e : std::filesystem::directory_iterator(sdHostRoot, ec)) {
+            std::filesystem::remove_all(e.path(), ec);
+        }
+    }
+    sdStats = SDStats();
+    sdFault = SDFault();
+    sdSyncedSize.clear();
+}
+
+// Identity of a file across renames: buffer address or host dev:inode
+inline std::string sdMemKey(const std::vector<uint8_t>* data) {
+    return "m" + std::to_string(reinterpret_cast<uintptr_t>(data));
+}
+
+inline std::string sdHostKey(const struct stat& st) {
+    return "h" + std::to_string(st.st_dev) + ":" + std::to_string(st.st_ino);
+}
+
+// Power goes out: unsynced growth of every tracked file is lost
+inline void sdPowerCut() {
+    sdFault.powerLost = true;
+    for (auto& kv : sdFiles) {
+        auto it = sdSyncedSize.find(sdMemKey(kv.second.get()));
+        if (it != sdSyncedSize.end() && kv.second->size() > it->second) {
+            kv.second->resize(it->second);
+        }
+    }
+    if (sdHostRoot.empty()) return;
+    std::error_code ec;
+    for (const auto& e : std::filesystem::recursive_directory_iterator(sdHostRoot, ec)) {
+        struct stat st;
+        if (stat(e.path().c_str(), &st) != 0 || !S_ISREG(st.st_mode)) continue;
+        auto it = sdSyncedSize.find(sdHostKey(st));
+        if (it != sdSyncedSize.end() && static_cast<size_t>(st.st_size) > it->second) {
+            truncate(e.path().c_str(), static_cast<off_t>(it->second));
+        }
+    }
+}
+
+// Gate for a mutating operation: false if it must not take effect
+inline bool sdMutation() {
+    if (sdFault.powerLost) return false;
+    if (++sdFault.ops == sdFault.cutAt) {
+        sdPowerCut();
+        return false;
+    }
+    return sdFault.ops != sdFault.failAt;
+}
+
+inline bool sdNextOpCuts() {
+    return !sdFault.powerLost && sdFault.cutAt != 0 && sdFault.ops + 1 == sdFault.cutAt;
+}
+
+// Cut power during mutating op n (1-based) from now; 0 only counts ops
+inline void sdArmPowerCut(uint32_t n) {
+    sdFault = SDFault();
+    sdFault.cutAt = n;
+}
+
+// Fail mutating op n (1-based) from now, as a write error the card survives
+inline void sdArmWriteFailure(uint32_t n) {
+    sdFault = SDFault();
+    sdFault.failAt = n;
+}
+
+inline bool sdPowerLost() { return sdFault.powerLost; }
+
+// Reboot: the card answers again, with whatever survived
+inline void sdPowerRestore() {
+    sdFault = SDFault();
+    sdSyncedSize.clear();
+}
+
+// Unmount and delete the host root
+inline void sdUnmountHost() {
+    if (!sdHostRoot.empty()) {
+        std::error_code ec;
+        std::filesystem::remove_all(sdHostRoot, ec);
+    }
+    sdHostRoot.clear();
+}
+
+// Owns a host file descriptor shared by every handle opened on it
+struct HostFd {
+    int fd;
+    explicit HostFd(int f) : fd(f) {}
+    ~HostFd() { if (fd >= 0) ::close(fd); }
+};
+
+} // namespace mock
+
+enum SeekMode { SeekSet = 0, SeekCur = 1, SeekEnd = 2 };
+
+class File {
+public:
+    File() = default;
+    File(std::shared_ptr<std::vector<uint8_t>> data, bool writable, bool append)
+        : _data(std::move(data)), _writable(writable), _append(append) {}
+    File(std::shared_ptr<mock::HostFd> host, bool writable, bool append)
+        : _host(std::move(host)), _writable(writable), _append(append) {}
+
+    explicit operator bool() const { return _data != nullptr || _host != nullptr; }
+
+    size_t size() const {
+        if (_host) {
+            struct stat st;
+            return fstat(_host->fd, &st) == 0 ? static_cast<size_t>(st.st_size) : 0;
+        }
+        return _data ? _data->size() : 0;
+    }
+
+    size_t position() const { return _pos; }
+    int available() { return *this ? static_cast<int>(size() - _pos) : 0; }
+
+    bool seek(uint32_t pos, SeekMode mode = SeekSet) {
+        if (!*this || mock::sdFault.powerLost) return false;
+        size_t end = size();
+        size_t base = mode == SeekSet ? 0 : mode == SeekCur ? _pos : end;
+        if (base + pos > end) {
+            // FATFS extends a file opened for writing (contents undefined)
+            if (!_writable || !mock::sdMutation() || !resize(base + pos)) return false;
+        }
+        _pos = base + pos;
+        return true;
+    }
+
+    size_t read(uint8_t* buf, size_t len) {
+        if (!*this || mock::sdFault.powerLost) return 0;
+        size_t n = 0;
+        if (_host) {
+            ssize_t r = pread(_host->fd, buf, len, static_cast<off_t>(_pos));
+            n = r > 0 ? static_cast<size_t>(r) : 0;
+        } else if (_pos < _data->size()) {
+            n = std::min(len, _data->size() - _pos);
+            memcpy(buf, _data->data() + _pos, n);
+        }
+        _pos += n;
+        mock::sdStats.bytesRead += n;
+        mock::sdCharge(mock::sdTiming.perCallUs +
+                       mock::sdTransferUs(n, mock::sdTiming.readBytesPerSec));
+        return n;
+    }
+
+    int read() {
+        uint8_t b;
+        return read(&b, 1) == 1 ? b : -1;
+    }
+
+    // Stream::readBytes (ArduinoJson reads a File through it)
+    size_t readBytes(char* buf, size_t len) {
+        return read(reinterpret_cast<uint8_t*>(buf), len);
+    }
+
+    size_t write(const uint8_t* buf, size_t len) {
+        if (!*this || !_writable) return 0;
+        if (_append) _pos = size();
+        if (mock::sdNextOpCuts()) rawWrite(buf, len / 2);  // Torn write
+        if (!mock::sdMutation()) return 0;
+        len = rawWrite(buf, len);
+        _pos += len;
+        mock::sdStats.bytesWritten += len;
+        mock::sdCharge(mock::sdTiming.perCallUs +
+                       mock::sdTransferUs(len, mock::sdTiming.writeBytesPerSec));
+        return len;
+    }
+
+    size_t write(uint8_t b) { return write(&b, 1); }
+
+    size_t print(const String& s) {
+        return write(reinterpret_cast<const uint8_t*>(s.c_str()), s.length());
+    }
+
+    size_t println(const String& s) { return print(s) + write('\n'); }
+
+    String readStringUntil(char terminator) {
+        std::string out;
+        int c;
+        while ((c = read()) >= 0 && c != terminator) {
+            out += static_cast<char>(c);
+        }
+        return String(out.c_str());
+    }
+
+    void flush() {
+        if (!*this) return;
+        mock::sdStats.flushes++;
+        mock::sdCharge(mock::sdTiming.flushUs);
+        if (_writable && mock::sdMutation()) markSynced(true);
+    }
+
+    // Closing a writable handle is an f_sync
+    void close() {
+        if (*this && _writable && mock::sdMutation()) markSynced(true);
+        _data.reset();
+        _host.reset();
+        _pos = 0;
+    }
+
+    // Start tracking unsynced growth (overwrite = after a truncating open)
+    void markSynced(bool overwrite) {
+        std::string key = syncKey();
+        if (overwrite) {
+            mock::sdSyncedSize[key] = size();
+        } else {
+            mock::sdSyncedSize.emplace(key, size());
+        }
+    }
+
+private:
+    std::shared_ptr<std::vector<uint8_t>> _data;
+    std::shared_ptr<mock::HostFd> _host;
+    size_t _pos = 0;
+    bool _writable = false;
+    bool _append = false;
+
+    bool resize(size_t n) {
+        if (_host) return ftruncate(_host->fd, static_cast<off_t>(n)) == 0;
+        _data->resize(n);
+        return true;
+    }
+
+    size_t rawWrite(const uint8_t* buf, size_t len) {
+        if (_host) {
+            ssize_t w = pwrite(_host->fd, buf, len, static_cast<off_t>(_pos));
+            return w < 0 ? 0 : static_cast<size_t>(w);
+        }
+        if (_pos + len > _data->size()) _data->resize(_pos + len);
+        memcpy(_data->data() + _pos, buf, len);
+        return len;
+    }
+
+    std::string syncKey() const {
+        if (!_host) return mock::sdMemKey(_data.get());
+        struct stat st;
+        fstat(_host->fd, &st);
+        return mock::sdHostKey(st);
+    }
+};
+
+class SDMock {
+public:
+    File open(const char* path, const char* mode = FILE_READ) {
+        mock::sdStats.opens++;
+        mock::sdCharge(mock::sdTiming.openUs);
+        std::string m(mode);
+        if (mock::sdFault.powerLost) return File();
+        if ((m == "w" || m == "a") && !mock::sdMutation()) return File();
+        File f = mock::sdHostRoot.empty() ? openMemory(path, m) : openHost(path, m);
+        if (f && m != "r") f.markSynced(m == "w");
+        return f;
+    }
+
+    File open(const String& path, const char* mode = FILE_READ) {
+        return open(path.c_str(), mode);
+    }
+
+    bool exists(const char* path) {
+        if (mock::sdFault.powerLost) return false;
+        if (!mock::sdHostRoot.empty()) {
+            std::error_code ec;
+            return std::filesystem::exists(mock::sdHostPath(path), ec);
+        }
+        return mock::sdFiles.count(path) > 0;
+    }
+    bool exists(const String& path) { return exists(path.c_str()); }
+
+    // In-memory backend has no directories, so mkdir always succeeds there
+    bool mkdir(const char* path) {
+        mock::sdStats.mkdirs++;
+        mock::sdCharge(mock::sdTiming.namespaceUs);
+        if (!mock::sdMutation()) return false;
+        if (mock::sdHostRoot.empty()) return true;
+        std::error_code ec;
+        std::filesystem::create_directory(mock::sdHostPath(path), ec);
+        return std::filesystem::is_directory(mock::sdHostPath(path), ec);
+    }
+    bool mkdir(const String& path) { return mkdir(path.c_str()); }
+
+    bool remove(const char* path) {
+        mock::sdStats.removes++;
+        mock::sdCharge(mock::sdTiming.namespaceUs);
+        if (!mock::sdMutation()) return false;
+        if (!mock::sdHostRoot.empty()) {
+            std::error_code ec;
+            std::string p = mock::sdHostPath(path);
+            struct stat st;
+            if (stat(p.c_str(), &st) != 0 || S_ISDIR(st.st_mode)) return false;
+            mock::sdSyncedSize.erase(mock::sdHostKey(st));  // inode may be reused
+            return std::filesystem::remove(p, ec);
+        }
+        auto it = mock::sdFiles.find(path);
+        if (it == mock::sdFiles.end()) return false;
+        mock::sdSyncedSize.erase(mock::sdMemKey(it->second.get()));
+        mock::sdFiles.erase(it);
+        return true;
+    }
+    bool remove(const String& path) { return remove(path.c_str()); }
+
+    bool rename(const char* from, const char* to) {
+        mock::sdStats.renames++;
+        mock::sdCharge(mock::sdTiming.namespaceUs);
+        if (!mock::sdMutation()) return false;
+        if (!mock::sdHostRoot.empty()) {
+            // FATFS f_rename refuses to replace an existing entry
+            std::error_code ec;
+            std::string src = mock::sdHostPath(from), dst = mock::sdHostPath(to);
+            if (!std::filesystem::exists(src, ec) || std::filesystem::exists(dst, ec)) {
+                return false;
+            }
+            std::filesystem::rename(src, dst, ec);
+            return !ec;
+        }
+        auto it = mock::sdFiles.find(from);
+        if (it == mock::sdFiles.end()) return false;
+        mock::sdFiles[to] = it->second;
+        mock::sdFiles.erase(from);
+        return true;
+    }
+    bool rename(const String& from, const String& to) {
+        return rename(from.c_str(), to.c_str());
+    }
+
+private:
+    File openMemory(const char* path, const std::string& m) {
+        auto it = mock::sdFiles.find(path);
+        if (m == "r" || m == "r+") {
+            if (it == mock::sdFiles.end()) return File();
+            return File(it->second, m == "r+", false);
+        }
+
+        // "w" truncates/creates, "a" creates and always writes at the end
+        if (it == mock::sdFiles.end()) {
+            it = mock::sdFiles.emplace(path, std::make_shared<std::vector<uint8_t>>()).first;
+        } else if (m == "w") {
+            it->second->clear();
+        }
+        File f(it->second, true, m == "a");
+        if (m == "a") f.seek(0, SeekEnd);
+        return f;
+    }
+
+    File openHost(const char* path, const std::string& m) {
+        std::string p = mock::sdHostPath(path);
+        std::error_code ec;
+        if (std::filesystem::is_directory(p, ec)) return File();
+
+        int flags = m == "r"  ? O_RDONLY
+                  : m == "r+" ? O_RDWR
+                  : m == "w"  ? O_RDWR | O_CREAT | O_TRUNC
+                  :             O_RDWR | O_CREAT;
+        int fd = ::open(p.c_str(), flags, 0644);
+        if (fd < 0) return File();
+        File f(std::make_shared<mock::HostFd>(fd), m != "r", m == "a");
+        if (m == "a") f.seek(0, SeekEnd);
+        return f;
+    }
+};
+
+inline SDMock SD;
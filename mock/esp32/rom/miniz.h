@@ -0,0 +1,87 @@
+#pragma once
+/**
+ * ESP32 ROM miniz (tinfl) mock for PlatformIO native testing
+ *
+ * Only what services/GzipStream.h calls: tinfl_init() and tinfl_decompress()
+ * with a wrapping TINFL_LZ_DICT_SIZE output window and
+ * TINFL_FLAG_HAS_MORE_INPUT. Constants and signatures are copied from the
+ * ROM header; the inflating is done by the host zlib (link with -lz). zlib
+ * keeps its own history, so the window is only an output buffer here, and
+ * unlike tinfl it never reads past the end of the deflate data.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <zlib.h>
+
+typedef unsigned char mz_uint8;
+typedef uint32_t mz_uint32;
+
+#define TINFL_LZ_DICT_SIZE 32768
+
+enum {
+    TINFL_FLAG_PARSE_ZLIB_HEADER = 1,
+    TINFL_FLAG_HAS_MORE_INPUT = 2,
+    TINFL_FLAG_USING_NON_WRAPPING_OUTPUT_BUF = 4,
+    TINFL_FLAG_COMPUTE_ADLER32 = 8
+};
+
+typedef enum {
+    TINFL_STATUS_BAD_PARAM = -3,
+    TINFL_STATUS_ADLER32_MISMATCH = -2,
+    TINFL_STATUS_FAILED = -1,
+    TINFL_STATUS_DONE = 0,
+    TINFL_STATUS_NEEDS_MORE_INPUT = 1,
+    TINFL_STATUS_HAS_MORE_OUTPUT = 2
+} tinfl_status;
+
+struct tinfl_decompressor {
+    mz_uint32 m_state = 0;  // 0 = tinfl_init() since the last call
+    z_stream zs = {};
+    bool open = false;
+    bool done = false;
+
+    ~tinfl_decompressor() {
+        if (open) inflateEnd(&zs);
+    }
+};
+
+#define tinfl_init(r) ((r)->m_state = 0)
+
+inline tinfl_status tinfl_decompress(tinfl_decompressor* r, const mz_uint8* pIn_buf_next,
+                                     size_t* pIn_buf_size, mz_uint8* pOut_buf_start,
+                                     mz_uint8* pOut_buf_next, size_t* pOut_buf_size,
+                                     const mz_uint32 decomp_flags) {
+    (void)pOut_buf_start;
+    if (r->m_state == 0) {
+        if (r->open) inflateEnd(&r->zs);
+        r->zs = z_stream();
+        int windowBits = (decomp_flags & TINFL_FLAG_PARSE_ZLIB_HEADER) ? 15 : -15;
+        r->open = inflateInit2(&r->zs, windowBits) == Z_OK;
+        if (!r->open) return TINFL_STATUS_FAILED;
+        r->m_state = 1;
+        r->done = false;
+    }
+    if (r->done) {
+        *pIn_buf_size = 0;
+        *pOut_buf_size = 0;
+        return TINFL_STATUS_DONE;
+    }
+
+    r->zs.next_in = const_cast<Bytef*>(pIn_buf_next);
+    r->zs.avail_in = static_cast<uInt>(*pIn_buf_size);
+    r->zs.next_out = pOut_buf_next;
+    r->zs.avail_out = static_cast<uInt>(*pOut_buf_size);
+    int rc = inflate(&r->zs, Z_NO_FLUSH);
+    *pIn_buf_size -= r->zs.avail_in;
+    *pOut_buf_size -= r->zs.avail_out;
+
+    if (rc == Z_STREAM_END) {
+        r->done = true;
+        return TINFL_STATUS_DONE;
+    }
+    if (rc != Z_OK && rc != Z_BUF_ERROR) return TINFL_STATUS_FAILED;
+    if (r->zs.avail_out == 0) return TINFL_STATUS_HAS_MORE_OUTPUT;
+    return (decomp_flags & TINFL_FLAG_HAS_MORE_INPUT) ? TINFL_STATUS_NEEDS_MORE_INPUT
+                                                      : TINFL_STATUS_FAILED;
+}
@@ -1,10 +1,13 @@
 #include <unity.h>
 #include <Arduino.h>
-#include <ArduinoJson.h>
+#include <string>
 
 #include "services/AssetManifestDiff.h"
 
 using services::manifest::Pending;
+using services::manifest::Parser;
+using services::manifest::Queue;
+using services::manifest::Table;
 using services::manifest::diff;
 using services::manifest::buildPath;
 using services::manifest::collectOrphans;
@@ -12,18 +15,37 @@ using services::manifest::collectOrphans;
 void setUp(void) {}
 void tearDown(void) {}
 
+static const char* SHA_A = "1111111111111111111111111111111111111111";
+static const char* SHA_B = "2222222222222222222222222222222222222222";
+
+// Feed `json` in slices of `slice` bytes (0 = all at once)
+static bool parse(Table& table, const std::string& json, size_t slice = 0) {
+    Parser parser(table);
+    parser.reset();
+    if (slice == 0) slice = json.size() ? json.size() : 1;
+    for (size_t off = 0; off < json.size(); off += slice) {
+        size_t n = std::min(slice, json.size() - off);
+        if (!parser.feed(reinterpret_cast<const uint8_t*>(json.data()) + off, n)) return false;
+    }
+    return parser.finish();
+}
+
+struct Text {
+    std::string data;
+    size_t print(const char* s) {
+        data += s;
+        return strlen(s);
+    }
+};
+
 // ─── diff(): identifies changed, added, and missing files ─────────────
 
 void test_diff_detects_added_image() {
-    DynamicJsonDocument remote(2048);
-    DynamicJsonDocument local(2048);
-    remote["images"]["kaa001"]["sha1"] = "1111111111111111111111111111111111111111";
-    remote["images"]["kaa001"]["size"] = 230454;
-    remote["audio"].to<JsonObject>();
-    local["images"].to<JsonObject>();
-    local["audio"].to<JsonObject>();
-
-    std::vector<Pending> pending = diff(remote, local);
+    Table remote, local;
+    TEST_ASSERT_TRUE(parse(remote, "{\"images\":{\"kaa001\":{\"sha1\":\"1111111111111111111111111111111111111111\",\"size\":230454}},\"audio\":{}}"));
+    TEST_ASSERT_TRUE(parse(local, "{\"images\":{},\"audio\":{}}"));
+
+    Queue pending = diff(remote, local);
     TEST_ASSERT_EQUAL(1, (int)pending.size());
     TEST_ASSERT_EQUAL_STRING("image", pending[0].type.c_str());
     TEST_ASSERT_EQUAL_STRING("kaa001", pending[0].tokenId.c_str());
@@ -31,62 +53,56 @@ void test_diff_detects_added_image() {
 }
 
 void test_diff_skips_unchanged_entries() {
-    DynamicJsonDocument remote(2048), local(2048);
-    remote["images"]["kaa001"]["sha1"] = "abcabcabcabcabcabcabcabcabcabcabcabcabca";
-    remote["images"]["kaa001"]["size"] = 1000;
-    remote["audio"].to<JsonObject>();
-    local["images"]["kaa001"]["sha1"] = "abcabcabcabcabcabcabcabcabcabcabcabcabca";
-    local["images"]["kaa001"]["size"] = 1000;
-    local["audio"].to<JsonObject>();
+    Table remote, local;
+    std::string m = "{\"images\":{\"kaa001\":{\"sha1\":\"abcabcabcabcabcabcabcabcabcabcabcabcabca\",\"size\":1000}},\"audio\":{}}";
+    TEST_ASSERT_TRUE(parse(remote, m));
+    // Case of the hex digits does not matter
+    TEST_ASSERT_TRUE(parse(local, "{\"images\":{\"kaa001\":{\"sha1\":\"ABCABCABCABCABCABCABCABCABCABCABCABCABCA\",\"size\":1000}}}"));
 
-    std::vector<Pending> pending = diff(remote, local);
-    TEST_ASSERT_EQUAL(0, (int)pending.size());
+    TEST_ASSERT_TRUE(diff(remote, local).empty());
 }
 
 void test_diff_flags_sha_mismatch() {
-    DynamicJsonDocument remote(2048), local(2048);
-    remote["images"]["kaa001"]["sha1"] = "1111111111111111111111111111111111111111";
-    remote["images"]["kaa001"]["size"] = 1000;
-    remote["audio"].to<JsonObject>();
-    local["images"]["kaa001"]["sha1"] = "2222222222222222222222222222222222222222";
-    local["images"]["kaa001"]["size"] = 1000;
-    local["audio"].to<JsonObject>();
-
-    std::vector<Pending> pending = diff(remote, local);
+    Table remote, local;
+    TEST_ASSERT_TRUE(parse(remote, "{\"images\":{\"kaa001\":{\"sha1\":\"1111111111111111111111111111111111111111\",\"size\":1000}}}"));
+    TEST_ASSERT_TRUE(parse(local, "{\"images\":{\"kaa001\":{\"sha1\":\"2222222222222222222222222222222222222222\",\"size\":1000}}}"));
+
+    Queue pending = diff(remote, local);
     TEST_ASSERT_EQUAL(1, (int)pending.size());
-    TEST_ASSERT_EQUAL_STRING("1111111111111111111111111111111111111111",
-                             pending[0].sha1.c_str());
+    TEST_ASSERT_EQUAL_STRING(SHA_A, pending[0].sha1.c_str());
 }
 
 void test_diff_preserves_images_before_audio_order() {
-    DynamicJsonDocument remote(2048), local(2048);
-    remote["images"]["kaa001"]["sha1"] = "a1a1a1a1a1a1a1a1a1a1a1a1a1a1a1a1a1a1a1a1";
-    remote["images"]["kaa001"]["size"] = 10;
-    remote["audio"]["asm031"]["sha1"] = "b2b2b2b2b2b2b2b2b2b2b2b2b2b2b2b2b2b2b2b2";
-    remote["audio"]["asm031"]["size"] = 20;
-    remote["audio"]["asm031"]["ext"] = "wav";
-    local.to<JsonObject>(); // empty local
-
-    std::vector<Pending> pending = diff(remote, local);
+    Table remote, local;
+    // Audio first in the text; images still come first in the queue
+    TEST_ASSERT_TRUE(parse(remote,
+        "{\"audio\":{\"asm031\":{\"sha1\":\"b2b2b2b2b2b2b2b2b2b2b2b2b2b2b2b2b2b2b2b2\",\"size\":20,\"ext\":\"wav\"}},"
+        "\"images\":{\"kaa001\":{\"sha1\":\"a1a1a1a1a1a1a1a1a1a1a1a1a1a1a1a1a1a1a1a1\",\"size\":10}}}"));
+    TEST_ASSERT_TRUE(parse(local, "{}"));
+
+    Queue pending = diff(remote, local);
     TEST_ASSERT_EQUAL(2, (int)pending.size());
     TEST_ASSERT_EQUAL_STRING("image", pending[0].type.c_str());
     TEST_ASSERT_EQUAL_STRING("audio", pending[1].type.c_str());
     TEST_ASSERT_EQUAL_STRING("wav", pending[1].ext.c_str());
+    TEST_ASSERT_TRUE(pending.isNamed(1, "audio/asm031.wav"));
+    TEST_ASSERT_FALSE(pending.isNamed(1, "audio/asm031.mp3"));
+    TEST_ASSERT_TRUE(pending.isNamed(0, "images/kaa001.bmp"));
+    TEST_ASSERT_FALSE(pending.isNamed(0, "images/kaa0011.bmp"));
 }
 
 void test_diff_skips_entries_missing_required_fields() {
-    DynamicJsonDocument remote(2048), local(2048);
-    // No sha1
-    remote["images"]["bad1"]["size"] = 100;
-    // No size
-    remote["images"]["bad2"]["sha1"] = "c3c3c3c3c3c3c3c3c3c3c3c3c3c3c3c3c3c3c3c3";
-    // Valid
-    remote["images"]["good"]["sha1"] = "d4d4d4d4d4d4d4d4d4d4d4d4d4d4d4d4d4d4d4d4";
-    remote["images"]["good"]["size"] = 1;
-    remote["audio"].to<JsonObject>();
-    local.to<JsonObject>();
-
-    std::vector<Pending> pending = diff(remote, local);
+    Table remote, local;
+    TEST_ASSERT_TRUE(parse(remote,
+        "{\"images\":{"
+        "\"bad1\":{\"size\":100},"                                               // No sha1
+        "\"bad2\":{\"sha1\":\"c3c3c3c3c3c3c3c3c3c3c3c3c3c3c3c3c3c3c3c3\"},"      // No size
+        "\"bad3\":{\"sha1\":\"not-hex-not-hex-not-hex-not-hex-not-hex!\",\"size\":5},"
+        "\"good\":{\"sha1\":\"d4d4d4d4d4d4d4d4d4d4d4d4d4d4d4d4d4d4d4d4\",\"size\":1}},"
+        "\"audio\":{}}"));
+    TEST_ASSERT_TRUE(parse(local, "{}"));
+
+    Queue pending = diff(remote, local);
     TEST_ASSERT_EQUAL(1, (int)pending.size());
     TEST_ASSERT_EQUAL_STRING("good", pending[0].tokenId.c_str());
 }
@@ -94,30 +110,41 @@ void test_diff_skips_entries_missing_required_fields() {
 // ─── collectOrphans(): tokenIds present locally but not remotely ──────
 
 void test_collectOrphans_finds_deleted_tokens() {
-    DynamicJsonDocument remote(2048), local(2048);
-    local["images"]["keep"]["sha1"] = "e5e5e5e5e5e5e5e5e5e5e5e5e5e5e5e5e5e5e5e5";
-    local["images"]["gone"]["sha1"] = "f6f6f6f6f6f6f6f6f6f6f6f6f6f6f6f6f6f6f6f6";
-    remote["images"]["keep"]["sha1"] = "e5e5e5e5e5e5e5e5e5e5e5e5e5e5e5e5e5e5e5e5";
-
-    std::vector<String> orphans;
-    collectOrphans(local["images"].as<JsonObject>(),
-                   remote["images"].as<JsonObjectConst>(),
-                   orphans);
+    Table remote, local;
+    TEST_ASSERT_TRUE(parse(local,
+        "{\"images\":{\"keep\":{\"sha1\":\"e5e5e5e5e5e5e5e5e5e5e5e5e5e5e5e5e5e5e5e5\"},"
+        "\"gone\":{\"sha1\":\"f6f6f6f6f6f6f6f6f6f6f6f6f6f6f6f6f6f6f6f6\"}}}"));
+    // An entry the remote cannot offer for download still keeps its local copy
+    TEST_ASSERT_TRUE(parse(remote, "{\"images\":{\"keep\":{\"size\":5}}}"));
+
+    std::vector<size_t> orphans = collectOrphans(local, remote);
     TEST_ASSERT_EQUAL(1, (int)orphans.size());
-    TEST_ASSERT_EQUAL_STRING("gone", orphans[0].c_str());
+    TEST_ASSERT_EQUAL_STRING("gone", local.tokenId(local[orphans[0]]));
 }
 
 void test_collectOrphans_treats_missing_remote_section_as_empty() {
-    DynamicJsonDocument remote(2048), local(2048);
-    local["audio"]["orphan1"]["sha1"] = "a1a1a1a1a1a1a1a1a1a1a1a1a1a1a1a1a1a1a1a1";
-    local["audio"]["orphan2"]["sha1"] = "b2b2b2b2b2b2b2b2b2b2b2b2b2b2b2b2b2b2b2b2";
-    // remote has no "audio" section at all
+    Table remote, local;
+    TEST_ASSERT_TRUE(parse(local,
+        "{\"audio\":{\"orphan1\":{\"sha1\":\"a1a1a1a1a1a1a1a1a1a1a1a1a1a1a1a1a1a1a1a1\"},"
+        "\"orphan2\":{\"sha1\":\"b2b2b2b2b2b2b2b2b2b2b2b2b2b2b2b2b2b2b2b2\"}}}"));
+    // Same tokenId as an image is a different asset
+    TEST_ASSERT_TRUE(parse(remote, "{\"images\":{\"orphan1\":{\"size\":1}}}"));
+
+    TEST_ASSERT_EQUAL(2, (int)collectOrphans(local, remote).size());
+}
 
-    std::vector<String> orphans;
-    collectOrphans(local["audio"].as<JsonObject>(),
-                   remote["audio"].as<JsonObjectConst>(),
-                   orphans);
-    TEST_ASSERT_EQUAL(2, (int)orphans.size());
+// ─── totalBytes(): sizes the asset pack ──────────────────────────────
+
+void test_totalBytes_sums_both_sections_skipping_malformed() {
+    Table remote;
+    TEST_ASSERT_TRUE(parse(remote,
+        "{\"images\":{\"kaa001\":{\"sha1\":\"1111111111111111111111111111111111111111\",\"size\":230454},"
+        "\"kaa002\":{\"size\":999}},"  // no sha1: never downloaded
+        "\"audio\":{\"kaa001\":{\"sha1\":\"2222222222222222222222222222222222222222\",\"size\":40000}}}"));
+    TEST_ASSERT_EQUAL(270454, (int)services::manifest::totalBytes(remote));
+
+    Table empty;
+    TEST_ASSERT_EQUAL(0, (int)services::manifest::totalBytes(empty));
 }
 
 // ─── buildPath(): SD paths match the canonical layout ────────────────
@@ -139,62 +166,186 @@ void test_buildPath_audio_defaults_to_wav_when_ext_missing() {
     TEST_ASSERT_EQUAL_STRING("/assets/audio/asm031.wav", p.c_str());
 }
 
-// ─── updateEntry(): upsert semantics, no duplicate keys ──────────────
+// ─── upsert(): per-file commits, no duplicate keys ───────────────────
 
-void test_updateEntry_first_insert_creates_entry() {
-    DynamicJsonDocument local(2048);
-    services::manifest::updateEntry(
-        local, "image", "kaa001",
-        "1111111111111111111111111111111111111111", 1000, nullptr);
+void test_upsert_first_insert_creates_entry() {
+    Table local;
+    TEST_ASSERT_TRUE(local.upsert(services::manifest::IMAGE, "kaa001", SHA_A, 1000, ""));
 
-    JsonObject images = local["images"].as<JsonObject>();
-    TEST_ASSERT_EQUAL(1, (int)images.size());
-    TEST_ASSERT_EQUAL_STRING(
-        "1111111111111111111111111111111111111111",
-        images["kaa001"]["sha1"].as<const char*>());
+    TEST_ASSERT_EQUAL(1, (int)local.size());
+    const services::manifest::Record* r = local.find(services::manifest::IMAGE, "kaa001");
+    TEST_ASSERT_NOT_NULL(r);
+    TEST_ASSERT_EQUAL_STRING(SHA_A, local.sha1Hex(*r).c_str());
 }
 
-void test_updateEntry_repeated_calls_do_not_duplicate_keys() {
-    DynamicJsonDocument local(4096);
+void test_upsert_repeated_calls_do_not_duplicate_keys() {
+    Table local;
+    local.upsert(services::manifest::IMAGE, "kaa002", SHA_A, 1, "");
+    local.upsert(services::manifest::IMAGE, "kaa001", SHA_A, 1000, "");
+    local.upsert(services::manifest::IMAGE, "kaa001", SHA_B, 2000, "");
+    local.upsert(services::manifest::AUDIO, "kaa000", SHA_B, 3, "wav");
+
+    TEST_ASSERT_EQUAL(3, (int)local.size());
+    const services::manifest::Record* r = local.find(services::manifest::IMAGE, "kaa001");
+    TEST_ASSERT_EQUAL_STRING(SHA_B, local.sha1Hex(*r).c_str());
+    TEST_ASSERT_EQUAL(2000, (int)r->size);
+    // Still sorted: images by tokenId, then audio
+    TEST_ASSERT_EQUAL_STRING("kaa001", local.tokenId(local[0]));
+    TEST_ASSERT_EQUAL_STRING("kaa002", local.tokenId(local[1]));
+    TEST_ASSERT_EQUAL_STRING("kaa000", local.tokenId(local[2]));
+}
 
-    services::manifest::updateEntry(
-        local, "image", "kaa001",
-        "1111111111111111111111111111111111111111", 1000, nullptr);
-    services::manifest::updateEntry(
-        local, "image", "kaa001",
-        "2222222222222222222222222222222222222222", 2000, nullptr);
+void test_upsert_audio_includes_ext() {
+    Table local;
+    local.upsert(services::manifest::AUDIO, "asm031", SHA_A, 5000, "wav");
+    TEST_ASSERT_EQUAL_STRING("wav", local.pending(0).ext.c_str());
+    TEST_ASSERT_FALSE(local.upsert(services::manifest::AUDIO, "asm031", SHA_A, 5000, "flac"));
+}
 
-    JsonObject images = local["images"].as<JsonObject>();
-    TEST_ASSERT_EQUAL(1, (int)images.size());
-    TEST_ASSERT_EQUAL_STRING(
-        "2222222222222222222222222222222222222222",
-        images["kaa001"]["sha1"].as<const char*>());
-    TEST_ASSERT_EQUAL(2000, (int)images["kaa001"]["size"].as<int>());
+void test_parse_skips_corrupt_section_type() {
+    Table local;
+    TEST_ASSERT_TRUE(parse(local, "{\"images\":\"garbage\",\"audio\":[1,{\"x\":2}]}"));
+    TEST_ASSERT_TRUE(local.empty());
+    TEST_ASSERT_TRUE(local.upsert(services::manifest::IMAGE, "kaa001", SHA_A, 100, ""));
+    TEST_ASSERT_EQUAL(1, (int)local.size());
 }
 
-void test_updateEntry_audio_includes_ext() {
-    DynamicJsonDocument local(2048);
-    services::manifest::updateEntry(
-        local, "audio", "asm031",
-        "3333333333333333333333333333333333333333", 5000, "wav");
+// ─── Parser: streaming input ─────────────────────────────────────────
+
+static std::string bigManifest(int count) {
+    std::string s = "{\"version\":3,\"images\":{";
+    for (int i = 0; i < count; i++) {
+        char e[160];
+        snprintf(e, sizeof(e), "%s\"tok%04d\":{\"sha1\":\"%040x\",\"size\":%d,\"notes\":[null,true]}",
+                 i ? ", " : "", i, i + 1, 1000 + i);
+        s += e;
+    }
+    return s + "},\n\"audio\":{\"tok0001\":{\"ext\":\"mp3\",\"size\":7,\"sha1\":\"" +
+           std::string(40, 'f') + "\"}}}";
+}
 
-    TEST_ASSERT_EQUAL_STRING(
-        "wav", local["audio"]["asm031"]["ext"].as<const char*>());
+void test_parser_any_slicing() {
+    std::string json = bigManifest(300);
+    const size_t slices[] = {1, 3, 17, 512, 0};
+    for (size_t slice : slices) {
+        Table t;
+        TEST_ASSERT_TRUE(parse(t, json, slice));
+        TEST_ASSERT_EQUAL(301, (int)t.size());
+        const services::manifest::Record* r = t.find(services::manifest::IMAGE, "tok0299");
+        TEST_ASSERT_NOT_NULL(r);
+        TEST_ASSERT_EQUAL(1299, (int)r->size);
+        TEST_ASSERT_EQUAL_HEX8(0x2c, r->sha1[19]);  // 300
+        r = t.find(services::manifest::AUDIO, "tok0001");
+        TEST_ASSERT_NOT_NULL(r);
+        TEST_ASSERT_EQUAL_STRING("mp3", r->ext);
+    }
 }
 
-void test_updateEntry_repairs_corrupt_section_type() {
-    DynamicJsonDocument local(2048);
-    local["images"] = "garbage";
+void test_parser_escapes_and_unknown_fields() {
+    Table t;
+    TEST_ASSERT_TRUE(parse(t,
+        " {\"meta\":{\"images\":{\"x\":{\"sha1\":\"1\"}}},"
+        "\"images\":{\"a\\\"b\\\\c\\u0041\\u00e9\":{\"size\":12,\"extra\":{\"sha1\":\"zz\"},"
+        "\"sha1\":\"1111111111111111111111111111111111111111\"}}} \r\n"));
+    TEST_ASSERT_EQUAL(1, (int)t.size());
+    TEST_ASSERT_EQUAL_STRING("a\"b\\cA\xc3\xa9", t.tokenId(t[0]));
+    TEST_ASSERT_EQUAL_STRING(SHA_A, t.sha1Hex(t[0]).c_str());
+    TEST_ASSERT_EQUAL(12, (int)t[0].size);
+}
+
+void test_parser_duplicate_keys_last_wins() {
+    Table t;
+    TEST_ASSERT_TRUE(parse(t,
+        "{\"images\":{\"k\":{\"sha1\":\"1111111111111111111111111111111111111111\",\"size\":1},"
+        "\"j\":{\"size\":2},"
+        "\"k\":{\"sha1\":\"2222222222222222222222222222222222222222\",\"size\":3}}}"));
+    TEST_ASSERT_EQUAL(2, (int)t.size());
+    const services::manifest::Record* r = t.find(services::manifest::IMAGE, "k");
+    TEST_ASSERT_EQUAL_STRING(SHA_B, t.sha1Hex(*r).c_str());
+    TEST_ASSERT_EQUAL(3, (int)r->size);
+}
+
+void test_parser_rejects_truncated_and_malformed() {
+    std::string json = bigManifest(5);
+    Table t;
+    TEST_ASSERT_FALSE(parse(t, json.substr(0, json.size() - 1)));
+    const char* bad[] = {
+        "",
+        "[]",
+        "{\"images\":{}",
+        "{\"images\":{},}",
+        "{\"images\" {}}",
+        "{\"images\":{\"a\":{\"size\":1,,}}}",
+        "{\"images\":{\"a\":{\"size\":tru}}}",
+        "{\"images\":{\"a\":{\"size\":1]}}",
+        "{\"images\":{\"a\":\"\\x\"}}",
+        "{\"images\":{}}{}",
+        "{\"images\":{\"a\nb\":{}}}",
+    };
+    for (const char* b : bad) {
+        Table u;
+        TEST_ASSERT_FALSE_MESSAGE(parse(u, b), b);
+    }
+}
 
-    services::manifest::updateEntry(
-        local, "image", "kaa001",
-        "4444444444444444444444444444444444444444", 100, nullptr);
+void test_parser_skips_unusable_entries() {
+    Table t;
+    Parser p(t);
+    p.reset();
+    std::string json =
+        "{\"images\":{\"0123456789012345678901234\":{\"size\":1},"  // tokenId > 24 chars
+        "\"ok\":{\"size\":1}},"
+        "\"audio\":{\"a\":{\"ext\":\"flac\",\"size\":1},\"b\":{\"size\":99999999999}}}";
+    TEST_ASSERT_TRUE(p.feed(reinterpret_cast<const uint8_t*>(json.data()), json.size()));
+    TEST_ASSERT_TRUE(p.finish());
+    TEST_ASSERT_EQUAL(2, (int)p.skipped());
+    TEST_ASSERT_EQUAL(2, (int)t.size());
+    TEST_ASSERT_EQUAL(0, (int)t.find(services::manifest::AUDIO, "b")->size);  // Out of range
+}
+
+void test_parser_entry_cap() {
+    std::string json = "{\"images\":{";
+    for (int i = 0; i <= limits::MANIFEST_MAX_ENTRIES; i++) {
+        json += (i ? ",\"" : "\"") + std::to_string(i) + "\":{\"size\":1}";
+    }
+    json += "}}";
+    Table t;
+    TEST_ASSERT_FALSE(parse(t, json));
+}
+
+void test_writeJson_round_trip() {
+    Table t;
+    TEST_ASSERT_TRUE(parse(t, bigManifest(40)));
+    t.upsert(services::manifest::IMAGE, "q\"uote", SHA_A, 9, "");
+    t.add(services::manifest::AUDIO, "nosha", "", 4, "");
+    t.finalize();
+
+    Text out;
+    TEST_ASSERT_TRUE(t.writeJson(out));
+    Table back;
+    TEST_ASSERT_TRUE(parse(back, out.data, 7));
+    TEST_ASSERT_EQUAL((int)t.size(), (int)back.size());
+    for (size_t i = 0; i < t.size(); i++) {
+        TEST_ASSERT_EQUAL_STRING(t.tokenId(t[i]), back.tokenId(back[i]));
+        TEST_ASSERT_EQUAL(t[i].type, back[i].type);
+        TEST_ASSERT_EQUAL(t[i].size, back[i].size);
+        TEST_ASSERT_EQUAL(t[i].hasSha1, back[i].hasSha1);
+        TEST_ASSERT_EQUAL_MEMORY(t[i].sha1, back[i].sha1, 20);
+        TEST_ASSERT_EQUAL_STRING(t[i].ext, back[i].ext);
+    }
+
+    Table empty;
+    Text e;
+    TEST_ASSERT_TRUE(empty.writeJson(e));
+    TEST_ASSERT_EQUAL_STRING("{\"images\":{},\"audio\":{}}", e.data.c_str());
+}
 
-    JsonObject images = local["images"].as<JsonObject>();
-    TEST_ASSERT_EQUAL(1, (int)images.size());
-    TEST_ASSERT_EQUAL_STRING(
-        "4444444444444444444444444444444444444444",
-        images["kaa001"]["sha1"].as<const char*>());
+void test_table_footprint() {
+    TEST_ASSERT_EQUAL(32, (int)sizeof(services::manifest::Record));
+    Table t;
+    TEST_ASSERT_TRUE(parse(t, bigManifest(1000)));
+    // ~40 bytes an entry: record plus "tokNNNN\0"
+    TEST_ASSERT_TRUE(t.heapBytes() <= 1001 * 40);
 }
 
 // ─── Unity runner ────────────────────────────────────────────────────
@@ -209,12 +360,21 @@ int main(int argc, char** argv) {
     RUN_TEST(test_diff_skips_entries_missing_required_fields);
     RUN_TEST(test_collectOrphans_finds_deleted_tokens);
     RUN_TEST(test_collectOrphans_treats_missing_remote_section_as_empty);
+    RUN_TEST(test_totalBytes_sums_both_sections_skipping_malformed);
     RUN_TEST(test_buildPath_image_uses_bmp_extension);
     RUN_TEST(test_buildPath_audio_uses_provided_ext);
     RUN_TEST(test_buildPath_audio_defaults_to_wav_when_ext_missing);
-    RUN_TEST(test_updateEntry_first_insert_creates_entry);
-    RUN_TEST(test_updateEntry_repeated_calls_do_not_duplicate_keys);
-    RUN_TEST(test_updateEntry_audio_includes_ext);
-    RUN_TEST(test_updateEntry_repairs_corrupt_section_type);
+    RUN_TEST(test_upsert_first_insert_creates_entry);
+    RUN_TEST(test_upsert_repeated_calls_do_not_duplicate_keys);
+    RUN_TEST(test_upsert_audio_includes_ext);
+    RUN_TEST(test_parse_skips_corrupt_section_type);
+    RUN_TEST(test_parser_any_slicing);
+    RUN_TEST(test_parser_escapes_and_unknown_fields);
+    RUN_TEST(test_parser_duplicate_keys_last_wins);
+    RUN_TEST(test_parser_rejects_truncated_and_malformed);
+    RUN_TEST(test_parser_skips_unusable_entries);
+    RUN_TEST(test_parser_entry_cap);
+    RUN_TEST(test_writeJson_round_trip);
+    RUN_TEST(test_table_footprint);
     return UNITY_END();
 }
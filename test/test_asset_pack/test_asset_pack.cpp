@@ -0,0 +1,234 @@
+#include <unity.h>
+#include <Arduino.h>
+#include <SD.h>
+#include <string>
+#include <vector>
+#include "hal/AssetPack.h"
+
+// AssetPack runs against the in-memory SD mock. The open-cost benchmark at
+// the bottom compares the pack's lookup with a FAT directory walk model.
+
+static const char* PACK = "/assets.pack";
+static const uint16_t CAP = 32;
+static const char* SHA = "0123456789abcdef0123456789abcdef01234567";
+
+void setUp(void) {
+    mock::sdReset();
+}
+
+void tearDown(void) {}
+
+// Reserve, write the payload, commit the entry (what the download sink does)
+static bool store(hal::AssetPack& pack, uint8_t type, const char* id, const char* ext,
+                  uint32_t len, uint8_t fill) {
+    uint32_t off;
+    if (!pack.reserve(len, off)) return false;
+    File f = SD.open(PACK, "r+");
+    f.seek(off);
+    std::vector<uint8_t> data(len, fill);
+    f.write(data.data(), len);
+    f.close();
+    hal::AssetPack::Entry e;
+    if (!hal::AssetPack::makeEntry(type, id, ext, SHA, off, len, e)) return false;
+    return pack.put(e);
+}
+
+static uint8_t byteAt(uint32_t offset) {
+    return (*mock::sdFiles[PACK])[offset];
+}
+
+void test_create_and_reload_empty() {
+    hal::AssetPack pack(PACK, CAP);
+    TEST_ASSERT_FALSE(pack.load());
+    TEST_ASSERT_TRUE(pack.create(64 * 1024));
+    TEST_ASSERT_EQUAL(hal::AssetPack::dataStart(CAP) + 64 * 1024, (int)SD.open(PACK).size());
+
+    hal::AssetPack again(PACK, CAP);
+    TEST_ASSERT_TRUE(again.load());
+    TEST_ASSERT_EQUAL(0, (int)again.size());
+    TEST_ASSERT_EQUAL(64 * 1024, (int)again.dataSize());
+}
+
+void test_put_find_and_reload_sorted() {
+    hal::AssetPack pack(PACK, CAP);
+    pack.create(256 * 1024);
+    TEST_ASSERT_TRUE(store(pack, hal::AssetPack::IMAGE, "kaa002", "bmp", 1000, 2));
+    TEST_ASSERT_TRUE(store(pack, hal::AssetPack::IMAGE, "kaa001", "bmp", 1000, 1));
+    TEST_ASSERT_TRUE(store(pack, hal::AssetPack::AUDIO, "kaa001", "wav", 3000, 3));
+
+    hal::AssetPack again(PACK, CAP);
+    TEST_ASSERT_TRUE(again.load());
+    TEST_ASSERT_EQUAL(3, (int)again.size());
+    TEST_ASSERT_EQUAL_STRING("kaa001", again.entries()[0].tokenId);
+    TEST_ASSERT_EQUAL_STRING("kaa002", again.entries()[1].tokenId);
+
+    const hal::AssetPack::Entry* e = again.find(hal::AssetPack::AUDIO, "kaa001");
+    TEST_ASSERT_NOT_NULL(e);
+    TEST_ASSERT_EQUAL(3000, (int)e->length);
+    TEST_ASSERT_EQUAL(3, byteAt(e->offset));
+    TEST_ASSERT_EQUAL(0x01, e->sha1[0]);
+    TEST_ASSERT_NULL(again.find(hal::AssetPack::AUDIO, "kaa002"));
+}
+
+void test_resolve_paths() {
+    hal::AssetPack pack(PACK, CAP);
+    pack.create(64 * 1024);
+    store(pack, hal::AssetPack::IMAGE, "kaa001", "bmp", 600, 1);
+    store(pack, hal::AssetPack::AUDIO, "kaa001", "wav", 700, 2);
+
+    hal::AssetPack::Extent x;
+    TEST_ASSERT_TRUE(pack.resolve("/assets/images/kaa001.bmp", x));
+    TEST_ASSERT_EQUAL(600, (int)x.length);
+    TEST_ASSERT_TRUE(pack.resolve("/assets/audio/kaa001.wav", x));
+    TEST_ASSERT_EQUAL(700, (int)x.length);
+    TEST_ASSERT_FALSE(pack.resolve("/assets/audio/kaa001.mp3", x));
+    TEST_ASSERT_FALSE(pack.resolve("/assets/images/kaa009.bmp", x));
+    TEST_ASSERT_FALSE(pack.resolve("/config.txt", x));
+}
+
+void test_extents_sector_aligned_and_disjoint() {
+    hal::AssetPack pack(PACK, CAP);
+    pack.create(64 * 1024);
+    store(pack, hal::AssetPack::IMAGE, "a", "bmp", 100, 1);
+    store(pack, hal::AssetPack::IMAGE, "b", "bmp", 1000, 2);
+    store(pack, hal::AssetPack::IMAGE, "c", "bmp", 10, 3);
+    for (const auto& e : pack.entries()) {
+        TEST_ASSERT_EQUAL(0, (int)(e.offset % hal::AssetPack::SECTOR));
+        TEST_ASSERT_EQUAL(e.tokenId[0] - 'a' + 1, byteAt(e.offset + e.length - 1));
+    }
+}
+
+// Update writes beside the old copy; the old extent is reused afterwards
+void test_update_keeps_old_copy_until_commit_then_reuses() {
+    hal::AssetPack pack(PACK, CAP);
+    pack.create(64 * 1024);
+    store(pack, hal::AssetPack::IMAGE, "kaa001", "bmp", 4096, 1);
+    uint32_t first = pack.find(hal::AssetPack::IMAGE, "kaa001")->offset;
+
+    uint32_t off;
+    TEST_ASSERT_TRUE(pack.reserve(4096, off));
+    TEST_ASSERT_NOT_EQUAL(first, off);
+
+    store(pack, hal::AssetPack::IMAGE, "kaa001", "bmp", 4096, 9);
+    TEST_ASSERT_EQUAL(1, (int)pack.size());
+    TEST_ASSERT_EQUAL(9, byteAt(pack.find(hal::AssetPack::IMAGE, "kaa001")->offset));
+
+    // Freed first extent is the first fit for the next asset
+    TEST_ASSERT_TRUE(pack.reserve(2048, off));
+    TEST_ASSERT_EQUAL(first, off);
+}
+
+void test_full_pack_refuses() {
+    hal::AssetPack pack(PACK, CAP);
+    pack.create(8 * 1024);
+    TEST_ASSERT_TRUE(store(pack, hal::AssetPack::IMAGE, "a", "bmp", 6000, 1));
+    uint32_t off;
+    TEST_ASSERT_FALSE(pack.reserve(4000, off));
+    TEST_ASSERT_TRUE(pack.reserve(2000, off));
+}
+
+void test_index_capacity_enforced() {
+    hal::AssetPack pack(PACK, 2);
+    pack.create(64 * 1024);
+    TEST_ASSERT_TRUE(store(pack, hal::AssetPack::IMAGE, "a", "bmp", 10, 1));
+    TEST_ASSERT_TRUE(store(pack, hal::AssetPack::IMAGE, "b", "bmp", 10, 1));
+    TEST_ASSERT_FALSE(store(pack, hal::AssetPack::IMAGE, "c", "bmp", 10, 1));
+    TEST_ASSERT_TRUE(store(pack, hal::AssetPack::IMAGE, "a", "bmp", 20, 1));  // replace ok
+}
+
+void test_remove_frees_entry() {
+    hal::AssetPack pack(PACK, CAP);
+    pack.create(64 * 1024);
+    store(pack, hal::AssetPack::IMAGE, "a", "bmp", 10, 1);
+    TEST_ASSERT_TRUE(pack.remove(hal::AssetPack::IMAGE, "a"));
+    TEST_ASSERT_FALSE(pack.remove(hal::AssetPack::IMAGE, "a"));
+    hal::AssetPack again(PACK, CAP);
+    TEST_ASSERT_TRUE(again.load());
+    TEST_ASSERT_EQUAL(0, (int)again.size());
+}
+
+// Torn write of the newest index slot: previous index still loads
+void test_torn_commit_falls_back_to_previous_slot() {
+    hal::AssetPack pack(PACK, CAP);
+    pack.create(64 * 1024);                                     // seq 1 -> slot A
+    store(pack, hal::AssetPack::IMAGE, "a", "bmp", 10, 1);      // seq 2 -> slot B
+    store(pack, hal::AssetPack::IMAGE, "b", "bmp", 10, 2);      // seq 3 -> slot A
+
+    (*mock::sdFiles[PACK])[20] ^= 0xFF;  // corrupt slot A header
+    hal::AssetPack again(PACK, CAP);
+    TEST_ASSERT_TRUE(again.load());
+    TEST_ASSERT_EQUAL(1, (int)again.size());
+    TEST_ASSERT_NOT_NULL(again.find(hal::AssetPack::IMAGE, "a"));
+
+    // Corrupting an entry (not the header) is caught by the entry CRC too
+    mock::sdReset();
+    hal::AssetPack p2(PACK, CAP);
+    p2.create(64 * 1024);
+    store(p2, hal::AssetPack::IMAGE, "a", "bmp", 10, 1);        // slot B
+    store(p2, hal::AssetPack::IMAGE, "b", "bmp", 10, 2);        // slot A
+    (*mock::sdFiles[PACK])[hal::AssetPack::HEADER_BYTES + 3] ^= 0xFF;
+    hal::AssetPack again2(PACK, CAP);
+    TEST_ASSERT_TRUE(again2.load());
+    TEST_ASSERT_EQUAL(1, (int)again2.size());
+}
+
+void test_capacity_change_reads_as_absent() {
+    hal::AssetPack pack(PACK, CAP);
+    pack.create(64 * 1024);
+    hal::AssetPack other(PACK, CAP * 2);
+    TEST_ASSERT_FALSE(other.load());
+}
+
+void test_make_entry_validates() {
+    hal::AssetPack::Entry e;
+    TEST_ASSERT_FALSE(hal::AssetPack::makeEntry(0, "", "bmp", SHA, 0, 1, e));
+    TEST_ASSERT_FALSE(hal::AssetPack::makeEntry(0, "a", "bmp", "abc", 0, 1, e));
+    TEST_ASSERT_FALSE(hal::AssetPack::makeEntry(0, "a", "bmp",
+                      "zz23456789abcdef0123456789abcdef01234567", 0, 1, e));
+    TEST_ASSERT_FALSE(hal::AssetPack::makeEntry(0, "a", "flac", SHA, 0, 1, e));
+    TEST_ASSERT_FALSE(hal::AssetPack::makeEntry(0, "this_token_id_is_way_too_long", "bmp",
+                      SHA, 0, 1, e));
+    TEST_ASSERT_TRUE(hal::AssetPack::makeEntry(0, "a", "bmp", SHA, 0, 1, e));
+}
+
+// Open cost: FAT walks 32-byte directory entries until it finds the name
+// (8.3 + LFN ~2 entries per asset), so a loose lookup reads O(n) bytes of
+// directory per open; the pack needs a RAM binary search and one root-dir
+// lookup regardless of n.
+void test_open_cost_constant_vs_directory_walk() {
+    const int DIR_ENTRY_BYTES = 64;
+    for (int n : {50, 200}) {
+        mock::sdReset();
+        hal::AssetPack pack(PACK, 256);
+        pack.create(4 * 1024 * 1024);
+        char id[40];
+        for (int i = 0; i < n; i++) {
+            snprintf(id, sizeof(id), "tok%03d", i);
+            store(pack, hal::AssetPack::IMAGE, id, "bmp", 100, 1);
+        }
+        hal::AssetPack::Extent x;
+        snprintf(id, sizeof(id), "/assets/images/tok%03d.bmp", n - 1);
+        mock::sdStats = mock::SDStats();
+        TEST_ASSERT_TRUE(pack.resolve(id, x));
+        TEST_ASSERT_EQUAL(0, (int)mock::sdStats.bytesRead);  // index is in RAM
+        printf("[BENCH] %d assets: loose open walks ~%d dir bytes (avg), pack lookup 0 SD bytes\n",
+               n, n * DIR_ENTRY_BYTES / 2);
+    }
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_create_and_reload_empty);
+    RUN_TEST(test_put_find_and_reload_sorted);
+    RUN_TEST(test_resolve_paths);
+    RUN_TEST(test_extents_sector_aligned_and_disjoint);
+    RUN_TEST(test_update_keeps_old_copy_until_commit_then_reuses);
+    RUN_TEST(test_full_pack_refuses);
+    RUN_TEST(test_index_capacity_enforced);
+    RUN_TEST(test_remove_frees_entry);
+    RUN_TEST(test_torn_commit_falls_back_to_previous_slot);
+    RUN_TEST(test_capacity_change_reads_as_absent);
+    RUN_TEST(test_make_entry_validates);
+    RUN_TEST(test_open_cost_constant_vs_directory_walk);
+    return UNITY_END();
+}
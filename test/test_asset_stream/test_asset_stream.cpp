@@ -0,0 +1,302 @@
+#include <unity.h>
+#include <Arduino.h>
+#include <string>
+#include <vector>
+#include "services/AssetStream.h"
+
+// Wire formats of the pipelined asset sync: target parsing, request and
+// response heads on the raw connection, the ustar bundle stream, and the
+// per-run rates.
+
+void setUp(void) {}
+void tearDown(void) {}
+
+// ─── Target and request head ──────────────────────────────────────────
+
+void test_target_from_orchestrator_url() {
+    services::HttpTarget t;
+    TEST_ASSERT_TRUE(services::parseHttpTarget("https://10.0.0.5:3000", t));
+    TEST_ASSERT_TRUE(t.secure);
+    TEST_ASSERT_EQUAL_STRING("10.0.0.5", t.host.c_str());
+    TEST_ASSERT_EQUAL(3000, t.port);
+    TEST_ASSERT_EQUAL(0, (int)t.basePath.length());
+
+    TEST_ASSERT_TRUE(services::parseHttpTarget("HTTP://orch.local/aln/", t));
+    TEST_ASSERT_FALSE(t.secure);
+    TEST_ASSERT_EQUAL(80, t.port);
+    TEST_ASSERT_EQUAL_STRING("/aln", t.basePath.c_str());
+}
+
+void test_target_rejects_bad_urls() {
+    services::HttpTarget t;
+    TEST_ASSERT_FALSE(services::parseHttpTarget("ftp://10.0.0.5", t));
+    TEST_ASSERT_FALSE(services::parseHttpTarget("https://", t));
+    TEST_ASSERT_FALSE(services::parseHttpTarget("https://10.0.0.5:0", t));
+    TEST_ASSERT_FALSE(services::parseHttpTarget("https://10.0.0.5:30x0/", t));
+    TEST_ASSERT_FALSE(services::parseHttpTarget("10.0.0.5:3000", t));
+}
+
+void test_request_head() {
+    services::HttpTarget t;
+    services::parseHttpTarget("https://10.0.0.5:3000", t);
+    String get = services::httpRequestHead("GET", t, "/api/assets/images/kaa001.bmp", true);
+    TEST_ASSERT_EQUAL_STRING("GET /api/assets/images/kaa001.bmp HTTP/1.1\r\n"
+                             "Host: 10.0.0.5:3000\r\n"
+                             "Connection: keep-alive\r\n\r\n", get.c_str());
+
+    services::parseHttpTarget("https://orch.local", t);
+    String post = services::httpRequestHead("POST", t, "/api/assets/bundle", false,
+                                            "application/json", 42);
+    TEST_ASSERT_EQUAL_STRING("POST /api/assets/bundle HTTP/1.0\r\n"
+                             "Host: orch.local\r\n"
+                             "Connection: close\r\n"
+                             "Content-Type: application/json\r\n"
+                             "Content-Length: 42\r\n\r\n", post.c_str());
+}
+
+// ─── Response head ────────────────────────────────────────────────────
+
+static const char* HEAD_OK =
+    "HTTP/1.1 200 OK\r\n"
+    "X-Powered-By: Express\r\n"
+    "content-length: 230454\r\n"
+    "Content-Type: image/bmp\r\n"
+    "\r\n";
+
+void test_head_byte_at_a_time_stops_at_body() {
+    std::string wire = std::string(HEAD_OK) + "BMbody";
+    services::HttpResponseHead head;
+    size_t used = 0;
+    while (!head.done() && used < wire.size()) {
+        used += head.feed(reinterpret_cast<const uint8_t*>(wire.data()) + used, 1);
+    }
+    TEST_ASSERT_TRUE(head.done());
+    TEST_ASSERT_EQUAL(strlen(HEAD_OK), used);
+    TEST_ASSERT_EQUAL(200, head.status);
+    TEST_ASSERT_EQUAL(230454, (int)head.contentLength);
+    TEST_ASSERT_TRUE(head.keepAlive);
+    TEST_ASSERT_FALSE(head.chunked);
+}
+
+void test_head_in_one_feed_leaves_body() {
+    std::string wire = std::string(HEAD_OK) + "BMbody";
+    services::HttpResponseHead head;
+    size_t used = head.feed(reinterpret_cast<const uint8_t*>(wire.data()), wire.size());
+    TEST_ASSERT_EQUAL(strlen(HEAD_OK), used);
+    TEST_ASSERT_EQUAL(0, (int)head.feed(reinterpret_cast<const uint8_t*>("x"), 1));
+}
+
+static services::HttpResponseHead parse(const char* wire) {
+    services::HttpResponseHead head;
+    head.feed(reinterpret_cast<const uint8_t*>(wire), strlen(wire));
+    return head;
+}
+
+void test_head_connection_rules() {
+    TEST_ASSERT_FALSE(parse("HTTP/1.1 200 OK\r\nConnection: close\r\n\r\n").keepAlive);
+    TEST_ASSERT_FALSE(parse("HTTP/1.0 200 OK\r\n\r\n").keepAlive);
+    TEST_ASSERT_TRUE(parse("HTTP/1.0 200 OK\r\nConnection: Keep-Alive\r\n\r\n").keepAlive);
+
+    services::HttpResponseHead h = parse("HTTP/1.1 404 Not Found\r\n"
+                                         "Transfer-Encoding: chunked\r\n\r\n");
+    TEST_ASSERT_EQUAL(404, h.status);
+    TEST_ASSERT_TRUE(h.chunked);
+    TEST_ASSERT_EQUAL(-1, (int)h.contentLength);
+}
+
+void test_head_rejects_garbage_and_runaway() {
+    TEST_ASSERT_TRUE(parse("<html>\r\n\r\n").failed());
+    TEST_ASSERT_TRUE(parse("HTTP/1.1 abc\r\n\r\n").failed());
+
+    std::string big = "HTTP/1.1 200 OK\r\n";
+    while (big.size() <= (size_t)limits::ASSET_MAX_HEAD_BYTES) big += "X-Pad: aaaaaaaaaaaaaaaa\r\n";
+    services::HttpResponseHead h = parse(big.c_str());
+    TEST_ASSERT_TRUE(h.failed());
+    TEST_ASSERT_FALSE(h.done());
+}
+
+// ─── Bundle ───────────────────────────────────────────────────────────
+
+static void tarEntry(std::string& out, const std::string& name, const std::string& data,
+                     char type = '0') {
+    uint8_t h[512] = {};
+    std::string file = name;
+    if (file.size() > 99) {  // ustar prefix split
+        size_t cut = file.rfind('/', 154);
+        memcpy(h + 345, file.data(), cut);
+        file = file.substr(cut + 1);
+    }
+    memcpy(h, file.data(), file.size());
+    snprintf(reinterpret_cast<char*>(h + 100), 8, "%07o", 0644);
+    snprintf(reinterpret_cast<char*>(h + 124), 12, "%011o", (unsigned)data.size());
+    h[156] = type;
+    memcpy(h + 257, "ustar", 6);
+    memcpy(h + 263, "00", 2);
+    memset(h + 148, ' ', 8);
+    unsigned sum = 0;
+    for (int i = 0; i < 512; i++) sum += h[i];
+    snprintf(reinterpret_cast<char*>(h + 148), 8, "%06o", sum);
+    out.append(reinterpret_cast<char*>(h), 512);
+    out += data;
+    out.append((512 - data.size() % 512) % 512, '\0');
+}
+
+static void tarEnd(std::string& out) { out.append(1024, '\0'); }
+
+struct Collect {
+    std::vector<std::string> names;
+    std::vector<std::string> bodies;
+    std::string skip;  // Entry name to refuse
+    bool open = false;
+    int ends = 0;
+
+    bool onEntry(const char* name, uint32_t) {
+        if (skip == name) return false;
+        names.push_back(name);
+        bodies.push_back("");
+        open = true;
+        return true;
+    }
+    bool onData(const uint8_t* d, size_t n) {
+        if (!open) return false;  // Data outside an accepted entry
+        bodies.back().append(reinterpret_cast<const char*>(d), n);
+        return true;
+    }
+    bool onEntryEnd() {
+        open = false;
+        ends++;
+        return true;
+    }
+};
+
+static std::string body(int seed, size_t n) {
+    std::string s(n, '\0');
+    for (size_t i = 0; i < n; i++) s[i] = static_cast<char>(seed * 131 + i * 7);
+    return s;
+}
+
+static std::string sampleBundle() {
+    std::string tar;
+    tarEntry(tar, "images/kaa001.bmp", body(1, 1500));
+    tarEntry(tar, "images", "", '5');                            // Directory
+    tarEntry(tar, "PaxHeader/x", "30 path=images/kaa002.bmp\n", 'x');
+    tarEntry(tar, "audio/kaa001.wav", body(2, 512));               // Exact block
+    tarEntry(tar, "images/empty.bmp", "");
+    tarEntry(tar, "images/kaa002.bmp", body(3, 70));
+    tarEnd(tar);
+    return tar;
+}
+
+static void checkSample(const Collect& c) {
+    TEST_ASSERT_EQUAL(4, (int)c.names.size());
+    TEST_ASSERT_EQUAL_STRING("images/kaa001.bmp", c.names[0].c_str());
+    TEST_ASSERT_EQUAL_STRING("audio/kaa001.wav", c.names[1].c_str());
+    TEST_ASSERT_EQUAL_STRING("images/empty.bmp", c.names[2].c_str());
+    TEST_ASSERT_TRUE(c.bodies[0] == body(1, 1500));
+    TEST_ASSERT_TRUE(c.bodies[1] == body(2, 512));
+    TEST_ASSERT_EQUAL(0, (int)c.bodies[2].size());
+    TEST_ASSERT_TRUE(c.bodies[3] == body(3, 70));
+    TEST_ASSERT_EQUAL(4, c.ends);
+}
+
+void test_tar_any_slicing() {
+    std::string tar = sampleBundle();
+    const size_t slices[] = {1, 7, 511, 512, 513, 1024, tar.size()};
+    for (size_t slice : slices) {
+        services::TarReader reader;
+        Collect c;
+        for (size_t off = 0; off < tar.size(); off += slice) {
+            size_t n = std::min(slice, tar.size() - off);
+            TEST_ASSERT_TRUE(reader.feed(reinterpret_cast<const uint8_t*>(tar.data()) + off, n, c));
+        }
+        TEST_ASSERT_TRUE(reader.ended());
+        TEST_ASSERT_EQUAL(4, (int)reader.entries());
+        checkSample(c);
+    }
+}
+
+void test_tar_skipped_entry_gets_no_data() {
+    std::string tar = sampleBundle();
+    services::TarReader reader;
+    Collect c;
+    c.skip = "audio/kaa001.wav";
+    TEST_ASSERT_TRUE(reader.feed(reinterpret_cast<const uint8_t*>(tar.data()), tar.size(), c));
+    TEST_ASSERT_EQUAL(3, (int)c.names.size());
+    TEST_ASSERT_EQUAL(3, c.ends);
+    TEST_ASSERT_TRUE(c.bodies[2] == body(3, 70));
+}
+
+void test_tar_long_name_uses_prefix() {
+    std::string dir = "images/" + std::string(100, 'd');
+    std::string tar;
+    tarEntry(tar, dir + "/kaa001.bmp", "BM");
+    tarEnd(tar);
+    services::TarReader reader;
+    Collect c;
+    reader.feed(reinterpret_cast<const uint8_t*>(tar.data()), tar.size(), c);
+    TEST_ASSERT_EQUAL_STRING((dir + "/kaa001.bmp").c_str(), c.names[0].c_str());
+}
+
+void test_tar_bad_checksum_fails() {
+    std::string tar;
+    tarEntry(tar, "images/kaa001.bmp", body(1, 100));
+    tar[10] ^= 0x20;  // Corrupt the name
+    services::TarReader reader;
+    Collect c;
+    TEST_ASSERT_FALSE(reader.feed(reinterpret_cast<const uint8_t*>(tar.data()), tar.size(), c));
+    TEST_ASSERT_TRUE(reader.failed());
+    TEST_ASSERT_EQUAL(0, (int)c.names.size());
+}
+
+void test_tar_truncated_is_not_ended() {
+    std::string tar = sampleBundle();
+    services::TarReader reader;
+    Collect c;
+    TEST_ASSERT_TRUE(reader.feed(reinterpret_cast<const uint8_t*>(tar.data()), 1800, c));
+    TEST_ASSERT_FALSE(reader.ended());
+    TEST_ASSERT_FALSE(reader.failed());
+    TEST_ASSERT_EQUAL(0, c.ends);  // First entry still open
+}
+
+struct Abort : Collect {
+    bool onData(const uint8_t*, size_t) { return false; }
+};
+
+void test_tar_handler_abort_stops_stream() {
+    std::string tar = sampleBundle();
+    services::TarReader reader;
+    Abort a;
+    TEST_ASSERT_FALSE(reader.feed(reinterpret_cast<const uint8_t*>(tar.data()), tar.size(), a));
+    TEST_ASSERT_EQUAL(1, (int)a.names.size());
+}
+
+// ─── Per-run totals ───────────────────────────────────────────────────
+
+void test_sync_rates() {
+    services::AssetSyncStats s;
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, s.filesPerSec());
+    s.files = 147;
+    s.bytes = 147u * 230454u;
+    s.elapsedMs = 49000;
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 3.0f, s.filesPerSec());
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 0.6595f, s.mbPerSec());
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_target_from_orchestrator_url);
+    RUN_TEST(test_target_rejects_bad_urls);
+    RUN_TEST(test_request_head);
+    RUN_TEST(test_head_byte_at_a_time_stops_at_body);
+    RUN_TEST(test_head_in_one_feed_leaves_body);
+    RUN_TEST(test_head_connection_rules);
+    RUN_TEST(test_head_rejects_garbage_and_runaway);
+    RUN_TEST(test_tar_any_slicing);
+    RUN_TEST(test_tar_skipped_entry_gets_no_data);
+    RUN_TEST(test_tar_long_name_uses_prefix);
+    RUN_TEST(test_tar_bad_checksum_fails);
+    RUN_TEST(test_tar_truncated_is_not_ended);
+    RUN_TEST(test_tar_handler_abort_stops_stream);
+    RUN_TEST(test_sync_rates);
+    return UNITY_END();
+}
@@ -0,0 +1,105 @@
+#include <unity.h>
+#include <Arduino.h>
+#include "services/BatchDrain.h"
+
+// Offline queue drain: adaptive batch sizing (round trip, free heap gate,
+// bytes per scan) and the throughput QUEUE_STATUS reports.
+
+using namespace queue_config;
+
+void setUp(void) {}
+void tearDown(void) {}
+
+static const uint32_t LOTS_OF_HEAP = 200000;
+
+void test_starts_at_start_size() {
+    services::BatchSizer b;
+    TEST_ASSERT_EQUAL(BATCH_START_SIZE, b.size());
+    TEST_ASSERT_EQUAL(BATCH_START_SIZE, b.next(LOTS_OF_HEAP));
+}
+
+void test_fast_full_batches_grow_to_max() {
+    services::BatchSizer b;
+    for (int i = 0; i < 10; i++) {
+        uint16_t n = b.next(LOTS_OF_HEAP);
+        b.onSuccess(n, n * 150, BATCH_TARGET_RTT_MS / 4);
+    }
+    TEST_ASSERT_EQUAL(BATCH_MAX_SIZE, b.size());
+}
+
+void test_partial_batch_does_not_grow() {
+    services::BatchSizer b;
+    b.onSuccess(3, 450, 50);  // Queue ran out: says nothing about 20
+    TEST_ASSERT_EQUAL(BATCH_START_SIZE, b.size());
+}
+
+void test_middling_rtt_holds_size() {
+    services::BatchSizer b;
+    b.onSuccess(BATCH_START_SIZE, 1500, BATCH_TARGET_RTT_MS * 3 / 4);
+    TEST_ASSERT_EQUAL(BATCH_START_SIZE, b.size());
+}
+
+void test_slow_batch_scales_down_proportionally() {
+    services::BatchSizer b;
+    b.onSuccess(BATCH_START_SIZE, 1500, BATCH_TARGET_RTT_MS * 2);
+    TEST_ASSERT_EQUAL(BATCH_START_SIZE / 2, b.size());
+    b.onSuccess(b.size(), 750, BATCH_TARGET_RTT_MS * 100);
+    TEST_ASSERT_EQUAL(BATCH_MIN_SIZE, b.size());
+}
+
+void test_failure_halves_with_floor() {
+    services::BatchSizer b;
+    b.onFailure();
+    TEST_ASSERT_EQUAL(BATCH_START_SIZE / 2, b.size());
+    for (int i = 0; i < 10; i++) b.onFailure();
+    TEST_ASSERT_EQUAL(BATCH_MIN_SIZE, b.size());
+}
+
+void test_heap_gates_but_does_not_size_batch() {
+    services::BatchSizer b;
+    for (int i = 0; i < 10; i++) b.onSuccess(b.size(), b.size() * 150, BATCH_TARGET_RTT_MS / 4);
+    // Streamed body: a bare margin over the reserve still takes a full batch
+    TEST_ASSERT_EQUAL(BATCH_MAX_SIZE, b.next(BATCH_HEAP_RESERVE + 1));
+    TEST_ASSERT_EQUAL(0, b.next(BATCH_HEAP_RESERVE));
+    TEST_ASSERT_EQUAL(0, b.next(BATCH_HEAP_RESERVE / 2));
+    TEST_ASSERT_EQUAL(BATCH_MAX_SIZE, b.size());  // Gate does not change the size
+}
+
+void test_bytes_per_scan_smoothed() {
+    services::BatchSizer b;
+    for (int i = 0; i < 30; i++) b.onSuccess(10, 10 * 400, BATCH_TARGET_RTT_MS);
+    TEST_ASSERT_TRUE(b.bytesPerScan() > 390 && b.bytesPerScan() <= 400);
+    b.onSuccess(10, 10 * 80, BATCH_TARGET_RTT_MS);  // One small batch moves it a quarter
+    TEST_ASSERT_TRUE(b.bytesPerScan() > 280 && b.bytesPerScan() < 320);
+    b.onSuccess(0, 0, 10);  // Empty: ignored
+    TEST_ASSERT_TRUE(b.bytesPerScan() > 280);
+}
+
+void test_drain_stats_rates() {
+    services::DrainStats s;
+    s.recordBatch(50, 7500, 400);
+    s.recordBatch(50, 7600, 420);
+    s.recordRun(100, 2000);
+    s.recordRun(0, 5);  // Nothing sent: not a run
+    TEST_ASSERT_EQUAL(1, (int)s.runs);
+    TEST_ASSERT_EQUAL(2, (int)s.batches);
+    TEST_ASSERT_EQUAL(100, (int)s.scans);
+    TEST_ASSERT_EQUAL(15100, (int)s.bytes);
+    TEST_ASSERT_EQUAL(420, (int)s.lastRttMs);
+    TEST_ASSERT_EQUAL_FLOAT(50.0f, services::DrainStats::rate(s.lastScans, s.lastMs));
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, services::DrainStats::rate(5, 0));
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_starts_at_start_size);
+    RUN_TEST(test_fast_full_batches_grow_to_max);
+    RUN_TEST(test_partial_batch_does_not_grow);
+    RUN_TEST(test_middling_rtt_holds_size);
+    RUN_TEST(test_slow_batch_scales_down_proportionally);
+    RUN_TEST(test_failure_halves_with_floor);
+    RUN_TEST(test_heap_gates_but_does_not_size_batch);
+    RUN_TEST(test_bytes_per_scan_smoothed);
+    RUN_TEST(test_drain_stats_rates);
+    return UNITY_END();
+}
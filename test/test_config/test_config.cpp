@@ -217,6 +217,19 @@ void test_defaults() {
     TEST_ASSERT_FALSE(cfg.debugMode);
     TEST_ASSERT_EQUAL(0, cfg.wifiSSID.length());
     TEST_ASSERT_EQUAL(0, cfg.deviceID.length());
+    TEST_ASSERT_EQUAL(0, (int)cfg.sdClockKHz);  // auto-tune
+    TEST_ASSERT_TRUE(cfg.assetFetch == models::AssetFetchMode::Pipeline);
+    TEST_ASSERT_TRUE(cfg.pushChannel);
+}
+
+void test_asset_fetch_mode_parse() {
+    models::AssetFetchMode mode = models::AssetFetchMode::Pipeline;
+    TEST_ASSERT_TRUE(models::parseAssetFetchMode("Bundle", mode));
+    TEST_ASSERT_TRUE(mode == models::AssetFetchMode::Bundle);
+    TEST_ASSERT_TRUE(models::parseAssetFetchMode("single", mode));
+    TEST_ASSERT_EQUAL_STRING("single", models::assetFetchModeName(mode));
+    TEST_ASSERT_FALSE(models::parseAssetFetchMode("fast", mode));
+    TEST_ASSERT_TRUE(mode == models::AssetFetchMode::Single);  // Untouched
 }
 
 int main(int argc, char** argv) {
@@ -249,6 +262,7 @@ int main(int argc, char** argv) {
 
     // Defaults
     RUN_TEST(test_defaults);
+    RUN_TEST(test_asset_fetch_mode_parse);
 
     return UNITY_END();
 }
@@ -0,0 +1,188 @@
+#include <unity.h>
+#include <Arduino.h>
+#include <string>
+#include <vector>
+#include <zlib.h>
+#include "services/GzipStream.h"
+
+// Content-Encoding: gzip decoding for streamed downloads (token database).
+// Bodies are compressed by the host zlib, as the orchestrator's would be.
+
+void setUp(void) {}
+void tearDown(void) {}
+
+struct Collect {
+    std::string data;
+    size_t limit = SIZE_MAX;  // Refuse writes past this many bytes
+    bool write(const uint8_t* p, size_t n) {
+        if (data.size() + n > limit) return false;
+        data.append(reinterpret_cast<const char*>(p), n);
+        return true;
+    }
+};
+
+// Token-database-like JSON, well past the 32 KB window
+static std::string tokenJson(int count) {
+    std::string s = "{\"tokens\":{";
+    for (int i = 0; i < count; i++) {
+        char entry[160];
+        snprintf(entry, sizeof(entry),
+                 "%s\"tok%05d\":{\"video\":\"%s\",\"image\":\"assets/images/tok%05d.bmp\","
+                 "\"rating\":%d}", i ? "," : "", i, (i % 7) ? "" : "clip.mp4", i,
+                 (i * 2654435761u) % 5);
+        s += entry;
+    }
+    return s + "}}";
+}
+
+static std::vector<uint8_t> gzip(const std::string& text, gz_header* header = nullptr) {
+    z_stream zs = {};
+    deflateInit2(&zs, 9, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY);
+    if (header) deflateSetHeader(&zs, header);
+    std::vector<uint8_t> out(deflateBound(&zs, text.size()) + 256);
+    zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(text.data()));
+    zs.avail_in = text.size();
+    zs.next_out = out.data();
+    zs.avail_out = out.size();
+    deflate(&zs, Z_FINISH);
+    out.resize(zs.total_out);
+    deflateEnd(&zs);
+    return out;
+}
+
+// Feed in slices of `slice` bytes (0 = whole body at once)
+static bool decode(services::GzipDecoder& d, const std::vector<uint8_t>& body, Collect& out,
+                   size_t slice = 0) {
+    if (slice == 0) slice = body.size();
+    for (size_t off = 0; off < body.size(); off += slice) {
+        size_t n = std::min(slice, body.size() - off);
+        if (!d.feed(body.data() + off, n, out)) return false;
+    }
+    return d.finish();
+}
+
+void test_round_trip_any_slicing() {
+    std::string text = tokenJson(2000);
+    TEST_ASSERT_TRUE(text.size() > 3 * TINFL_LZ_DICT_SIZE);
+    std::vector<uint8_t> body = gzip(text);
+    const size_t slices[] = {1, 7, 512, 4096, 0};
+    for (size_t slice : slices) {
+        services::GzipDecoder d;
+        Collect out;
+        TEST_ASSERT_TRUE(d.begin());
+        TEST_ASSERT_TRUE(decode(d, body, out, slice));
+        TEST_ASSERT_TRUE(out.data == text);
+        TEST_ASSERT_EQUAL(body.size(), d.inBytes());
+        TEST_ASSERT_EQUAL(text.size(), d.outBytes());
+    }
+}
+
+void test_optional_header_fields_skipped() {
+    std::string text = tokenJson(50);
+    gz_header h = {};
+    Bytef extra[] = {'A', 'P', 3, 0, 1, 2, 3};
+    h.extra = extra;
+    h.extra_len = sizeof(extra);
+    h.name = reinterpret_cast<Bytef*>(const_cast<char*>("tokens.json"));
+    h.comment = reinterpret_cast<Bytef*>(const_cast<char*>("about the tokens"));
+    h.hcrc = 1;
+    std::vector<uint8_t> body = gzip(text, &h);
+    TEST_ASSERT_EQUAL_HEX8(0x1E, body[3]);  // FHCRC | FEXTRA | FNAME | FCOMMENT
+
+    services::GzipDecoder d;
+    Collect out;
+    TEST_ASSERT_TRUE(d.begin());
+    TEST_ASSERT_TRUE(decode(d, body, out, 3));
+    TEST_ASSERT_TRUE(out.data == text);
+}
+
+void test_empty_body() {
+    std::vector<uint8_t> body = gzip("");
+    services::GzipDecoder d;
+    Collect out;
+    TEST_ASSERT_TRUE(d.begin());
+    TEST_ASSERT_TRUE(decode(d, body, out));
+    TEST_ASSERT_EQUAL(0, (int)out.data.size());
+}
+
+void test_truncated_body_fails_finish() {
+    std::vector<uint8_t> body = gzip(tokenJson(500));
+    // Cut in the deflate data, and cut inside the trailer
+    const size_t cuts[] = {body.size() / 2, body.size() - 3};
+    for (size_t cut : cuts) {
+        std::vector<uint8_t> part(body.begin(), body.begin() + cut);
+        services::GzipDecoder d;
+        Collect out;
+        TEST_ASSERT_TRUE(d.begin());
+        TEST_ASSERT_FALSE(decode(d, part, out));
+    }
+}
+
+void test_trailer_mismatch_fails_finish() {
+    std::vector<uint8_t> body = gzip(tokenJson(100));
+    std::vector<uint8_t> badCrc = body;
+    badCrc[body.size() - 8] ^= 0x01;
+    std::vector<uint8_t> badSize = body;
+    badSize[body.size() - 1] ^= 0x01;
+
+    services::GzipDecoder d;
+    Collect out;
+    TEST_ASSERT_TRUE(d.begin());
+    TEST_ASSERT_FALSE(decode(d, badCrc, out));
+    TEST_ASSERT_EQUAL_STRING("crc mismatch", d.error());
+
+    TEST_ASSERT_TRUE(d.begin());
+    TEST_ASSERT_FALSE(decode(d, badSize, out));
+    TEST_ASSERT_EQUAL_STRING("size mismatch", d.error());
+}
+
+void test_not_gzip_rejected() {
+    std::string plain = "{\"tokens\":{}}";
+    services::GzipDecoder d;
+    Collect out;
+    TEST_ASSERT_TRUE(d.begin());
+    TEST_ASSERT_FALSE(d.feed(reinterpret_cast<const uint8_t*>(plain.data()), plain.size(), out));
+    TEST_ASSERT_EQUAL_STRING("not gzip", d.error());
+    TEST_ASSERT_FALSE(d.finish());
+}
+
+void test_corrupt_deflate_data_rejected() {
+    std::vector<uint8_t> body = gzip(tokenJson(100));
+    body[10] = 0xFF;  // First deflate byte: reserved block type
+    services::GzipDecoder d;
+    Collect out;
+    TEST_ASSERT_TRUE(d.begin());
+    TEST_ASSERT_FALSE(decode(d, body, out));
+}
+
+void test_refused_write_stops_decoding() {
+    std::vector<uint8_t> body = gzip(tokenJson(500));
+    services::GzipDecoder d;
+    Collect out;
+    out.limit = 1000;
+    TEST_ASSERT_TRUE(d.begin());
+    TEST_ASSERT_FALSE(decode(d, body, out, 64));
+    TEST_ASSERT_EQUAL_STRING("write failed", d.error());
+}
+
+void test_feed_before_begin_fails() {
+    services::GzipDecoder d;
+    Collect out;
+    uint8_t b = 0x1f;
+    TEST_ASSERT_FALSE(d.feed(&b, 1, out));
+    TEST_ASSERT_FALSE(d.finish());
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_round_trip_any_slicing);
+    RUN_TEST(test_optional_header_fields_skipped);
+    RUN_TEST(test_empty_body);
+    RUN_TEST(test_truncated_body_fails_finish);
+    RUN_TEST(test_trailer_mismatch_fails_finish);
+    RUN_TEST(test_not_gzip_rejected);
+    RUN_TEST(test_corrupt_deflate_data_rejected);
+    RUN_TEST(test_refused_write_stops_decoding);
+    RUN_TEST(test_feed_before_begin_fails);
+    return UNITY_END();
+}
@@ -0,0 +1,134 @@
+#include <unity.h>
+#include <Arduino.h>
+#include "services/HttpStats.h"
+
+// Keep-alive bookkeeping for OrchestratorService::HTTPHelper: cold/warm
+// split, the idle-heap leak guard and origin matching for reuse.
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_cold_and_warm_split() {
+    services::HttpStats s;
+    s.recordRequest(true, true, 180000, 200);   // Handshake
+    s.recordRequest(false, true, 25000, 200);   // Reused
+    s.recordRequest(false, true, 30000, 200);
+    s.recordRequest(true, false, 210000, 200);  // One-shot (always cold)
+
+    TEST_ASSERT_EQUAL(4, (int)s.requests);
+    TEST_ASSERT_EQUAL(1, (int)s.handshakes);
+    TEST_ASSERT_EQUAL(2, (int)s.reused);
+    TEST_ASSERT_EQUAL(1, (int)s.oneShot);
+    TEST_ASSERT_EQUAL(2, (int)s.cold.count);
+    TEST_ASSERT_EQUAL(2, (int)s.warm.count);
+    TEST_ASSERT_EQUAL(210000, (int)s.cold.maxUs);
+    TEST_ASSERT_EQUAL(27500, (int)s.warm.meanUs());
+}
+
+void test_errors_not_in_latency() {
+    services::HttpStats s;
+    s.recordRequest(true, true, 5000000, -1);
+    TEST_ASSERT_EQUAL(1, (int)s.errors);
+    TEST_ASSERT_EQUAL(1, (int)s.handshakes);
+    TEST_ASSERT_EQUAL(0, (int)s.cold.count);
+}
+
+void test_handshake_heap_keeps_max_drop() {
+    services::HttpStats s;
+    s.recordHandshakeHeap(150000, 110000);
+    s.recordHandshakeHeap(150000, 120000);
+    s.recordHandshakeHeap(100000, 120000);  // Heap grew: ignored
+    TEST_ASSERT_EQUAL(40000, (int)s.maxHandshakeHeap);
+}
+
+void test_net_histogram_spans_seconds() {
+    hal::NetLatencyHistogram h;
+    h.record(3000000);
+    h.record(3000001);
+    TEST_ASSERT_EQUAL(1, (int)h.buckets[hal::NetLatencyHistogram::BUCKETS - 2]);
+    TEST_ASSERT_EQUAL(1, (int)h.buckets[hal::NetLatencyHistogram::BUCKETS - 1]);
+    TEST_ASSERT_EQUAL(10, (int)hal::NetLatencyHistogram::BUCKETS);
+}
+
+// ─── Leak guard ───────────────────────────────────────────────────────
+
+void test_leak_guard_steady_heap() {
+    services::HttpLeakGuard g;
+    for (int i = 0; i < 50; i++) {
+        TEST_ASSERT_FALSE(g.sample(120000 - (i % 2) * http_config::LEAK_TOLERANCE_BYTES));
+    }
+    TEST_ASSERT_EQUAL(120000, (int)g.baseline);
+    TEST_ASSERT_EQUAL(0, (int)g.strikes);
+}
+
+void test_leak_guard_trips_on_consecutive_drift() {
+    services::HttpLeakGuard g;
+    g.sample(120000);
+    uint32_t heap = 120000;
+    for (uint8_t i = 1; i < http_config::LEAK_STRIKES; i++) {
+        heap -= 4096;
+        TEST_ASSERT_FALSE(g.sample(heap));
+    }
+    TEST_ASSERT_TRUE(g.sample(heap - 4096));
+    TEST_ASSERT_TRUE(g.tripped);
+    g.newConnection();
+    TEST_ASSERT_TRUE(g.sample(120000));  // Stays tripped until reboot
+}
+
+void test_leak_guard_recovery_clears_strikes() {
+    services::HttpLeakGuard g;
+    g.sample(120000);
+    for (uint8_t i = 1; i < http_config::LEAK_STRIKES; i++) g.sample(100000);
+    g.sample(119500);  // Back within tolerance
+    TEST_ASSERT_EQUAL(0, (int)g.strikes);
+    TEST_ASSERT_FALSE(g.sample(100000));
+}
+
+void test_leak_guard_rebaselines_per_connection() {
+    services::HttpLeakGuard g;
+    g.sample(120000);
+    g.sample(100000);
+    g.newConnection();
+    TEST_ASSERT_FALSE(g.sample(90000));  // New baseline
+    TEST_ASSERT_EQUAL(90000, (int)g.baseline);
+    TEST_ASSERT_EQUAL(0, (int)g.strikes);
+}
+
+// ─── Origin ───────────────────────────────────────────────────────────
+
+void test_origin_strips_path() {
+    TEST_ASSERT_EQUAL_STRING("https://10.0.0.5:3000",
+                             services::httpOrigin("https://10.0.0.5:3000/api/scan").c_str());
+    TEST_ASSERT_EQUAL_STRING("https://10.0.0.5:3000",
+                             services::httpOrigin("https://10.0.0.5:3000").c_str());
+    TEST_ASSERT_EQUAL_STRING("http://orch.local",
+                             services::httpOrigin("HTTP://Orch.local/health?x=1").c_str());
+}
+
+void test_origin_distinguishes_port_and_scheme() {
+    String a = services::httpOrigin("https://10.0.0.5:3000/api/scan");
+    TEST_ASSERT_TRUE(a == services::httpOrigin("https://10.0.0.5:3000/health"));
+    TEST_ASSERT_FALSE(a == services::httpOrigin("https://10.0.0.5:3001/health"));
+    TEST_ASSERT_FALSE(a == services::httpOrigin("http://10.0.0.5:3000/health"));
+}
+
+void test_origin_rejects_bare_path() {
+    TEST_ASSERT_EQUAL(0, (int)services::httpOrigin("/api/scan").length());
+    TEST_ASSERT_EQUAL(0, (int)services::httpOrigin("").length());
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_cold_and_warm_split);
+    RUN_TEST(test_errors_not_in_latency);
+    RUN_TEST(test_handshake_heap_keeps_max_drop);
+    RUN_TEST(test_net_histogram_spans_seconds);
+    RUN_TEST(test_leak_guard_steady_heap);
+    RUN_TEST(test_leak_guard_trips_on_consecutive_drift);
+    RUN_TEST(test_leak_guard_recovery_clears_strikes);
+    RUN_TEST(test_leak_guard_rebaselines_per_connection);
+    RUN_TEST(test_origin_strips_path);
+    RUN_TEST(test_origin_distinguishes_port_and_scheme);
+    RUN_TEST(test_origin_rejects_bare_path);
+    return UNITY_END();
+}
@@ -0,0 +1,58 @@
+#include <unity.h>
+#include <Arduino.h>
+#include "hal/LatencyHistogram.h"
+
+// Unity requires setUp/tearDown (even if empty)
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_empty_histogram_reports_zero() {
+    hal::LatencyHistogram h;
+    TEST_ASSERT_EQUAL(0, (int)h.count);
+    TEST_ASSERT_EQUAL(0, (int)h.meanUs());
+    TEST_ASSERT_EQUAL(0, (int)h.percentileUs(50));
+}
+
+// Bounds are inclusive: a sample equal to a bound lands in that bucket.
+void test_bucket_boundaries_inclusive() {
+    hal::LatencyHistogram h;
+    h.record(0);
+    h.record(250);
+    h.record(251);
+    h.record(100000);
+    h.record(100001);
+
+    TEST_ASSERT_EQUAL(2, (int)h.buckets[0]);
+    TEST_ASSERT_EQUAL(1, (int)h.buckets[1]);
+    TEST_ASSERT_EQUAL(1, (int)h.buckets[hal::LatencyHistogram::BUCKETS - 2]);
+    TEST_ASSERT_EQUAL(1, (int)h.buckets[hal::LatencyHistogram::BUCKETS - 1]);
+    TEST_ASSERT_EQUAL(5, (int)h.count);
+    TEST_ASSERT_EQUAL(100001, (int)h.maxUs);
+}
+
+void test_mean_and_percentiles() {
+    hal::LatencyHistogram h;
+    for (int i = 0; i < 9; i++) h.record(800);   // <= 1000 bucket
+    h.record(30000);                             // <= 50000 bucket
+
+    TEST_ASSERT_EQUAL((9 * 800 + 30000) / 10, (int)h.meanUs());
+    TEST_ASSERT_EQUAL(1000, (int)h.percentileUs(50));
+    TEST_ASSERT_EQUAL(1000, (int)h.percentileUs(90));
+    // Top sample's bucket bound (50 ms) exceeds the real max, so max wins
+    TEST_ASSERT_EQUAL(30000, (int)h.percentileUs(99));
+}
+
+void test_overflow_bucket_reports_max() {
+    hal::LatencyHistogram h;
+    h.record(250000);
+    TEST_ASSERT_EQUAL(250000, (int)h.percentileUs(50));
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_empty_histogram_reports_zero);
+    RUN_TEST(test_bucket_boundaries_inclusive);
+    RUN_TEST(test_mean_and_percentiles);
+    RUN_TEST(test_overflow_bucket_reports_max);
+    return UNITY_END();
+}
@@ -274,6 +274,161 @@ void test_multi_record_first_text_extractable() {
     TEST_ASSERT_EQUAL_STRING("mar004", result.c_str());
 }
 
+// ─── Incremental read support (locateNDEFText) ───────────────────────
+
+// A short token fits the reader's first FAST_READ window (pages 3..7 =
+// 20 bytes) — locateNDEFText must report Complete without needing more.
+void test_short_token_fits_first_read_window() {
+    uint8_t buf[32];
+    buildValidNDEFPages(buf, "kaa001");
+    hal::NDEFTextSpan span;
+    TEST_ASSERT_EQUAL(static_cast<int>(hal::NDEFLayout::Complete),
+                      static_cast<int>(hal::locateNDEFText(buf, 20, span)));
+    TEST_ASSERT_EQUAL(19, (int)span.required);
+    TEST_ASSERT_EQUAL(6, (int)span.textLength);
+}
+
+// A buffer that ends mid-record reports exactly how many bytes the
+// record needs, so the reader can fetch only the missing pages.
+void test_need_more_reports_required_bytes() {
+    uint8_t buf[32];
+    buildValidNDEFPages(buf, "longtoken");  // record ends at byte 22
+    hal::NDEFTextSpan span;
+    TEST_ASSERT_EQUAL(static_cast<int>(hal::NDEFLayout::NeedMore),
+                      static_cast<int>(hal::locateNDEFText(buf, 20, span)));
+    TEST_ASSERT_EQUAL(22, (int)span.required);
+
+    // Truncated buffers still return empty text (never a partial token)
+    TEST_ASSERT_EQUAL_STRING("", hal::parseNDEFText(buf, 20, 0x00).c_str());
+    TEST_ASSERT_EQUAL_STRING("longtoken", hal::parseNDEFText(buf, 24, 0x00).c_str());
+}
+
+// Text longer than the old fixed pages 3..10 window.
+void test_text_beyond_page_10() {
+    const char* text = "this-token-id-is-far-longer-than-pages-3-to-10";
+    int textLen = strlen(text);
+    uint8_t buf[96];
+    memset(buf, 0, sizeof(buf));
+    buf[0] = 0xE1; buf[1] = 0x10; buf[2] = 0x3E; buf[3] = 0x00;
+    buf[4] = 0x03;
+    buf[5] = (uint8_t)(4 + 3 + textLen);
+    int idx = 6;
+    buf[idx++] = 0xD1;
+    buf[idx++] = 0x01;
+    buf[idx++] = (uint8_t)(3 + textLen);
+    buf[idx++] = 'T';
+    buf[idx++] = 0x02;
+    buf[idx++] = 'e';
+    buf[idx++] = 'n';
+    memcpy(&buf[idx], text, textLen);
+
+    TEST_ASSERT_EQUAL_STRING("", hal::parseNDEFText(buf, 32, 0x00).c_str());
+    TEST_ASSERT_EQUAL_STRING(text, hal::parseNDEFText(buf, sizeof(buf), 0x00).c_str());
+}
+
+// 3-byte TLV length format (0xFF, hi, lo) used once a message reaches
+// 255 bytes. Only the first record needs to be present.
+void test_three_byte_tlv_length() {
+    uint8_t buf[32];
+    memset(buf, 0, 32);
+    buf[0] = 0xE1; buf[1] = 0x10; buf[2] = 0x6D; buf[3] = 0x00;  // NTAG215
+    buf[4] = 0x03;           // NDEF Message TLV
+    buf[5] = 0xFF;           // 3-byte length follows
+    buf[6] = 0x01;           // length = 0x012C = 300
+    buf[7] = 0x2C;
+    buf[8]  = 0x91;          // MB, SR, TNF=1 (ME=0: more records follow)
+    buf[9]  = 0x01;
+    buf[10] = 0x09;
+    buf[11] = 'T';
+    buf[12] = 0x02; buf[13] = 'e'; buf[14] = 'n';
+    memcpy(&buf[15], "jaw011", 6);
+
+    String result = hal::parseNDEFText(buf, 32, 0x00);
+    TEST_ASSERT_EQUAL_STRING("jaw011", result.c_str());
+}
+
+// Text record is NOT the first record: a URI record precedes it and must
+// be skipped by length.
+void test_text_record_after_uri_record() {
+    uint8_t buf[48];
+    memset(buf, 0, sizeof(buf));
+    buf[0] = 0xE1; buf[1] = 0x10; buf[2] = 0x3E; buf[3] = 0x00;
+    buf[4] = 0x03;
+    buf[5] = 0x1C;                                   // 28-byte message
+    // Record 1: URI (MB=1, ME=0, SR=1, TNF=1), payload 10
+    buf[6] = 0x91; buf[7] = 0x01; buf[8] = 0x0A; buf[9] = 'U';
+    buf[10] = 0x04;                                  // "https://"
+    memcpy(&buf[11], "aln.game.", 9);
+    // Record 2: Text (ME=1, SR=1, TNF=1), payload 9
+    buf[20] = 0x51; buf[21] = 0x01; buf[22] = 0x09; buf[23] = 'T';
+    buf[24] = 0x02; buf[25] = 'e'; buf[26] = 'n';
+    memcpy(&buf[27], "rat002", 6);
+    buf[33] = 0xFE;
+
+    TEST_ASSERT_EQUAL_STRING("rat002", hal::parseNDEFText(buf, sizeof(buf), 0x00).c_str());
+}
+
+// Normal (non-SR) record with 4-byte payload length and an ID field.
+void test_long_form_record_with_id() {
+    uint8_t buf[40];
+    memset(buf, 0, sizeof(buf));
+    buf[4] = 0x03;
+    buf[5] = 0x14;                 // 20-byte message
+    buf[6] = 0xC9;                 // MB|ME|IL, SR=0, TNF=1
+    buf[7] = 0x01;                 // type length
+    buf[8] = 0x00; buf[9] = 0x00; buf[10] = 0x00; buf[11] = 0x09;  // payload 9
+    buf[12] = 0x02;                // ID length
+    buf[13] = 'T';
+    buf[14] = 'i'; buf[15] = 'd';  // ID
+    buf[16] = 0x02; buf[17] = 'e'; buf[18] = 'n';
+    memcpy(&buf[19], "sof003", 6);
+
+    TEST_ASSERT_EQUAL_STRING("sof003", hal::parseNDEFText(buf, sizeof(buf), 0x00).c_str());
+}
+
+// A message with no Text record at all is Invalid (not NeedMore), so the
+// reader stops instead of reading further.
+void test_message_without_text_record_is_invalid() {
+    uint8_t buf[32];
+    memset(buf, 0, 32);
+    buf[4] = 0x03;
+    buf[5] = 0x07;
+    buf[6] = 0xD1; buf[7] = 0x01; buf[8] = 0x03; buf[9] = 'U';
+    buf[10] = 0x04; buf[11] = 'a'; buf[12] = 'b';
+    hal::NDEFTextSpan span;
+    TEST_ASSERT_EQUAL(static_cast<int>(hal::NDEFLayout::Invalid),
+                      static_cast<int>(hal::locateNDEFText(buf, 32, span)));
+}
+
+// CC data-area size bounds the read: a record claiming to extend past
+// the tag's user memory is rejected rather than requested.
+void test_cc_data_area_bounds_required_length() {
+    uint8_t buf[32];
+    memset(buf, 0, 32);
+    buf[0] = 0xE1; buf[1] = 0x10; buf[2] = 0x02; buf[3] = 0x00;  // 16-byte data area
+    buf[4] = 0x03;
+    buf[5] = 0x30;                 // 48-byte message (beyond data area)
+    buf[6] = 0xD1; buf[7] = 0x01; buf[8] = 0x2C; buf[9] = 'T';
+    hal::NDEFTextSpan span;
+    TEST_ASSERT_EQUAL(static_cast<int>(hal::NDEFLayout::Invalid),
+                      static_cast<int>(hal::locateNDEFText(buf, 32, span)));
+}
+
+// A Text record with an empty payload has no status byte: rejected without
+// reading one. The buffer ends exactly at the record, so a status-byte
+// read would be past `len` (sized exactly for sanitizer builds).
+void test_empty_text_payload_at_buffer_end() {
+    uint8_t buf[10] = {
+        0xE1, 0x10, 0x3E, 0x00,    // CC
+        0x03, 0x04,                // TLV: NDEF, len=4
+        0xD1, 0x01, 0x00, 'T'      // Text record, payload length 0
+    };
+    hal::NDEFTextSpan span;
+    TEST_ASSERT_EQUAL(static_cast<int>(hal::NDEFLayout::Invalid),
+                      static_cast<int>(hal::locateNDEFText(buf, sizeof(buf), span)));
+    TEST_ASSERT_EQUAL_STRING("", hal::parseNDEFText(buf, sizeof(buf), 0x00).c_str());
+}
+
 // ─── Main ─────────────────────────────────────────────────────────────
 
 int main(int argc, char** argv) {
@@ -294,6 +449,15 @@ int main(int argc, char** argv) {
     RUN_TEST(test_ndef_message_too_short);
     RUN_TEST(test_malformed_record_returns_empty_cleanly);
     RUN_TEST(test_multi_record_first_text_extractable);
+    RUN_TEST(test_short_token_fits_first_read_window);
+    RUN_TEST(test_need_more_reports_required_bytes);
+    RUN_TEST(test_text_beyond_page_10);
+    RUN_TEST(test_three_byte_tlv_length);
+    RUN_TEST(test_text_record_after_uri_record);
+    RUN_TEST(test_long_form_record_with_id);
+    RUN_TEST(test_message_without_text_record_is_invalid);
+    RUN_TEST(test_cc_data_area_bounds_required_length);
+    RUN_TEST(test_empty_text_payload_at_buffer_end);
 
     return UNITY_END();
 }
@@ -1,6 +1,8 @@
 #include <unity.h>
 #include <Arduino.h>
 #include <ArduinoJson.h>
+#include <chrono>
+#include "config.h"
 #include "services/PayloadBuilder.h"
 
 // Unity requires setUp/tearDown (even if empty)
@@ -203,6 +205,287 @@ void test_buildBatchJson_empty_batch() {
     TEST_ASSERT_EQUAL(0, doc["transactions"].as<JsonArray>().size());
 }
 
+// ─── Streamed batch body (BatchBodyReader) ────────────────────────────
+
+// Hands out a fixed list of scans; fails at failAt when set
+struct ListSource {
+    std::vector<models::ScanData> scans;
+    size_t next_ = 0;
+    int failAt = -1;
+    int rewinds = 0;
+
+    int next(models::ScanData& scan) {
+        if ((int)next_ == failAt) return -1;
+        if (next_ == scans.size()) return 0;
+        scan = scans[next_++];
+        return 1;
+    }
+    void rewind() { next_ = 0; rewinds++; }
+};
+
+static std::vector<models::ScanData> sampleBatch() {
+    std::vector<models::ScanData> batch;
+    batch.push_back(models::ScanData("kaa001", "TeamA", "SCANNER_001", "2026-04-01T12:00:00Z"));
+    batch.push_back(models::ScanData("tok\"2\\", "", "SCANNER_001", "2026-04-01T12:00:01Z"));
+    batch.push_back(models::ScanData("rat003", "001", "SCANNER_001", "2026-04-01T12:00:02Z"));
+    return batch;
+}
+
+// The drain's measuring pass: header from the first scan, then the length
+static services::BatchHeader measure(const String& batchId, services::PayloadEncoding encoding,
+                                     const std::vector<models::ScanData>& batch, size_t& length) {
+    services::BatchHeader h;
+    h.batchId = batchId;
+    h.encoding = encoding;
+    length = 0;
+    for (size_t i = 0; i < batch.size(); i++) {
+        if (i == 0) {
+            h.deviceId = batch[0].deviceId;
+            h.deviceType = batch[0].deviceType;
+        }
+        length += services::batchEntry(h, batch[i], i == 0).size();
+        h.scans++;
+    }
+    length += services::batchHead(h).size() + services::batchTail(h).size();
+    return h;
+}
+
+static std::string drain(services::BatchBodyReader<ListSource>& reader, size_t chunk) {
+    std::string out;
+    uint8_t buf[64];
+    size_t n;
+    while ((n = reader.read(buf, chunk)) > 0) out.append(reinterpret_cast<char*>(buf), n);
+    return out;
+}
+
+static std::string encodeBatch(services::PayloadEncoding encoding,
+                               const std::vector<models::ScanData>& batch) {
+    size_t length;
+    services::BatchHeader h = measure("b_1", encoding, batch, length);
+    ListSource source;
+    source.scans = batch;
+    services::BatchBodyReader<ListSource> reader(h, length, source);
+    std::string body = drain(reader, 64);
+    TEST_ASSERT_FALSE(reader.failed());
+    TEST_ASSERT_EQUAL(length, body.size());
+    return body;
+}
+
+void test_batch_pieces_match_buildBatchJson() {
+    auto batch = sampleBatch();
+    String whole = services::buildBatchJson("SCANNER_001_0", batch);
+    size_t length;
+    services::BatchHeader h = measure("SCANNER_001_0", services::PayloadEncoding::Json, batch, length);
+    TEST_ASSERT_EQUAL(whole.length(), length);
+
+    ListSource source;
+    source.scans = batch;
+    services::BatchBodyReader<ListSource> reader(h, length, source);
+    TEST_ASSERT_EQUAL_STRING(whole.c_str(), drain(reader, 7).c_str());
+    TEST_ASSERT_TRUE(reader.done());
+    TEST_ASSERT_FALSE(reader.failed());
+    TEST_ASSERT_EQUAL(0, reader.remaining());
+}
+
+void test_batch_reader_output_is_valid_json() {
+    std::string body = encodeBatch(services::PayloadEncoding::Json, sampleBatch());
+
+    JsonDocument doc;
+    TEST_ASSERT_TRUE(deserializeJson(doc, body.c_str()) == DeserializationError::Ok);
+    TEST_ASSERT_EQUAL(3, doc["transactions"].as<JsonArray>().size());
+    TEST_ASSERT_EQUAL_STRING("tok\"2\\", doc["transactions"][1]["tokenId"].as<const char*>());
+    TEST_ASSERT_FALSE(doc["transactions"][1]["teamId"].is<const char*>());
+}
+
+void test_batch_reader_rewind_restarts_body() {
+    auto batch = sampleBatch();
+    size_t length;
+    services::BatchHeader h = measure("b_1", services::PayloadEncoding::Json, batch, length);
+    ListSource source;
+    source.scans = batch;
+    services::BatchBodyReader<ListSource> reader(h, length, source);
+    uint8_t buf[40];
+    reader.read(buf, sizeof(buf));  // A send that died part-way
+
+    reader.rewind();
+    TEST_ASSERT_EQUAL(1, source.rewinds);
+    TEST_ASSERT_EQUAL(reader.length(), reader.remaining());
+    TEST_ASSERT_EQUAL('{', reader.peek());
+    TEST_ASSERT_EQUAL_STRING(services::buildBatchJson("b_1", batch).c_str(), drain(reader, 64).c_str());
+}
+
+// The ring changed under the batch: the body must stop before "]}" rather
+// than carry a different set of scans
+void test_batch_reader_source_failure_stops_short() {
+    auto batch = sampleBatch();
+    size_t length;
+    services::BatchHeader h = measure("b_1", services::PayloadEncoding::Json, batch, length);
+    ListSource source;
+    source.scans = batch;
+    source.failAt = 2;
+    services::BatchBodyReader<ListSource> reader(h, length, source);
+    std::string body = drain(reader, 64);
+
+    TEST_ASSERT_TRUE(reader.failed());
+    TEST_ASSERT_TRUE(body.size() < reader.length());
+    TEST_ASSERT_EQUAL(std::string::npos, body.find("]}"));
+    TEST_ASSERT_EQUAL(-1, reader.peek());
+}
+
+void test_batch_reader_length_mismatch_fails() {
+    auto batch = sampleBatch();
+    size_t length;
+    services::BatchHeader h = measure("b_1", services::PayloadEncoding::Json, batch, length);
+    ListSource fewer;
+    fewer.scans = batch;
+    fewer.scans.pop_back();  // Source ends early
+    services::BatchBodyReader<ListSource> shortReader(h, length, fewer);
+    std::string body = drain(shortReader, 64);
+    TEST_ASSERT_TRUE(shortReader.failed());
+    TEST_ASSERT_EQUAL(std::string::npos, body.find("]}"));
+
+    size_t fewerLength;
+    services::BatchHeader fh = measure("b_1", services::PayloadEncoding::Json, fewer.scans, fewerLength);
+    ListSource more;
+    more.scans = batch;  // More than measured
+    services::BatchBodyReader<ListSource> longReader(fh, fewerLength, more);
+    body = drain(longReader, 64);
+    TEST_ASSERT_TRUE(longReader.failed());
+    TEST_ASSERT_TRUE(body.size() <= longReader.length());
+}
+
+void test_json_string_escapes_control_characters() {
+    String out;
+    services::appendJsonString(out, String("a\tb\x01"));
+    TEST_ASSERT_EQUAL_STRING("\"a\\tb\\u0001\"", out.c_str());
+}
+
+// ─── MessagePack encoding ─────────────────────────────────────────────
+
+static const uint64_t TS_EPOCH_MS = 1775044800000ULL;  // 2026-04-01T12:00:00.000Z
+
+// Timestamps as generateTimestamp() writes them (milliseconds)
+static std::vector<models::ScanData> sampleMsgPackBatch() {
+    std::vector<models::ScanData> batch;
+    batch.push_back(models::ScanData("kaa001", "TeamA", "SCANNER_001", "2026-04-01T12:00:00.000Z"));
+    batch.push_back(models::ScanData("tok\"2\\", "", "SCANNER_001", "2026-04-01T12:00:01.000Z"));
+    batch.push_back(models::ScanData("rat003", "001", "SCANNER_001", "2026-04-01T12:00:02.000Z"));
+    return batch;
+}
+
+void test_scan_msgpack_fields() {
+    models::ScanData scan("kaa001", "001", "SCANNER_001", "2026-04-01T14:00:00.000+02:00");
+    std::string body = services::buildScanMsgPack(scan);
+
+    JsonDocument doc;
+    TEST_ASSERT_TRUE(deserializeMsgPack(doc, body.data(), body.size()) == DeserializationError::Ok);
+    TEST_ASSERT_EQUAL_STRING("kaa001", doc["tokenId"].as<const char*>());
+    TEST_ASSERT_EQUAL_STRING("001", doc["teamId"].as<const char*>());
+    TEST_ASSERT_EQUAL_STRING("SCANNER_001", doc["deviceId"].as<const char*>());
+    TEST_ASSERT_EQUAL_STRING("esp32", doc["deviceType"].as<const char*>());
+    TEST_ASSERT_TRUE(doc["timestamp"].as<uint64_t>() == TS_EPOCH_MS);  // UTC instant
+}
+
+void test_scan_msgpack_omits_empty_team_and_keeps_odd_timestamp() {
+    models::ScanData scan("kaa001", "", "SCANNER_001", "not-a-time");
+    std::string body = services::buildScanMsgPack(scan);
+
+    JsonDocument doc;
+    TEST_ASSERT_TRUE(deserializeMsgPack(doc, body.data(), body.size()) == DeserializationError::Ok);
+    TEST_ASSERT_FALSE(doc["teamId"].is<const char*>());
+    TEST_ASSERT_EQUAL_STRING("not-a-time", doc["timestamp"].as<const char*>());
+}
+
+void test_batch_msgpack_names_device_once() {
+    std::string body = encodeBatch(services::PayloadEncoding::MsgPack, sampleMsgPackBatch());
+
+    JsonDocument doc;
+    TEST_ASSERT_TRUE(deserializeMsgPack(doc, body.data(), body.size()) == DeserializationError::Ok);
+    TEST_ASSERT_EQUAL_STRING("b_1", doc["batchId"].as<const char*>());
+    TEST_ASSERT_EQUAL_STRING("SCANNER_001", doc["deviceId"].as<const char*>());
+    TEST_ASSERT_EQUAL_STRING("esp32", doc["deviceType"].as<const char*>());
+
+    JsonArray tx = doc["transactions"].as<JsonArray>();
+    TEST_ASSERT_EQUAL(3, tx.size());
+    TEST_ASSERT_EQUAL(3, tx[0].as<JsonArray>().size());
+    TEST_ASSERT_EQUAL_STRING("kaa001", tx[0][0].as<const char*>());
+    TEST_ASSERT_EQUAL_STRING("TeamA", tx[0][1].as<const char*>());
+    TEST_ASSERT_TRUE(tx[0][2].as<uint64_t>() == TS_EPOCH_MS);
+    TEST_ASSERT_EQUAL_STRING("tok\"2\\", tx[1][0].as<const char*>());
+    TEST_ASSERT_TRUE(tx[1][1].isNull());
+    TEST_ASSERT_TRUE(tx[2][2].as<uint64_t>() == TS_EPOCH_MS + 2000);
+    TEST_ASSERT_EQUAL(std::string::npos, body.find("SCANNER_001", body.find("SCANNER_001") + 1));
+}
+
+void test_batch_msgpack_other_device_inline() {
+    auto batch = sampleMsgPackBatch();
+    batch[1].deviceId = "SCANNER_OLD";  // Renamed while it was queued
+    std::string body = encodeBatch(services::PayloadEncoding::MsgPack, batch);
+
+    JsonDocument doc;
+    TEST_ASSERT_TRUE(deserializeMsgPack(doc, body.data(), body.size()) == DeserializationError::Ok);
+    JsonArray tx = doc["transactions"].as<JsonArray>();
+    TEST_ASSERT_EQUAL(3, tx[0].as<JsonArray>().size());
+    TEST_ASSERT_EQUAL(5, tx[1].as<JsonArray>().size());
+    TEST_ASSERT_EQUAL_STRING("SCANNER_OLD", tx[1][3].as<const char*>());
+    TEST_ASSERT_EQUAL_STRING("esp32", tx[1][4].as<const char*>());
+}
+
+void test_batch_msgpack_large_batch_header() {
+    std::vector<models::ScanData> batch;
+    for (int i = 0; i < 40; i++) {
+        batch.push_back(models::ScanData("kaa001", "001", "SCANNER_001", "2026-04-01T12:00:00.000Z"));
+    }
+    std::string body = encodeBatch(services::PayloadEncoding::MsgPack, batch);  // array16 header
+
+    JsonDocument doc;
+    TEST_ASSERT_TRUE(deserializeMsgPack(doc, body.data(), body.size()) == DeserializationError::Ok);
+    TEST_ASSERT_EQUAL(40, doc["transactions"].as<JsonArray>().size());
+}
+
+void test_negotiate_encoding() {
+    JsonDocument doc;
+    deserializeJson(doc, "{\"status\":\"online\",\"scanEncodings\":[\"json\",\"msgpack\"]}");
+    TEST_ASSERT_TRUE(services::negotiateEncoding(doc["scanEncodings"]) == services::PayloadEncoding::MsgPack);
+
+    deserializeJson(doc, "{\"status\":\"online\",\"scanEncodings\":[\"json\",\"cbor\"]}");
+    TEST_ASSERT_TRUE(services::negotiateEncoding(doc["scanEncodings"]) == services::PayloadEncoding::Json);
+
+    deserializeJson(doc, "{\"status\":\"online\"}");  // Older server
+    TEST_ASSERT_TRUE(services::negotiateEncoding(doc["scanEncodings"]) == services::PayloadEncoding::Json);
+
+    deserializeJson(doc, "{\"scanEncodings\":\"msgpack\"}");  // Not an array
+    TEST_ASSERT_TRUE(services::negotiateEncoding(doc["scanEncodings"]) == services::PayloadEncoding::Json);
+}
+
+void test_bench_batch_size_and_encode_time() {
+    std::vector<models::ScanData> batch;
+    char token[16], ts[32];
+    for (int i = 0; i < queue_config::MAX_QUEUE_SIZE; i++) {
+        snprintf(token, sizeof(token), "kaa%03d", i);
+        snprintf(ts, sizeof(ts), "2026-04-01T12:%02d:%02d.%03dZ", i / 60, i % 60, i * 7 % 1000);
+        batch.push_back(models::ScanData(token, i % 3 ? "001" : "", "SCANNER_FLOOR1_001", ts));
+    }
+
+    const int rounds = 50;
+    size_t bytes[2] = {0, 0};
+    double usPerBatch[2] = {0, 0};
+    const services::PayloadEncoding encodings[2] = {services::PayloadEncoding::Json,
+                                                    services::PayloadEncoding::MsgPack};
+    for (int e = 0; e < 2; e++) {
+        auto start = std::chrono::steady_clock::now();
+        for (int r = 0; r < rounds; r++) bytes[e] = encodeBatch(encodings[e], batch).size();
+        auto us = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count();
+        usPerBatch[e] = (double)us / rounds;  // Measure + stream, as the drain does
+    }
+
+    printf("[BENCH] %d-scan batch: JSON %u bytes (%.0f us), msgpack %u bytes (%.0f us), %.1fx smaller\n",
+           queue_config::MAX_QUEUE_SIZE, (unsigned)bytes[0], usPerBatch[0],
+           (unsigned)bytes[1], usPerBatch[1], (double)bytes[0] / bytes[1]);
+    TEST_ASSERT_TRUE(bytes[1] * 3 < bytes[0]);
+}
+
 int main(int argc, char** argv) {
     UNITY_BEGIN();
 
@@ -231,5 +514,22 @@ int main(int argc, char** argv) {
     RUN_TEST(test_buildBatchJson_omits_empty_teamId_in_transactions);
     RUN_TEST(test_buildBatchJson_empty_batch);
 
+    // Streamed batch body
+    RUN_TEST(test_batch_pieces_match_buildBatchJson);
+    RUN_TEST(test_batch_reader_output_is_valid_json);
+    RUN_TEST(test_batch_reader_rewind_restarts_body);
+    RUN_TEST(test_batch_reader_source_failure_stops_short);
+    RUN_TEST(test_batch_reader_length_mismatch_fails);
+    RUN_TEST(test_json_string_escapes_control_characters);
+
+    // MessagePack encoding
+    RUN_TEST(test_scan_msgpack_fields);
+    RUN_TEST(test_scan_msgpack_omits_empty_team_and_keeps_odd_timestamp);
+    RUN_TEST(test_batch_msgpack_names_device_once);
+    RUN_TEST(test_batch_msgpack_other_device_inline);
+    RUN_TEST(test_batch_msgpack_large_batch_header);
+    RUN_TEST(test_negotiate_encoding);
+    RUN_TEST(test_bench_batch_size_and_encode_time);
+
     return UNITY_END();
 }
@@ -0,0 +1,427 @@
+#include <unity.h>
+#include <Arduino.h>
+#include <SD.h>
+#include <map>
+#include <string>
+#include "services/QueueRing.h"
+#include "services/AtomicFile.h"
+#include "services/AssetSink.h"
+#include "hal/AssetPack.h"
+
+// Power-loss harness. Each workload runs once to count its mutating SD
+// operations, then again with the power cut at every one of them in turn;
+// after each cut the card is "rebooted", boot recovery runs, and the
+// invariants below are checked:
+//   - queue: no acknowledged scan is lost and none reappears out of order;
+//     only the append in flight may be lost, only the batch whose removal
+//     was in flight may be re-sent
+//   - assets: no manifest entry claims the current remote sha1 while the
+//     file a reader would open holds other bytes (sync would never repair
+//     that), and one clean sync afterwards converges
+// Runs on the host-directory SD backend (FATFS rename/mkdir semantics).
+
+static std::string root;
+
+void setUp(void) {
+    mock::sdMountHost(root);
+    mock::sdReset();
+}
+
+void tearDown(void) {}
+
+// Run work once unarmed to count ops, then cut at each op in turn
+template <typename Setup, typename Work, typename Check>
+static uint32_t sweep(Setup setup, Work work, Check check) {
+    mock::sdReset();
+    setup();
+    mock::sdArmPowerCut(0);
+    work();
+    uint32_t total = mock::sdFault.ops;
+
+    for (uint32_t cut = 1; cut <= total; cut++) {
+        mock::sdReset();
+        setup();
+        mock::sdArmPowerCut(cut);
+        work();
+        bool lost = mock::sdPowerLost();
+        mock::sdPowerRestore();
+        if (!lost || !check(cut)) return cut;
+    }
+    return 0;
+}
+
+// ─── Queue ring ───────────────────────────────────────────────────────
+
+static const char* RING = "/queue.ring";
+static const uint32_t RING_CAP = 4096;
+
+static uint16_t scanRecord(uint32_t i, uint8_t* buf) {
+    return static_cast<uint16_t>(snprintf(reinterpret_cast<char*>(buf), 96,
+        "{\"tokenId\":\"tok%04lu\",\"teamId\":\"001\",\"timestamp\":\"2025-10-19T14:30:45Z\"}",
+        (unsigned long)i));
+}
+
+static uint32_t recordIndex(const uint8_t* data) {
+    const char* p = strstr(reinterpret_cast<const char*>(data), ":\"tok");
+    return p ? static_cast<uint32_t>(atoi(p + 5)) : UINT32_MAX;
+}
+
+// What the workload had acknowledged when the power went, as ranges:
+// records [lo, hi) must survive; lo may still be loMin (removal in
+// flight), hi may reach hiMax (append in flight)
+struct QueueProgress {
+    uint32_t loMin = 0, lo = 0;
+    uint32_t hi = 0, hiMax = 0;
+};
+
+static QueueProgress queueProgress;
+
+static void queueWork() {
+    QueueProgress& q = queueProgress;
+    q = QueueProgress();
+    services::QueueRing ring(RING, RING_CAP, 100);
+    if (ring.open() == services::QueueRing::OpenResult::Failed) return;
+
+    uint8_t buf[96];
+    auto appendOne = [&]() {
+        q.hiMax = q.hi + 1;
+        if (ring.append(buf, scanRecord(q.hi, buf))) q.hi++;
+    };
+    auto drain = [&](uint32_t n) {
+        uint32_t base = q.lo;
+        auto cursor = ring.peek(n, [](const uint8_t*, uint16_t) {});
+        q.loMin = q.lo;
+        if (cursor.count > 0 && ring.consume(cursor)) q.lo = base + cursor.count;
+        q.loMin = q.lo;
+    };
+
+    for (int i = 0; i < 6; i++) appendOne();
+    drain(4);
+    // Journal flush: one batch, one header commit
+    uint32_t batchStart = q.hi;
+    q.hiMax = batchStart + 4;
+    uint32_t next = batchStart;
+    uint32_t added = ring.appendBatch([&](uint8_t* out, uint16_t) -> uint16_t {
+        return next < batchStart + 4 ? scanRecord(next++, out) : 0;
+    });
+    q.hi += added;
+    drain(3);
+    for (int i = 0; i < 3; i++) appendOne();
+    drain(10);
+}
+
+static bool queueCheck(uint32_t cut) {
+    const QueueProgress& q = queueProgress;
+    services::QueueRing ring(RING, RING_CAP, 100);
+    auto result = ring.open();
+    if (result == services::QueueRing::OpenResult::Failed) return false;
+    if (result != services::QueueRing::OpenResult::Loaded && q.hi > 0) {
+        printf("cut %lu: ring not loaded (%d) after %lu acked appends\n",
+               (unsigned long)cut, (int)result, (unsigned long)q.hi);
+        return false;
+    }
+
+    std::vector<uint32_t> got;
+    ring.peek(ring.count(), [&](const uint8_t* d, uint16_t) { got.push_back(recordIndex(d)); });
+    uint32_t first = got.empty() ? q.lo : got.front();
+    uint32_t end = got.empty() ? q.lo : got.back() + 1;
+    bool contiguous = true;
+    for (size_t i = 0; i < got.size(); i++) contiguous &= got[i] == first + i;
+
+    bool ok = contiguous && ring.damagedCount() == 0 &&
+              first >= q.loMin && first <= q.lo &&
+              end >= q.hi && end <= q.hiMax;
+    // Empty ring: everything acked was consumed (or never appended)
+    if (got.empty()) ok = ring.damagedCount() == 0 && q.lo >= q.hi;
+    if (!ok) {
+        printf("cut %lu: ring holds [%lu, %lu) x%u, expected start in [%lu, %lu], "
+               "end in [%lu, %lu]\n", (unsigned long)cut, (unsigned long)first,
+               (unsigned long)end, (unsigned)got.size(), (unsigned long)q.loMin,
+               (unsigned long)q.lo, (unsigned long)q.hi, (unsigned long)q.hiMax);
+        return false;
+    }
+
+    // Still usable after recovery
+    uint8_t buf[96];
+    return ring.append(buf, scanRecord(999, buf));
+}
+
+void test_queue_ring_survives_power_loss_at_every_op() {
+    uint32_t failedAt = sweep([] {}, queueWork, queueCheck);
+    TEST_ASSERT_EQUAL(0, failedAt);
+}
+
+// ─── Asset sync (loose files and pack) ───────────────────────────────
+
+static const char* MANIFEST = "/assets/manifest.txt";
+static const char* MANIFEST_TMP = "/assets/manifest.tmp";
+static const char* PACK = "/assets.pack";
+
+struct Asset {
+    const char* tokenId;
+    int version;
+};
+
+// v1 on the card before the workload, v2 on the server
+static const Asset V1[] = { {"kaa001", 1}, {"kaa002", 1}, {"kaa003", 1}, {"kaa004", 1} };
+static const Asset V2[] = { {"kaa001", 1}, {"kaa002", 2}, {"kaa003", 2}, {"kaa005", 1} };
+
+static std::string content(const std::string& tokenId, int version) {
+    std::string out(700 + version * 37, '\0');  // Spans sectors, uneven size
+    uint32_t x = services::crc32(reinterpret_cast<const uint8_t*>(tokenId.data()),
+                                 tokenId.size(), static_cast<uint32_t>(version));
+    for (char& c : out) {
+        x = x * 1103515245u + 12345u;
+        c = static_cast<char>(x >> 16);
+    }
+    return out;
+}
+
+// Stand-in for the SHA-1 (no mbedtls natively): 40 hex chars from CRC-32
+static std::string digest(const std::string& bytes) {
+    char hex[9];
+    snprintf(hex, sizeof(hex), "%08lx", (unsigned long)services::crc32(
+        reinterpret_cast<const uint8_t*>(bytes.data()), bytes.size()));
+    std::string out;
+    for (int i = 0; i < 5; i++) out += hex;
+    return out;
+}
+
+static std::map<std::string, std::string> remoteSet(const Asset* set, size_t n) {
+    std::map<std::string, std::string> out;
+    for (size_t i = 0; i < n; i++) out[set[i].tokenId] = digest(content(set[i].tokenId, set[i].version));
+    return out;
+}
+
+static String imagePath(const std::string& tokenId) {
+    return String(paths::IMAGES_DIR) + tokenId.c_str() + ".bmp";
+}
+
+// Manifest: "tokenId sha1" lines, replaced through atomic_file like the
+// JSON one; false if absent or unparseable
+static bool loadManifest(std::map<std::string, std::string>& out) {
+    out.clear();
+    services::atomic_file::recover(MANIFEST_TMP, MANIFEST);
+    File f = SD.open(MANIFEST, FILE_READ);
+    if (!f) return false;
+    while (f.available() > 0) {
+        String line = f.readStringUntil('\n');
+        int sp = line.indexOf(' ');
+        if (sp <= 0 || line.length() - sp - 1 != 40) return false;
+        out[line.substring(0, sp).c_str()] = line.substring(sp + 1).c_str();
+    }
+    return true;
+}
+
+static bool writeManifest(const std::map<std::string, std::string>& m) {
+    return services::atomic_file::write(MANIFEST_TMP, MANIFEST, [&](File& f) {
+        for (const auto& kv : m) f.println(String((kv.first + " " + kv.second).c_str()));
+        return true;
+    });
+}
+
+template <typename Sink>
+static bool stream(Sink& sink, const std::string& bytes) {
+    if (!sink.open()) return false;
+    size_t half = bytes.size() / 2;
+    bool ok = sink.write(reinterpret_cast<const uint8_t*>(bytes.data()), half) == half &&
+              sink.write(reinterpret_cast<const uint8_t*>(bytes.data()) + half,
+                         bytes.size() - half) == bytes.size() - half;
+    sink.close();
+    if (!ok || !sink.commit()) {
+        sink.discard();
+        return false;
+    }
+    return true;
+}
+
+// AssetService::syncFromOrchestrator() minus the network: diff, download
+// each pending file and commit the manifest after each, then prune
+static void syncAssets(const Asset* set, size_t n, bool usePack) {
+    std::map<std::string, std::string> remote = remoteSet(set, n);
+    std::map<std::string, std::string> local;
+    loadManifest(local);
+    hal::AssetPack pack(PACK, 16);
+    if (usePack) pack.load();
+
+    for (size_t i = 0; i < n; i++) {
+        std::string id = set[i].tokenId;
+        if (local.count(id) && local[id] == remote[id]) continue;
+        std::string bytes = content(id, set[i].version);
+        bool ok;
+        if (usePack && pack.isLoaded()) {
+            services::AssetPackSink sink(pack, imagePath(id));
+            ok = sink.prepare(hal::AssetPack::IMAGE, id.c_str(), "bmp", bytes.size(),
+                              remote[id].c_str()) && stream(sink, bytes);
+        } else {
+            services::AssetFileSink sink(imagePath(id));
+            ok = stream(sink, bytes);
+        }
+        if (!ok) continue;
+        local[id] = remote[id];
+        writeManifest(local);
+    }
+
+    std::vector<std::string> orphans;
+    for (const auto& kv : local) if (!remote.count(kv.first)) orphans.push_back(kv.first);
+    for (const auto& id : orphans) {
+        SD.remove(imagePath(id).c_str());
+        if (pack.isLoaded()) pack.remove(hal::AssetPack::IMAGE, id.c_str());
+        local.erase(id);
+    }
+    if (!orphans.empty()) writeManifest(local);
+}
+
+// What DisplayDriver::drawBMP() would read: packed copy first, then loose
+static std::string readAsset(const std::string& tokenId, hal::AssetPack& pack) {
+    hal::AssetPack::Extent e;
+    String path = imagePath(tokenId);
+    bool packed = pack.resolve(path, e);
+    File f = SD.open(packed ? String(PACK) : path, FILE_READ);
+    if (!f) return "<missing>";
+    size_t len = packed ? e.length : f.size();
+    if (packed) f.seek(e.offset);
+    std::string out(len, '\0');
+    f.read(reinterpret_cast<uint8_t*>(&out[0]), len);
+    return out;
+}
+
+static bool assetsConsistent(uint32_t cut, bool usePack, bool converged) {
+    std::map<std::string, std::string> remote = remoteSet(V2, 4);
+    std::map<std::string, std::string> local;
+    if (!loadManifest(local)) {
+        printf("cut %lu: manifest lost\n", (unsigned long)cut);
+        return false;
+    }
+    hal::AssetPack pack(PACK, 16);
+    if (usePack && !pack.load()) {
+        printf("cut %lu: asset pack index unreadable\n", (unsigned long)cut);
+        return false;
+    }
+    for (const auto& kv : local) {
+        bool current = remote.count(kv.first) && remote[kv.first] == kv.second;
+        if (!current) continue;  // Next sync re-fetches or prunes it
+        if (digest(readAsset(kv.first, pack)) != kv.second) {
+            printf("cut %lu: %s listed current but file differs\n",
+                   (unsigned long)cut, kv.first.c_str());
+            return false;
+        }
+    }
+    return !converged || local == remote;
+}
+
+static void looseSetup() {
+    SD.mkdir("/assets");
+    SD.mkdir(paths::IMAGES_DIR);
+    syncAssets(V1, 4, false);
+}
+
+static void packSetup() {
+    SD.mkdir("/assets");
+    SD.mkdir(paths::IMAGES_DIR);
+    hal::AssetPack pack(PACK, 16);
+    pack.create(16 * 1024);
+    syncAssets(V1, 4, true);
+}
+
+void test_loose_asset_sync_survives_power_loss_at_every_op() {
+    uint32_t failedAt = sweep(looseSetup, [] { syncAssets(V2, 4, false); }, [](uint32_t cut) {
+        if (!assetsConsistent(cut, false, false)) return false;
+        syncAssets(V2, 4, false);
+        return assetsConsistent(cut, false, true);
+    });
+    TEST_ASSERT_EQUAL(0, failedAt);
+}
+
+void test_packed_asset_sync_survives_power_loss_at_every_op() {
+    uint32_t failedAt = sweep(packSetup, [] { syncAssets(V2, 4, true); }, [](uint32_t cut) {
+        if (!assetsConsistent(cut, true, false)) return false;
+        syncAssets(V2, 4, true);
+        return assetsConsistent(cut, true, true);
+    });
+    TEST_ASSERT_EQUAL(0, failedAt);
+}
+
+// ─── atomic_file recovery states ─────────────────────────────────────
+
+static void put(const char* path, const char* text) {
+    File f = SD.open(path, FILE_WRITE);
+    f.print(text);
+    f.close();
+}
+
+void test_recover_keeps_dest_and_drops_tmp() {
+    put("/m.json", "old");
+    put("/m.tmp", "new-partial");
+    TEST_ASSERT_FALSE(services::atomic_file::recover("/m.tmp", "/m.json"));
+    TEST_ASSERT_FALSE(SD.exists("/m.tmp"));
+    File f = SD.open("/m.json", FILE_READ);
+    TEST_ASSERT_EQUAL(3, (int)f.size());
+}
+
+void test_recover_installs_orphaned_tmp() {
+    put("/m.tmp", "new");
+    TEST_ASSERT_TRUE(services::atomic_file::recover("/m.tmp", "/m.json"));
+    TEST_ASSERT_TRUE(SD.exists("/m.json"));
+    TEST_ASSERT_FALSE(SD.exists("/m.tmp"));
+    TEST_ASSERT_FALSE(services::atomic_file::recover("/m.tmp", "/m.json"));
+}
+
+void test_failed_body_leaves_dest_untouched() {
+    put("/m.json", "old");
+    TEST_ASSERT_FALSE(services::atomic_file::write("/m.tmp", "/m.json",
+                                                   [](File&) { return false; }));
+    TEST_ASSERT_FALSE(SD.exists("/m.tmp"));
+    File f = SD.open("/m.json", FILE_READ);
+    TEST_ASSERT_EQUAL(3, (int)f.size());
+}
+
+// ─── Fault model ─────────────────────────────────────────────────────
+
+void test_unsynced_growth_lost_at_cut() {
+    put("/f.bin", "1234");
+    File f = SD.open("/f.bin", FILE_APPEND);
+    f.print("5678");
+    f.flush();
+    f.print("90");           // Not synced
+    mock::sdArmPowerCut(1);
+    TEST_ASSERT_FALSE(SD.remove("/other"));  // The cut
+    TEST_ASSERT_TRUE(mock::sdPowerLost());
+    TEST_ASSERT_FALSE((bool)SD.open("/f.bin", FILE_READ));
+    mock::sdPowerRestore();
+    File r = SD.open("/f.bin", FILE_READ);
+    TEST_ASSERT_EQUAL(8, (int)r.size());
+}
+
+void test_cut_write_is_torn() {
+    File f = SD.open("/t.bin", FILE_WRITE);
+    f.print("abcd");
+    f.flush();
+    f.seek(0);
+    mock::sdArmPowerCut(1);
+    TEST_ASSERT_EQUAL(0, (int)f.print("WXYZ"));
+    mock::sdPowerRestore();
+    File r = SD.open("/t.bin", FILE_READ);
+    char buf[5] = {};
+    r.read(reinterpret_cast<uint8_t*>(buf), 4);
+    TEST_ASSERT_EQUAL_STRING("WXcd", buf);
+}
+
+int main(int argc, char** argv) {
+    root = mock::sdMakeTempRoot();
+    if (root.empty()) return 1;
+
+    UNITY_BEGIN();
+    RUN_TEST(test_unsynced_growth_lost_at_cut);
+    RUN_TEST(test_cut_write_is_torn);
+    RUN_TEST(test_recover_keeps_dest_and_drops_tmp);
+    RUN_TEST(test_recover_installs_orphaned_tmp);
+    RUN_TEST(test_failed_body_leaves_dest_untouched);
+    RUN_TEST(test_queue_ring_survives_power_loss_at_every_op);
+    RUN_TEST(test_loose_asset_sync_survives_power_loss_at_every_op);
+    RUN_TEST(test_packed_asset_sync_survives_power_loss_at_every_op);
+    int failures = UNITY_END();
+
+    mock::sdUnmountHost();
+    return failures;
+}
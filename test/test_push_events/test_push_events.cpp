@@ -0,0 +1,193 @@
+#include <unity.h>
+#include <Arduino.h>
+#include <string>
+#include <vector>
+#include "services/PushEvents.h"
+
+// Push channel wire format: event stream parsing, names, reconnect backoff.
+
+void setUp(void) {}
+void tearDown(void) {}
+
+struct Events {
+    std::vector<std::string> names;
+    std::vector<std::string> data;
+    void onEvent(const char* name, const char* d) {
+        names.push_back(name);
+        data.push_back(d);
+    }
+};
+
+static void feed(services::SseParser& p, Events& ev, const std::string& s, size_t slice = 0) {
+    if (slice == 0) slice = s.size();
+    for (size_t off = 0; off < s.size(); off += slice) {
+        size_t n = std::min(slice, s.size() - off);
+        p.feed(reinterpret_cast<const uint8_t*>(s.data()) + off, n, ev);
+    }
+}
+
+// ─── Event stream ─────────────────────────────────────────────────────
+
+static const char* STREAM =
+    ": connected\n\n"
+    "event: health\n"
+    "data: {\"status\":\"online\",\"timezone\":\"PST8PDT,M3.2.0,M11.1.0\"}\n\n"
+    ": ping\n\n"
+    "event: session\n"
+    "data: {\"status\":\"active\"}\n\n"
+    "event: tokens\n"
+    "data: {}\n\n";
+
+void test_stream_any_slicing() {
+    const size_t slices[] = {1, 2, 5, 13, 64, 0};
+    for (size_t slice : slices) {
+        services::SseParser p;
+        Events ev;
+        feed(p, ev, STREAM, slice);
+        TEST_ASSERT_EQUAL(3, (int)ev.names.size());
+        TEST_ASSERT_EQUAL_STRING("health", ev.names[0].c_str());
+        TEST_ASSERT_EQUAL_STRING("{\"status\":\"online\",\"timezone\":\"PST8PDT,M3.2.0,M11.1.0\"}",
+                                 ev.data[0].c_str());
+        TEST_ASSERT_EQUAL_STRING("session", ev.names[1].c_str());
+        TEST_ASSERT_EQUAL_STRING("tokens", ev.names[2].c_str());
+        TEST_ASSERT_EQUAL(2, (int)p.comments());
+    }
+}
+
+void test_crlf_and_cr_line_ends() {
+    services::SseParser p;
+    Events ev;
+    feed(p, ev, "event: assets\r\ndata: a\r\n\r\nevent: tokens\rdata: b\r\r", 1);
+    TEST_ASSERT_EQUAL(2, (int)ev.names.size());
+    TEST_ASSERT_EQUAL_STRING("assets", ev.names[0].c_str());
+    TEST_ASSERT_EQUAL_STRING("a", ev.data[0].c_str());
+    TEST_ASSERT_EQUAL_STRING("tokens", ev.names[1].c_str());
+    TEST_ASSERT_EQUAL_STRING("b", ev.data[1].c_str());
+}
+
+void test_multiline_data_and_defaults() {
+    services::SseParser p;
+    Events ev;
+    feed(p, ev, "data: one\ndata:two\ndata\n\n"   // No space, then empty value
+                "event: health\n\n"               // No data: not dispatched
+                "id: 7\ndata: x\n\n");            // Name reset after dispatch
+    TEST_ASSERT_EQUAL(2, (int)ev.names.size());
+    TEST_ASSERT_EQUAL_STRING("message", ev.names[0].c_str());
+    TEST_ASSERT_EQUAL_STRING("one\ntwo\n", ev.data[0].c_str());
+    TEST_ASSERT_EQUAL_STRING("message", ev.names[1].c_str());
+    TEST_ASSERT_EQUAL_STRING("x", ev.data[1].c_str());
+}
+
+void test_event_is_not_dispatched_until_blank_line() {
+    services::SseParser p;
+    Events ev;
+    feed(p, ev, "event: tokens\ndata: {}\n");
+    TEST_ASSERT_EQUAL(0, (int)ev.names.size());
+    feed(p, ev, "\n");
+    TEST_ASSERT_EQUAL(1, (int)ev.names.size());
+}
+
+void test_oversized_event_dropped_whole() {
+    services::SseParser p;
+    Events ev;
+    std::string big(http_config::PUSH_MAX_EVENT_BYTES + 10, 'x');
+    feed(p, ev, "event: session\ndata: " + big + "\n\n");
+    // Within the line limit, but the joined data is too long
+    std::string half(http_config::PUSH_MAX_EVENT_BYTES / 2, 'y');
+    feed(p, ev, "data: " + half + "\ndata: " + half + "\n\n");
+    feed(p, ev, "event: tokens\ndata: ok\n\n");
+    TEST_ASSERT_EQUAL(1, (int)ev.names.size());
+    TEST_ASSERT_EQUAL_STRING("tokens", ev.names[0].c_str());
+    TEST_ASSERT_EQUAL(2, (int)p.dropped());
+}
+
+void test_long_comment_does_not_spoil_next_event() {
+    services::SseParser p;
+    Events ev;
+    feed(p, ev, ":" + std::string(http_config::PUSH_MAX_EVENT_BYTES * 2, 'p') + "\n"
+                "event: assets\ndata: {}\n\n");
+    TEST_ASSERT_EQUAL(1, (int)ev.names.size());
+    TEST_ASSERT_EQUAL(0, (int)p.dropped());
+    TEST_ASSERT_EQUAL(1, (int)p.comments());
+}
+
+void test_retry_field() {
+    services::SseParser p;
+    Events ev;
+    TEST_ASSERT_EQUAL(0, (int)p.retryMs());
+    feed(p, ev, "retry: 5000\n\nretry: soon\n\n");
+    TEST_ASSERT_EQUAL(5000, (int)p.retryMs());
+    TEST_ASSERT_EQUAL(0, (int)ev.names.size());
+}
+
+// ─── Names ────────────────────────────────────────────────────────────
+
+void test_event_names() {
+    TEST_ASSERT_TRUE(services::parsePushEvent("health") == services::PushEvent::Health);
+    TEST_ASSERT_TRUE(services::parsePushEvent("timezone") == services::PushEvent::Timezone);
+    TEST_ASSERT_TRUE(services::parsePushEvent("session") == services::PushEvent::Session);
+    TEST_ASSERT_TRUE(services::parsePushEvent("tokens") == services::PushEvent::Tokens);
+    TEST_ASSERT_TRUE(services::parsePushEvent("assets") == services::PushEvent::Assets);
+    TEST_ASSERT_TRUE(services::parsePushEvent("message") == services::PushEvent::Unknown);
+    TEST_ASSERT_TRUE(services::parsePushEvent("Tokens") == services::PushEvent::Unknown);
+}
+
+void test_session_states() {
+    TEST_ASSERT_TRUE(services::parseSessionState("active") == services::SessionState::Active);
+    TEST_ASSERT_TRUE(services::parseSessionState("paused") == services::SessionState::Paused);
+    TEST_ASSERT_TRUE(services::parseSessionState("ended") == services::SessionState::Ended);
+    TEST_ASSERT_TRUE(services::parseSessionState(nullptr) == services::SessionState::None);
+    TEST_ASSERT_TRUE(services::parseSessionState("") == services::SessionState::None);
+    TEST_ASSERT_TRUE(services::parseSessionState("setup") == services::SessionState::Unknown);
+    TEST_ASSERT_EQUAL_STRING("ACTIVE", services::sessionStateName(services::SessionState::Active));
+}
+
+// ─── Backoff ──────────────────────────────────────────────────────────
+
+void test_backoff_doubles_to_cap() {
+    services::PushBackoff b;
+    TEST_ASSERT_EQUAL(http_config::PUSH_RETRY_MIN_MS, b.afterFailure());
+    TEST_ASSERT_EQUAL(http_config::PUSH_RETRY_MIN_MS * 2, b.afterFailure());
+    for (int i = 0; i < 20; i++) b.afterFailure();
+    TEST_ASSERT_EQUAL(http_config::PUSH_RETRY_MAX_MS, b.afterFailure());
+}
+
+void test_backoff_stable_link_starts_over() {
+    services::PushBackoff b;
+    b.afterFailure();
+    b.afterFailure();
+    // Flapping link keeps backing off
+    TEST_ASSERT_EQUAL(http_config::PUSH_RETRY_MIN_MS * 4, b.afterDrop(1000));
+    TEST_ASSERT_EQUAL(http_config::PUSH_RETRY_MIN_MS,
+                      b.afterDrop(http_config::PUSH_STABLE_MS));
+}
+
+void test_backoff_unsupported_and_hint() {
+    services::PushBackoff b;
+    b.afterFailure();
+    TEST_ASSERT_EQUAL(http_config::PUSH_UNSUPPORTED_RETRY_MS, b.afterUnsupported());
+    TEST_ASSERT_EQUAL(http_config::PUSH_RETRY_MIN_MS, b.afterFailure());  // Reset
+
+    services::PushBackoff h;
+    h.setHint(10000);
+    TEST_ASSERT_EQUAL(10000, (int)h.afterFailure());
+    h.setHint(1);  // Clamped
+    TEST_ASSERT_EQUAL(http_config::PUSH_RETRY_MIN_MS, h.afterDrop(http_config::PUSH_STABLE_MS));
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_stream_any_slicing);
+    RUN_TEST(test_crlf_and_cr_line_ends);
+    RUN_TEST(test_multiline_data_and_defaults);
+    RUN_TEST(test_event_is_not_dispatched_until_blank_line);
+    RUN_TEST(test_oversized_event_dropped_whole);
+    RUN_TEST(test_long_comment_does_not_spoil_next_event);
+    RUN_TEST(test_retry_field);
+    RUN_TEST(test_event_names);
+    RUN_TEST(test_session_states);
+    RUN_TEST(test_backoff_doubles_to_cap);
+    RUN_TEST(test_backoff_stable_link_starts_over);
+    RUN_TEST(test_backoff_unsupported_and_hint);
+    return UNITY_END();
+}
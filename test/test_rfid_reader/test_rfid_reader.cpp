@@ -0,0 +1,291 @@
+#include <unity.h>
+#include <Arduino.h>
+#include <MFRC522Emulator.h>
+#include "hal/RFIDReader.h"
+
+// The real RFIDReader bit-bangs its software SPI into the register-level
+// MFRC522 emulator, which talks to a scripted NTAG card. All timing is the
+// mock's virtual clock, so durations and operation counts are exact.
+
+static mock::MFRC522Emulator emu(pins::RFID_SCK, pins::RFID_MOSI,
+                                 pins::RFID_MISO, pins::RFID_SS);
+static mock::NtagCard card;
+
+static hal::RFIDReader& reader() { return hal::RFIDReader::getInstance(); }
+
+void setUp(void) {
+    card = mock::NtagCard(mock::NtagType::NTAG215);
+    card.writeNdefText("kaa001");
+    emu.insertCard(&card);
+    reader().disableRFField();
+    reader().resetStats();
+    emu.resetCounters();
+}
+
+void tearDown(void) {
+    emu.removeCard();
+}
+
+// Full scan as the scan task runs it: detect, then NDEF read.
+static String scanOnce(hal::DetectResult* detect = nullptr) {
+    MFRC522::Uid uid = {};
+    hal::DetectResult result = reader().detectCard(uid);
+    if (detect) *detect = result;
+    if (result != hal::DetectResult::Detected) return "";
+    return reader().extractNDEFText();
+}
+
+// ─── Initialization ───────────────────────────────────────────────────
+
+void test_begin_configures_chip() {
+    TEST_ASSERT_TRUE(reader().isInitialized());
+    TEST_ASSERT_EQUAL_HEX8(0x40, emu.peek(MFRC522::RFCfgReg));  // 33 dB, not max gain
+    TEST_ASSERT_EQUAL_HEX8(0x3D, emu.peek(MFRC522::ModeReg));   // CRC preset 0x6363
+    TEST_ASSERT_EQUAL_HEX8(0x00, emu.peek(MFRC522::TModeReg));  // timer off (beeping fix)
+    TEST_ASSERT_FALSE(emu.fieldOn());                           // antenna deferred
+}
+
+// ─── Detection ────────────────────────────────────────────────────────
+
+void test_no_card_returns_nocard_on_first_timeout() {
+    emu.removeCard();
+    uint64_t start = mock::nowUs;
+
+    MFRC522::Uid uid = {};
+    TEST_ASSERT_EQUAL(static_cast<int>(hal::DetectResult::NoCard),
+                      static_cast<int>(reader().detectCard(uid)));
+
+    // One WUPA answered by the 25 ms PCD timer — no retries spent.
+    TEST_ASSERT_EQUAL(1, (int)emu.counters().rfFrames);
+    TEST_ASSERT_EQUAL(1, (int)emu.counters().rfTimeouts);
+    TEST_ASSERT_FALSE(emu.fieldOn());
+    TEST_ASSERT_LESS_THAN(40000, (long)(mock::nowUs - start));
+}
+
+void test_detect_selects_seven_byte_uid() {
+    MFRC522::Uid uid = {};
+    TEST_ASSERT_EQUAL(static_cast<int>(hal::DetectResult::Detected),
+                      static_cast<int>(reader().detectCard(uid)));
+
+    TEST_ASSERT_EQUAL(7, uid.size);
+    TEST_ASSERT_EQUAL_MEMORY(card.uid(), uid.uidByte, 7);
+    TEST_ASSERT_EQUAL_HEX8(0x00, uid.sak);
+    TEST_ASSERT_EQUAL(static_cast<int>(mock::CardState::Active),
+                      static_cast<int>(card.state()));
+    // WUPA + anticollision/select at both cascade levels
+    TEST_ASSERT_EQUAL(5, (int)emu.counters().rfFrames);
+    reader().disableRFField();
+}
+
+// ─── NDEF extraction ──────────────────────────────────────────────────
+
+void test_short_token_single_fast_read_then_halt() {
+    TEST_ASSERT_EQUAL_STRING("kaa001", scanOnce().c_str());
+
+    TEST_ASSERT_EQUAL(1, (int)card.fastReads);
+    TEST_ASSERT_EQUAL(1, (int)card.halts);
+    TEST_ASSERT_FALSE(emu.fieldOn());  // field off -> card unpowered (IDLE)
+    TEST_ASSERT_EQUAL(1, (int)reader().getStats().successfulScans);
+    TEST_ASSERT_EQUAL(0, (int)reader().getStats().retryCount);
+}
+
+void test_long_text_reads_only_missing_pages() {
+    const char* text = "a-very-long-token-identifier-that-runs-well-past-page-ten";
+    card.writeNdefText(text);
+
+    TEST_ASSERT_EQUAL_STRING(text, scanOnce().c_str());
+    // Header window, then one follow-up for exactly the remaining pages
+    TEST_ASSERT_EQUAL(2, (int)card.fastReads);
+}
+
+void test_ntag213_token() {
+    card = mock::NtagCard(mock::NtagType::NTAG213);
+    card.writeNdefText("rat002");
+    TEST_ASSERT_EQUAL_STRING("rat002", scanOnce().c_str());
+}
+
+void test_blank_card_reads_empty() {
+    card.formatBlank();
+    hal::DetectResult detect;
+    TEST_ASSERT_EQUAL_STRING("", scanOnce(&detect).c_str());
+    TEST_ASSERT_EQUAL(static_cast<int>(hal::DetectResult::Detected),
+                      static_cast<int>(detect));
+    TEST_ASSERT_FALSE(emu.fieldOn());
+}
+
+// ─── Fault injection / retry paths ────────────────────────────────────
+
+// Card browns out during the first FAST_READ; reSelect (WUPA from IDLE)
+// wakes it and the second attempt succeeds.
+void test_dropout_during_read_recovers_via_reselect() {
+    card.injectFault(mock::CardFault::Dropout, 0x3A);
+
+    TEST_ASSERT_EQUAL_STRING("kaa001", scanOnce().c_str());
+    TEST_ASSERT_EQUAL(1, (int)reader().getStats().retryCount);
+    TEST_ASSERT_EQUAL(2, (int)card.wakeups);
+}
+
+// The card answered (and moved to READY1) but the PCD saw a parity error.
+// The retry WUPA is unexpected in READY1 and drops the card to IDLE
+// silently, so it takes the third attempt to detect it.
+void test_parity_error_on_wakeup_is_retried() {
+    card.injectFault(mock::CardFault::ParityError, MFRC522::PICC_CMD_WUPA);
+
+    TEST_ASSERT_EQUAL_STRING("kaa001", scanOnce().c_str());
+    TEST_ASSERT_EQUAL(2, (int)reader().getStats().retryCount);
+}
+
+// Attempts 1 and 3 collide in anticollision; attempt 2's WUPA lands on a
+// READY1 card and times out (see parity test above).
+void test_persistent_collision_reports_comm_failed() {
+    card.injectFault(mock::CardFault::Collision, MFRC522::PICC_CMD_SEL_CL1, 0, 10);
+
+    hal::DetectResult detect;
+    TEST_ASSERT_EQUAL_STRING("", scanOnce(&detect).c_str());
+    TEST_ASSERT_EQUAL(static_cast<int>(hal::DetectResult::CommFailed),
+                      static_cast<int>(detect));
+    TEST_ASSERT_EQUAL(2, (int)reader().getStats().collisionErrors);
+    TEST_ASSERT_EQUAL(1, (int)reader().getStats().failedScans);
+    TEST_ASSERT_FALSE(emu.fieldOn());
+}
+
+// Silent corruption (parity OK) turns the NDEF TLV into a Terminator, so
+// the parse fails with the card still ACTIVE. The reSelect WUPA is then an
+// unexpected frame for an ACTIVE NTAG: it drops to IDLE without answering,
+// costing attempt 2; attempt 3 wakes it properly and reads clean data.
+void test_corrupt_read_recovers_on_third_attempt() {
+    card.injectFault(mock::CardFault::Corrupt, 0x3A, 0, 1, /*byteIndex*/ 4, /*xor*/ 0xFD);
+
+    TEST_ASSERT_EQUAL_STRING("kaa001", scanOnce().c_str());
+    TEST_ASSERT_EQUAL(2, (int)reader().getStats().retryCount);
+}
+
+void test_card_removed_after_detect_exhausts_retries() {
+    MFRC522::Uid uid = {};
+    TEST_ASSERT_EQUAL(static_cast<int>(hal::DetectResult::Detected),
+                      static_cast<int>(reader().detectCard(uid)));
+    emu.removeCard();
+
+    TEST_ASSERT_EQUAL_STRING("", reader().extractNDEFText().c_str());
+    TEST_ASSERT_FALSE(emu.fieldOn());
+}
+
+// ─── Phase statistics ─────────────────────────────────────────────────
+
+void test_clean_scan_records_each_phase_once() {
+    TEST_ASSERT_EQUAL_STRING("kaa001", scanOnce().c_str());
+    const hal::RFIDStats st = reader().getStats();
+
+    TEST_ASSERT_EQUAL(1, (int)st.phase(hal::RFIDPhase::FieldSettle).count);
+    TEST_ASSERT_EQUAL(1, (int)st.phase(hal::RFIDPhase::Wakeup).count);
+    TEST_ASSERT_EQUAL(1, (int)st.phase(hal::RFIDPhase::SelectCL1).count);
+    TEST_ASSERT_EQUAL(1, (int)st.phase(hal::RFIDPhase::SelectCL2).count);
+    TEST_ASSERT_EQUAL(0, (int)st.phase(hal::RFIDPhase::SelectCL3).count);
+    TEST_ASSERT_EQUAL(1, (int)st.phase(hal::RFIDPhase::FastRead).count);
+    TEST_ASSERT_EQUAL(1, (int)st.phase(hal::RFIDPhase::NdefParse).count);
+    TEST_ASSERT_EQUAL(1, (int)st.phase(hal::RFIDPhase::Scan).count);
+
+    // Field settle is dominated by ANTENNA_SETTLE_MS; HLTA by the 25 ms timer
+    TEST_ASSERT_GREATER_OR_EQUAL(rfid_config::ANTENNA_SETTLE_MS * 1000,
+                                 st.phase(hal::RFIDPhase::FieldSettle).maxUs);
+    TEST_ASSERT_GREATER_OR_EQUAL(25000, st.phase(hal::RFIDPhase::Halt).maxUs);
+
+    TEST_ASSERT_EQUAL(1, (int)st.detectAttempts[0]);
+    TEST_ASSERT_EQUAL(1, (int)st.readAttempts[0]);
+    TEST_ASSERT_EQUAL(1, (int)st.cardsSeen());
+    TEST_ASSERT_EQUAL(1, (int)st.tokensRead());
+    st.print();  // Must not crash on populated stats
+}
+
+// Idle polls happen every 500 ms; their WUPA timeouts must not swamp the
+// wakeup histogram.
+void test_idle_poll_not_recorded_as_wakeup() {
+    emu.removeCard();
+    MFRC522::Uid uid = {};
+    reader().detectCard(uid);
+
+    const hal::RFIDStats st = reader().getStats();
+    TEST_ASSERT_EQUAL(0, (int)st.phase(hal::RFIDPhase::Wakeup).count);
+    TEST_ASSERT_EQUAL(0, (int)st.cardsSeen());
+}
+
+void test_retry_lands_in_attempt_histogram() {
+    card.injectFault(mock::CardFault::Dropout, 0x3A);
+    TEST_ASSERT_EQUAL_STRING("kaa001", scanOnce().c_str());
+    const hal::RFIDStats st = reader().getStats();
+
+    TEST_ASSERT_EQUAL(0, (int)st.readAttempts[0]);
+    TEST_ASSERT_EQUAL(1, (int)st.readAttempts[1]);
+    TEST_ASSERT_EQUAL(2, (int)st.phase(hal::RFIDPhase::FastRead).count);
+    TEST_ASSERT_EQUAL(2, (int)st.phase(hal::RFIDPhase::Wakeup).count);  // + reSelect
+    TEST_ASSERT_EQUAL(2, (int)st.phase(hal::RFIDPhase::SelectCL1).count);
+}
+
+// getStats() is a copy: the scan task writing on, or a reset, leaves a
+// snapshot Core 1 is printing untouched.
+void test_stats_snapshot_is_a_copy() {
+    TEST_ASSERT_EQUAL_STRING("kaa001", scanOnce().c_str());
+    const hal::RFIDStats st = reader().getStats();
+    reader().resetStats();
+    TEST_ASSERT_EQUAL(1, (int)st.tokensRead());
+    TEST_ASSERT_EQUAL(1, (int)st.phase(hal::RFIDPhase::Scan).count);
+    TEST_ASSERT_EQUAL(0, (int)reader().getStats().tokensRead());
+}
+
+// ─── Cost accounting ──────────────────────────────────────────────────
+
+// A clean scan costs the same SPI traffic and device time every run —
+// these numbers are the baseline to compare reader changes against.
+void test_scan_cost_is_deterministic() {
+    uint64_t start = mock::nowUs;
+    TEST_ASSERT_EQUAL_STRING("kaa001", scanOnce().c_str());
+    uint64_t firstUs = mock::nowUs - start;
+    mock::MFRC522Counters first = emu.counters();
+
+    setUp();
+    start = mock::nowUs;
+    TEST_ASSERT_EQUAL_STRING("kaa001", scanOnce().c_str());
+    uint64_t secondUs = mock::nowUs - start;
+    mock::MFRC522Counters second = emu.counters();
+
+    TEST_ASSERT_EQUAL(firstUs, secondUs);
+    TEST_ASSERT_EQUAL(first.spiTransactions, second.spiTransactions);
+    TEST_ASSERT_EQUAL(first.spiBytes, second.spiBytes);
+    TEST_ASSERT_EQUAL(first.rfFrames, second.rfFrames);
+
+    // WUPA, 2x (anticoll + select), FAST_READ, HLTA
+    TEST_ASSERT_EQUAL(7, (int)first.rfFrames);
+
+    printf("[BENCH] clean scan: %llu us, %u SPI transactions, %u SPI bytes, "
+           "%u RF frames, %u CRC runs, field on %llu us\n",
+           (unsigned long long)firstUs, first.spiTransactions, first.spiBytes,
+           first.rfFrames, first.crcCalcs,
+           (unsigned long long)emu.fieldOnTimeUs());
+}
+
+// ─── Main ─────────────────────────────────────────────────────────────
+
+int main(int argc, char** argv) {
+    emu.attach();
+    reader().begin();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_begin_configures_chip);
+    RUN_TEST(test_no_card_returns_nocard_on_first_timeout);
+    RUN_TEST(test_detect_selects_seven_byte_uid);
+    RUN_TEST(test_short_token_single_fast_read_then_halt);
+    RUN_TEST(test_long_text_reads_only_missing_pages);
+    RUN_TEST(test_ntag213_token);
+    RUN_TEST(test_blank_card_reads_empty);
+    RUN_TEST(test_dropout_during_read_recovers_via_reselect);
+    RUN_TEST(test_parity_error_on_wakeup_is_retried);
+    RUN_TEST(test_persistent_collision_reports_comm_failed);
+    RUN_TEST(test_corrupt_read_recovers_on_third_attempt);
+    RUN_TEST(test_card_removed_after_detect_exhausts_retries);
+    RUN_TEST(test_clean_scan_records_each_phase_once);
+    RUN_TEST(test_idle_poll_not_recorded_as_wakeup);
+    RUN_TEST(test_retry_lands_in_attempt_histogram);
+    RUN_TEST(test_stats_snapshot_is_a_copy);
+    RUN_TEST(test_scan_cost_is_deterministic);
+    return UNITY_END();
+}
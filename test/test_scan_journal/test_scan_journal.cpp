@@ -0,0 +1,291 @@
+#include <unity.h>
+#include <Arduino.h>
+#include <SD.h>
+#include <string>
+#include <vector>
+#include "services/ScanJournal.h"
+#include "services/QueueRing.h"
+#include "services/ScanRecord.h"
+
+// Write-behind journal flush policy, plus the batched ring append it feeds
+// (SD traffic of one coalesced flush vs. one append per scan).
+
+using Journal = services::ScanJournal<queue_config::SCAN_JOURNAL_DEPTH>;
+
+static const char* RING = "/queue.ring";
+static const uint32_t PLENTY_HEAP = 200000;
+
+void setUp(void) {
+    mock::sdReset();
+}
+
+void tearDown(void) {}
+
+static models::ScanData scan(int i) {
+    char token[16];
+    snprintf(token, sizeof(token), "tok%04d", i);
+    return models::ScanData(token, "001", "SCANNER_FLOOR1_001", "2025-10-19T14:30:45.123Z");
+}
+
+// ─── Flush policy ─────────────────────────────────────────────────────
+
+void test_empty_journal_never_due() {
+    Journal j;
+    j.requestFlush();
+    TEST_ASSERT_FALSE(j.flushDue(100000, 0));
+}
+
+void test_fifo_submit_pop() {
+    Journal j;
+    for (int i = 0; i < 3; i++) TEST_ASSERT_TRUE(j.submit(scan(i), 0));
+    TEST_ASSERT_EQUAL(3, (int)j.size());
+    models::ScanData out;
+    for (int i = 0; i < 3; i++) {
+        TEST_ASSERT_TRUE(j.pop(out));
+        TEST_ASSERT_EQUAL_STRING(scan(i).tokenId.c_str(), out.tokenId.c_str());
+    }
+    TEST_ASSERT_FALSE(j.pop(out));
+}
+
+void test_due_after_flush_interval() {
+    Journal j;
+    j.submit(scan(0), 1000);
+    j.submit(scan(1), 1200);  // Age is measured from the oldest pending scan
+    TEST_ASSERT_FALSE(j.flushDue(1000 + queue_config::SCAN_JOURNAL_FLUSH_MS - 1, PLENTY_HEAP));
+    TEST_ASSERT_TRUE(j.flushDue(1000 + queue_config::SCAN_JOURNAL_FLUSH_MS, PLENTY_HEAP));
+}
+
+void test_due_at_batch_size() {
+    Journal j;
+    for (size_t i = 0; i + 1 < queue_config::SCAN_JOURNAL_BATCH; i++) j.submit(scan(i), 0);
+    TEST_ASSERT_FALSE(j.flushDue(0, PLENTY_HEAP));
+    j.submit(scan(99), 0);
+    TEST_ASSERT_TRUE(j.flushDue(0, PLENTY_HEAP));
+}
+
+void test_due_on_low_heap() {
+    Journal j;
+    j.submit(scan(0), 0);
+    TEST_ASSERT_FALSE(j.flushDue(0, queue_config::SCAN_JOURNAL_LOW_HEAP_BYTES));
+    TEST_ASSERT_TRUE(j.flushDue(0, queue_config::SCAN_JOURNAL_LOW_HEAP_BYTES - 1));
+}
+
+void test_requested_flush_until_flushed() {
+    Journal j;
+    j.submit(scan(0), 0);
+    j.requestFlush();
+    TEST_ASSERT_TRUE(j.flushDue(0, PLENTY_HEAP));
+    j.flushed();
+    TEST_ASSERT_FALSE(j.flushDue(0, PLENTY_HEAP));
+}
+
+void test_full_journal_rejects_and_counts() {
+    Journal j;
+    for (size_t i = 0; i < Journal::capacity(); i++) TEST_ASSERT_TRUE(j.submit(scan(i), 0));
+    TEST_ASSERT_FALSE(j.submit(scan(999), 0));
+    TEST_ASSERT_EQUAL(1, (int)j.overflowCount());
+}
+
+// The stamp restarts once the journal drained: a later scan is not flushed
+// early because of an old one.
+void test_age_restarts_after_drain() {
+    Journal j;
+    j.submit(scan(0), 0);
+    models::ScanData out;
+    j.pop(out);
+    j.submit(scan(1), 5000);
+    TEST_ASSERT_FALSE(j.flushDue(5000 + queue_config::SCAN_JOURNAL_FLUSH_MS - 1, PLENTY_HEAP));
+}
+
+// ─── Batched ring append ──────────────────────────────────────────────
+
+static uint16_t encodeNext(Journal& j, const services::DeviceIdTable& table,
+                           uint8_t* buf, uint16_t cap) {
+    models::ScanData s;
+    if (!j.pop(s)) return 0;
+    return services::encodeScanRecord(s, table, buf, cap);
+}
+
+void test_batch_append_is_one_commit_in_fifo_order() {
+    services::DeviceIdTable table;
+    table.intern("SCANNER_FLOOR1_001");
+    services::QueueRing ring(RING, 4096, 100);
+    ring.open();
+
+    Journal j;
+    for (int i = 0; i < 6; i++) j.submit(scan(i), 0);
+    uint32_t seqBefore = ring.headerSeq();
+    uint32_t n = ring.appendBatch([&](uint8_t* buf, uint16_t cap) {
+        return encodeNext(j, table, buf, cap);
+    });
+    TEST_ASSERT_EQUAL(6, (int)n);
+    TEST_ASSERT_EQUAL(seqBefore + 1, ring.headerSeq());
+    TEST_ASSERT_TRUE(j.empty());
+
+    std::vector<std::string> tokens;
+    ring.peek(10, [&](const uint8_t* data, uint16_t len) {
+        models::ScanData s;
+        if (services::decodeScanRecord(data, len, table, s)) tokens.push_back(s.tokenId.c_str());
+    });
+    TEST_ASSERT_EQUAL(6, (int)tokens.size());
+    TEST_ASSERT_EQUAL_STRING("tok0000", tokens[0].c_str());
+    TEST_ASSERT_EQUAL_STRING("tok0005", tokens[5].c_str());
+
+    // Survives a reboot like single appends do
+    services::QueueRing reopened(RING, 4096, 100);
+    TEST_ASSERT_TRUE(reopened.open() == services::QueueRing::OpenResult::Loaded);
+    TEST_ASSERT_EQUAL(6, (int)reopened.count());
+}
+
+void test_batch_append_respects_max_entries() {
+    services::DeviceIdTable table;
+    table.intern("SCANNER_FLOOR1_001");
+    services::QueueRing ring(RING, 4096, 4);
+    ring.open();
+
+    Journal j;
+    for (int i = 0; i < 6; i++) j.submit(scan(i), 0);
+    ring.appendBatch([&](uint8_t* buf, uint16_t cap) { return encodeNext(j, table, buf, cap); });
+    TEST_ASSERT_EQUAL(4, (int)ring.count());
+    TEST_ASSERT_EQUAL(2, (int)ring.droppedCount());
+}
+
+// Flush pattern: peek while the ring writes, discard what it committed
+static uint32_t appendPeeked(services::QueueRing& ring, Journal& j,
+                             const services::DeviceIdTable& table, size_t& examined) {
+    examined = 0;
+    return ring.appendBatch([&](uint8_t* buf, uint16_t cap) -> uint16_t {
+        const models::ScanData* s = j.peek(examined);
+        if (!s) return 0;
+        examined++;
+        return services::encodeScanRecord(*s, table, buf, cap);
+    });
+}
+
+static std::vector<std::string> ringTokens(services::QueueRing& ring,
+                                           const services::DeviceIdTable& table) {
+    std::vector<std::string> tokens;
+    ring.peek(100, [&](const uint8_t* data, uint16_t len) {
+        models::ScanData s;
+        if (services::decodeScanRecord(data, len, table, s)) tokens.push_back(s.tokenId.c_str());
+    });
+    return tokens;
+}
+
+void test_batch_stops_at_failed_write() {
+    services::DeviceIdTable table;
+    table.intern("SCANNER_FLOOR1_001");
+    services::QueueRing ring(RING, 4096, 100);
+    ring.open();
+
+    Journal j;
+    for (int i = 0; i < 6; i++) j.submit(scan(i), 0);
+    mock::sdArmWriteFailure(5);  // Two writes per record: the third record's frame
+    size_t examined;
+    uint32_t n = appendPeeked(ring, j, table, examined);
+    TEST_ASSERT_EQUAL(2, (int)n);
+    TEST_ASSERT_EQUAL(3, (int)examined);  // Not asked for more after the failure
+    TEST_ASSERT_EQUAL(2, (int)ring.count());
+    j.discard(n);
+    TEST_ASSERT_EQUAL(4, (int)j.size());
+    TEST_ASSERT_EQUAL_STRING("tok0002", j.peek(0)->tokenId.c_str());
+
+    services::QueueRing reopened(RING, 4096, 100);
+    TEST_ASSERT_TRUE(reopened.open() == services::QueueRing::OpenResult::Loaded);
+    TEST_ASSERT_EQUAL(2, (int)reopened.count());
+
+    // Next flush picks up where this one stopped
+    j.discard(appendPeeked(ring, j, table, examined));
+    TEST_ASSERT_TRUE(j.empty());
+    std::vector<std::string> tokens = ringTokens(ring, table);
+    TEST_ASSERT_EQUAL(6, (int)tokens.size());
+    TEST_ASSERT_EQUAL_STRING("tok0002", tokens[2].c_str());
+    TEST_ASSERT_EQUAL_STRING("tok0005", tokens[5].c_str());
+}
+
+void test_failed_commit_rolls_back_batch() {
+    services::DeviceIdTable table;
+    table.intern("SCANNER_FLOOR1_001");
+    services::QueueRing ring(RING, 4096, 4);
+    ring.open();
+    for (int i = 0; i < 2; i++) {
+        uint8_t buf[services::QueueRing::MAX_RECORD_BYTES];
+        ring.append(buf, services::encodeScanRecord(scan(i), table, buf, sizeof(buf)));
+    }
+    uint32_t seqBefore = ring.headerSeq();
+
+    Journal j;
+    for (int i = 2; i < 5; i++) j.submit(scan(i), 0);
+    mock::sdArmWriteFailure(8);  // 3 records x 2 writes, data flush, then the header
+    size_t examined;
+    TEST_ASSERT_EQUAL(0, (int)appendPeeked(ring, j, table, examined));
+    // RAM matches the card again: drop-oldest for the batch undone too
+    TEST_ASSERT_EQUAL(2, (int)ring.count());
+    TEST_ASSERT_EQUAL(0, (int)ring.droppedCount());
+    TEST_ASSERT_EQUAL(seqBefore, ring.headerSeq());
+    TEST_ASSERT_EQUAL(3, (int)j.size());
+
+    j.discard(appendPeeked(ring, j, table, examined));
+    TEST_ASSERT_TRUE(j.empty());
+    TEST_ASSERT_EQUAL(1, (int)ring.droppedCount());
+    services::QueueRing reopened(RING, 4096, 4);
+    TEST_ASSERT_TRUE(reopened.open() == services::QueueRing::OpenResult::Loaded);
+    std::vector<std::string> tokens = ringTokens(reopened, table);
+    TEST_ASSERT_EQUAL(4, (int)tokens.size());
+    TEST_ASSERT_EQUAL_STRING("tok0001", tokens[0].c_str());
+    TEST_ASSERT_EQUAL_STRING("tok0004", tokens[3].c_str());
+}
+
+void test_bench_coalesced_flush_vs_per_scan_append() {
+    const int SCANS = queue_config::SCAN_JOURNAL_BATCH;
+    services::DeviceIdTable table;
+    table.intern("SCANNER_FLOOR1_001");
+
+    services::QueueRing single(RING, 32768, 100);
+    single.open();
+    mock::sdStats = mock::SDStats();
+    for (int i = 0; i < SCANS; i++) {
+        uint8_t buf[services::QueueRing::MAX_RECORD_BYTES];
+        size_t len = services::encodeScanRecord(scan(i), table, buf, sizeof(buf));
+        single.append(buf, len);
+    }
+    mock::SDStats perScan = mock::sdStats;
+
+    mock::sdReset();
+    services::QueueRing batched(RING, 32768, 100);
+    batched.open();
+    Journal j;
+    for (int i = 0; i < SCANS; i++) j.submit(scan(i), 0);
+    mock::sdStats = mock::SDStats();
+    batched.appendBatch([&](uint8_t* buf, uint16_t cap) { return encodeNext(j, table, buf, cap); });
+    mock::SDStats coalesced = mock::sdStats;
+
+    printf("[BENCH] %d scans: per-scan %lu opens/%lu flushes/%lu bytes, "
+           "coalesced %lu opens/%lu flushes/%lu bytes\n", SCANS,
+           (unsigned long)perScan.opens, (unsigned long)perScan.flushes,
+           (unsigned long)perScan.bytesWritten, (unsigned long)coalesced.opens,
+           (unsigned long)coalesced.flushes, (unsigned long)coalesced.bytesWritten);
+    TEST_ASSERT_EQUAL(1, (int)coalesced.opens);
+    TEST_ASSERT_EQUAL(2, (int)coalesced.flushes);  // Data, then header
+    TEST_ASSERT_TRUE(coalesced.bytesWritten < perScan.bytesWritten);
+}
+
+// ─── Main ─────────────────────────────────────────────────────────────
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_empty_journal_never_due);
+    RUN_TEST(test_fifo_submit_pop);
+    RUN_TEST(test_due_after_flush_interval);
+    RUN_TEST(test_due_at_batch_size);
+    RUN_TEST(test_due_on_low_heap);
+    RUN_TEST(test_requested_flush_until_flushed);
+    RUN_TEST(test_full_journal_rejects_and_counts);
+    RUN_TEST(test_age_restarts_after_drain);
+    RUN_TEST(test_batch_append_is_one_commit_in_fifo_order);
+    RUN_TEST(test_batch_append_respects_max_entries);
+    RUN_TEST(test_batch_stops_at_failed_write);
+    RUN_TEST(test_failed_commit_rolls_back_batch);
+    RUN_TEST(test_bench_coalesced_flush_vs_per_scan_append);
+    return UNITY_END();
+}
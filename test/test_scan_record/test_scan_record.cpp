@@ -0,0 +1,200 @@
+#include <unity.h>
+#include <Arduino.h>
+#include "services/ScanRecord.h"
+
+// Binary queue record codec. JSON sizes are computed by hand here (no
+// ArduinoJson dependency) to match buildScanJson()'s output.
+
+using services::DeviceIdTable;
+
+void setUp(void) {}
+void tearDown(void) {}
+
+static models::ScanData sample(const char* ts = "2025-10-19T14:30:45.123+02:00") {
+    return models::ScanData("kaa001", "001", "SCANNER_FLOOR1_001", ts);
+}
+
+static DeviceIdTable tableWith(const char* id) {
+    DeviceIdTable t;
+    t.intern(id);
+    return t;
+}
+
+static void assertSame(const models::ScanData& a, const models::ScanData& b) {
+    TEST_ASSERT_EQUAL_STRING(a.tokenId.c_str(), b.tokenId.c_str());
+    TEST_ASSERT_EQUAL_STRING(a.teamId.c_str(), b.teamId.c_str());
+    TEST_ASSERT_EQUAL_STRING(a.deviceId.c_str(), b.deviceId.c_str());
+    TEST_ASSERT_EQUAL_STRING(a.deviceType.c_str(), b.deviceType.c_str());
+    TEST_ASSERT_EQUAL_STRING(a.timestamp.c_str(), b.timestamp.c_str());
+}
+
+static void roundTrip(const models::ScanData& in, const DeviceIdTable& table) {
+    uint8_t buf[512];
+    size_t n = services::encodeScanRecord(in, table, buf, sizeof(buf));
+    TEST_ASSERT_TRUE(n > 0);
+    models::ScanData out;
+    TEST_ASSERT_TRUE(services::decodeScanRecord(buf, n, table, out));
+    assertSame(in, out);
+}
+
+// ─── Record round trip ────────────────────────────────────────────────
+
+void test_round_trip_interned_compact() {
+    DeviceIdTable table = tableWith("SCANNER_FLOOR1_001");
+    models::ScanData scan = sample();
+    uint8_t buf[512];
+    size_t n = services::encodeScanRecord(scan, table, buf, sizeof(buf));
+    // version + flags + token(1+6) + team(1+3) + device index + 7-byte time
+    TEST_ASSERT_EQUAL(2 + 7 + 4 + 1 + 7, (int)n);
+    roundTrip(scan, table);
+}
+
+void test_round_trip_utc_timestamp() {
+    roundTrip(sample("2025-10-19T23:59:59.999Z"), tableWith("SCANNER_FLOOR1_001"));
+}
+
+void test_round_trip_negative_offset() {
+    roundTrip(sample("2026-03-01T00:00:00.000-07:30"), tableWith("SCANNER_FLOOR1_001"));
+}
+
+void test_round_trip_without_team() {
+    models::ScanData scan = sample();
+    scan.teamId = "";
+    roundTrip(scan, tableWith("SCANNER_FLOOR1_001"));
+}
+
+// Fields the compact forms cannot express are stored inline, never altered
+void test_inline_fallbacks_are_lossless() {
+    DeviceIdTable empty;
+    models::ScanData scan = sample("2025-10-19 14:30:45");  // Unsynced-clock style
+    scan.deviceType = "debug";
+    roundTrip(scan, empty);
+
+    uint8_t buf[512];
+    size_t n = services::encodeScanRecord(scan, empty, buf, sizeof(buf));
+    TEST_ASSERT_EQUAL(services::SCAN_REC_HAS_TEAM | services::SCAN_REC_DEVICE_INLINE |
+                      services::SCAN_REC_TYPE_INLINE | services::SCAN_REC_TIME_INLINE,
+                      buf[1]);
+    TEST_ASSERT_TRUE(n > 0);
+
+    // Offsets that are not a multiple of 15 minutes also stay inline
+    uint8_t packed[services::COMPACT_TIMESTAMP_BYTES];
+    TEST_ASSERT_FALSE(services::packTimestamp("2025-10-19T14:30:45.123+05:07", packed));
+    roundTrip(sample("2025-10-19T14:30:45.123+05:07"), tableWith("SCANNER_FLOOR1_001"));
+}
+
+void test_epoch_ms_from_timestamp() {
+    uint64_t ms = 0;
+    TEST_ASSERT_TRUE(services::epochMsFromTimestamp("2025-10-19T14:30:45.123Z", ms));
+    TEST_ASSERT_TRUE(ms == 1760884245123ULL);
+    TEST_ASSERT_TRUE(services::epochMsFromTimestamp("2025-10-19T16:30:45.123+02:00", ms));
+    TEST_ASSERT_TRUE(ms == 1760884245123ULL);  // Same instant
+    TEST_ASSERT_TRUE(services::epochMsFromTimestamp("2025-10-19T09:00:45.123-05:30", ms));
+    TEST_ASSERT_TRUE(ms == 1760884245123ULL);
+    TEST_ASSERT_TRUE(services::epochMsFromTimestamp("1970-01-01T00:00:05.000Z", ms));
+    TEST_ASSERT_TRUE(ms == 5000);  // Unsynced clock stays recognisable
+    TEST_ASSERT_FALSE(services::epochMsFromTimestamp("1970-01-01T00:00:05.000+01:00", ms));
+    TEST_ASSERT_FALSE(services::epochMsFromTimestamp("2025-10-19 14:30", ms));
+}
+
+void test_decode_rejects_bad_input() {
+    DeviceIdTable table = tableWith("SCANNER_FLOOR1_001");
+    uint8_t buf[512];
+    size_t n = services::encodeScanRecord(sample(), table, buf, sizeof(buf));
+    models::ScanData out;
+
+    TEST_ASSERT_FALSE(services::decodeScanRecord(buf, n - 1, table, out));  // Truncated
+    buf[n] = 0;
+    TEST_ASSERT_FALSE(services::decodeScanRecord(buf, n + 1, table, out));  // Trailing byte
+
+    DeviceIdTable empty;  // Index 0 unknown
+    TEST_ASSERT_FALSE(services::decodeScanRecord(buf, n, empty, out));
+
+    buf[0] = services::SCAN_RECORD_VERSION + 1;
+    TEST_ASSERT_FALSE(services::decodeScanRecord(buf, n, table, out));
+}
+
+void test_encode_rejects_short_buffer() {
+    DeviceIdTable table = tableWith("SCANNER_FLOOR1_001");
+    uint8_t buf[8];
+    TEST_ASSERT_EQUAL(0, (int)services::encodeScanRecord(sample(), table, buf, sizeof(buf)));
+}
+
+// ─── DeviceId table ───────────────────────────────────────────────────
+
+void test_table_intern_and_capacity() {
+    DeviceIdTable t;
+    TEST_ASSERT_EQUAL(0, t.intern("A"));
+    TEST_ASSERT_EQUAL(1, t.intern("B"));
+    TEST_ASSERT_EQUAL(0, t.intern("A"));
+    for (int i = 2; i < DeviceIdTable::MAX_IDS; i++) t.intern(String("ID") + String(i));
+    TEST_ASSERT_EQUAL(-1, t.intern("overflow"));
+    TEST_ASSERT_EQUAL(DeviceIdTable::MAX_IDS, t.count);
+}
+
+void test_table_serialize_round_trip_and_crc() {
+    DeviceIdTable t;
+    t.intern("SCANNER_FLOOR1_001");
+    t.intern("SCANNER_FLOOR2_002");
+
+    uint8_t raw[256];
+    size_t n = t.serialize(raw, sizeof(raw));
+    TEST_ASSERT_TRUE(n > 0);
+
+    DeviceIdTable loaded;
+    TEST_ASSERT_TRUE(loaded.deserialize(raw, n));
+    TEST_ASSERT_EQUAL(2, loaded.count);
+    TEST_ASSERT_EQUAL_STRING("SCANNER_FLOOR2_002", loaded.ids[1].c_str());
+
+    raw[5] ^= 0x01;  // Damaged table is refused, previous contents kept
+    TEST_ASSERT_FALSE(loaded.deserialize(raw, n));
+    TEST_ASSERT_EQUAL(2, loaded.count);
+    TEST_ASSERT_FALSE(loaded.deserialize(raw, 3));
+}
+
+// ─── Size vs. JSON line ───────────────────────────────────────────────
+
+void test_size_vs_json_line() {
+    models::ScanData scan = sample("2025-10-19T14:30:45.123Z");
+    DeviceIdTable table = tableWith(scan.deviceId.c_str());
+
+    char json[256];
+    int jsonLen = snprintf(json, sizeof(json),
+        "{\"tokenId\":\"%s\",\"teamId\":\"%s\",\"deviceId\":\"%s\","
+        "\"deviceType\":\"%s\",\"timestamp\":\"%s\"}",
+        scan.tokenId.c_str(), scan.teamId.c_str(), scan.deviceId.c_str(),
+        scan.deviceType.c_str(), scan.timestamp.c_str());
+
+    uint8_t buf[512];
+    size_t n = services::encodeScanRecord(scan, table, buf, sizeof(buf));
+    printf("[BENCH] record size: JSON %d bytes, binary %u bytes (%.1fx)\n",
+           jsonLen, (unsigned)n, (double)jsonLen / n);
+    TEST_ASSERT_TRUE(n * 4 < (size_t)jsonLen);
+}
+
+// ─── CRC32 ────────────────────────────────────────────────────────────
+
+void test_crc32_check_value() {
+    const char* check = "123456789";
+    TEST_ASSERT_EQUAL_HEX32(0xCBF43926,
+        services::crc32(reinterpret_cast<const uint8_t*>(check), 9));
+}
+
+// ─── Main ─────────────────────────────────────────────────────────────
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_round_trip_interned_compact);
+    RUN_TEST(test_round_trip_utc_timestamp);
+    RUN_TEST(test_round_trip_negative_offset);
+    RUN_TEST(test_round_trip_without_team);
+    RUN_TEST(test_inline_fallbacks_are_lossless);
+    RUN_TEST(test_epoch_ms_from_timestamp);
+    RUN_TEST(test_decode_rejects_bad_input);
+    RUN_TEST(test_encode_rejects_short_buffer);
+    RUN_TEST(test_table_intern_and_capacity);
+    RUN_TEST(test_table_serialize_round_trip_and_crc);
+    RUN_TEST(test_size_vs_json_line);
+    RUN_TEST(test_crc32_check_value);
+    return UNITY_END();
+}
@@ -0,0 +1,154 @@
+#include <unity.h>
+#include <Arduino.h>
+#include <thread>
+#include "services/ScanSubmitQueue.h"
+
+// Async scan submission: the Core-1 <-> submit-task hand-off and the rule
+// for reconciling a late outcome with the optimistic display.
+
+void setUp(void) {}
+void tearDown(void) {}
+
+using services::LateOutcomeAction;
+using services::ScanOutcome;
+
+static models::ScanData makeScan(int i) {
+    char id[8];
+    snprintf(id, sizeof(id), "tok%03d", i);
+    return models::ScanData(id, "001", "SCANNER_01", "2025-10-19T14:30:45.123Z");
+}
+
+// ─── Hand-off ─────────────────────────────────────────────────────────
+
+void test_round_trip_carries_scan_and_timing() {
+    services::ScanSubmitQueue<4> q;
+    TEST_ASSERT_TRUE(q.submit(makeScan(1), 100));
+
+    services::ScanSubmission sub;
+    TEST_ASSERT_TRUE(q.next(sub));
+    TEST_ASSERT_FALSE(q.next(sub));
+    q.complete(sub, ScanOutcome::RETRY_QUEUE, 450);
+
+    services::ScanResult r;
+    TEST_ASSERT_TRUE(q.poll(r));
+    TEST_ASSERT_EQUAL_STRING("tok001", r.scan.tokenId.c_str());
+    TEST_ASSERT_EQUAL_STRING("SCANNER_01", r.scan.deviceId.c_str());
+    TEST_ASSERT_EQUAL(static_cast<int>(ScanOutcome::RETRY_QUEUE), static_cast<int>(r.outcome));
+    TEST_ASSERT_EQUAL(100, (int)r.submittedAtMs);
+    TEST_ASSERT_EQUAL(450, (int)r.completedAtMs);
+    TEST_ASSERT_FALSE(q.poll(r));
+}
+
+void test_in_flight_counts_until_polled() {
+    services::ScanSubmitQueue<4> q;
+    for (int i = 0; i < 4; i++) TEST_ASSERT_TRUE(q.submit(makeScan(i), 0));
+    TEST_ASSERT_EQUAL(4, (int)q.inFlight());
+
+    // Sent and completed, but the main loop hasn't seen the outcome yet
+    services::ScanSubmission sub;
+    while (q.next(sub)) q.complete(sub, ScanOutcome::ACCEPTED, 0);
+    TEST_ASSERT_FALSE(q.submit(makeScan(9), 0));
+    TEST_ASSERT_EQUAL(4, (int)q.inFlight());
+
+    services::ScanResult r;
+    TEST_ASSERT_TRUE(q.poll(r));
+    TEST_ASSERT_EQUAL(3, (int)q.inFlight());
+    TEST_ASSERT_TRUE(q.submit(makeScan(9), 0));
+}
+
+void test_outcomes_keep_submit_order() {
+    services::ScanSubmitQueue<4> q;
+    services::ScanSubmission sub;
+    services::ScanResult r;
+    for (int round = 0; round < 3; round++) {
+        for (int i = 0; i < 3; i++) q.submit(makeScan(round * 10 + i), 0);
+        while (q.next(sub)) q.complete(sub, ScanOutcome::ACCEPTED, 0);
+        for (int i = 0; i < 3; i++) {
+            TEST_ASSERT_TRUE(q.poll(r));
+            TEST_ASSERT_EQUAL_STRING(makeScan(round * 10 + i).tokenId.c_str(),
+                                     r.scan.tokenId.c_str());
+        }
+    }
+    TEST_ASSERT_EQUAL(0, (int)q.inFlight());
+}
+
+// Main loop and submit task on separate threads: every accepted scan
+// comes back exactly once, in order, however the two interleave.
+void test_threaded_no_outcome_lost() {
+    services::ScanSubmitQueue<4> q;
+    const int N = 2000;
+    std::atomic<bool> done{false};
+
+    std::thread submitTask([&]() {
+        services::ScanSubmission sub;
+        while (!done.load()) {
+            if (q.next(sub)) {
+                q.complete(sub, ScanOutcome::ACCEPTED, 0);
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    int submitted = 0, polled = 0, refused = 0;
+    services::ScanResult r;
+    while (polled < N) {
+        if (submitted < N) {
+            if (q.submit(makeScan(submitted % 1000), 0)) submitted++;
+            else refused++;
+        }
+        if (q.poll(r)) {
+            TEST_ASSERT_EQUAL_STRING(makeScan(polled % 1000).tokenId.c_str(),
+                                     r.scan.tokenId.c_str());
+            polled++;
+        }
+    }
+    done.store(true);
+    submitTask.join();
+
+    TEST_ASSERT_EQUAL(N, polled);
+    TEST_ASSERT_EQUAL(0, (int)q.inFlight());
+    printf("[INFO] %d scans round-tripped, %d submits refused at depth 4\n", N, refused);
+}
+
+// ─── Late outcome rule ────────────────────────────────────────────────
+
+static LateOutcomeAction act(ScanOutcome o, bool onScreen, bool idle) {
+    return services::lateOutcomeAction(o, onScreen, idle);
+}
+
+void test_accepted_changes_nothing() {
+    TEST_ASSERT_TRUE(act(ScanOutcome::ACCEPTED, true, false) == LateOutcomeAction::None);
+    TEST_ASSERT_TRUE(act(ScanOutcome::ACCEPTED, false, true) == LateOutcomeAction::None);
+}
+
+void test_video_unavailable_only_while_token_shown() {
+    TEST_ASSERT_TRUE(act(ScanOutcome::ACCEPTED_NO_VIDEO, true, false) ==
+                     LateOutcomeAction::VideoUnavailable);
+    TEST_ASSERT_TRUE(act(ScanOutcome::RETRY_QUEUE, true, false) ==
+                     LateOutcomeAction::VideoUnavailable);
+    TEST_ASSERT_TRUE(act(ScanOutcome::ACCEPTED_NO_VIDEO, false, true) == LateOutcomeAction::None);
+    TEST_ASSERT_TRUE(act(ScanOutcome::RETRY_QUEUE, false, false) == LateOutcomeAction::None);
+}
+
+void test_no_session_reverts_unless_another_token_shown() {
+    TEST_ASSERT_TRUE(act(ScanOutcome::REJECTED_NO_SESSION, true, false) ==
+                     LateOutcomeAction::RevertNoSession);
+    TEST_ASSERT_TRUE(act(ScanOutcome::REJECTED_NO_SESSION, false, true) ==
+                     LateOutcomeAction::RevertNoSession);
+    // Player already scanned something else (or opened status)
+    TEST_ASSERT_TRUE(act(ScanOutcome::REJECTED_NO_SESSION, false, false) ==
+                     LateOutcomeAction::None);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_round_trip_carries_scan_and_timing);
+    RUN_TEST(test_in_flight_counts_until_polled);
+    RUN_TEST(test_outcomes_keep_submit_order);
+    RUN_TEST(test_threaded_no_outcome_lost);
+    RUN_TEST(test_accepted_changes_nothing);
+    RUN_TEST(test_video_unavailable_only_while_token_shown);
+    RUN_TEST(test_no_session_reverts_unless_another_token_shown);
+    return UNITY_END();
+}
@@ -0,0 +1,110 @@
+#include <unity.h>
+#include <Arduino.h>
+#include <SD.h>
+#include <vector>
+#include "hal/SDClockProbe.h"
+
+// Clock selection runs with an injected mount function; the pattern check
+// itself runs against the in-memory SD mock.
+
+static const uint32_t CLOCKS[] = { 8000, 10000, 16000, 20000, 26667, 40000 };
+static const size_t N_CLOCKS = sizeof(CLOCKS) / sizeof(CLOCKS[0]);
+
+void setUp(void) {
+    mock::sdReset();
+}
+
+void tearDown(void) {}
+
+void test_pattern_deterministic_per_seed() {
+    uint8_t a[64], b[64], c[64];
+    hal::sdprobe::fillPattern(a, sizeof(a), 20000);
+    hal::sdprobe::fillPattern(b, sizeof(b), 20000);
+    hal::sdprobe::fillPattern(c, sizeof(c), 26667);
+    TEST_ASSERT_EQUAL(0, memcmp(a, b, sizeof(a)));
+    TEST_ASSERT_NOT_EQUAL(0, memcmp(a, c, sizeof(a)));
+}
+
+void test_verify_round_trip_removes_scratch() {
+    uint8_t buf[512];
+    hal::SDProbeResult r;
+    TEST_ASSERT_TRUE(hal::sdprobe::verifyReadWrite("/.sdprobe", 16384, 20000, buf, sizeof(buf), r));
+    TEST_ASSERT_FALSE(SD.exists("/.sdprobe"));
+    TEST_ASSERT_EQUAL(16384, (int)mock::sdStats.bytesWritten);
+    TEST_ASSERT_EQUAL(16384, (int)mock::sdStats.bytesRead);
+}
+
+void test_verify_odd_length() {
+    uint8_t buf[512];
+    hal::SDProbeResult r;
+    TEST_ASSERT_TRUE(hal::sdprobe::verifyReadWrite("/.sdprobe", 1000, 8000, buf, sizeof(buf), r));
+}
+
+void test_all_clocks_pass_picks_fastest() {
+    std::vector<uint32_t> mounts;
+    auto r = hal::sdprobe::selectClock(CLOCKS, N_CLOCKS, 4000,
+        [&](uint32_t khz) { mounts.push_back(khz); return true; },
+        [](uint32_t, hal::SDProbeResult&) { return true; });
+    TEST_ASSERT_TRUE(r.ok);
+    TEST_ASSERT_EQUAL(40000, (int)r.clockKHz);
+    TEST_ASSERT_EQUAL((int)N_CLOCKS, (int)mounts.size());  // no remount needed
+}
+
+void test_mount_failure_stops_and_remounts_last_good() {
+    std::vector<uint32_t> mounts;
+    auto r = hal::sdprobe::selectClock(CLOCKS, N_CLOCKS, 4000,
+        [&](uint32_t khz) { mounts.push_back(khz); return khz <= 20000; },
+        [](uint32_t, hal::SDProbeResult&) { return true; });
+    TEST_ASSERT_TRUE(r.ok);
+    TEST_ASSERT_EQUAL(20000, (int)r.clockKHz);
+    TEST_ASSERT_EQUAL(26667, (int)mounts[4]);   // 40 MHz never tried
+    TEST_ASSERT_EQUAL(20000, (int)mounts.back());
+    TEST_ASSERT_EQUAL(6, (int)mounts.size());
+}
+
+// Marginal clock: mounts fine but corrupts data, and a faster one would
+// have passed by luck — the first failure ends the probe.
+void test_corruption_stops_at_first_failure() {
+    uint32_t mounted = 0;
+    auto r = hal::sdprobe::selectClock(CLOCKS, N_CLOCKS, 4000,
+        [&](uint32_t khz) { mounted = khz; return true; },
+        [](uint32_t khz, hal::SDProbeResult&) { return khz != 20000; });
+    TEST_ASSERT_TRUE(r.ok);
+    TEST_ASSERT_EQUAL(16000, (int)r.clockKHz);
+    TEST_ASSERT_EQUAL(16000, (int)mounted);
+}
+
+void test_nothing_passes_falls_back() {
+    uint32_t mounted = 0;
+    auto r = hal::sdprobe::selectClock(CLOCKS, N_CLOCKS, 4000,
+        [&](uint32_t khz) { mounted = khz; return true; },
+        [](uint32_t, hal::SDProbeResult&) { return false; });
+    TEST_ASSERT_FALSE(r.ok);
+    TEST_ASSERT_EQUAL(4000, (int)r.clockKHz);
+    TEST_ASSERT_EQUAL(4000, (int)mounted);
+}
+
+void test_probe_through_mock_sd() {
+    uint8_t buf[512];
+    auto r = hal::sdprobe::selectClock(CLOCKS, N_CLOCKS, 4000,
+        [](uint32_t) { return true; },
+        [&buf](uint32_t khz, hal::SDProbeResult& res) {
+            return hal::sdprobe::verifyReadWrite("/.sdprobe", 4096, khz, buf, sizeof(buf), res);
+        });
+    TEST_ASSERT_TRUE(r.ok);
+    TEST_ASSERT_EQUAL(40000, (int)r.clockKHz);
+    TEST_ASSERT_EQUAL(0, (int)mock::sdFiles.size());
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_pattern_deterministic_per_seed);
+    RUN_TEST(test_verify_round_trip_removes_scratch);
+    RUN_TEST(test_verify_odd_length);
+    RUN_TEST(test_all_clocks_pass_picks_fastest);
+    RUN_TEST(test_mount_failure_stops_and_remounts_last_good);
+    RUN_TEST(test_corruption_stops_at_first_failure);
+    RUN_TEST(test_nothing_passes_falls_back);
+    RUN_TEST(test_probe_through_mock_sd);
+    return UNITY_END();
+}
@@ -0,0 +1,227 @@
+#include <unity.h>
+#include <Arduino.h>
+#include <SD.h>
+#include <string>
+#include "services/QueueRing.h"
+
+// Host-directory SD backend and the SPI timing model, plus a storage-path
+// benchmark (queue ring enqueue/drain) at 4 MHz and 20 MHz.
+
+static std::string root;
+
+void setUp(void) {
+    mock::sdMountHost(root);
+    mock::sdReset();
+    mock::sdTiming = mock::SDTiming();
+}
+
+void tearDown(void) {}
+
+static bool writeText(const char* path, const char* text) {
+    File f = SD.open(path, FILE_WRITE);
+    if (!f) return false;
+    size_t n = strlen(text);
+    bool ok = f.write(reinterpret_cast<const uint8_t*>(text), n) == n;
+    f.close();
+    return ok;
+}
+
+static std::string readText(const char* path) {
+    File f = SD.open(path, FILE_READ);
+    if (!f) return "<missing>";
+    std::string out(f.size(), '\0');
+    f.read(reinterpret_cast<uint8_t*>(&out[0]), out.size());
+    f.close();
+    return out;
+}
+
+// ─── Host backend ─────────────────────────────────────────────────────
+
+void test_files_land_in_host_directory() {
+    TEST_ASSERT_TRUE(writeText("/hello.txt", "hello"));
+    TEST_ASSERT_TRUE(std::filesystem::exists(root + "/hello.txt"));
+    TEST_ASSERT_EQUAL(5, (int)std::filesystem::file_size(root + "/hello.txt"));
+    TEST_ASSERT_EQUAL_STRING("hello", readText("/hello.txt").c_str());
+    TEST_ASSERT_TRUE(mock::sdFiles.empty());  // In-memory store untouched
+}
+
+void test_open_modes() {
+    TEST_ASSERT_FALSE((bool)SD.open("/none.txt", FILE_READ));
+    TEST_ASSERT_FALSE((bool)SD.open("/none.txt", "r+"));
+
+    writeText("/m.txt", "abc");
+    File a = SD.open("/m.txt", FILE_APPEND);
+    a.write(reinterpret_cast<const uint8_t*>("de"), 2);
+    a.seek(0);
+    a.write(reinterpret_cast<const uint8_t*>("f"), 1);  // Append ignores seek
+    a.close();
+    TEST_ASSERT_EQUAL_STRING("abcdef", readText("/m.txt").c_str());
+
+    File rw = SD.open("/m.txt", "r+");
+    rw.seek(1);
+    rw.write(reinterpret_cast<const uint8_t*>("X"), 1);
+    rw.close();
+    TEST_ASSERT_EQUAL_STRING("aXcdef", readText("/m.txt").c_str());
+
+    writeText("/m.txt", "z");  // "w" truncates
+    TEST_ASSERT_EQUAL_STRING("z", readText("/m.txt").c_str());
+}
+
+void test_handles_share_one_file() {
+    File w = SD.open("/shared.bin", FILE_WRITE);
+    File r = SD.open("/shared.bin", FILE_READ);
+    w.write(reinterpret_cast<const uint8_t*>("xyz"), 3);
+    TEST_ASSERT_EQUAL(3, (int)r.size());
+    uint8_t buf[3];
+    TEST_ASSERT_EQUAL(3, (int)r.read(buf, 3));
+    TEST_ASSERT_EQUAL('z', buf[2]);
+}
+
+void test_seek_past_end_extends_only_writable() {
+    writeText("/s.bin", "ab");
+    File r = SD.open("/s.bin", FILE_READ);
+    TEST_ASSERT_FALSE(r.seek(100));
+    r.close();
+
+    File w = SD.open("/s.bin", "r+");
+    TEST_ASSERT_TRUE(w.seek(4095));
+    TEST_ASSERT_EQUAL(1, (int)w.write(static_cast<uint8_t>(7)));
+    TEST_ASSERT_EQUAL(4096, (int)w.size());
+    w.close();
+}
+
+void test_directories_behave_like_fatfs() {
+    TEST_ASSERT_FALSE(writeText("/assets/images/a.bmp", "x"));  // No parent yet
+    TEST_ASSERT_TRUE(SD.mkdir("/assets"));
+    TEST_ASSERT_TRUE(SD.mkdir("/assets/images"));
+    TEST_ASSERT_TRUE(SD.mkdir("/assets/images"));  // Already there
+    TEST_ASSERT_TRUE(writeText("/assets/images/a.bmp", "x"));
+    TEST_ASSERT_TRUE(SD.exists("/assets/images"));
+    TEST_ASSERT_FALSE((bool)SD.open("/assets", FILE_READ));
+    TEST_ASSERT_FALSE(SD.remove("/assets"));
+}
+
+void test_rename_refuses_existing_destination() {
+    writeText("/a.txt", "A");
+    writeText("/b.txt", "B");
+    TEST_ASSERT_FALSE(SD.rename("/a.txt", "/b.txt"));
+    TEST_ASSERT_EQUAL_STRING("B", readText("/b.txt").c_str());
+
+    TEST_ASSERT_TRUE(SD.remove("/b.txt"));
+    TEST_ASSERT_TRUE(SD.rename("/a.txt", "/b.txt"));
+    TEST_ASSERT_FALSE(SD.exists("/a.txt"));
+    TEST_ASSERT_EQUAL_STRING("A", readText("/b.txt").c_str());
+    TEST_ASSERT_FALSE(SD.rename("/gone.txt", "/c.txt"));
+}
+
+void test_counters() {
+    writeText("/c.txt", "12345");
+    readText("/c.txt");
+    SD.rename("/c.txt", "/d.txt");
+    SD.remove("/d.txt");
+    TEST_ASSERT_EQUAL(2, (int)mock::sdStats.opens);
+    TEST_ASSERT_EQUAL(5, (int)mock::sdStats.bytesWritten);
+    TEST_ASSERT_EQUAL(5, (int)mock::sdStats.bytesRead);
+    TEST_ASSERT_EQUAL(1, (int)mock::sdStats.renames);
+    TEST_ASSERT_EQUAL(1, (int)mock::sdStats.removes);
+}
+
+// ─── Timing model ─────────────────────────────────────────────────────
+
+void test_default_timing_is_free() {
+    uint32_t t0 = micros();
+    writeText("/t.txt", "free");
+    TEST_ASSERT_EQUAL(t0, micros());
+    TEST_ASSERT_EQUAL(0, (int)mock::sdStats.busyUs);
+}
+
+void test_timing_charges_virtual_clock() {
+    mock::sdTiming = { 1000, 2000, 3000, 10, 100000, 50000 };
+    static uint8_t block[10000];
+
+    uint32_t t0 = micros();
+    File f = SD.open("/t.bin", FILE_WRITE);              // 1000
+    f.write(block, sizeof(block));                       // 10 + 200000
+    f.flush();                                           // 2000
+    f.close();
+    f = SD.open("/t.bin", FILE_READ);                    // 1000
+    f.read(block, sizeof(block));                        // 10 + 100000
+    f.close();
+    SD.rename("/t.bin", "/u.bin");                       // 3000
+    uint32_t elapsed = micros() - t0;
+
+    TEST_ASSERT_EQUAL(307020, (int)elapsed);
+    TEST_ASSERT_EQUAL(elapsed, (uint32_t)mock::sdStats.busyUs);
+}
+
+void test_timing_applies_to_in_memory_backend() {
+    mock::sdMountHost("");
+    mock::sdTiming = mock::SD_SPI_4MHZ;
+    uint32_t t0 = micros();
+    File f = SD.open("/mem.txt", FILE_WRITE);
+    f.write(static_cast<uint8_t>(1));
+    f.close();
+    TEST_ASSERT_EQUAL(mock::SD_SPI_4MHZ.openUs + mock::SD_SPI_4MHZ.perCallUs +
+                      mock::sdTransferUs(1, mock::SD_SPI_4MHZ.writeBytesPerSec),
+                      micros() - t0);
+    TEST_ASSERT_EQUAL(1, (int)mock::sdFiles.size());
+}
+
+// ─── Storage path benchmark ──────────────────────────────────────────
+
+// Modelled time to enqueue 100 scans one by one, then drain in batches of 10
+static uint32_t ringWorkloadUs(const mock::SDTiming& timing) {
+    mock::sdReset();
+    mock::sdTiming = timing;
+    uint32_t t0 = micros();
+
+    services::QueueRing ring("/queue.ring", 32768, 200);
+    ring.open();
+    char rec[160];
+    for (int i = 0; i < 100; i++) {
+        int n = snprintf(rec, sizeof(rec),
+                         "{\"tokenId\":\"tok%04d\",\"teamId\":\"001\",\"deviceId\":\"SCANNER_01\","
+                         "\"timestamp\":\"2025-10-19T14:30:45.123Z\"}", i);
+        ring.append(reinterpret_cast<const uint8_t*>(rec), static_cast<uint16_t>(n));
+    }
+    uint32_t drained = 0;
+    while (ring.count() > 0) {
+        auto cursor = ring.peek(10, [&](const uint8_t*, uint16_t) { drained++; });
+        if (cursor.count == 0 || !ring.consume(cursor)) break;
+    }
+
+    uint32_t elapsed = micros() - t0;
+    mock::sdTiming = mock::SDTiming();
+    return drained == 100 ? elapsed : 0;
+}
+
+void test_bench_queue_ring_at_4_and_20_mhz() {
+    uint32_t slow = ringWorkloadUs(mock::SD_SPI_4MHZ);
+    uint32_t fast = ringWorkloadUs(mock::SD_SPI_20MHZ);
+    printf("[BENCH] queue ring, 100 enqueues + 10 batch drains: %lu ms @ 4 MHz, %lu ms @ 20 MHz\n",
+           (unsigned long)(slow / 1000), (unsigned long)(fast / 1000));
+    TEST_ASSERT_TRUE(fast > 0);
+    TEST_ASSERT_TRUE(slow > fast);
+}
+
+int main(int argc, char** argv) {
+    root = mock::sdMakeTempRoot();
+    if (root.empty()) return 1;
+
+    UNITY_BEGIN();
+    RUN_TEST(test_files_land_in_host_directory);
+    RUN_TEST(test_open_modes);
+    RUN_TEST(test_handles_share_one_file);
+    RUN_TEST(test_seek_past_end_extends_only_writable);
+    RUN_TEST(test_directories_behave_like_fatfs);
+    RUN_TEST(test_rename_refuses_existing_destination);
+    RUN_TEST(test_counters);
+    RUN_TEST(test_default_timing_is_free);
+    RUN_TEST(test_timing_charges_virtual_clock);
+    RUN_TEST(test_timing_applies_to_in_memory_backend);
+    RUN_TEST(test_bench_queue_ring_at_4_and_20_mhz);
+    int failures = UNITY_END();
+
+    mock::sdUnmountHost();
+    return failures;
+}
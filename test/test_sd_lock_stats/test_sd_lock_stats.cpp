@@ -0,0 +1,151 @@
+#include <unity.h>
+#include <Arduino.h>
+#include "hal/SDLockStats.h"
+
+// SD mutex instrumentation: hal::SDCard feeds these from takeMutex() /
+// giveMutex(); the logic is exercised directly here.
+
+void setUp(void) {}
+void tearDown(void) {}
+
+static const uint32_t WARN_US = freertos_config::SD_LOCK_HOLD_WARN_MS * 1000;
+
+void test_empty_stats() {
+    hal::SDLockStats s;
+    TEST_ASSERT_EQUAL(0, (int)s.hold.count);
+    TEST_ASSERT_EQUAL(0, (int)s.timeouts);
+    TEST_ASSERT_NULL(s.maxHoldCaller);
+}
+
+void test_records_wait_and_hold() {
+    hal::SDLockStats s;
+    s.recordAcquire("queueScan", 120);
+    s.recordRelease("queueScan", 3000, WARN_US);
+    s.recordAcquire("drawBMP", 15000);
+    s.recordRelease("drawBMP", 900, WARN_US);
+
+    TEST_ASSERT_EQUAL(2, (int)s.wait.count);
+    TEST_ASSERT_EQUAL(2, (int)s.hold.count);
+    TEST_ASSERT_EQUAL(15000, (int)s.wait.maxUs);
+    TEST_ASSERT_EQUAL(3000, (int)s.hold.maxUs);
+    TEST_ASSERT_EQUAL_STRING("drawBMP", s.maxWaitCaller);
+    TEST_ASSERT_EQUAL_STRING("queueScan", s.maxHoldCaller);
+}
+
+void test_long_hold_flagged() {
+    hal::SDLockStats s;
+    TEST_ASSERT_FALSE(s.recordRelease("stream:chunk", WARN_US, WARN_US));
+    TEST_ASSERT_TRUE(s.recordRelease("stream:whole-file", WARN_US + 1, WARN_US));
+    TEST_ASSERT_EQUAL(1, (int)s.longHolds);
+    TEST_ASSERT_EQUAL_STRING("stream:whole-file", s.maxHoldCaller);
+}
+
+void test_timeouts_counted() {
+    hal::SDLockStats s;
+    s.recordTimeout("uploadBatch");
+    s.recordTimeout("uploadBatch");
+    TEST_ASSERT_EQUAL(2, (int)s.timeouts);
+    TEST_ASSERT_EQUAL(0, (int)s.wait.count);
+    TEST_ASSERT_EQUAL(1, (int)s.callerCount);
+    TEST_ASSERT_EQUAL(2, (int)s.callers[0].timeouts);
+    TEST_ASSERT_EQUAL(0, (int)s.callers[0].acquisitions);
+}
+
+void test_per_caller_totals() {
+    hal::SDLockStats s;
+    for (int i = 0; i < 3; i++) {
+        s.recordAcquire("queueScan", 100 * (i + 1));
+        s.recordRelease("queueScan", 2000, WARN_US);
+    }
+    s.recordAcquire("drawBMP", 50);
+    s.recordRelease("drawBMP", WARN_US + 5000, WARN_US);
+
+    TEST_ASSERT_EQUAL(2, (int)s.callerCount);
+    const hal::SDCallerStats& q = s.callers[0];
+    TEST_ASSERT_EQUAL_STRING("queueScan", q.name);
+    TEST_ASSERT_EQUAL(3, (int)q.acquisitions);
+    TEST_ASSERT_EQUAL(600, (int)q.totalWaitUs);
+    TEST_ASSERT_EQUAL(300, (int)q.maxWaitUs);
+    TEST_ASSERT_EQUAL(6000, (int)q.totalHoldUs);
+    TEST_ASSERT_EQUAL(0, (int)q.longHolds);
+
+    const hal::SDCallerStats& d = s.callers[1];
+    TEST_ASSERT_EQUAL_STRING("drawBMP", d.name);
+    TEST_ASSERT_EQUAL(1, (int)d.longHolds);
+    TEST_ASSERT_EQUAL(WARN_US + 5000, d.maxHoldUs);
+}
+
+// Same name from a different buffer (e.g. literal in another TU) -> same row
+void test_caller_matched_by_content() {
+    hal::SDLockStats s;
+    char copy[] = "uploadBatch";
+    s.recordAcquire("uploadBatch", 0);
+    s.recordAcquire(copy, 0);
+    TEST_ASSERT_EQUAL(1, (int)s.callerCount);
+    TEST_ASSERT_EQUAL(2, (int)s.callers[0].acquisitions);
+}
+
+void test_table_overflow_row() {
+    hal::SDLockStats s;
+    static char names[40][8];
+    for (int i = 0; i < 40; i++) {
+        snprintf(names[i], sizeof(names[i]), "c%d", i);
+        s.recordAcquire(names[i], 0);
+    }
+    const uint8_t MAX = hal::SDLockStats::MAX_CALLERS;
+    TEST_ASSERT_EQUAL(MAX, (int)s.callerCount);
+    TEST_ASSERT_EQUAL_STRING("c0", s.callers[0].name);
+    TEST_ASSERT_EQUAL_STRING("(other)", s.callers[MAX - 1].name);
+    TEST_ASSERT_EQUAL(40 - (MAX - 1), (int)s.callers[MAX - 1].acquisitions);
+    // Known callers still land in their own row once the table is full
+    s.recordAcquire(names[1], 0);
+    TEST_ASSERT_EQUAL(2, (int)s.callers[1].acquisitions);
+}
+
+void test_sorted_by_total_hold() {
+    hal::SDLockStats s;
+    s.recordRelease("light", 100, WARN_US);
+    s.recordRelease("heavy", 90000, WARN_US);
+    s.recordRelease("medium", 5000, WARN_US);
+    s.recordRelease("medium", 5000, WARN_US);
+    uint8_t order[hal::SDLockStats::MAX_CALLERS];
+    TEST_ASSERT_EQUAL(3, (int)s.sortedByHold(order));
+    TEST_ASSERT_EQUAL_STRING("heavy", s.callers[order[0]].name);
+    TEST_ASSERT_EQUAL_STRING("medium", s.callers[order[1]].name);
+    TEST_ASSERT_EQUAL_STRING("light", s.callers[order[2]].name);
+}
+
+// A 230 KB asset streamed in 4 KB chunks vs. one whole-file hold: the
+// per-chunk profile stays under the warn threshold.
+void test_chunked_download_profile_stays_short() {
+    hal::SDLockStats chunked, whole;
+    const uint32_t CHUNK_WRITE_US = 6000;  // ~4 KB SD write incl. FAT update
+    const uint32_t NETWORK_US = 25000;     // ~4 KB over WiFi/TLS
+    const int CHUNKS = 230 * 1024 / 4096 + 1;
+
+    for (int i = 0; i < CHUNKS; i++) {
+        chunked.recordAcquire("stream:chunk", 0);
+        chunked.recordRelease("stream:chunk", CHUNK_WRITE_US, WARN_US);
+    }
+    whole.recordAcquire("stream", 0);
+    whole.recordRelease("stream", CHUNKS * (CHUNK_WRITE_US + NETWORK_US), WARN_US);
+
+    printf("[BENCH] 230 KB asset: whole-file hold %lu ms, chunked max hold %lu ms\n",
+           (unsigned long)whole.hold.maxUs / 1000, (unsigned long)chunked.hold.maxUs / 1000);
+    TEST_ASSERT_EQUAL(0, (int)chunked.longHolds);
+    TEST_ASSERT_EQUAL(1, (int)whole.longHolds);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_empty_stats);
+    RUN_TEST(test_records_wait_and_hold);
+    RUN_TEST(test_long_hold_flagged);
+    RUN_TEST(test_timeouts_counted);
+    RUN_TEST(test_per_caller_totals);
+    RUN_TEST(test_caller_matched_by_content);
+    RUN_TEST(test_table_overflow_row);
+    RUN_TEST(test_sorted_by_total_hold);
+    RUN_TEST(test_chunked_download_profile_stays_short);
+    return UNITY_END();
+}
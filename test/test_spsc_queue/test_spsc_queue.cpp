@@ -0,0 +1,141 @@
+#include <unity.h>
+#include <Arduino.h>
+#include <thread>
+#include "hal/SPSCQueue.h"
+
+// Unity requires setUp/tearDown (even if empty)
+void setUp(void) {}
+void tearDown(void) {}
+
+// ─── Single-threaded semantics ────────────────────────────────────────
+
+void test_empty_queue_pop_fails() {
+    hal::SPSCQueue<int, 4> q;
+    int out = -1;
+    TEST_ASSERT_TRUE(q.empty());
+    TEST_ASSERT_FALSE(q.pop(out));
+    TEST_ASSERT_EQUAL(-1, out);
+}
+
+void test_fifo_order() {
+    hal::SPSCQueue<int, 4> q;
+    TEST_ASSERT_TRUE(q.push(1));
+    TEST_ASSERT_TRUE(q.push(2));
+    TEST_ASSERT_TRUE(q.push(3));
+    TEST_ASSERT_EQUAL(3, (int)q.size());
+
+    int out = 0;
+    TEST_ASSERT_TRUE(q.pop(out)); TEST_ASSERT_EQUAL(1, out);
+    TEST_ASSERT_TRUE(q.pop(out)); TEST_ASSERT_EQUAL(2, out);
+    TEST_ASSERT_TRUE(q.pop(out)); TEST_ASSERT_EQUAL(3, out);
+    TEST_ASSERT_TRUE(q.empty());
+}
+
+// Full capacity is usable (no sacrificed slot) and overflow is counted,
+// not overwritten.
+void test_full_queue_rejects_and_counts_drop() {
+    hal::SPSCQueue<int, 4> q;
+    for (int i = 0; i < 4; i++) {
+        TEST_ASSERT_TRUE(q.push(i));
+    }
+    TEST_ASSERT_FALSE(q.push(99));
+    TEST_ASSERT_EQUAL(1, (int)q.dropped());
+
+    int out = -1;
+    TEST_ASSERT_TRUE(q.pop(out));
+    TEST_ASSERT_EQUAL(0, out);  // oldest entry survived the overflow
+}
+
+void test_wraparound_many_cycles() {
+    hal::SPSCQueue<int, 2> q;
+    for (int i = 0; i < 1000; i++) {
+        TEST_ASSERT_TRUE(q.push(i));
+        int out = -1;
+        TEST_ASSERT_TRUE(q.pop(out));
+        TEST_ASSERT_EQUAL(i, out);
+    }
+    TEST_ASSERT_TRUE(q.empty());
+    TEST_ASSERT_EQUAL(0, (int)q.dropped());
+}
+
+// peek() looks without taking; discard() then drops from the front.
+void test_peek_and_discard() {
+    hal::SPSCQueue<int, 4> q;
+    TEST_ASSERT_NULL(q.peek());
+    for (int i = 0; i < 3; i++) q.push(i);
+    TEST_ASSERT_EQUAL(0, *q.peek());
+    TEST_ASSERT_EQUAL(2, *q.peek(2));
+    TEST_ASSERT_NULL(q.peek(3));
+    TEST_ASSERT_EQUAL(3, (int)q.size());
+
+    q.discard(2);
+    TEST_ASSERT_EQUAL(1, (int)q.size());
+    TEST_ASSERT_EQUAL(2, *q.peek());
+    q.discard(5);  // More than queued
+    TEST_ASSERT_TRUE(q.empty());
+}
+
+// Scan events carry a String; pop() must move it out intact and leave the
+// slot empty so the heap buffer isn't pinned until the slot is reused.
+struct Event {
+    int kind = 0;
+    String tokenId;
+};
+
+void test_moves_heap_owning_payload() {
+    hal::SPSCQueue<Event, 4> q;
+    Event e;
+    e.kind = 7;
+    e.tokenId = "kaa001";
+    TEST_ASSERT_TRUE(q.push(std::move(e)));
+
+    Event out;
+    TEST_ASSERT_TRUE(q.pop(out));
+    TEST_ASSERT_EQUAL(7, out.kind);
+    TEST_ASSERT_EQUAL_STRING("kaa001", out.tokenId.c_str());
+}
+
+// ─── Cross-thread hand-off ────────────────────────────────────────────
+
+// Producer and consumer on separate threads (stand-ins for the Core-0 scan
+// task and the Core-1 loop). Every value must arrive exactly once, in order.
+void test_two_thread_handoff_preserves_order() {
+    static hal::SPSCQueue<uint32_t, 8> q;
+    const uint32_t N = 200000;
+
+    std::thread producer([&]() {
+        for (uint32_t i = 0; i < N; ) {
+            if (q.push(i)) i++;
+            else std::this_thread::yield();
+        }
+    });
+
+    uint32_t expected = 0;
+    bool ordered = true;
+    while (expected < N) {
+        uint32_t v;
+        if (q.pop(v)) {
+            if (v != expected) ordered = false;
+            expected++;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+
+    TEST_ASSERT_TRUE(ordered);
+    TEST_ASSERT_EQUAL(N, expected);
+    TEST_ASSERT_TRUE(q.empty());
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_empty_queue_pop_fails);
+    RUN_TEST(test_fifo_order);
+    RUN_TEST(test_full_queue_rejects_and_counts_drop);
+    RUN_TEST(test_wraparound_many_cycles);
+    RUN_TEST(test_peek_and_discard);
+    RUN_TEST(test_moves_heap_owning_payload);
+    RUN_TEST(test_two_thread_handoff_preserves_order);
+    return UNITY_END();
+}
@@ -0,0 +1,102 @@
+#include <unity.h>
+#include <Arduino.h>
+#include <SD.h>
+#include "services/SyncValidators.h"
+
+// Cache validator sidecars for conditional token/manifest sync.
+
+namespace sv = services::sync_validators;
+
+static const char* DATA = "/tokens.json";
+static const char* SIDECAR = "/tokens.etag";
+
+void setUp(void) { mock::sdReset(); }
+void tearDown(void) {}
+
+static void writeFile(const char* path, const char* text) {
+    File f = SD.open(path, FILE_WRITE);
+    f.print(text);
+    f.close();
+}
+
+void test_format_parse_round_trip() {
+    services::SyncValidators v;
+    v.etag = "W/\"5a1-Hc2n1kGCbV1TnO8CPiwSG5M0dSI\"";
+    v.lastModified = "Wed, 14 Oct 2026 18:02:11 GMT";
+    services::SyncValidators back = sv::parse(sv::format(v));
+    TEST_ASSERT_EQUAL_STRING(v.etag.c_str(), back.etag.c_str());
+    TEST_ASSERT_EQUAL_STRING(v.lastModified.c_str(), back.lastModified.c_str());
+}
+
+void test_parse_names_case_insensitive_unknown_ignored() {
+    services::SyncValidators v = sv::parse("etag:  \"abc\"  \nX-Other: 1\nLAST-MODIFIED: Thu\n");
+    TEST_ASSERT_EQUAL_STRING("\"abc\"", v.etag.c_str());
+    TEST_ASSERT_EQUAL_STRING("Thu", v.lastModified.c_str());
+    TEST_ASSERT_TRUE(sv::parse("garbage\n\n").empty());
+}
+
+void test_save_then_load() {
+    writeFile(DATA, "{}");
+    services::SyncValidators v;
+    v.etag = "\"1\"";
+    TEST_ASSERT_TRUE(sv::save(SIDECAR, v));
+    services::SyncValidators back = sv::load(SIDECAR, DATA);
+    TEST_ASSERT_EQUAL_STRING("\"1\"", back.etag.c_str());
+    TEST_ASSERT_EQUAL(0, (int)back.lastModified.length());
+}
+
+void test_load_without_data_file_is_empty() {
+    services::SyncValidators v;
+    v.etag = "\"1\"";
+    sv::save(SIDECAR, v);
+    // The file it describes is gone: never send a condition for it
+    TEST_ASSERT_TRUE(sv::load(SIDECAR, DATA).empty());
+}
+
+void test_load_without_sidecar_is_empty() {
+    writeFile(DATA, "{}");
+    TEST_ASSERT_TRUE(sv::load(SIDECAR, DATA).empty());
+}
+
+void test_save_empty_and_clear_remove_sidecar() {
+    writeFile(DATA, "{}");
+    services::SyncValidators v;
+    v.lastModified = "Thu";
+    sv::save(SIDECAR, v);
+    TEST_ASSERT_TRUE(SD.exists(SIDECAR));
+
+    TEST_ASSERT_TRUE(sv::save(SIDECAR, services::SyncValidators()));
+    TEST_ASSERT_FALSE(SD.exists(SIDECAR));
+
+    sv::save(SIDECAR, v);
+    sv::clear(SIDECAR);
+    TEST_ASSERT_FALSE(SD.exists(SIDECAR));
+    sv::clear(SIDECAR);  // Absent: no-op
+    TEST_ASSERT_TRUE(sv::load(SIDECAR, DATA).empty());
+}
+
+void test_save_replaces_previous_validators() {
+    writeFile(DATA, "{}");
+    services::SyncValidators a;
+    a.etag = "\"a\"";
+    a.lastModified = "Mon";
+    sv::save(SIDECAR, a);
+    services::SyncValidators b;
+    b.etag = "\"b\"";
+    sv::save(SIDECAR, b);
+    services::SyncValidators back = sv::load(SIDECAR, DATA);
+    TEST_ASSERT_EQUAL_STRING("\"b\"", back.etag.c_str());
+    TEST_ASSERT_EQUAL(0, (int)back.lastModified.length());
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_format_parse_round_trip);
+    RUN_TEST(test_parse_names_case_insensitive_unknown_ignored);
+    RUN_TEST(test_save_then_load);
+    RUN_TEST(test_load_without_data_file_is_empty);
+    RUN_TEST(test_load_without_sidecar_is_empty);
+    RUN_TEST(test_save_empty_and_clear_remove_sidecar);
+    RUN_TEST(test_save_replaces_previous_validators);
+    return UNITY_END();
+}
@@ -0,0 +1,124 @@
+#include <unity.h>
+#include <Arduino.h>
+#include <SD.h>
+#include <string>
+#include <vector>
+#include "services/TokenDb.h"
+
+// /tokens.json load: filtered parse of tokens.*.video from a File on the
+// SD mock, including a DB far past the old 50 KB download cap.
+
+static const char* DB = "/tokens.json";
+
+void setUp(void) { mock::sdReset(); }
+void tearDown(void) {}
+
+static void writeFile(const std::string& text) {
+    File f = SD.open(DB, FILE_WRITE);
+    f.write(reinterpret_cast<const uint8_t*>(text.data()), text.size());
+    f.close();
+}
+
+static bool load(std::vector<models::TokenMetadata>& tokens, DeserializationError& error) {
+    File f = SD.open(DB, FILE_READ);
+    bool ok = services::token_db::parse(f, tokens, error);
+    f.close();
+    return ok;
+}
+
+void test_reads_video_and_ignores_other_fields() {
+    writeFile("{\"version\":3,\"tokens\":{"
+              "\"kaa001\":{\"video\":\"kaa001.mp4\",\"image\":\"x.bmp\",\"audio\":\"x.wav\"},"
+              "\"jaw001\":{\"video\":\"\",\"processingImage\":\"p.bmp\"},"
+              "\"rat001\":{\"image\":\"r.bmp\"}}}");
+    std::vector<models::TokenMetadata> tokens;
+    DeserializationError error;
+    TEST_ASSERT_TRUE(load(tokens, error));
+    TEST_ASSERT_EQUAL(3, (int)tokens.size());
+    TEST_ASSERT_EQUAL_STRING("kaa001", tokens[0].tokenId.c_str());
+    TEST_ASSERT_EQUAL_STRING("kaa001.mp4", tokens[0].video.c_str());
+    TEST_ASSERT_TRUE(tokens[0].isVideoToken());
+    TEST_ASSERT_FALSE(tokens[1].isVideoToken());
+    TEST_ASSERT_EQUAL_STRING("", tokens[2].video.c_str());  // No video field
+}
+
+void test_large_token_db_loads() {
+    // ~3000 tokens with the metadata the orchestrator sends: well over 500 KB
+    const int count = 3000;
+    std::string json = "{\"tokens\":{";
+    char buf[512];
+    for (int i = 0; i < count; i++) {
+        snprintf(buf, sizeof(buf),
+                 "%s\"tok%05d\":{\"video\":\"%s\",\"image\":\"assets/images/tok%05d.bmp\","
+                 "\"audio\":\"assets/audio/tok%05d.wav\","
+                 "\"processingImage\":\"assets/images/tok%05d_processing.bmp\","
+                 "\"SF_MemoryType\":\"Technical\",\"SF_ValueRating\":%d,"
+                 "\"summary\":\"A memory fragment recovered from the night of the party, "
+                 "token number %05d, padded the way real descriptions are.\"}",
+                 i ? "," : "", i, (i % 10 == 0) ? "clip.mp4" : "", i, i, i, i % 5 + 1, i);
+        json += buf;
+    }
+    json += "}}";
+    TEST_ASSERT_TRUE(json.size() > 500 * 1024);
+    writeFile(json);
+
+    std::vector<models::TokenMetadata> tokens;
+    DeserializationError error;
+    TEST_ASSERT_TRUE(load(tokens, error));
+    TEST_ASSERT_EQUAL(count, (int)tokens.size());
+    TEST_ASSERT_EQUAL_STRING("tok00000", tokens[0].tokenId.c_str());
+    TEST_ASSERT_TRUE(tokens[0].isVideoToken());
+    TEST_ASSERT_FALSE(tokens[1].isVideoToken());
+    TEST_ASSERT_EQUAL_STRING("tok02999", tokens[count - 1].tokenId.c_str());
+    TEST_ASSERT_EQUAL_STRING("clip.mp4", tokens[2990].video.c_str());
+}
+
+void test_missing_tokens_object_empties_list() {
+    writeFile("{\"version\":3}");
+    std::vector<models::TokenMetadata> tokens(2);
+    DeserializationError error;
+    TEST_ASSERT_FALSE(load(tokens, error));
+    TEST_ASSERT_FALSE((bool)error);
+    TEST_ASSERT_EQUAL(0, (int)tokens.size());
+}
+
+void test_parse_error_keeps_previous_tokens() {
+    writeFile("{\"tokens\":{\"kaa001\":{\"video\":\"kaa");  // Cut short
+    std::vector<models::TokenMetadata> tokens(2);
+    DeserializationError error;
+    TEST_ASSERT_FALSE(load(tokens, error));
+    TEST_ASSERT_TRUE((bool)error);
+    TEST_ASSERT_EQUAL(2, (int)tokens.size());
+}
+
+// check(): the sync's pre-commit test of a downloaded .part
+static bool check(DeserializationError& error) {
+    File f = SD.open(DB, FILE_READ);
+    bool ok = services::token_db::check(f, error);
+    f.close();
+    return ok;
+}
+
+void test_check_accepts_whole_object_and_rejects_cut_body() {
+    DeserializationError error;
+    writeFile("{\"tokens\":{\"kaa001\":{\"video\":\"kaa001.mp4\"}}}");
+    TEST_ASSERT_TRUE(check(error));
+
+    writeFile("{\"tokens\":{\"kaa001\":{\"vid");  // Close-delimited body cut short
+    TEST_ASSERT_FALSE(check(error));
+    TEST_ASSERT_TRUE((bool)error);
+
+    writeFile("[1,2]");  // Valid JSON, not a token DB
+    TEST_ASSERT_FALSE(check(error));
+    TEST_ASSERT_FALSE((bool)error);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_reads_video_and_ignores_other_fields);
+    RUN_TEST(test_large_token_db_loads);
+    RUN_TEST(test_missing_tokens_object_empties_list);
+    RUN_TEST(test_parse_error_keeps_previous_tokens);
+    RUN_TEST(test_check_accepts_whole_object_and_rejects_cut_body);
+    return UNITY_END();
+}
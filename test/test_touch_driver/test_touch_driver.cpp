@@ -0,0 +1,143 @@
+#include <unity.h>
+#include <Arduino.h>
+#include "hal/TouchDriver.h"
+
+// The ISR is driven through mock::drivePin(), which runs it inline on each
+// GPIO36 edge; the virtual clock stands in for finger/EMI timing.
+
+static hal::TouchDriver& touch() { return hal::TouchDriver::getInstance(); }
+
+static void press(uint32_t widthUs) {
+    mock::drivePin(pins::TOUCH_IRQ, LOW);
+    mock::nowUs += widthUs;
+    mock::drivePin(pins::TOUCH_IRQ, HIGH);
+}
+
+void setUp(void) {
+    mock::pinLevels[pins::TOUCH_IRQ] = HIGH;
+    touch().begin();
+    hal::TouchEvent drain;
+    while (touch().poll(drain)) {}
+}
+
+void tearDown(void) {}
+
+void test_emi_pulse_rejected() {
+    uint32_t rejected = touch().getRejectedCount();
+    press(50);
+
+    hal::TouchEvent ev;
+    TEST_ASSERT_FALSE(touch().poll(ev));
+    TEST_ASSERT_EQUAL(rejected + 1, touch().getRejectedCount());
+}
+
+// An edge the ISR only services after the pin is HIGH again never queues.
+void test_glitch_faster_than_isr_counted() {
+    uint32_t rejected = touch().getRejectedCount();
+    mock::pulseEdge(pins::TOUCH_IRQ);
+
+    hal::TouchEvent ev;
+    TEST_ASSERT_FALSE(touch().poll(ev));
+    TEST_ASSERT_EQUAL(rejected + 1, touch().getRejectedCount());
+}
+
+void test_released_tap_accepted_once() {
+    uint32_t accepted = touch().getAcceptedCount();
+    uint32_t fallUs = (uint32_t)mock::nowUs;
+    press(70000);
+
+    hal::TouchEvent ev;
+    TEST_ASSERT_TRUE(touch().poll(ev));
+    TEST_ASSERT_FALSE(ev.held);
+    TEST_ASSERT_EQUAL(fallUs, ev.pressedAtUs);
+    TEST_ASSERT_EQUAL(70000, (int)ev.widthUs);
+    TEST_ASSERT_FALSE(touch().poll(ev));
+    TEST_ASSERT_EQUAL(accepted + 1, touch().getAcceptedCount());
+}
+
+// A press is reported once it has been LOW for the threshold, without
+// waiting for release; the later release is not reported again.
+void test_held_press_accepted_before_release() {
+    mock::drivePin(pins::TOUCH_IRQ, LOW);
+
+    hal::TouchEvent ev;
+    mock::nowUs += timing::TOUCH_PULSE_WIDTH_THRESHOLD_US - 1;
+    TEST_ASSERT_FALSE(touch().poll(ev));
+
+    mock::nowUs += 1;
+    TEST_ASSERT_TRUE(touch().poll(ev));
+    TEST_ASSERT_TRUE(ev.held);
+    TEST_ASSERT_FALSE(touch().poll(ev));
+
+    mock::nowUs += 400000;
+    mock::drivePin(pins::TOUCH_IRQ, HIGH);
+    TEST_ASSERT_FALSE(touch().poll(ev));
+}
+
+// Polling never blocks: poll() on a held line returns without advancing time.
+void test_poll_does_not_block() {
+    mock::drivePin(pins::TOUCH_IRQ, LOW);
+    uint64_t before = mock::nowUs;
+
+    hal::TouchEvent ev;
+    touch().poll(ev);
+    TEST_ASSERT_EQUAL_UINT64(before, mock::nowUs);
+
+    mock::nowUs += 20000;
+    mock::drivePin(pins::TOUCH_IRQ, HIGH);
+}
+
+void test_emi_burst_then_tap() {
+    for (int i = 0; i < 5; i++) {
+        press(20);
+        mock::nowUs += 1000;
+    }
+    press(80000);
+
+    hal::TouchEvent ev;
+    TEST_ASSERT_TRUE(touch().poll(ev));
+    TEST_ASSERT_EQUAL(80000, (int)ev.widthUs);
+    TEST_ASSERT_FALSE(touch().poll(ev));
+}
+
+// A lost rising edge must not latch the driver in "pressed": the next
+// falling edge starts a fresh press that is still reported.
+void test_missed_release_recovers() {
+    mock::drivePin(pins::TOUCH_IRQ, LOW);
+    mock::nowUs += 30000;
+    hal::TouchEvent ev;
+    TEST_ASSERT_TRUE(touch().poll(ev));
+
+    // Rising edge lost: level goes HIGH with no ISR, then a new press
+    mock::pinLevels[pins::TOUCH_IRQ] = HIGH;
+    mock::nowUs += 200000;
+    press(60000);
+
+    TEST_ASSERT_TRUE(touch().poll(ev));
+    TEST_ASSERT_EQUAL(60000, (int)ev.widthUs);
+}
+
+void test_queue_overflow_drops_and_counts() {
+    uint32_t dropped = touch().getDroppedCount();
+    for (int i = 0; i < hal::TOUCH_PULSE_QUEUE_DEPTH + 3; i++) {
+        press(30);
+        mock::nowUs += 100;
+    }
+    TEST_ASSERT_EQUAL(dropped + 3, touch().getDroppedCount());
+
+    hal::TouchEvent ev;
+    TEST_ASSERT_FALSE(touch().poll(ev));
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_emi_pulse_rejected);
+    RUN_TEST(test_glitch_faster_than_isr_counted);
+    RUN_TEST(test_released_tap_accepted_once);
+    RUN_TEST(test_held_press_accepted_before_release);
+    RUN_TEST(test_poll_does_not_block);
+    RUN_TEST(test_emi_burst_then_tap);
+    RUN_TEST(test_missed_release_recovers);
+    RUN_TEST(test_queue_overflow_drops_and_counts);
+    return UNITY_END();
+}